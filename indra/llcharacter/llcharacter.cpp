@@ -205,17 +205,40 @@ void LLCharacter::updateMotions(e_update_t update_type)
 	}
 	else
 	{
-		// unpause if the number of outstanding pause requests has dropped to the initial one
-		if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
+		// <FS:Perf> Parallel motion evaluation
+		//// unpause if the number of outstanding pause requests has dropped to the initial one
+		//if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
+		//{
+		//	mMotionController.unpauseAllMotions();
+		//}
+		//bool force_update = (update_type == FORCE_UPDATE);
+		//{
+		//	mMotionController.updateMotions(force_update);
+		//}
+		if (prepareMotionUpdate(update_type))
 		{
-			mMotionController.unpauseAllMotions();
-		}
-		bool force_update = (update_type == FORCE_UPDATE);
-		{
-			mMotionController.updateMotions(force_update);
+			mMotionController.evaluateMotions();
+			mMotionController.commitMotionUpdate();
 		}
+		// </FS:Perf>
+	}
+}
+
+// <FS:Perf> Parallel motion evaluation
+//-----------------------------------------------------------------------------
+// prepareMotionUpdate()
+//-----------------------------------------------------------------------------
+BOOL LLCharacter::prepareMotionUpdate(e_update_t update_type)
+{
+	// unpause if the number of outstanding pause requests has dropped to the initial one
+	if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
+	{
+		mMotionController.unpauseAllMotions();
 	}
+	bool force_update = (update_type == FORCE_UPDATE);
+	return mMotionController.prepareMotionUpdate(force_update);
 }
+// </FS:Perf>
 
 
 //-----------------------------------------------------------------------------
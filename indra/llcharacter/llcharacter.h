@@ -160,6 +160,12 @@ public:
 	// periodic update function, steps the motion controller
 	enum e_update_t { NORMAL_UPDATE, HIDDEN_UPDATE, FORCE_UPDATE };
 	void updateMotions(e_update_t update_type);
+	// <FS:Perf> Parallel motion evaluation
+	// The main thread part of updateMotions() for NORMAL_UPDATE and
+	// FORCE_UPDATE. When it returns TRUE, the caller goes on with
+	// getMotionController().evaluateMotions() and commitMotionUpdate().
+	BOOL prepareMotionUpdate(e_update_t update_type);
+	// </FS:Perf>
 
 	LLAnimPauseRequest requestPause();
 	BOOL areAnimationsPaused() const { return mMotionController.isPaused(); }
@@ -267,7 +267,10 @@ void LLHeadRotMotion::onDeactivate()
 // LLEyeMotion()
 // Class Constructor
 //-----------------------------------------------------------------------------
-LLEyeMotion::LLEyeMotion(const LLUUID &id) : LLMotion(id)
+// <FS:Perf> Parallel motion evaluation
+//LLEyeMotion::LLEyeMotion(const LLUUID &id) : LLMotion(id)
+LLEyeMotion::LLEyeMotion(const LLUUID &id) : LLMotion(id), mRandom((U32)ll_rand())
+// </FS:Perf>
 {
 	mCharacter = NULL;
 	mEyeJitterTime = 0.f;
@@ -457,6 +460,17 @@ void LLEyeMotion::adjustEyeTarget(LLVector3* targetPos, LLJointState& left_eye_s
 	right_eye_state.setRotation( right_eye_rot );
 }
 
+// <FS:Perf> Parallel motion evaluation
+//-----------------------------------------------------------------------------
+// LLEyeMotion::randomFloat()
+// Same range as ll_frand(val)
+//-----------------------------------------------------------------------------
+F32 LLEyeMotion::randomFloat(F32 val)
+{
+	return val * (F32)((F64)mRandom() / 4294967296.0);
+}
+// </FS:Perf>
+
 //-----------------------------------------------------------------------------
 // LLEyeMotion::onUpdate()
 //-----------------------------------------------------------------------------
@@ -466,31 +480,47 @@ BOOL LLEyeMotion::onUpdate(F32 time, U8* joint_mask)
 	//calculate jitter
 	if (mEyeJitterTimer.getElapsedTimeF32() > mEyeJitterTime)
 	{
-		mEyeJitterTime = EYE_JITTER_MIN_TIME + ll_frand(EYE_JITTER_MAX_TIME - EYE_JITTER_MIN_TIME);
-		mEyeJitterYaw = (ll_frand(2.f) - 1.f) * EYE_JITTER_MAX_YAW;
-		mEyeJitterPitch = (ll_frand(2.f) - 1.f) * EYE_JITTER_MAX_PITCH;
+		// <FS:Perf> Parallel motion evaluation
+		//mEyeJitterTime = EYE_JITTER_MIN_TIME + ll_frand(EYE_JITTER_MAX_TIME - EYE_JITTER_MIN_TIME);
+		//mEyeJitterYaw = (ll_frand(2.f) - 1.f) * EYE_JITTER_MAX_YAW;
+		//mEyeJitterPitch = (ll_frand(2.f) - 1.f) * EYE_JITTER_MAX_PITCH;
+		mEyeJitterTime = EYE_JITTER_MIN_TIME + randomFloat(EYE_JITTER_MAX_TIME - EYE_JITTER_MIN_TIME);
+		mEyeJitterYaw = (randomFloat(2.f) - 1.f) * EYE_JITTER_MAX_YAW;
+		mEyeJitterPitch = (randomFloat(2.f) - 1.f) * EYE_JITTER_MAX_PITCH;
+		// </FS:Perf>
 		// make sure lookaway time count gets updated, because we're resetting the timer
 		mEyeLookAwayTime -= llmax(0.f, mEyeJitterTimer.getElapsedTimeF32());
 		mEyeJitterTimer.reset();
 	} 
 	else if (mEyeJitterTimer.getElapsedTimeF32() > mEyeLookAwayTime)
 	{
-		if (ll_frand() > 0.1f)
+		// <FS:Perf> Parallel motion evaluation
+		//if (ll_frand() > 0.1f)
+		if (randomFloat() > 0.1f)
+		// </FS:Perf>
 		{
 			// blink while moving eyes some percentage of the time
 			mEyeBlinkTime = mEyeBlinkTimer.getElapsedTimeF32();
 		}
 		if (mEyeLookAwayYaw == 0.f && mEyeLookAwayPitch == 0.f)
 		{
-			mEyeLookAwayYaw = (ll_frand(2.f) - 1.f) * EYE_LOOK_AWAY_MAX_YAW;
-			mEyeLookAwayPitch = (ll_frand(2.f) - 1.f) * EYE_LOOK_AWAY_MAX_PITCH;
-			mEyeLookAwayTime = EYE_LOOK_BACK_MIN_TIME + ll_frand(EYE_LOOK_BACK_MAX_TIME - EYE_LOOK_BACK_MIN_TIME);
+			// <FS:Perf> Parallel motion evaluation
+			//mEyeLookAwayYaw = (ll_frand(2.f) - 1.f) * EYE_LOOK_AWAY_MAX_YAW;
+			//mEyeLookAwayPitch = (ll_frand(2.f) - 1.f) * EYE_LOOK_AWAY_MAX_PITCH;
+			//mEyeLookAwayTime = EYE_LOOK_BACK_MIN_TIME + ll_frand(EYE_LOOK_BACK_MAX_TIME - EYE_LOOK_BACK_MIN_TIME);
+			mEyeLookAwayYaw = (randomFloat(2.f) - 1.f) * EYE_LOOK_AWAY_MAX_YAW;
+			mEyeLookAwayPitch = (randomFloat(2.f) - 1.f) * EYE_LOOK_AWAY_MAX_PITCH;
+			mEyeLookAwayTime = EYE_LOOK_BACK_MIN_TIME + randomFloat(EYE_LOOK_BACK_MAX_TIME - EYE_LOOK_BACK_MIN_TIME);
+			// </FS:Perf>
 		}
 		else
 		{
 			mEyeLookAwayYaw = 0.f;
 			mEyeLookAwayPitch = 0.f;
-			mEyeLookAwayTime = EYE_LOOK_AWAY_MIN_TIME + ll_frand(EYE_LOOK_AWAY_MAX_TIME - EYE_LOOK_AWAY_MIN_TIME);
+			// <FS:Perf> Parallel motion evaluation
+			//mEyeLookAwayTime = EYE_LOOK_AWAY_MIN_TIME + ll_frand(EYE_LOOK_AWAY_MAX_TIME - EYE_LOOK_AWAY_MIN_TIME);
+			mEyeLookAwayTime = EYE_LOOK_AWAY_MIN_TIME + randomFloat(EYE_LOOK_AWAY_MAX_TIME - EYE_LOOK_AWAY_MIN_TIME);
+			// </FS:Perf>
 		}
 	}
 
@@ -529,7 +559,10 @@ BOOL LLEyeMotion::onUpdate(F32 time, U8* joint_mask)
 			if (rightEyeBlinkMorph == 0.f)
 			{
 				mEyesClosed = FALSE;
-				mEyeBlinkTime = EYE_BLINK_MIN_TIME + ll_frand(EYE_BLINK_MAX_TIME - EYE_BLINK_MIN_TIME);
+				// <FS:Perf> Parallel motion evaluation
+				//mEyeBlinkTime = EYE_BLINK_MIN_TIME + ll_frand(EYE_BLINK_MAX_TIME - EYE_BLINK_MIN_TIME);
+				mEyeBlinkTime = EYE_BLINK_MIN_TIME + randomFloat(EYE_BLINK_MAX_TIME - EYE_BLINK_MIN_TIME);
+				// </FS:Perf>
 				mEyeBlinkTimer.reset();
 			}
 		}
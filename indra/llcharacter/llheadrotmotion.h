@@ -32,6 +32,7 @@
 //-----------------------------------------------------------------------------
 #include "llmotion.h"
 #include "llframetimer.h"
+#include "llrand.h" // <FS:Perf/> Parallel motion evaluation
 
 #define MIN_REQUIRED_PIXEL_AREA_HEAD_ROT 500.f;
 #define MIN_REQUIRED_PIXEL_AREA_EYE 25000.f;
@@ -210,6 +211,13 @@ public:
 	LLFrameTimer		mEyeBlinkTimer;
 	F32					mEyeBlinkTime;
 	BOOL				mEyesClosed;
+
+	// <FS:Perf> Parallel motion evaluation
+	// onUpdate() may run on a worker thread, where the shared generator
+	// behind ll_frand() must not be used, so each eye motion has its own.
+	F32 randomFloat(F32 val = 1.f);
+	LLRandMT19937		mRandom;
+	// </FS:Perf>
 };
 
 #endif // LL_LLHEADROTMOTION_H
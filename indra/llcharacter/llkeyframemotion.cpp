@@ -45,6 +45,8 @@
 
 #include "nd/ndexceptions.h" // <FS:ND/> For nd::exceptions::xran
 
+#include <algorithm> // <FS:Perf/> std::lower_bound, std::stable_sort
+
 //-----------------------------------------------------------------------------
 // Static Definitions
 //-----------------------------------------------------------------------------
@@ -63,6 +65,65 @@ static F32 MIN_ACCELERATION_SQUARED = 0.0005f * 0.0005f;
 
 static F32 MAX_CONSTRAINTS = 10;
 
+// <FS:Perf>
+//-----------------------------------------------------------------------------
+// find_key()
+// Index of the first key at or after time, like lower_bound. cursor holds
+// the answer of the previous call; playing forward it is either still right
+// or a few keys short, so only looping back or seeking needs the search.
+//-----------------------------------------------------------------------------
+static U32 find_key(const std::vector<F32>& times, F32 time, U32& cursor)
+{
+	const U32 num_keys = (U32)times.size();
+	U32 right = llmin(cursor, num_keys);
+	if (right > 0 && times[right - 1] >= time)
+	{
+		// Went back in time
+		right = (U32)(std::lower_bound(times.begin(), times.begin() + right, time) - times.begin());
+	}
+	else
+	{
+		const U32 MAX_STEPS = 4;
+		U32 steps = 0;
+		while (right < num_keys && times[right] < time && steps++ < MAX_STEPS)
+		{
+			++right;
+		}
+		if (right < num_keys && times[right] < time)
+		{
+			right = (U32)(std::lower_bound(times.begin() + right, times.end(), time) - times.begin());
+		}
+	}
+	cursor = right;
+	return right;
+}
+
+//-----------------------------------------------------------------------------
+// sort_keys()
+// Sorts keys by time, keeping the last one read for any given time as
+// inserting them into a map used to.
+//-----------------------------------------------------------------------------
+template <class KEY>
+static void sort_keys(std::vector<KEY>& keys)
+{
+	std::stable_sort(keys.begin(), keys.end(),
+					 [](const KEY& a, const KEY& b) { return a.mTime < b.mTime; });
+	size_t count = 0;
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		if (count > 0 && keys[count - 1].mTime == keys[i].mTime)
+		{
+			keys[count - 1] = keys[i];
+		}
+		else
+		{
+			keys[count++] = keys[i];
+		}
+	}
+	keys.resize(count);
+}
+// </FS:Perf>
+
 //-----------------------------------------------------------------------------
 // JointMotionList
 //-----------------------------------------------------------------------------
@@ -144,71 +205,116 @@ LLKeyframeMotion::ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::ScaleCurve::~ScaleCurve() 
 {
-	mKeys.clear();
+	// <FS:Perf>
+	//mKeys.clear();
+	mKeyTimes.clear();
+	mKeyValues.clear();
+	// </FS:Perf>
 	mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration, U32& cursor) const
 {
 	LLVector3 value;
 
-	if (mKeys.empty())
+	if (mKeyTimes.empty()) // <FS:Perf/>
 	{
 		value.clearVec();
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	// <FS:Perf>
+	//key_map_t::iterator right = mKeys.lower_bound(time);
+	//if (right == mKeys.end())
+	//{
+	//	// Past last key
+	//	--right;
+	//	value = right->second.mScale;
+	//}
+	//else if (right == mKeys.begin() || right->first == time)
+	//{
+	//	// Before first key or exactly on a key
+	//	value = right->second.mScale;
+	//}
+	//else
+	//{
+	//	// Between two keys
+	//	key_map_t::iterator left = right; --left;
+	//	F32 index_before = left->first;
+	//	F32 index_after = right->first;
+	//	ScaleKey& scale_before = left->second;
+	//	ScaleKey& scale_after = right->second;
+	//	if (right == mKeys.end())
+	//	{
+	//		scale_after = mLoopInKey;
+	//		index_after = duration;
+	//	}
+	//
+	//	F32 u = (time - index_before) / (index_after - index_before);
+	//	value = interp(u, scale_before, scale_after);
+	//}
+	const U32 right = find_key(mKeyTimes, time, cursor);
+	if (right == mKeyTimes.size())
 	{
 		// Past last key
-		--right;
-		value = right->second.mScale;
+		value = mKeyValues.back();
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (right == 0 || mKeyTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mScale;
+		value = mKeyValues[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		ScaleKey& scale_before = left->second;
-		ScaleKey& scale_after = right->second;
-		if (right == mKeys.end())
-		{
-			scale_after = mLoopInKey;
-			index_after = duration;
-		}
-
+		const F32 index_before = mKeyTimes[right - 1];
+		const F32 index_after = mKeyTimes[right];
 		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, scale_before, scale_after);
+		value = interp(u, mKeyValues[right - 1], mKeyValues[right]);
 	}
+	// </FS:Perf>
 	return value;
 }
 
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before, ScaleKey& after)
+// <FS:Perf>
+//LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before, ScaleKey& after)
+LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, const LLVector3& before, const LLVector3& after) const
+// </FS:Perf>
 {
 	switch (mInterpolationType)
 	{
 	case IT_STEP:
-		return before.mScale;
+		return before;
 
 	default:
 	case IT_LINEAR:
 	case IT_SPLINE:
-		return lerp(before.mScale, after.mScale, u);
+		return lerp(before, after, u);
+	}
+}
+
+// <FS:Perf>
+//-----------------------------------------------------------------------------
+// setKeys()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::ScaleCurve::setKeys(std::vector<ScaleKey>& keys)
+{
+	sort_keys(keys);
+	mKeyTimes.resize(keys.size());
+	mKeyValues.resize(keys.size());
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		mKeyTimes[i] = keys[i].mTime;
+		mKeyValues[i] = keys[i].mScale;
 	}
 }
+// </FS:Perf>
 
 //-----------------------------------------------------------------------------
 // RotationCurve::RotationCurve()
@@ -224,72 +330,117 @@ LLKeyframeMotion::RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::RotationCurve::~RotationCurve()
 {
-	mKeys.clear();
+	// <FS:Perf>
+	//mKeys.clear();
+	mKeyTimes.clear();
+	mKeyValues.clear();
+	// </FS:Perf>
 	mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // RotationCurve::getValue()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration, U32& cursor) const
 {
 	LLQuaternion value;
 
-	if (mKeys.empty())
+	if (mKeyTimes.empty()) // <FS:Perf/>
 	{
 		value = LLQuaternion::DEFAULT;
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	// <FS:Perf>
+	//key_map_t::iterator right = mKeys.lower_bound(time);
+	//if (right == mKeys.end())
+	//{
+	//	// Past last key
+	//	--right;
+	//	value = right->second.mRotation;
+	//}
+	//else if (right == mKeys.begin() || right->first == time)
+	//{
+	//	// Before first key or exactly on a key
+	//	value = right->second.mRotation;
+	//}
+	//else
+	//{
+	//	// Between two keys
+	//	key_map_t::iterator left = right; --left;
+	//	F32 index_before = left->first;
+	//	F32 index_after = right->first;
+	//	RotationKey& rot_before = left->second;
+	//	RotationKey& rot_after = right->second;
+	//	if (right == mKeys.end())
+	//	{
+	//		rot_after = mLoopInKey;
+	//		index_after = duration;
+	//	}
+	//
+	//	F32 u = (time - index_before) / (index_after - index_before);
+	//	value = interp(u, rot_before, rot_after);
+	//}
+	const U32 right = find_key(mKeyTimes, time, cursor);
+	if (right == mKeyTimes.size())
 	{
 		// Past last key
-		--right;
-		value = right->second.mRotation;
+		value = mKeyValues.back();
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (right == 0 || mKeyTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mRotation;
+		value = mKeyValues[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		RotationKey& rot_before = left->second;
-		RotationKey& rot_after = right->second;
-		if (right == mKeys.end())
-		{
-			rot_after = mLoopInKey;
-			index_after = duration;
-		}
-
+		const F32 index_before = mKeyTimes[right - 1];
+		const F32 index_after = mKeyTimes[right];
 		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, rot_before, rot_after);
+		value = interp(u, mKeyValues[right - 1], mKeyValues[right]);
 	}
+	// </FS:Perf>
 	return value;
 }
 
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before, RotationKey& after)
+// <FS:Perf>
+//LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before, RotationKey& after)
+LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, const LLQuaternion& before, const LLQuaternion& after) const
+// </FS:Perf>
 {
 	switch (mInterpolationType)
 	{
 	case IT_STEP:
-		return before.mRotation;
+		return before;
 
 	default:
 	case IT_LINEAR:
 	case IT_SPLINE:
-		return nlerp(u, before.mRotation, after.mRotation);
+		return nlerp(u, before, after);
 	}
 }
 
+// <FS:Perf>
+//-----------------------------------------------------------------------------
+// setKeys()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::RotationCurve::setKeys(std::vector<RotationKey>& keys)
+{
+	sort_keys(keys);
+	mKeyTimes.resize(keys.size());
+	mKeyValues.resize(keys.size());
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		mKeyTimes[i] = keys[i].mTime;
+		mKeyValues[i] = keys[i].mRotation;
+	}
+}
+// </FS:Perf>
+
 
 //-----------------------------------------------------------------------------
 // PositionCurve::PositionCurve()
@@ -305,52 +456,77 @@ LLKeyframeMotion::PositionCurve::PositionCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::PositionCurve::~PositionCurve()
 {
-	mKeys.clear();
+	// <FS:Perf>
+	//mKeys.clear();
+	mKeyTimes.clear();
+	mKeyValues.clear();
+	// </FS:Perf>
 	mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // PositionCurve::getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration, U32& cursor) const
 {
 	LLVector3 value;
 
-	if (mKeys.empty())
+	if (mKeyTimes.empty()) // <FS:Perf/>
 	{
 		value.clearVec();
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	// <FS:Perf>
+	//key_map_t::iterator right = mKeys.lower_bound(time);
+	//if (right == mKeys.end())
+	//{
+	//	// Past last key
+	//	--right;
+	//	value = right->second.mPosition;
+	//}
+	//else if (right == mKeys.begin() || right->first == time)
+	//{
+	//	// Before first key or exactly on a key
+	//	value = right->second.mPosition;
+	//}
+	//else
+	//{
+	//	// Between two keys
+	//	key_map_t::iterator left = right; --left;
+	//	F32 index_before = left->first;
+	//	F32 index_after = right->first;
+	//	PositionKey& pos_before = left->second;
+	//	PositionKey& pos_after = right->second;
+	//	if (right == mKeys.end())
+	//	{
+	//		pos_after = mLoopInKey;
+	//		index_after = duration;
+	//	}
+	//
+	//	F32 u = (time - index_before) / (index_after - index_before);
+	//	value = interp(u, pos_before, pos_after);
+	//}
+	const U32 right = find_key(mKeyTimes, time, cursor);
+	if (right == mKeyTimes.size())
 	{
 		// Past last key
-		--right;
-		value = right->second.mPosition;
+		value = mKeyValues.back();
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (right == 0 || mKeyTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mPosition;
+		value = mKeyValues[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		PositionKey& pos_before = left->second;
-		PositionKey& pos_after = right->second;
-		if (right == mKeys.end())
-		{
-			pos_after = mLoopInKey;
-			index_after = duration;
-		}
-
+		const F32 index_before = mKeyTimes[right - 1];
+		const F32 index_after = mKeyTimes[right];
 		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, pos_before, pos_after);
+		value = interp(u, mKeyValues[right - 1], mKeyValues[right]);
 	}
+	// </FS:Perf>
 
 	llassert(value.isFinite());
 	
@@ -360,18 +536,38 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, PositionKey& after)
+// <FS:Perf>
+//LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, PositionKey& after)
+LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, const LLVector3& before, const LLVector3& after) const
+// </FS:Perf>
 {
 	switch (mInterpolationType)
 	{
 	case IT_STEP:
-		return before.mPosition;
+		return before;
 	default:
 	case IT_LINEAR:
 	case IT_SPLINE:
-		return lerp(before.mPosition, after.mPosition, u);
+		return lerp(before, after, u);
+	}
+}
+
+// <FS:Perf>
+//-----------------------------------------------------------------------------
+// setKeys()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::PositionCurve::setKeys(std::vector<PositionKey>& keys)
+{
+	sort_keys(keys);
+	mKeyTimes.resize(keys.size());
+	mKeyValues.resize(keys.size());
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		mKeyTimes[i] = keys[i].mTime;
+		mKeyValues[i] = keys[i].mPosition;
 	}
 }
+// </FS:Perf>
 
 
 //-----------------------------------------------------------------------------
@@ -383,7 +579,10 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
 //-----------------------------------------------------------------------------
 // JointMotion::update()
 //-----------------------------------------------------------------------------
-void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+// <FS:Perf>
+//void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration, KeyCursors& cursors)
+// </FS:Perf>
 {
 	// this value being 0 is the cause of https://jira.lindenlab.com/browse/SL-22678 but I haven't 
 	// managed to get a stack to see how it got here. Testing for 0 here will stop the crash.
@@ -399,7 +598,10 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::SCALE) && mScaleCurve.mNumKeys)
 	{
-		joint_state->setScale( mScaleCurve.getValue( time, duration ) );
+		// <FS:Perf>
+		//joint_state->setScale( mScaleCurve.getValue( time, duration ) );
+		joint_state->setScale( mScaleCurve.getValue( time, duration, cursors.mScale ) );
+		// </FS:Perf>
 	}
 
 	//-------------------------------------------------------------------------
@@ -407,7 +609,10 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
 	{
-		joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+		// <FS:Perf>
+		//joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+		joint_state->setRotation( mRotationCurve.getValue( time, duration, cursors.mRotation ) );
+		// </FS:Perf>
 	}
 
 	//-------------------------------------------------------------------------
@@ -415,7 +620,10 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
 	{
-		joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+		// <FS:Perf>
+		//joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+		joint_state->setPosition( mPositionCurve.getValue( time, duration, cursors.mPosition ) );
+		// </FS:Perf>
 	}
 }
 
@@ -738,11 +946,34 @@ BOOL LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
 	llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
+	// <FS:Perf>
+	if (mKeyCursors.size() < mJointMotionList->getNumJointMotions())
+	{
+		mKeyCursors.resize(mJointMotionList->getNumJointMotions());
+	}
+	// </FS:Perf>
+	// <FS:Perf> Animation LOD: the pose blender ignores these joints, so don't bother with their curves
+	const bool base_joints_only = mCharacter->getMotionController().getBaseJointsOnly();
+	// </FS:Perf>
 	for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
 	{
+		// <FS:Perf> Animation LOD
+		if (base_joints_only)
+		{
+			LLJoint* joint = mJointStates[i].notNull() ? mJointStates[i]->getJoint() : NULL;
+			if (joint && joint->getSupport() == LLJoint::SUPPORT_EXTENDED)
+			{
+				continue;
+			}
+		}
+		// </FS:Perf>
 		mJointMotionList->getJointMotion(i)->update(mJointStates[i],
 													  time, 
-													  mJointMotionList->mDuration );
+													  // <FS:Perf>
+													  //mJointMotionList->mDuration );
+													  mJointMotionList->mDuration,
+													  mKeyCursors[i] );
+													  // </FS:Perf>
 	}
 
 	LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
@@ -1534,6 +1765,7 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
 		// scan rotation curve keys
 		//---------------------------------------------------------------------
 		RotationCurve *rCurve = &joint_motion->mRotationCurve;
+		std::vector<RotationKey> rot_keys; // <FS:Perf/> Sorted into rCurve once all are read
 
 		for (S32 k = 0; k < joint_motion->mRotationCurve.mNumKeys; k++)
 		{
@@ -1630,10 +1862,17 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
 				return FALSE;
 			}
 
-			rCurve->mKeys[time] = rot_key;
+			// <FS:Perf>
+			//rCurve->mKeys[time] = rot_key;
+			rot_keys.push_back(rot_key);
+			// </FS:Perf>
 		}
+		rCurve->setKeys(rot_keys); // <FS:Perf/>
 
-        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeys.size())
+        // <FS:Perf>
+        //if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeys.size())
+        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeyTimes.size())
+        // </FS:Perf>
         {
             rotation_dupplicates++;
             LL_INFOS() << "Motion: " << asset_id << " had dupplicate rotation keys that were removed" << LL_ENDL;
@@ -1659,6 +1898,7 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
 		// scan position curve keys
 		//---------------------------------------------------------------------
 		PositionCurve *pCurve = &joint_motion->mPositionCurve;
+		std::vector<PositionKey> pos_keys; // <FS:Perf/> Sorted into pCurve once all are read
 		BOOL is_pelvis = joint_motion->mJointName == "mPelvis";
 		for (S32 k = 0; k < joint_motion->mPositionCurve.mNumKeys; k++)
 		{
@@ -1733,7 +1973,10 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
 				return FALSE;
 			}
 			
-			pCurve->mKeys[pos_key.mTime] = pos_key;
+			// <FS:Perf>
+			//pCurve->mKeys[pos_key.mTime] = pos_key;
+			pos_keys.push_back(pos_key);
+			// </FS:Perf>
 
 			if (is_pelvis)
 			{
@@ -1741,7 +1984,12 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
 			}
 		}
 
-        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeys.size())
+		pCurve->setKeys(pos_keys); // <FS:Perf/>
+
+        // <FS:Perf>
+        //if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeys.size())
+        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeyTimes.size())
+        // </FS:Perf>
         {
             position_dupplicates++;
         }
@@ -2038,15 +2286,30 @@ BOOL LLKeyframeMotion::serialize(LLDataPacker& dp) const
 		JointMotion* joint_motionp = mJointMotionList->getJointMotion(i);
 		success &= dp.packString(joint_motionp->mJointName, "joint_name");
 		success &= dp.packS32(joint_motionp->mPriority, "joint_priority");
-        success &= dp.packS32(joint_motionp->mRotationCurve.mKeys.size(), "num_rot_keys");
+        // <FS:Perf>
+        //success &= dp.packS32(joint_motionp->mRotationCurve.mKeys.size(), "num_rot_keys");
+        const RotationCurve& rot_curve = joint_motionp->mRotationCurve;
+        PositionCurve& pos_curve = joint_motionp->mPositionCurve;
+        success &= dp.packS32(rot_curve.mKeyTimes.size(), "num_rot_keys");
+        // </FS:Perf>
 
         LL_DEBUGS("BVH") << "Joint " << i
             << " name: " << joint_motionp->mJointName
-            << " Rotation keys: " << joint_motionp->mRotationCurve.mKeys.size()
-            << " Position keys: " << joint_motionp->mPositionCurve.mKeys.size() << LL_ENDL;
-        for (RotationCurve::key_map_t::value_type& rot_pair : joint_motionp->mRotationCurve.mKeys)
+            // <FS:Perf>
+            //<< " Rotation keys: " << joint_motionp->mRotationCurve.mKeys.size()
+            //<< " Position keys: " << joint_motionp->mPositionCurve.mKeys.size() << LL_ENDL;
+            << " Rotation keys: " << rot_curve.mKeyTimes.size()
+            << " Position keys: " << pos_curve.mKeyTimes.size() << LL_ENDL;
+            // </FS:Perf>
+        // <FS:Perf>
+        //for (RotationCurve::key_map_t::value_type& rot_pair : joint_motionp->mRotationCurve.mKeys)
+        for (size_t k = 0; k < rot_curve.mKeyTimes.size(); ++k)
+        // </FS:Perf>
 		{
-			RotationKey& rot_key = rot_pair.second;
+			// <FS:Perf>
+			//RotationKey& rot_key = rot_pair.second;
+			RotationKey rot_key(rot_curve.mKeyTimes[k], rot_curve.mKeyValues[k]);
+			// </FS:Perf>
 			U16 time_short = F32_to_U16(rot_key.mTime, 0.f, mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
@@ -2064,23 +2327,41 @@ BOOL LLKeyframeMotion::serialize(LLDataPacker& dp) const
 			LL_DEBUGS("BVH") << "  rot: t " << rot_key.mTime << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
 		}
 
-		success &= dp.packS32(joint_motionp->mPositionCurve.mKeys.size(), "num_pos_keys");
-		for (PositionCurve::key_map_t::value_type& pos_pair : joint_motionp->mPositionCurve.mKeys)
+		// <FS:Perf>
+		//success &= dp.packS32(joint_motionp->mPositionCurve.mKeys.size(), "num_pos_keys");
+		//for (PositionCurve::key_map_t::value_type& pos_pair : joint_motionp->mPositionCurve.mKeys)
+		success &= dp.packS32(pos_curve.mKeyTimes.size(), "num_pos_keys");
+		for (size_t k = 0; k < pos_curve.mKeyTimes.size(); ++k)
+		// </FS:Perf>
 		{
-			PositionKey& pos_key = pos_pair.second;
-			U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
+			// <FS:Perf>
+			//PositionKey& pos_key = pos_pair.second;
+			//U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
+			const F32 key_time = pos_curve.mKeyTimes[k];
+			LLVector3& key_position = pos_curve.mKeyValues[k];
+			U16 time_short = F32_to_U16(key_time, 0.f, mJointMotionList->mDuration);
+			// </FS:Perf>
 			success &= dp.packU16(time_short, "time");
 
 			U16 x, y, z;
-			pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-			x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-			y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-			z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			// <FS:Perf> Still quantizes the stored key, as before
+			//pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			//x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			//y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			//z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			key_position.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			x = F32_to_U16(key_position.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			y = F32_to_U16(key_position.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			z = F32_to_U16(key_position.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			// </FS:Perf>
 			success &= dp.packU16(x, "pos_x");
 			success &= dp.packU16(y, "pos_y");
 			success &= dp.packU16(z, "pos_z");
 
-			LL_DEBUGS("BVH") << "  pos: t " << pos_key.mTime << " pos " << pos_key.mPosition.mV[VX] <<","<< pos_key.mPosition.mV[VY] <<","<< pos_key.mPosition.mV[VZ] << LL_ENDL;
+			// <FS:Perf>
+			//LL_DEBUGS("BVH") << "  pos: t " << pos_key.mTime << " pos " << pos_key.mPosition.mV[VX] <<","<< pos_key.mPosition.mV[VY] <<","<< pos_key.mPosition.mV[VZ] << LL_ENDL;
+			LL_DEBUGS("BVH") << "  pos: t " << key_time << " pos " << key_position.mV[VX] <<","<< key_position.mV[VY] <<","<< key_position.mV[VZ] << LL_ENDL;
+			// </FS:Perf>
 		}
 	}	
 
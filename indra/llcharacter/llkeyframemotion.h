@@ -325,13 +325,24 @@ public:
 	public:
 		ScaleCurve();
 		~ScaleCurve();
-		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+		// <FS:Perf> Keys are looked up from cursor, the index found by the
+		// previous call of this animation instance, which is updated.
+		//LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+		LLVector3 getValue(F32 time, F32 duration, U32& cursor) const;
+		LLVector3 getValue(F32 time, F32 duration) const { U32 cursor = 0; return getValue(time, duration, cursor); }
+		LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after) const;
+		// Sorts keys by time, later duplicates replace earlier ones
+		void setKeys(std::vector<ScaleKey>& keys);
+		// </FS:Perf>
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, ScaleKey> key_map_t;
-		key_map_t 			mKeys;
+		// <FS:Perf> Flat arrays sorted by time instead of a map
+		//typedef std::map<F32, ScaleKey> key_map_t;
+		//key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLVector3>	mKeyValues;
+		// </FS:Perf>
 		ScaleKey			mLoopInKey;
 		ScaleKey			mLoopOutKey;
 	};
@@ -344,13 +355,22 @@ public:
 	public:
 		RotationCurve();
 		~RotationCurve();
-		LLQuaternion getValue(F32 time, F32 duration);
-		LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+		// <FS:Perf>
+		//LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+		LLQuaternion getValue(F32 time, F32 duration, U32& cursor) const;
+		LLQuaternion getValue(F32 time, F32 duration) const { U32 cursor = 0; return getValue(time, duration, cursor); }
+		LLQuaternion interp(F32 u, const LLQuaternion& before, const LLQuaternion& after) const;
+		void setKeys(std::vector<RotationKey>& keys);
+		// </FS:Perf>
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, RotationKey> key_map_t;
-		key_map_t		mKeys;
+		// <FS:Perf>
+		//typedef std::map<F32, RotationKey> key_map_t;
+		//key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLQuaternion>	mKeyValues;
+		// </FS:Perf>
 		RotationKey		mLoopInKey;
 		RotationKey		mLoopOutKey;
 	};
@@ -363,17 +383,40 @@ public:
 	public:
 		PositionCurve();
 		~PositionCurve();
-		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+		// <FS:Perf>
+		//LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+		LLVector3 getValue(F32 time, F32 duration, U32& cursor) const;
+		LLVector3 getValue(F32 time, F32 duration) const { U32 cursor = 0; return getValue(time, duration, cursor); }
+		LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after) const;
+		void setKeys(std::vector<PositionKey>& keys);
+		// </FS:Perf>
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, PositionKey> key_map_t;
-		key_map_t		mKeys;
+		// <FS:Perf>
+		//typedef std::map<F32, PositionKey> key_map_t;
+		//key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLVector3>	mKeyValues;
+		// </FS:Perf>
 		PositionKey		mLoopInKey;
 		PositionKey		mLoopOutKey;
 	};
 
+	// <FS:Perf>
+	//-------------------------------------------------------------------------
+	// KeyCursors
+	// Per instance and joint, where the previous update found its keys.
+	// Playing forward, the next keys are usually the same or the ones after.
+	//-------------------------------------------------------------------------
+	struct KeyCursors
+	{
+		U32 mScale = 0;
+		U32 mRotation = 0;
+		U32 mPosition = 0;
+	};
+	// </FS:Perf>
+
 	//-------------------------------------------------------------------------
 	// JointMotion
 	//-------------------------------------------------------------------------
@@ -387,7 +430,10 @@ public:
 		U32				mUsage;
 		LLJoint::JointPriority	mPriority;
 
-		void update(LLJointState* joint_state, F32 time, F32 duration);
+		// <FS:Perf>
+		//void update(LLJointState* joint_state, F32 time, F32 duration);
+		void update(LLJointState* joint_state, F32 time, F32 duration, KeyCursors& cursors);
+		// </FS:Perf>
 	};
 	
 	//-------------------------------------------------------------------------
@@ -424,6 +470,7 @@ public:
 protected:
 	JointMotionList*				mJointMotionList;
 	std::vector<LLPointer<LLJointState> > mJointStates;
+	std::vector<KeyCursors>			mKeyCursors; // <FS:Perf/> Parallel to mJointStates
 	LLJoint*						mPelvisp;
 	LLCharacter*					mCharacter;
 	typedef std::list<JointConstraint*>	constraint_list_t;
@@ -140,6 +140,13 @@ LLMotionController::LLMotionController()
 	  mTimeStep(0.f),
 	  mTimeStepCount(0),
 	  mLastInterp(0.f),
+	  mForceUpdate(false), // <FS:Perf/> Parallel motion evaluation
+	  // <FS:Perf> Animation LOD
+	  mLODPeriod(1),
+	  mLODFrame(0),
+	  mLODPoseCached(false),
+	  mBaseJointsOnly(false),
+	  // </FS:Perf>
 	  mIsSelf(FALSE),
 	  mLastCountAfterPurge(0)
 {
@@ -182,6 +189,11 @@ void LLMotionController::deleteAllMotions()
 	// up the mDeprecatedMotions list as well.
 	for_each(mDeprecatedMotions.begin(), mDeprecatedMotions.end(), DeletePointer());
 	mDeprecatedMotions.clear();
+
+	// <FS:Perf> Parallel motion evaluation
+	mPendingStopRequests.clear();
+	mPendingDeactivations.clear();
+	// </FS:Perf>
 }
 
 //-----------------------------------------------------------------------------
@@ -510,7 +522,10 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
 	if (motionp->isStopped() && mAnimTime > motionp->getStopTime() + motionp->getEaseOutDuration())
 	{
-		deactivateMotionInstance(motionp);
+		// <FS:Perf> Parallel motion evaluation
+		//deactivateMotionInstance(motionp);
+		mPendingDeactivations.push_back(motionp);
+		// </FS:Perf>
 	}
 	else if (motionp->isStopped() && mAnimTime > motionp->getStopTime())
 	{
@@ -527,7 +542,10 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
 		// this will only be called when an animation stops itself (runs out of time)
 		if (mLastTime <= motionp->mSendStopTimestamp)
 		{
-			mCharacter->requestStopMotion( motionp );
+			// <FS:Perf> Parallel motion evaluation
+			//mCharacter->requestStopMotion( motionp );
+			mPendingStopRequests.push_back(motionp);
+			// </FS:Perf>
 			stopMotionInstance(motionp, FALSE);
 		}
 	}
@@ -629,7 +647,10 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				// this will only be called when an animation stops itself (runs out of time)
 				if (mLastTime <= motionp->mSendStopTimestamp)
 				{
-					mCharacter->requestStopMotion( motionp );
+					// <FS:Perf> Parallel motion evaluation
+					//mCharacter->requestStopMotion( motionp );
+					mPendingStopRequests.push_back(motionp);
+					// </FS:Perf>
 					stopMotionInstance(motionp, FALSE);
 				}
 			}
@@ -639,7 +660,10 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				if (motionp->isStopped() && mAnimTime > motionp->getStopTime() + motionp->getEaseOutDuration())
 				{
 					posep->setWeight(0.f);
-					deactivateMotionInstance(motionp);
+					// <FS:Perf> Parallel motion evaluation
+					//deactivateMotionInstance(motionp);
+					mPendingDeactivations.push_back(motionp);
+					// </FS:Perf>
 				}
 				continue;
 			}
@@ -666,7 +690,10 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 			else
 			{
 				posep->setWeight(0.f);
-				deactivateMotionInstance(motionp);
+				// <FS:Perf> Parallel motion evaluation
+				//deactivateMotionInstance(motionp);
+				mPendingDeactivations.push_back(motionp);
+				// </FS:Perf>
 				continue;
 			}
 		}
@@ -710,7 +737,10 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				// this will only be called when an animation stops itself (runs out of time)
 				if (mLastTime <= motionp->mSendStopTimestamp)
 				{
-					mCharacter->requestStopMotion( motionp );
+					// <FS:Perf> Parallel motion evaluation
+					//mCharacter->requestStopMotion( motionp );
+					mPendingStopRequests.push_back(motionp);
+					// </FS:Perf>
 					stopMotionInstance(motionp, FALSE);
 				}
 			}
@@ -756,7 +786,10 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				// animation has stopped itself due to internal logic
 				// propagate this to the network
 				// as not all viewers are guaranteed to have access to the same logic
-				mCharacter->requestStopMotion( motionp );
+				// <FS:Perf> Parallel motion evaluation
+				//mCharacter->requestStopMotion( motionp );
+				mPendingStopRequests.push_back(motionp);
+				// </FS:Perf>
 				stopMotionInstance(motionp, FALSE);
 			}
 
@@ -821,6 +854,22 @@ void LLMotionController::updateLoadingMotions()
 void LLMotionController::updateMotions(bool force_update)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+	// <FS:Perf> Parallel motion evaluation
+	if (prepareMotionUpdate(force_update))
+	{
+		evaluateMotions();
+		commitMotionUpdate();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// prepareMotionUpdate()
+//-----------------------------------------------------------------------------
+BOOL LLMotionController::prepareMotionUpdate(bool force_update)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+	mForceUpdate = force_update;
+	// </FS:Perf>
     // SL-763: "Distant animated objects run at super fast speed"
     // The use_quantum optimization or possibly the associated code in setTimeStamp()
     // does not work as implemented.
@@ -861,7 +910,10 @@ void LLMotionController::updateMotions(bool force_update)
 
 				updateLoadingMotions();
 				
-				return;
+				// <FS:Perf> Parallel motion evaluation
+				//return;
+				return FALSE;
+				// </FS:Perf>
 			}
 			
 			// is calculating a new keyframe pose, make sure the last one gets applied
@@ -875,14 +927,60 @@ void LLMotionController::updateMotions(bool force_update)
 		else
 		{
 			mAnimTime = update_time;
+
+			// <FS:Perf> Animation LOD
+			if (mLODPeriod > 1 && !force_update && mHasRunOnce)
+			{
+				if (mLODPoseCached && ++mLODFrame < mLODPeriod)
+				{
+					// cover the rest of the way to the cached pose in even steps,
+					// arriving there on the next evaluated frame
+					mPoseBlender.interpolate(1.f / (F32)(mLODPeriod - mLODFrame + 1));
+					updateLoadingMotions();
+					return FALSE;
+				}
+
+				// is calculating a new pose, make sure the last one gets applied
+				if (mLODPoseCached)
+				{
+					mPoseBlender.interpolate(1.f);
+					clearBlenders();
+				}
+				mLODFrame = 0;
+				mLODPoseCached = true;
+			}
+			else if (mLODPoseCached)
+			{
+				// back to full rate
+				mPoseBlender.interpolate(1.f);
+				clearBlenders();
+				mLODPoseCached = false;
+			}
+			// </FS:Perf>
 		}
 	}
 
 	updateLoadingMotions();
 	
+	// <FS:Perf> Parallel motion evaluation
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::evaluateMotions()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+	BOOL use_quantum = (mTimeStep != 0.f);
+	// </FS:Perf>
+
 	resetJointSignatures();
 
-	if (mPaused && !force_update)
+	// <FS:Perf> Parallel motion evaluation
+	//if (mPaused && !force_update)
+	if (mPaused && !mForceUpdate)
+	// </FS:Perf>
 	{
 		updateIdleActiveMotions();
 	}
@@ -896,7 +994,10 @@ void LLMotionController::updateMotions(bool force_update)
 		// update all regular motions
 		updateRegularMotions();
 		
-		if (use_quantum)
+		// <FS:Perf> Animation LOD
+		//if (use_quantum)
+		if (use_quantum || mLODPoseCached)
+		// </FS:Perf>
 		{
 			mPoseBlender.blendAndCache(TRUE);
 		}
@@ -905,11 +1006,51 @@ void LLMotionController::updateMotions(bool force_update)
 			mPoseBlender.blendAndApply();
 		}
 	}
+	// <FS:Perf> Parallel motion evaluation
+}
+
+//-----------------------------------------------------------------------------
+// commitMotionUpdate()
+//-----------------------------------------------------------------------------
+void LLMotionController::commitMotionUpdate()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+	// Stop requests first: a deactivation may delete a deprecated motion
+	for (LLMotion* motionp : mPendingStopRequests)
+	{
+		mCharacter->requestStopMotion(motionp);
+	}
+	mPendingStopRequests.clear();
+
+	for (LLMotion* motionp : mPendingDeactivations)
+	{
+		deactivateMotionInstance(motionp);
+	}
+	mPendingDeactivations.clear();
+	// </FS:Perf>
 
 	mHasRunOnce = TRUE;
 //	LL_INFOS() << "Motion controller time " << motionTimer.getElapsedTimeF32() << LL_ENDL;
 }
 
+// <FS:Perf> Animation LOD
+//-----------------------------------------------------------------------------
+// setAnimationLOD()
+//-----------------------------------------------------------------------------
+void LLMotionController::setAnimationLOD(U32 period, bool base_joints_only)
+{
+	period = llmax(period, 1U);
+	if (period != mLODPeriod)
+	{
+		// evaluate on the next update, so that a finer LOD takes effect right away
+		mLODFrame = period;
+		mLODPeriod = period;
+	}
+	mBaseJointsOnly = base_joints_only;
+	mPoseBlender.setBaseJointsOnly(base_joints_only);
+}
+// </FS:Perf>
+
 //-----------------------------------------------------------------------------
 // updateMotionsMinimal()
 // minimal update (e.g. while hidden)
@@ -926,6 +1067,17 @@ void LLMotionController::updateMotionsMinimal()
 
 	deactivateStoppedMotions();
 
+	// <FS:Perf> Animation LOD
+	if (mLODPoseCached)
+	{
+		// the cached pose is stale by the time the character is updated again,
+		// so evaluate on the next update instead of blending towards it
+		clearBlenders();
+		mLODPoseCached = false;
+		mLODFrame = mLODPeriod;
+	}
+	// </FS:Perf>
+
 	mHasRunOnce = TRUE;
 }
 
@@ -33,6 +33,7 @@
 #include <string>
 #include <map>
 #include <deque>
+#include <vector> // <FS:Perf/> Deferred motion side effects
 
 #include "llmotion.h"
 #include "llpose.h"
@@ -132,6 +133,30 @@ public:
 	// deactivates terminated motions`
 	void updateMotions(bool force_update = false);
 
+	// <FS:Perf> Parallel motion evaluation
+	// updateMotions() in three steps, so that the poses of many characters
+	// can be evaluated at the same time on worker threads.
+	// prepareMotionUpdate() and commitMotionUpdate() run on the main thread.
+	// prepareMotionUpdate() advances the animation clock and finishes
+	// loading motions, and returns FALSE when the pose already is up to date,
+	// in which case the other two are skipped. evaluateMotions() updates the
+	// motions and blends them into the joints of this character only. Stop
+	// requests and deactivations it comes across are queued, and
+	// commitMotionUpdate() carries them out.
+	BOOL prepareMotionUpdate(bool force_update);
+	void evaluateMotions();
+	void commitMotionUpdate();
+	// </FS:Perf>
+
+	// <FS:Perf> Animation LOD
+	// Evaluate the motions only once every period frames, and blend the
+	// joints towards the last evaluated pose in the frames between. With
+	// base_joints_only, extended (Bento) joints are not animated at all.
+	void setAnimationLOD(U32 period, bool base_joints_only);
+	U32 getLODPeriod() const { return mLODPeriod; }
+	bool getBaseJointsOnly() const { return mBaseJointsOnly; }
+	// </FS:Perf>
+
 	// minimal update (e.g. while hidden)
 	void updateMotionsMinimal();
 
@@ -232,6 +257,19 @@ protected:
 	F32					mLastInterp;
 
 	U8					mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
+
+	// <FS:Perf> Parallel motion evaluation
+	bool				mForceUpdate;
+	std::vector<LLMotion*>	mPendingStopRequests;
+	std::vector<LLMotion*>	mPendingDeactivations;
+	// </FS:Perf>
+
+	// <FS:Perf> Animation LOD
+	U32					mLODPeriod;
+	U32					mLODFrame;				// frames since the motions were last evaluated
+	bool				mLODPoseCached;			// the joints are being blended towards a cached pose
+	bool				mBaseJointsOnly;
+	// </FS:Perf>
 private:
 	U32					mLastCountAfterPurge; //for logging and debugging purposes
 };
@@ -455,7 +455,8 @@ void LLJointStateBlender::resetCachedJoint()
 //-----------------------------------------------------------------------------
 
 LLPoseBlender::LLPoseBlender()
-	: mNextPoseSlot(0)
+	: mNextPoseSlot(0),
+	  mBaseJointsOnly(false) // <FS:Perf/> Animation LOD
 {
 }
 
@@ -475,6 +476,12 @@ BOOL LLPoseBlender::addMotion(LLMotion* motion)
 	for(LLJointState* jsp = pose->getFirstJointState(); jsp; jsp = pose->getNextJointState())
 	{
 		LLJoint *jointp = jsp->getJoint();
+		// <FS:Perf> Animation LOD
+		if (mBaseJointsOnly && jointp && jointp->getSupport() == LLJoint::SUPPORT_EXTENDED)
+		{
+			continue;
+		}
+		// </FS:Perf>
 		LLJointStateBlender* joint_blender;
 		if (mJointStateBlenderPool.find(jointp) == mJointStateBlenderPool.end())
 		{
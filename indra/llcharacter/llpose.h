@@ -113,6 +113,7 @@ protected:
 
 	S32			mNextPoseSlot;
 	LLPose		mBlendedPose;
+	bool		mBaseJointsOnly; // <FS:Perf/> Animation LOD
 public:
 	// Constructor
 	LLPoseBlender();
@@ -135,6 +136,11 @@ public:
 	void interpolate(F32 u);
 
 	LLPose* getBlendedPose() { return &mBlendedPose; }
+
+	// <FS:Perf> Animation LOD
+	// leave joints outside the base skeleton out of the blend
+	void setBaseJointsOnly(bool base_joints_only) { mBaseJointsOnly = base_joints_only; }
+	// </FS:Perf>
 };
 
 #endif // LL_LLPOSE_H
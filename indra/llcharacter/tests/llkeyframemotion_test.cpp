@@ -0,0 +1,368 @@
+/**
+ * @file llkeyframemotion_test.cpp
+ * @brief Checks keyframe curve lookups against the map based lookup they
+ *        replaced, plus a playback benchmark on a synthetic skeleton.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llkeyframemotion.h"
+#include "../lljoint.h"
+#include "../lljointstate.h"
+
+#include "llstring.h"
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    typedef LLKeyframeMotion::RotationKey RotationKey;
+    typedef LLKeyframeMotion::PositionKey PositionKey;
+    typedef std::map<F32, LLQuaternion> rotation_map_t;
+    typedef std::map<F32, LLVector3> position_map_t;
+
+    // Keys spread over duration at roughly keys_per_second, with a little
+    // jitter so that they are not evenly spaced
+    std::vector<RotationKey> random_rotation_keys(F32 duration, F32 keys_per_second, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<F32> angle(-F_PI, F_PI);
+        std::uniform_real_distribution<F32> jitter(0.f, 0.5f);
+        const S32 count = llmax(2, (S32)(duration * keys_per_second));
+        std::vector<RotationKey> keys;
+        for (S32 i = 0; i < count; ++i)
+        {
+            F32 time = llmin(duration, ((F32)i + jitter(rng)) / keys_per_second);
+            LLQuaternion rot;
+            rot.setEulerAngles(angle(rng), angle(rng), angle(rng));
+            keys.push_back(RotationKey(time, rot));
+        }
+        return keys;
+    }
+
+    std::vector<PositionKey> random_position_keys(F32 duration, F32 keys_per_second, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<F32> offset(-1.f, 1.f);
+        std::uniform_real_distribution<F32> jitter(0.f, 0.5f);
+        const S32 count = llmax(2, (S32)(duration * keys_per_second));
+        std::vector<PositionKey> keys;
+        for (S32 i = 0; i < count; ++i)
+        {
+            F32 time = llmin(duration, ((F32)i + jitter(rng)) / keys_per_second);
+            keys.push_back(PositionKey(time, LLVector3(offset(rng), offset(rng), offset(rng))));
+        }
+        return keys;
+    }
+
+    // The lookup LLKeyframeMotion did before its curves were flattened
+    template <class MAP>
+    typename MAP::mapped_type map_value(const MAP& keys,
+                                        F32 time,
+                                        const std::function<typename MAP::mapped_type(F32, const typename MAP::mapped_type&, const typename MAP::mapped_type&)>& interp)
+    {
+        typename MAP::const_iterator right = keys.lower_bound(time);
+        if (right == keys.end())
+        {
+            --right;
+            return right->second;
+        }
+        if (right == keys.begin() || right->first == time)
+        {
+            return right->second;
+        }
+        typename MAP::const_iterator left = right; --left;
+        F32 u = (time - left->first) / (right->first - left->first);
+        return interp(u, left->second, right->second);
+    }
+
+    LLQuaternion map_rotation(const rotation_map_t& keys, F32 time)
+    {
+        return map_value(keys, time, [](F32 u, const LLQuaternion& a, const LLQuaternion& b) { return nlerp(u, a, b); });
+    }
+
+    LLVector3 map_position(const position_map_t& keys, F32 time)
+    {
+        return map_value(keys, time, [](F32 u, const LLVector3& a, const LLVector3& b) { return lerp(a, b, u); });
+    }
+
+    // Microseconds per call of func, best of a few runs
+    F64 time_usec(const std::function<void()>& func, S32 repeat)
+    {
+        F64 best = 0.0;
+        for (S32 run = 0; run < 3; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (S32 i = 0; i < repeat; ++i)
+            {
+                func();
+            }
+            F64 usec = std::chrono::duration<F64, std::micro>(std::chrono::steady_clock::now() - start).count() / repeat;
+            best = (run == 0 || usec < best) ? usec : best;
+        }
+        return best;
+    }
+}
+
+namespace tut
+{
+    struct llkeyframemotion_data
+    {
+        llkeyframemotion_data() : mRNG(1234) {}
+
+        std::mt19937 mRNG;
+    };
+    typedef test_group<llkeyframemotion_data> llkeyframemotion_group_t;
+    typedef llkeyframemotion_group_t::object llkeyframemotion_object_t;
+    tut::llkeyframemotion_group_t llkeyframemotion_group("LLKeyframeMotion");
+
+    template<> template<>
+    void llkeyframemotion_object_t::test<1>()
+    {
+        set_test_name("keys are sorted and the last duplicate wins");
+
+        std::vector<PositionKey> keys;
+        keys.push_back(PositionKey(2.f, LLVector3(2.f, 0.f, 0.f)));
+        keys.push_back(PositionKey(0.f, LLVector3(0.f, 0.f, 0.f)));
+        keys.push_back(PositionKey(1.f, LLVector3(1.f, 0.f, 0.f)));
+        keys.push_back(PositionKey(2.f, LLVector3(3.f, 0.f, 0.f)));
+
+        LLKeyframeMotion::PositionCurve curve;
+        curve.setKeys(keys);
+        ensure_equals("key count", curve.mKeyTimes.size(), (size_t)3);
+        ensure_equals("first time", curve.mKeyTimes[0], 0.f);
+        ensure_equals("second time", curve.mKeyTimes[1], 1.f);
+        ensure_equals("third time", curve.mKeyTimes[2], 2.f);
+        ensure_equals("duplicate replaced", curve.mKeyValues[2].mV[VX], 3.f);
+        ensure_equals("value between keys", curve.getValue(0.5f, 2.f).mV[VX], 0.5f);
+        ensure_equals("value past the end", curve.getValue(5.f, 2.f).mV[VX], 3.f);
+    }
+
+    template<> template<>
+    void llkeyframemotion_object_t::test<2>()
+    {
+        set_test_name("cursor lookups match the map lookup");
+
+        const F32 duration = 10.f;
+        std::vector<RotationKey> rot_keys = random_rotation_keys(duration, 24.f, mRNG);
+        std::vector<PositionKey> pos_keys = random_position_keys(duration, 24.f, mRNG);
+        rotation_map_t rot_map;
+        for (const RotationKey& key : rot_keys)
+        {
+            rot_map[key.mTime] = key.mRotation;
+        }
+        position_map_t pos_map;
+        for (const PositionKey& key : pos_keys)
+        {
+            pos_map[key.mTime] = key.mPosition;
+        }
+
+        LLKeyframeMotion::RotationCurve rot_curve;
+        rot_curve.setKeys(rot_keys);
+        LLKeyframeMotion::PositionCurve pos_curve;
+        pos_curve.setKeys(pos_keys);
+
+        // Forward at frame rate, looping, then random seeks, plus the keys
+        // themselves and times outside the curve
+        std::vector<F32> times;
+        for (F32 time = -0.5f; time < 3.f * duration; time += 1.f / 45.f)
+        {
+            times.push_back(fmodf(llmax(time, 0.f), duration + 0.25f));
+        }
+        std::uniform_real_distribution<F32> seek(-1.f, duration + 1.f);
+        for (S32 i = 0; i < 500; ++i)
+        {
+            times.push_back(seek(mRNG));
+        }
+        for (F32 key_time : rot_curve.mKeyTimes)
+        {
+            times.push_back(key_time);
+        }
+
+        U32 rot_cursor = 0;
+        U32 pos_cursor = 0;
+        for (F32 time : times)
+        {
+            ensure("rotation at " + std::to_string(time),
+                   rot_curve.getValue(time, duration, rot_cursor) == map_rotation(rot_map, time));
+            ensure("position at " + std::to_string(time),
+                   pos_curve.getValue(time, duration, pos_cursor) == map_position(pos_map, time));
+        }
+    }
+
+    // Not a regression test: a dance club's worth of avatars, each playing
+    // two animations on a 30 joint skeleton, timed per frame. It only runs
+    // with LL_KEYFRAME_BENCHMARK set.
+    template<> template<>
+    void llkeyframemotion_object_t::test<3>()
+    {
+        set_test_name("animation playback speed");
+        if (LLStringUtil::getenv("LL_KEYFRAME_BENCHMARK").empty())
+        {
+            skip("set LL_KEYFRAME_BENCHMARK to run the benchmark");
+        }
+
+        const S32 NUM_AVATARS = 60;
+        const S32 ANIMS_PER_AVATAR = 2;
+        const S32 NUM_JOINTS = 30;
+        const F32 DURATION = 12.f;
+        const F32 KEYS_PER_SECOND = 30.f;
+        const S32 FRAMES = 90;
+        const F32 FRAME_TIME = 1.f / 45.f;
+
+        // One shared key list per animation, as LLKeyframeDataCache has it
+        std::vector<std::unique_ptr<LLKeyframeMotion::JointMotionList>> anims;
+        std::vector<std::vector<rotation_map_t>> rot_maps(ANIMS_PER_AVATAR);
+        std::vector<std::vector<position_map_t>> pos_maps(ANIMS_PER_AVATAR);
+        for (S32 a = 0; a < ANIMS_PER_AVATAR; ++a)
+        {
+            anims.emplace_back(new LLKeyframeMotion::JointMotionList);
+            anims.back()->mDuration = DURATION;
+            for (S32 j = 0; j < NUM_JOINTS; ++j)
+            {
+                LLKeyframeMotion::JointMotion* joint_motion = new LLKeyframeMotion::JointMotion;
+                std::vector<RotationKey> rot_keys = random_rotation_keys(DURATION, KEYS_PER_SECOND, mRNG);
+                std::vector<PositionKey> pos_keys = random_position_keys(DURATION, KEYS_PER_SECOND, mRNG);
+                rot_maps[a].emplace_back();
+                pos_maps[a].emplace_back();
+                for (const RotationKey& key : rot_keys)
+                {
+                    rot_maps[a].back()[key.mTime] = key.mRotation;
+                }
+                for (const PositionKey& key : pos_keys)
+                {
+                    pos_maps[a].back()[key.mTime] = key.mPosition;
+                }
+                joint_motion->mRotationCurve.mNumKeys = (S32)rot_keys.size();
+                joint_motion->mRotationCurve.setKeys(rot_keys);
+                joint_motion->mPositionCurve.mNumKeys = (S32)pos_keys.size();
+                joint_motion->mPositionCurve.setKeys(pos_keys);
+                anims.back()->mJointMotionArray.push_back(joint_motion);
+            }
+        }
+
+        // Per avatar skeleton, per playing animation joint states and cursors
+        struct Playing
+        {
+            LLKeyframeMotion::JointMotionList* mAnim;
+            S32 mAnimIndex;
+            F32 mStartOffset;
+            std::vector<LLPointer<LLJointState>> mJointStates;
+            std::vector<LLKeyframeMotion::KeyCursors> mCursors;
+        };
+        std::vector<std::unique_ptr<LLJoint>> joints;
+        std::vector<Playing> playing;
+        std::uniform_real_distribution<F32> offset(0.f, DURATION);
+        for (S32 av = 0; av < NUM_AVATARS; ++av)
+        {
+            const size_t first_joint = joints.size();
+            for (S32 j = 0; j < NUM_JOINTS; ++j)
+            {
+                joints.emplace_back(new LLJoint);
+            }
+            for (S32 a = 0; a < ANIMS_PER_AVATAR; ++a)
+            {
+                Playing play;
+                play.mAnim = anims[a].get();
+                play.mAnimIndex = a;
+                play.mStartOffset = offset(mRNG);
+                for (S32 j = 0; j < NUM_JOINTS; ++j)
+                {
+                    play.mJointStates.push_back(new LLJointState(joints[first_joint + j].get()));
+                    play.mJointStates.back()->setUsage(LLJointState::ROT | LLJointState::POS);
+                }
+                play.mCursors.resize(NUM_JOINTS);
+                playing.push_back(play);
+            }
+        }
+
+        F32 sink = 0.f;
+        S32 frame = 0;
+        auto play_time = [&](const Playing& play)
+            {
+                return fmodf(play.mStartOffset + (F32)frame * FRAME_TIME, DURATION);
+            };
+
+        F64 map_usec = time_usec([&]()
+            {
+                for (Playing& play : playing)
+                {
+                    const F32 time = play_time(play);
+                    for (S32 j = 0; j < NUM_JOINTS; ++j)
+                    {
+                        play.mJointStates[j]->setRotation(map_rotation(rot_maps[play.mAnimIndex][j], time));
+                        play.mJointStates[j]->setPosition(map_position(pos_maps[play.mAnimIndex][j], time));
+                    }
+                }
+                ++frame;
+            }, FRAMES);
+
+        frame = 0;
+        F64 search_usec = time_usec([&]()
+            {
+                for (Playing& play : playing)
+                {
+                    const F32 time = play_time(play);
+                    for (S32 j = 0; j < NUM_JOINTS; ++j)
+                    {
+                        // A fresh cursor every time searches the whole curve
+                        LLKeyframeMotion::KeyCursors cursors;
+                        play.mAnim->getJointMotion(j)->update(play.mJointStates[j], time, DURATION, cursors);
+                    }
+                }
+                ++frame;
+            }, FRAMES);
+
+        frame = 0;
+        F64 cursor_usec = time_usec([&]()
+            {
+                for (Playing& play : playing)
+                {
+                    const F32 time = play_time(play);
+                    for (S32 j = 0; j < NUM_JOINTS; ++j)
+                    {
+                        play.mAnim->getJointMotion(j)->update(play.mJointStates[j], time, DURATION, play.mCursors[j]);
+                    }
+                }
+                ++frame;
+            }, FRAMES);
+
+        for (const Playing& play : playing)
+        {
+            sink += play.mJointStates[0]->getRotation().mQ[VW];
+        }
+
+        std::cout << "\nLLKeyframeMotion, " << NUM_AVATARS << " avatars x " << ANIMS_PER_AVATAR
+                  << " animations x " << NUM_JOINTS << " joints, microseconds per frame: map "
+                  << (S32)map_usec << ", sorted search " << (S32)search_usec
+                  << ", sorted with cursor " << (S32)cursor_usec << std::endl;
+        ensure("played", llfinite(sink));
+    }
+}
@@ -0,0 +1,252 @@
+/**
+ * @file llmotioncontroller_test.cpp
+ * @brief Checks how the animation LOD spreads a cached pose over the
+ *        frames that are not evaluated.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmotioncontroller.h"
+#include "../llcharacter.h"
+#include "../lljoint.h"
+#include "../lljointstate.h"
+#include "v3dmath.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const LLUUID TARGET_MOTION_ID("5e3f1a2c-8d47-4b6e-9c01-7a2b3c4d5e6f");
+
+    // Holds one joint at whatever position the test asks for, at full weight,
+    // and counts how often it is evaluated
+    class LLTargetMotion : public LLMotion
+    {
+    public:
+        LLTargetMotion(const LLUUID& id) : LLMotion(id), mJointState(new LLJointState) {}
+
+        static LLMotion* create(const LLUUID& id) { return new LLTargetMotion(id); }
+
+        virtual BOOL getLoop() { return TRUE; }
+        virtual F32 getDuration() { return 0.f; }
+        virtual F32 getEaseInDuration() { return 0.f; }
+        virtual F32 getEaseOutDuration() { return 0.f; }
+        virtual LLJoint::JointPriority getPriority() { return LLJoint::HIGH_PRIORITY; }
+        virtual LLMotionBlendType getBlendType() { return NORMAL_BLEND; }
+        virtual F32 getMinPixelArea() { return 0.f; }
+
+        virtual LLMotionInitStatus onInitialize(LLCharacter* character)
+        {
+            mJointState->setJoint(character->getCharacterJoint(0));
+            mJointState->setUsage(LLJointState::POS);
+            addJointState(mJointState);
+            return STATUS_SUCCESS;
+        }
+        virtual BOOL onActivate() { return TRUE; }
+        virtual BOOL onUpdate(F32 time, U8* joint_mask)
+        {
+            mJointState->setPosition(sTarget);
+            ++sUpdates;
+            return TRUE;
+        }
+        virtual void onDeactivate() {}
+
+        static LLVector3 sTarget;
+        static S32 sUpdates;
+
+    private:
+        LLPointer<LLJointState> mJointState;
+    };
+
+    LLVector3 LLTargetMotion::sTarget;
+    S32 LLTargetMotion::sUpdates = 0;
+
+    // A character with a single joint
+    class LLOneJointCharacter : public LLCharacter
+    {
+    public:
+        LLOneJointCharacter() : mJoint(0) {}
+
+        virtual const char* getAnimationPrefix() { return "test"; }
+        virtual LLJoint* getRootJoint() { return &mJoint; }
+        virtual LLVector3 getCharacterPosition() { return LLVector3::zero; }
+        virtual LLQuaternion getCharacterRotation() { return LLQuaternion::DEFAULT; }
+        virtual LLVector3 getCharacterVelocity() { return LLVector3::zero; }
+        virtual LLVector3 getCharacterAngularVelocity() { return LLVector3::zero; }
+        virtual void getGround(const LLVector3& inPos, LLVector3& outPos, LLVector3& outNorm) { outPos = inPos; outNorm = LLVector3::z_axis; }
+        virtual LLJoint* getCharacterJoint(U32 i) { return i == 0 ? &mJoint : NULL; }
+        virtual F32 getTimeDilation() { return 1.f; }
+        virtual F32 getPixelArea() const { return 1000.f; }
+        virtual LLPolyMesh* getHeadMesh() { return NULL; }
+        virtual LLPolyMesh* getUpperBodyMesh() { return NULL; }
+        virtual LLVector3d getPosGlobalFromAgent(const LLVector3& position) { return LLVector3d(position); }
+        virtual LLVector3 getPosAgentFromGlobal(const LLVector3d& position) { return LLVector3(position); }
+        virtual void addDebugText(const std::string& text) {}
+        virtual const LLUUID& getID() const { return mID; }
+
+        LLJoint mJoint;
+        LLUUID mID;
+    };
+}
+
+namespace tut
+{
+    struct llmotioncontroller_data
+    {
+        llmotioncontroller_data()
+        {
+            mCharacter.registerMotion(TARGET_MOTION_ID, LLTargetMotion::create);
+            LLTargetMotion::sTarget.clearVec();
+            LLTargetMotion::sUpdates = 0;
+        }
+
+        LLMotionController& controller() { return mCharacter.getMotionController(); }
+        F32 jointX() { return mCharacter.mJoint.getPosition().mV[VX]; }
+
+        // Starts the motion and runs the first update, which is never skipped
+        void start(U32 period)
+        {
+            controller().setAnimationLOD(period, false);
+            ensure("motion started", mCharacter.startMotion(TARGET_MOTION_ID));
+            controller().updateMotions();
+            ensure_equals("first update evaluates", LLTargetMotion::sUpdates, 1);
+            ensure_equals("first update applies", jointX(), 0.f);
+        }
+
+        // Moves the target, then runs one update
+        void update(F32 target_x)
+        {
+            LLTargetMotion::sTarget.mV[VX] = target_x;
+            controller().updateMotions();
+        }
+
+        LLOneJointCharacter mCharacter;
+    };
+    typedef test_group<llmotioncontroller_data> llmotioncontroller_group_t;
+    typedef llmotioncontroller_group_t::object llmotioncontroller_object_t;
+    tut::llmotioncontroller_group_t llmotioncontroller_group("LLMotionController");
+
+    template<> template<>
+    void llmotioncontroller_object_t::test<1>()
+    {
+        set_test_name("a cached pose is reached in even steps");
+
+        const U32 period = 4;
+        start(period);
+
+        // evaluated and cached, not applied yet
+        update(1.f);
+        ensure_equals("evaluated", LLTargetMotion::sUpdates, 2);
+        ensure_equals("cached, not applied", jointX(), 0.f);
+
+        // then 1/4, 1/3 and 1/2 of what is left: a quarter of the way per frame
+        for (U32 frame = 1; frame < period; ++frame)
+        {
+            update(9.f);
+            ensure_equals("skipped", LLTargetMotion::sUpdates, 2);
+            ensure_approximately_equals("even step", jointX(), (F32)frame / (F32)period, 16);
+        }
+
+        // the next evaluation lands on the cached pose and caches the next one
+        update(2.f);
+        ensure_equals("evaluated again", LLTargetMotion::sUpdates, 3);
+        ensure_approximately_equals("cached pose reached", jointX(), 1.f, 16);
+        update(9.f);
+        ensure_approximately_equals("towards the next pose", jointX(), 1.25f, 16);
+    }
+
+    template<> template<>
+    void llmotioncontroller_object_t::test<2>()
+    {
+        set_test_name("switching between full rate and LOD");
+
+        start(4);
+        update(1.f);
+        update(9.f);
+        ensure_approximately_equals("on the way", jointX(), 0.25f, 16);
+
+        // back to full rate: every update evaluates and applies
+        controller().setAnimationLOD(1, false);
+        update(3.f);
+        ensure_equals("evaluated at full rate", LLTargetMotion::sUpdates, 3);
+        ensure_approximately_equals("applied right away", jointX(), 3.f, 16);
+        update(4.f);
+        ensure_equals("evaluated every update", LLTargetMotion::sUpdates, 4);
+        ensure_approximately_equals("applied every update", jointX(), 4.f, 16);
+
+        // and to LOD again
+        controller().setAnimationLOD(3, false);
+        update(7.f);
+        ensure_equals("evaluated into the cache", LLTargetMotion::sUpdates, 5);
+        ensure_approximately_equals("held", jointX(), 4.f, 16);
+        update(9.f);
+        ensure_equals("skipped at LOD", LLTargetMotion::sUpdates, 5);
+        ensure_approximately_equals("a third of the way", jointX(), 5.f, 16);
+    }
+
+    template<> template<>
+    void llmotioncontroller_object_t::test<3>()
+    {
+        set_test_name("a period change evaluates on the next update");
+
+        start(8);
+        update(1.f);
+        update(9.f);
+        ensure_equals("skipped", LLTargetMotion::sUpdates, 2);
+        ensure_approximately_equals("an eighth of the way", jointX(), 0.125f, 16);
+
+        // a finer LOD doesn't wait out the rest of the coarse period
+        controller().setAnimationLOD(2, false);
+        update(3.f);
+        ensure_equals("evaluated after the change", LLTargetMotion::sUpdates, 3);
+        ensure_approximately_equals("cached pose applied", jointX(), 1.f, 16);
+        update(9.f);
+        ensure_equals("skipped at the new period", LLTargetMotion::sUpdates, 3);
+        ensure_approximately_equals("half of the way", jointX(), 2.f, 16);
+    }
+
+    template<> template<>
+    void llmotioncontroller_object_t::test<4>()
+    {
+        set_test_name("no stale pose after minimal updates");
+
+        start(4);
+        update(1.f);
+        update(9.f);
+        ensure_approximately_equals("on the way", jointX(), 0.25f, 16);
+
+        // hidden for a while
+        controller().updateMotionsMinimal();
+        controller().updateMotionsMinimal();
+
+        // the pose cached before is dropped, not blended towards
+        update(5.f);
+        ensure_equals("evaluated when seen again", LLTargetMotion::sUpdates, 3);
+        ensure_approximately_equals("not moved to the stale pose", jointX(), 0.25f, 16);
+        update(9.f);
+        ensure_equals("skipped", LLTargetMotion::sUpdates, 3);
+        ensure_approximately_equals("towards the fresh pose", jointX(), 1.4375f, 16);
+    }
+}
@@ -46,6 +46,8 @@ public:
 	T* append(S32 N);
 	T& operator[](int idx);
 	const T& operator[](int idx) const;
+	// <FS:Perf/> Exchange buffers without copying elements
+	void swap(LLAlignedArray& other);
 };
 
 template <class T, U32 alignment>
@@ -141,5 +143,15 @@ T* LLAlignedArray<T, alignment>::append(S32 N)
 	return &((*this)[sz]);
 }
 
+// <FS:Perf>
+template <class T, U32 alignment>
+void LLAlignedArray<T, alignment>::swap(LLAlignedArray& other)
+{
+	std::swap(mArray, other.mArray);
+	std::swap(mElementCount, other.mElementCount);
+	std::swap(mCapacity, other.mCapacity);
+}
+// </FS:Perf>
+
 #endif
 
@@ -35,6 +35,7 @@
 LLFrameTimer LLSmoothInterpolation::sInternalTimer;
 std::vector<LLSmoothInterpolation::Interpolant> LLSmoothInterpolation::sInterpolants;
 F32 LLSmoothInterpolation::sTimeDelta;
+bool LLSmoothInterpolation::sCacheLocked = false; // <FS:Perf/> Parallel motion evaluation
 
 // helper functors
 struct LLSmoothInterpolation::CompareTimeConstants
@@ -95,6 +96,12 @@ F32 LLSmoothInterpolation::getInterpolant(F32SecondsImplicit time_constant, bool
 		{
 			return find_it->mInterpolant;
 		}
+		// <FS:Perf> Parallel motion evaluation
+		else if (sCacheLocked)
+		{
+			return calcInterpolant(time_constant.value());
+		}
+		// </FS:Perf>
 		else
 		{
 			Interpolant interp;
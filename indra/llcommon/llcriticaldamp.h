@@ -44,6 +44,14 @@ public:
 	// ACCESSORS
 	static F32 getInterpolant(F32SecondsImplicit time_constant, bool use_cache = true);
 
+	// <FS:Perf> Parallel motion evaluation
+	// While the cache is locked, getInterpolant() only looks values up in
+	// it and works out the ones it doesn't have without adding them, so
+	// that several threads can call it at once. Lock and unlock it on the
+	// main thread, around the work handed to the other threads.
+	static void lockCache(bool locked) { sCacheLocked = locked; }
+	// </FS:Perf>
+
 	template<typename T> 
 	static T lerp(T a, T b, F32SecondsImplicit time_constant, bool use_cache = true)
 	{
@@ -66,6 +74,7 @@ protected:
 	typedef std::vector<Interpolant> interpolant_vec_t;
 	static interpolant_vec_t 	sInterpolants;
 	static F32					sTimeDelta;
+	static bool					sCacheLocked; // <FS:Perf/> Parallel motion evaluation
 };
 
 typedef LLSmoothInterpolation LLCriticalDamp;
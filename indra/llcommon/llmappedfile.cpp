@@ -0,0 +1,258 @@
+/**
+ * @file llmappedfile.cpp
+ * @brief Cross-platform memory-mapped file.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmappedfile.h"
+#include "llstring.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !LL_WINDOWS
+namespace
+{
+    // Back the first size bytes of the file with real disk blocks. A file
+    // grown with ftruncate() alone is sparse, and storing through a shared
+    // mapping into a hole raises SIGBUS instead of an error once the disk
+    // is full. Returns 0 or an errno value.
+    int allocate_file(int fd, size_t current_size, size_t size)
+    {
+#if LL_DARWIN
+        if (size <= current_size)
+        {
+            return 0;
+        }
+        fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)(size - current_size), 0 };
+        if (fcntl(fd, F_PREALLOCATE, &store) == -1)
+        {
+            return errno;
+        }
+        return ftruncate(fd, (off_t)size) == 0 ? 0 : errno;
+#else
+        // Also fills in holes left in files created before space was reserved
+        size = llmax(size, current_size);
+        return size > 0 ? posix_fallocate(fd, 0, (off_t)size) : 0;
+#endif
+    }
+}
+#endif
+
+LLMappedFile::LLMappedFile()
+:   mData(nullptr),
+    mSize(0),
+    mMode(READ_ONLY),
+#if LL_WINDOWS
+    mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(nullptr)
+#else
+    mFileDescriptor(-1)
+#endif
+{
+}
+
+LLMappedFile::~LLMappedFile()
+{
+    close();
+}
+
+#if LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename, EMode mode, size_t size)
+{
+    close();
+
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    const bool writable = (mode == READ_WRITE);
+    HANDLE file = CreateFileW(utf16filename.c_str(),
+                              writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr,
+                              writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        LL_WARNS("LLMappedFile") << "Unable to open " << filename << " error " << GetLastError() << LL_ENDL;
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    size_t map_size = (size_t)file_size.QuadPart;
+    if (writable && size > map_size)
+    {
+        // CreateFileMapping() grows the file to the requested size
+        map_size = size;
+    }
+    if (map_size == 0)
+    {
+        // Zero length files cannot be mapped
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        (DWORD)((U64)map_size >> 32), (DWORD)(map_size & 0xFFFFFFFF), nullptr);
+    if (!mapping)
+    {
+        LL_WARNS("LLMappedFile") << "Unable to create mapping for " << filename << " error " << GetLastError() << LL_ENDL;
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, map_size);
+    if (!data)
+    {
+        LL_WARNS("LLMappedFile") << "Unable to map " << filename << " error " << GetLastError() << LL_ENDL;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = (U8*)data;
+    mSize = map_size;
+    mMode = mode;
+    mFilename = filename;
+    return true;
+}
+
+void LLMappedFile::close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+    if (mMappingHandle)
+    {
+        CloseHandle((HANDLE)mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle((HANDLE)mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+    mSize = 0;
+    mFilename.clear();
+}
+
+bool LLMappedFile::flush()
+{
+    return mData && FlushViewOfFile(mData, 0);
+}
+
+#else // LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename, EMode mode, size_t size)
+{
+    close();
+
+    const bool writable = (mode == READ_WRITE);
+    int fd = ::open(filename.c_str(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0600);
+    if (fd < 0)
+    {
+        LL_WARNS("LLMappedFile") << "Unable to open " << filename << ": " << strerror(errno) << LL_ENDL;
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t map_size = (size_t)file_stat.st_size;
+    if (writable)
+    {
+        int error = allocate_file(fd, map_size, size);
+        if (error != 0)
+        {
+            LL_WARNS("LLMappedFile") << "Unable to reserve " << llmax(size, map_size) << " bytes for " << filename << ": " << strerror(error) << LL_ENDL;
+            ::close(fd);
+            return false;
+        }
+        map_size = llmax(size, map_size);
+    }
+    if (map_size == 0)
+    {
+        // Zero length files cannot be mapped
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, map_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        LL_WARNS("LLMappedFile") << "Unable to map " << filename << ": " << strerror(errno) << LL_ENDL;
+        ::close(fd);
+        return false;
+    }
+
+    mFileDescriptor = fd;
+    mData = (U8*)data;
+    mSize = map_size;
+    mMode = mode;
+    mFilename = filename;
+    return true;
+}
+
+void LLMappedFile::close()
+{
+    if (mData)
+    {
+        munmap(mData, mSize);
+        mData = nullptr;
+    }
+    if (mFileDescriptor >= 0)
+    {
+        ::close(mFileDescriptor);
+        mFileDescriptor = -1;
+    }
+    mSize = 0;
+    mFilename.clear();
+}
+
+bool LLMappedFile::flush()
+{
+    return mData && msync(mData, mSize, MS_ASYNC) == 0;
+}
+
+#endif // LL_WINDOWS
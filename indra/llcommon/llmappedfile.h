@@ -0,0 +1,96 @@
+/**
+ * @file llmappedfile.h
+ * @brief Cross-platform memory-mapped file.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMAPPEDFILE_H
+#define LL_LLMAPPEDFILE_H
+
+#include <string>
+
+/**
+ * Maps a whole file into the address space of the process. Once mapped,
+ * data() can be read (and, in READ_WRITE mode, written) directly without
+ * any further system calls.
+ *
+ * The object itself is not thread safe, but the mapped memory may be
+ * accessed from any thread for as long as the file stays open.
+ */
+class LL_COMMON_API LLMappedFile
+{
+public:
+    enum EMode
+    {
+        READ_ONLY,
+        READ_WRITE
+    };
+
+    LLMappedFile();
+    ~LLMappedFile();
+
+    LLMappedFile(const LLMappedFile&) = delete;
+    LLMappedFile& operator=(const LLMappedFile&) = delete;
+
+    /**
+     * Map filename into memory.
+     *
+     * In READ_ONLY mode the file must exist and size is ignored: the whole
+     * file is mapped. In READ_WRITE mode the file is created if needed and
+     * grown (never shrunk) to size bytes before being mapped; pass 0 to map
+     * the file at its current size. Disk space for the whole mapping is
+     * reserved up front, so a full disk makes open() fail rather than a
+     * later store through data().
+     *
+     * Returns false, leaving the object closed, on failure.
+     */
+    bool open(const std::string& filename, EMode mode, size_t size = 0);
+
+    // Unmap and close the file. Safe to call when not open.
+    void close();
+
+    // Ask the OS to write dirty pages back to the file (asynchronously).
+    bool flush();
+
+    bool isOpen() const         { return mData != nullptr; }
+    U8* data()                  { return mData; }
+    const U8* data() const      { return mData; }
+    size_t size() const         { return mSize; }
+    EMode getMode() const       { return mMode; }
+    const std::string& getFilename() const { return mFilename; }
+
+private:
+    U8*         mData;
+    size_t      mSize;
+    EMode       mMode;
+    std::string mFilename;
+#if LL_WINDOWS
+    void*       mFileHandle;
+    void*       mMappingHandle;
+#else
+    int         mFileDescriptor;
+#endif
+};
+
+#endif // LL_LLMAPPEDFILE_H
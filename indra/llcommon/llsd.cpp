@@ -37,6 +37,11 @@
 #include "stringize.h"
 
 #include <limits>
+// <FS:Perf> Arena allocation of Impl nodes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+// </FS:Perf>
 
 // Defend against a caller forcibly passing a negative number into an unsigned
 // size_t index param
@@ -100,6 +105,13 @@ protected:
 	bool shared() const							{ return (mUseCount > 1) && (mUseCount != STATIC_USAGE_COUNT); }
 	
 	U32 mUseCount;
+	// <FS:Perf> Arena allocation of Impl nodes
+	LLSD::Arena* mArena;	///< arena holding this node, null for heap nodes
+
+public:
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+	// </FS:Perf>
 
 public:
 	static void reset(Impl*& var, Impl* impl);
@@ -276,6 +288,8 @@ namespace
 	{
 	public:
 		ImplString(const LLSD::String& v) : Base(v) { }
+		// <FS:Perf/> Take the value over instead of copying it
+		ImplString(LLSD::String&& v) : Base(LLSD::String()) { mValue.swap(v); }
 				
 		virtual LLSD::Boolean	asBoolean() const	{ return !mValue.empty(); }
 		virtual LLSD::Integer	asInteger() const;
@@ -363,6 +377,8 @@ namespace
 	{
 	public:
 		ImplBinary(const LLSD::Binary& v) : Base(v) { }
+		// <FS:Perf/> Take the value over instead of copying it
+		ImplBinary(LLSD::Binary&& v) : Base(LLSD::Binary()) { mValue.swap(v); }
 				
 		virtual const LLSD::Binary&	asBinary() const{ return mValue; }
 	};
@@ -655,15 +671,148 @@ namespace
 	}
 }
 
+// <FS:Perf> Arena allocation of Impl nodes
+/**
+ * Bump allocator for Impl nodes. Only the thread that owns the ArenaScope
+ * allocates from it, and only while the scope is alive, but nodes can be
+ * destroyed on any thread, so just the reference count is atomic. The
+ * scope holds one reference and every node holds one.
+ */
+class LLSD::Arena
+{
+public:
+	Arena()
+		: mRefs(1), mNext(nullptr), mEnd(nullptr), mNextBlockSize(FIRST_BLOCK_SIZE)
+	{
+	}
+
+	void* allocate(size_t size)
+	{
+		size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		if (size > size_t(mEnd - mNext))
+		{
+			// Start small so that parsing a short message does not cost a
+			// big block, then grow for large documents.
+			size_t block_size = std::max(mNextBlockSize, size);
+			mBlocks.emplace_back(new char[block_size], block_size);
+			mNext = mBlocks.back().first.get();
+			mEnd = mNext + block_size;
+			mNextBlockSize = std::min(mNextBlockSize * 2, MAX_BLOCK_SIZE);
+		}
+		void* result = mNext;
+		mNext += size;
+		return result;
+	}
+
+	bool owns(const void* ptr) const
+	{
+		for (const auto& block : mBlocks)
+		{
+			const char* start = block.first.get();
+			if (ptr >= start && ptr < start + block.second)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void retain()
+	{
+		mRefs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void release()
+	{
+		if (mRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete this;
+		}
+	}
+
+	// Arena of the innermost ArenaScope on this thread, if any
+	static thread_local Arena* sCurrent;
+
+private:
+	static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+	static constexpr size_t FIRST_BLOCK_SIZE = 4 * 1024;
+	static constexpr size_t MAX_BLOCK_SIZE = 256 * 1024;
+
+	std::atomic<U32> mRefs;
+	std::vector<std::pair<std::unique_ptr<char[]>, size_t> > mBlocks;
+	char* mNext;
+	char* mEnd;
+	size_t mNextBlockSize;
+};
+
+thread_local LLSD::Arena* LLSD::Arena::sCurrent = nullptr;
+
+LLSD::ArenaScope::ArenaScope()
+	: mArena(nullptr)
+{
+	if (!Arena::sCurrent)
+	{
+		mArena = new Arena;
+		Arena::sCurrent = mArena;
+	}
+}
+
+LLSD::ArenaScope::~ArenaScope()
+{
+	if (mArena)
+	{
+		Arena::sCurrent = nullptr;
+		mArena->release();
+	}
+}
+
+// static
+void* LLSD::Impl::operator new(size_t size)
+{
+	Arena* arena = Arena::sCurrent;
+	return arena ? arena->allocate(size) : ::operator new(size);
+}
+
+// static
+void LLSD::Impl::operator delete(void* ptr)
+{
+	// reset() never deletes arena nodes, so we only get here for one if
+	// its constructor threw. ~Impl() has run by then and left the
+	// reference it took on the arena for us.
+	Arena* arena = Arena::sCurrent;
+	if (arena && arena->owns(ptr))
+	{
+		arena->release();
+	}
+	else
+	{
+		::operator delete(ptr);
+	}
+}
+// </FS:Perf>
+
 LLSD::Impl::Impl()
 	: mUseCount(0)
+	// <FS:Perf> Arena allocation of Impl nodes
+	, mArena(Arena::sCurrent)
+	// </FS:Perf>
 {
+	// <FS:Perf> Arena allocation of Impl nodes
+	// Every Impl made with new on this thread got its memory from
+	// Arena::sCurrent in operator new above
+	if (mArena)
+	{
+		mArena->retain();
+	}
+	// </FS:Perf>
 	++sAllocationCount;
 	++sOutstandingCount;
 }
 
 LLSD::Impl::Impl(StaticAllocationMarker)
 	: mUseCount(0)
+	// <FS:Perf/> Arena allocation of Impl nodes
+	, mArena(nullptr)
 {
 }
 
@@ -680,7 +829,19 @@ void LLSD::Impl::reset(Impl*& var, Impl* impl)
 	}
 	if (var  &&  var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
 	{
-		delete var;
+		// <FS:Perf> Arena allocation of Impl nodes
+		//delete var;
+		if (Arena* arena = var->mArena)
+		{
+			// The arena gets the memory back when it goes away
+			var->~Impl();
+			arena->release();
+		}
+		else
+		{
+			delete var;
+		}
+		// </FS:Perf>
 	}
 	var = impl;
 }
@@ -849,6 +1010,10 @@ LLSD::LLSD(const String& v) : impl(0)	{ ALLOC_LLSD_OBJECT;	assign(v); }
 LLSD::LLSD(const Date& v) : impl(0)		{ ALLOC_LLSD_OBJECT;	assign(v); }
 LLSD::LLSD(const URI& v) : impl(0)		{ ALLOC_LLSD_OBJECT;	assign(v); }
 LLSD::LLSD(const Binary& v) : impl(0)	{ ALLOC_LLSD_OBJECT;	assign(v); }
+// <FS:Perf> Take the value over instead of copying it
+LLSD::LLSD(String&& v) : impl(0)		{ ALLOC_LLSD_OBJECT;	Impl::reset(impl, new ImplString(std::move(v))); }
+LLSD::LLSD(Binary&& v) : impl(0)		{ ALLOC_LLSD_OBJECT;	Impl::reset(impl, new ImplBinary(std::move(v))); }
+// </FS:Perf>
 
 // Scalar Assignment
 void LLSD::assign(Boolean v)			{ safe(impl).assign(impl, v); }
@@ -188,6 +188,10 @@ public:
 		LLSD(const Date&);
 		LLSD(const URI&);
 		LLSD(const Binary&);
+		// <FS:Perf> Take the value over instead of copying it, for parsers
+		LLSD(String&&);
+		LLSD(Binary&&);
+		// </FS:Perf>
 	//@}
 
 	/** @name Convenience Constructors */
@@ -426,6 +430,39 @@ private:
 		friend class LLSD::Impl;
 	//@}
 
+	// <FS:Perf> Arena allocation of Impl nodes
+	/** @name Arena Allocation */
+	//@{
+public:
+		class Arena;
+
+		/**
+		 * While an ArenaScope is alive, the values created on this thread
+		 * take their Impl nodes from one arena instead of one heap
+		 * allocation each. The arena is freed when the last node from it is
+		 * destroyed, on whatever thread that happens, so the values can be
+		 * used and passed around like any other. Nested scopes share the
+		 * outermost arena.
+		 *
+		 * Meant for parsers building large documents that are thrown away
+		 * after use: as long as any value from the arena is alive, the whole
+		 * arena stays allocated.
+		 */
+		class LL_COMMON_API ArenaScope
+		{
+		public:
+			ArenaScope();
+			~ArenaScope();
+
+			ArenaScope(const ArenaScope&) = delete;
+			ArenaScope& operator=(const ArenaScope&) = delete;
+
+		private:
+			Arena* mArena;
+		};
+	//@}
+	// </FS:Perf>
+
 private:
 	/** @name Debugging Interface */
 	//@{
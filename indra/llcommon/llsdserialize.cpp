@@ -1295,6 +1295,414 @@ bool LLSDBinaryParser::parseString(
 	return true;
 }
 
+// <FS:Perf> Parse straight out of memory
+namespace
+{
+/**
+ * Binary LLSD parser working on a contiguous buffer. It follows the
+ * grammar and failure rules of LLSDBinaryParser::doParse(), except that a
+ * value cut off by the end of the buffer is always a failure. Every string
+ * is built once, straight from its bytes in the buffer.
+ */
+class LLSDBinaryBufferParser
+{
+public:
+	LLSDBinaryBufferParser(const U8* data, size_t size)
+		: mStart(data), mPos(data), mEnd(data + size)
+	{
+	}
+
+	S32 parse(LLSD& data, S32 max_depth);
+
+	// bytes read so far, like tellg() on the stream parser's input
+	size_t getBytesParsed() const { return size_t(mPos - mStart); }
+
+private:
+	static const int END = -1;
+
+	size_t left() const { return size_t(mEnd - mPos); }
+	int get() { return (mPos < mEnd) ? *mPos++ : END; }
+	int peek() const { return (mPos < mEnd) ? *mPos : END; }
+
+	bool read(void* dst, size_t size);
+	bool readSize(S32& size);
+	bool parseString(std::string& value);
+	bool parseDelimString(std::string& value, char delim);
+	S32 parseMap(LLSD& map, S32 max_depth);
+	S32 parseArray(LLSD& array, S32 max_depth);
+
+	const U8* mStart;
+	const U8* mPos;
+	const U8* mEnd;
+};
+
+S32 LLSDBinaryBufferParser::parse(LLSD& data, S32 max_depth)
+{
+	int c = get();
+	if (END == c)
+	{
+		return 0;
+	}
+	if (max_depth == 0)
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	S32 parse_count = 1;
+	switch (c)
+	{
+	case '{':
+	case '[':
+	{
+		S32 child_count = (c == '{') ? parseMap(data, max_depth - 1) : parseArray(data, max_depth - 1);
+		if ((child_count == LLSDParser::PARSE_FAILURE) || data.isUndefined())
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		else
+		{
+			parse_count += child_count;
+		}
+		break;
+	}
+
+	case '!':
+		data.clear();
+		break;
+
+	case '0':
+		data = false;
+		break;
+
+	case '1':
+		data = true;
+		break;
+
+	case 'i':
+	{
+		U32 value_nbo = 0;
+		if (read(&value_nbo, sizeof(U32)))
+		{
+			data = (S32)ntohl(value_nbo);
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'r':
+	{
+		F64 real_nbo = 0.0;
+		if (read(&real_nbo, sizeof(F64)))
+		{
+			data = ll_ntohd(real_nbo);
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'u':
+	{
+		LLUUID id;
+		if (read(id.mData, UUID_BYTES))
+		{
+			data = id;
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case '\'':
+	case '"':
+	case 's':
+	{
+		std::string value;
+		if ((c == 's') ? parseString(value) : parseDelimString(value, (char)c))
+		{
+			data = LLSD(std::move(value));
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'l':
+	{
+		std::string value;
+		if (parseString(value))
+		{
+			data = LLURI(value);
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'd':
+	{
+		// dates are not byte swapped, see LLSDBinaryFormatter
+		F64 real = 0.0;
+		if (read(&real, sizeof(F64)))
+		{
+			data = LLDate(real);
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'b':
+	{
+		S32 size = 0;
+		if (readSize(size))
+		{
+			LLSD::Binary value(mPos, mPos + size);
+			mPos += size;
+			data = LLSD(std::move(value));
+		}
+		else
+		{
+			parse_count = LLSDParser::PARSE_FAILURE;
+		}
+		break;
+	}
+
+	default:
+		parse_count = LLSDParser::PARSE_FAILURE;
+		LL_INFOS() << "Unrecognized character while parsing: int(" << c
+			<< ")" << LL_ENDL;
+		break;
+	}
+	if (LLSDParser::PARSE_FAILURE == parse_count)
+	{
+		data.clear();
+	}
+	return parse_count;
+}
+
+S32 LLSDBinaryBufferParser::parseMap(LLSD& map, S32 max_depth)
+{
+	map = LLSD::emptyMap();
+	S32 size = 0;
+	if (!read(&size, sizeof(S32)))
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	size = (S32)ntohl(size);
+	S32 parse_count = 0;
+	S32 count = 0;
+	int c = get();
+	while ((c != '}') && (count < size) && (c != END))
+	{
+		std::string name;
+		switch (c)
+		{
+		case 'k':
+			if (!parseString(name))
+			{
+				return LLSDParser::PARSE_FAILURE;
+			}
+			break;
+		case '\'':
+		case '"':
+			if (!parseDelimString(name, (char)c))
+			{
+				return LLSDParser::PARSE_FAILURE;
+			}
+			break;
+		}
+		LLSD child;
+		S32 child_count = parse(child, max_depth);
+		if (child_count > 0)
+		{
+			// There must be a value for every key
+			parse_count += child_count;
+			map.insert(name, child);
+		}
+		else
+		{
+			return LLSDParser::PARSE_FAILURE;
+		}
+		++count;
+		c = get();
+	}
+	if ((c != '}') || (count < size))
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
+S32 LLSDBinaryBufferParser::parseArray(LLSD& array, S32 max_depth)
+{
+	array = LLSD::emptyArray();
+	S32 size = 0;
+	if (!read(&size, sizeof(S32)))
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	size = (S32)ntohl(size);
+	S32 parse_count = 0;
+	S32 count = 0;
+	int c = peek();
+	while ((c != ']') && (count < size) && (c != END))
+	{
+		LLSD child;
+		S32 child_count = parse(child, max_depth);
+		if (LLSDParser::PARSE_FAILURE == child_count)
+		{
+			return LLSDParser::PARSE_FAILURE;
+		}
+		if (child_count)
+		{
+			parse_count += child_count;
+			array.append(child);
+		}
+		++count;
+		c = peek();
+	}
+	c = get();
+	if ((c != ']') || (count < size))
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
+bool LLSDBinaryBufferParser::read(void* dst, size_t size)
+{
+	if (left() < size)
+	{
+		mPos = mEnd;
+		return false;
+	}
+	memcpy(dst, mPos, size);	/* Flawfinder: ignore */
+	mPos += size;
+	return true;
+}
+
+bool LLSDBinaryBufferParser::readSize(S32& size)
+{
+	U32 value_nbo = 0;
+	if (!read(&value_nbo, sizeof(U32)))
+	{
+		return false;
+	}
+	size = (S32)ntohl(value_nbo);
+	if ((size < 0) || ((size_t)size > left()))
+	{
+		mPos = mEnd;
+		return false;
+	}
+	return true;
+}
+
+bool LLSDBinaryBufferParser::parseString(std::string& value)
+{
+	S32 size = 0;
+	if (!readSize(size))
+	{
+		return false;
+	}
+	value.assign((const char*)mPos, size);
+	mPos += size;
+	return true;
+}
+
+// Same escapes as deserialize_string_delim()
+bool LLSDBinaryBufferParser::parseDelimString(std::string& value, char delim)
+{
+	value.clear();
+	while (mPos < mEnd)
+	{
+		// copy everything up to the next delimiter or escape in one go
+		const U8* start = mPos;
+		while ((mPos < mEnd) && (*mPos != (U8)delim) && (*mPos != '\\'))
+		{
+			++mPos;
+		}
+		value.append((const char*)start, mPos - start);
+		if (mPos == mEnd)
+		{
+			break;
+		}
+		if (*mPos++ == (U8)delim)
+		{
+			return true;
+		}
+		if (mPos == mEnd)
+		{
+			break;
+		}
+		char c = (char)*mPos++;
+		switch (c)
+		{
+		case 'a': value += '\a'; break;
+		case 'b': value += '\b'; break;
+		case 'f': value += '\f'; break;
+		case 'n': value += '\n'; break;
+		case 'r': value += '\r'; break;
+		case 't': value += '\t'; break;
+		case 'v': value += '\v'; break;
+		case 'x':
+			if (left() < 2)
+			{
+				mPos = mEnd;
+				return false;
+			}
+			value += (char)((hex_as_nybble((char)mPos[0]) << 4) | hex_as_nybble((char)mPos[1]));
+			mPos += 2;
+			break;
+		default:
+			value += c;
+			break;
+		}
+	}
+	return false;
+}
+} // anonymous namespace
+
+// static
+S32 LLSDSerialize::fromBinary(LLSD& sd, const U8* data, size_t size, S32 max_depth, size_t* bytes_parsed)
+{
+	LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+	LLSD::ArenaScope arena;
+	LLSDBinaryBufferParser parser(data, size);
+	S32 count = parser.parse(sd, max_depth);
+	if (bytes_parsed)
+	{
+		*bytes_parsed = parser.getBytesParsed();
+	}
+	return count;
+}
+
+// static
+S32 LLSDSerialize::fromNotation(LLSD& sd, const char* data, size_t size)
+{
+	LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+	// Notation is mostly text, where the stream parser's number and
+	// base64 handling is worth keeping, so this only saves copying the
+	// input into a string stream. No arena either: notation messages are
+	// small and callers tend to keep parts of them.
+	boost::iostreams::stream<boost::iostreams::array_source> istr(data, size);
+	LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
+	return p->parse(istr, sd, size);
+}
+// </FS:Perf>
+
 
 /**
  * LLSDFormatter
@@ -2339,9 +2747,12 @@ LLUZipHelper::EZipRresult LLUZipHelper::unzip_llsd(LLSD& data, const U8* in, S32
 	{
 		char* result_ptr = strip_deprecated_header((char*)result, cur_size);
 
-		boost::iostreams::stream<boost::iostreams::array_source> istrm(result_ptr, cur_size);
-		
-		if (!LLSDSerialize::fromBinary(data, istrm, cur_size, UNZIP_LLSD_MAX_DEPTH))
+		// <FS:Perf> Parse straight out of the inflated buffer
+		//boost::iostreams::stream<boost::iostreams::array_source> istrm(result_ptr, cur_size);
+		//
+		//if (!LLSDSerialize::fromBinary(data, istrm, cur_size, UNZIP_LLSD_MAX_DEPTH))
+		if (!LLSDSerialize::fromBinary(data, (const U8*)result_ptr, cur_size, UNZIP_LLSD_MAX_DEPTH))
+		// </FS:Perf>
 		{
 			// free(result);
 			if( result )
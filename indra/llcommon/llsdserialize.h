@@ -290,6 +290,32 @@ private:
 	bool parseBinary(std::istream& istr, LLSD& data) const;
 };
 
+// <FS:Perf> Streaming XML parse
+/**
+ * @class LLSDStreamVisitor
+ * @brief Receives parts of an XML LLSD document while it is being parsed.
+ *
+ * For every array it starts, LLSDXMLParser asks wantElements() whether
+ * the visitor wants its elements. Each element of an array the visitor
+ * wants is handed to visitElement() as soon as its closing tag is read,
+ * and is not added to the array. Consumers that only walk a large
+ * document once can then process it piece by piece, and never hold more
+ * than one element in memory. Everything the visitor does not take still
+ * ends up in the parse result as usual.
+ *
+ * Paths are LLSD arrays of map keys and array indexes from the top of the
+ * document, the same form llsd::drill() takes.
+ */
+class LL_COMMON_API LLSDStreamVisitor
+{
+public:
+	virtual ~LLSDStreamVisitor() {}
+
+	virtual bool wantElements(const LLSD& array_path) = 0;
+	virtual void visitElement(const LLSD& element_path, const LLSD& element) = 0;
+};
+// </FS:Perf>
+
 /** 
  * @class LLSDXMLParser
  * @brief Parser which handles XML format LLSD.
@@ -308,6 +334,15 @@ public:
 	 */
 	LLSDXMLParser(bool emit_errors=true);
 
+	// <FS:Perf> Streaming XML parse
+	/**
+	 * @brief Hand array elements to visitor while parsing, see
+	 * LLSDStreamVisitor. Pass NULL to build the whole tree again. The
+	 * visitor is not owned, and is kept until changed.
+	 */
+	void setVisitor(LLSDStreamVisitor* visitor);
+	// </FS:Perf>
+
 protected:
 	/** 
 	 * @brief Call this method to parse a stream for LLSD.
@@ -825,6 +860,16 @@ public:
 		return fromXMLEmbedded(sd, str, emit_errors);
 //		return fromXMLDocument(sd, str, emit_errors);
 	}
+	// <FS:Perf> Streaming XML parse
+	// Like fromXML(), handing the elements of the arrays visitor asks
+	// for to it as they are parsed instead of storing them in sd
+	static S32 fromXML(LLSD& sd, std::istream& str, LLSDStreamVisitor& visitor, bool emit_errors=true)
+	{
+		LLPointer<LLSDXMLParser> p = new LLSDXMLParser(emit_errors);
+		p->setVisitor(&visitor);
+		return p->parse(str, sd, LLSDSerialize::SIZE_UNLIMITED);
+	}
+	// </FS:Perf>
 
 	/*
 	 * Binary Methods
@@ -846,6 +891,20 @@ public:
 		(void)p->parse(str, sd, max_bytes, max_depth);
 		return sd;
 	}
+
+	// <FS:Perf> Parse straight out of memory
+	/**
+	 * Parse from a buffer holding the whole document, without a stream in
+	 * between and with the nodes allocated from an LLSD::ArenaScope.
+	 * Returns the same counts as the stream version. Best for documents
+	 * that are read and thrown away: anything kept from the result keeps
+	 * the arena with it. If bytes_parsed is given, it is set to how much
+	 * of the buffer the document took up.
+	 */
+	static S32 fromBinary(LLSD& sd, const U8* data, size_t size, S32 max_depth = -1, size_t* bytes_parsed = nullptr);
+	/// Notation from a buffer, without copying it into a string stream first
+	static S32 fromNotation(LLSD& sd, const char* data, size_t size);
+	// </FS:Perf>
 };
 
 class LL_COMMON_API LLUZipHelper : public LLRefCount
@@ -274,6 +274,9 @@ public:
 	
 	void reset();
 
+	// <FS:Perf/> Streaming XML parse
+	void setVisitor(LLSDStreamVisitor* visitor)	{ mVisitor = visitor; }
+
 private:
 	void startElementHandler(const XML_Char* name, const XML_Char** attributes);
 	void endElementHandler(const XML_Char* name);
@@ -328,11 +331,30 @@ private:
 	
 	std::string mCurrentKey;		// Current XML <tag>
 	std::string mCurrentContent;	// String data between <tag> and </tag>
+
+	// <FS:Perf> Streaming XML parse
+	// Where each value on mStack sits in the document, only kept up when
+	// there is a visitor
+	struct StreamLevel
+	{
+		LLSD mPathEntry;		// key or index of the value in its parent
+		S32 mElements = 0;		// elements started so far, for arrays
+		bool mStreamed = false;	// elements go to mVisitor, not into the array
+		LLSD mElement;			// the value itself, when its parent is streamed
+	};
+	LLSD getPath() const;
+	void pushStreamLevel(const LLSD& path_entry);
+
+	LLSDStreamVisitor* mVisitor;
+	std::deque<StreamLevel> mStreamLevels;	// deque, so mElement stays put
+	// </FS:Perf>
 };
 
 
 LLSDXMLParser::Impl::Impl(bool emit_errors)
 	: mEmitErrors(emit_errors)
+	// <FS:Perf/> Streaming XML parse
+	, mVisitor(NULL)
 {
 	mParser = XML_ParserCreate(NULL);
 	reset();
@@ -527,6 +549,9 @@ void LLSDXMLParser::Impl::reset()
 	mSkipping = false;
 	
 	mCurrentKey.clear();
+
+	// <FS:Perf/> Streaming XML parse
+	mStreamLevels.clear();
 	
 	XML_ParserReset(mParser, "utf-8");
 	XML_SetUserData(mParser, this);
@@ -555,6 +580,25 @@ LLSDXMLParser::Impl::findAttribute(const XML_Char* name, const XML_Char** pairs)
 	return NULL;
 }
 
+// <FS:Perf> Streaming XML parse
+LLSD LLSDXMLParser::Impl::getPath() const
+{
+	LLSD path = LLSD::emptyArray();
+	// the top level value has no path entry
+	for (size_t i = 1; i < mStreamLevels.size(); ++i)
+	{
+		path.append(mStreamLevels[i].mPathEntry);
+	}
+	return path;
+}
+
+void LLSDXMLParser::Impl::pushStreamLevel(const LLSD& path_entry)
+{
+	mStreamLevels.emplace_back();
+	mStreamLevels.back().mPathEntry = path_entry;
+}
+// </FS:Perf>
+
 void LLSDXMLParser::Impl::parsePart(const char* buf, llssize len)
 {
 	if ( buf != NULL 
@@ -658,6 +702,12 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 	if (mStack.empty())
 	{
 		mStack.push_back(&mResult);
+		// <FS:Perf> Streaming XML parse
+		if (mVisitor)
+		{
+			pushStreamLevel(LLSD());
+		}
+		// </FS:Perf>
 	}
 	else if (mStack.back()->isMap())
 	{
@@ -671,8 +721,36 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 		LLSD& newElement = map[mCurrentKey];
 		mStack.push_back(&newElement);		
 
+		// <FS:Perf> Streaming XML parse
+		if (mVisitor)
+		{
+			pushStreamLevel(mCurrentKey);
+		}
+		// </FS:Perf>
+
 		mCurrentKey.clear();
 	}
+	// <FS:Perf> Streaming XML parse
+	else if (mVisitor && mStack.back()->isArray())
+	{
+		StreamLevel& parent = mStreamLevels.back();
+		LLSD::Integer index = parent.mElements++;
+		if (parent.mStreamed)
+		{
+			// build the element on the side, endElementHandler() hands it
+			// to the visitor
+			pushStreamLevel(index);
+			mStack.push_back(&mStreamLevels.back().mElement);
+		}
+		else
+		{
+			LLSD& array = *mStack.back();
+			array.append(LLSD());
+			mStack.push_back(&array[array.size() - 1]);
+			pushStreamLevel(index);
+		}
+	}
+	// </FS:Perf>
 	else if (mStack.back()->isArray())
 	{
 		LLSD& array = *mStack.back();
@@ -695,6 +773,12 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 		
 		case ELEMENT_ARRAY:
 			*mStack.back() = LLSD::emptyArray();
+			// <FS:Perf> Streaming XML parse
+			if (mVisitor)
+			{
+				mStreamLevels.back().mStreamed = mVisitor->wantElements(getPath());
+			}
+			// </FS:Perf>
 			break;
 			
 		default:
@@ -837,6 +921,17 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	}
 
 	mCurrentContent.clear();
+
+	// <FS:Perf> Streaming XML parse
+	if (mVisitor && !mStreamLevels.empty())
+	{
+		if (mStreamLevels.size() > 1 && mStreamLevels[mStreamLevels.size() - 2].mStreamed)
+		{
+			mVisitor->visitElement(getPath(), value);
+		}
+		mStreamLevels.pop_back();
+	}
+	// </FS:Perf>
 }
 
 void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
@@ -955,6 +1050,13 @@ void LLSDXMLParser::parsePart(const char *buf, llssize len)
 	impl.parsePart(buf, len);
 }
 
+// <FS:Perf> Streaming XML parse
+void LLSDXMLParser::setVisitor(LLSDStreamVisitor* visitor)
+{
+	impl.setVisitor(visitor);
+}
+// </FS:Perf>
+
 // virtual
 S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data, S32 max_depth) const
 {
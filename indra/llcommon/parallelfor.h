@@ -0,0 +1,137 @@
+/**
+ * @file   parallelfor.h
+ * @date   2024-06-10
+ * @brief  parallelFor() splits a loop over the threads of a ThreadPool and
+ *         waits for it to finish.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_PARALLELFOR_H)
+#define LL_PARALLELFOR_H
+
+#include "threadpool.h"
+#include "workqueue.h"
+#include <algorithm>                // std::min
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>                   // std::shared_ptr
+#include <mutex>
+#include <string>
+
+namespace LL
+{
+    /**
+     * parallelFor() calls func(begin, end) on consecutive slices of
+     * [0, count) and returns once every slice is done. There are as many
+     * slices as pool threads plus one. Each thread of the ThreadPool called
+     * pool_name is asked to take one, and the calling thread takes slices
+     * too until none are left, so it never sits waiting on slices queued
+     * behind other work of the pool.
+     *
+     * Slices are at least grain long, so a small count runs on the calling
+     * thread alone. So does everything when there is no such pool, or when
+     * its queue is closed.
+     *
+     * func must be safe to call at the same time on different slices. If a
+     * slice throws, the exception is rethrown here once all the slices have
+     * finished. Don't call parallelFor() from a thread of the pool itself:
+     * it would wait on slices queued behind its own work.
+     */
+    template <typename FUNC>
+    void parallelFor(const std::string& pool_name, size_t count, size_t grain, const FUNC& func)
+    {
+        const size_t width = ThreadPoolBase::getWidth(pool_name, 0);
+        const size_t slices = std::min(width + 1, count / std::max(grain, size_t(1)));
+        WorkQueueBase::ptr_t queue;
+        if (slices > 1)
+        {
+            queue = WorkQueueBase::getInstance(pool_name);
+        }
+        if (! queue)
+        {
+            if (count)
+            {
+                func(0, count);
+            }
+            return;
+        }
+
+        struct State
+        {
+            std::mutex mMutex;
+            std::condition_variable mDone;
+            size_t mPending;
+            std::atomic<size_t> mNextSlice;
+            std::exception_ptr mException;
+        };
+        auto state = std::make_shared<State>();
+        state->mPending = slices;
+        state->mNextSlice = 0;
+
+        // Takes slices until there are none left. A pool thread that only
+        // gets to run this after we have returned finds none, and so never
+        // touches func.
+        auto take_slices = [state, &func, count, slices]()
+        {
+            for (size_t i = state->mNextSlice++; i < slices; i = state->mNextSlice++)
+            {
+                std::exception_ptr exception;
+                try
+                {
+                    func(count * i / slices, count * (i + 1) / slices);
+                }
+                catch (...)
+                {
+                    exception = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(state->mMutex);
+                if (exception && ! state->mException)
+                {
+                    state->mException = exception;
+                }
+                if (--state->mPending == 0)
+                {
+                    state->mDone.notify_one();
+                }
+            }
+        };
+
+        for (size_t i = 1; i < slices; ++i)
+        {
+            // if the queue closed under us, we just take more slices here
+            queue->post(take_slices);
+        }
+        take_slices();
+
+        std::unique_lock<std::mutex> lock(state->mMutex);
+        state->mDone.wait(lock, [&state](){ return state->mPending == 0; });
+        if (state->mException)
+        {
+            std::rethrow_exception(state->mException);
+        }
+    }
+} // namespace LL
+
+#endif /* ! defined(LL_PARALLELFOR_H) */
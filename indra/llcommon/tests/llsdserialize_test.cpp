@@ -57,7 +57,9 @@ typedef U32 uint32_t;
 #include "../test/namedtempfile.h"
 #include "stringize.h"
 #include "StringVec.h"
+#include <chrono>
 #include <functional>
+#include <iostream>
 
 typedef std::function<void(const LLSD& data, std::ostream& str)> FormatterFunction;
 typedef std::function<bool(std::istream& istr, LLSD& data, llssize max_bytes)> ParserFunction;
@@ -857,6 +859,82 @@ namespace tut
             8);
     }
 
+	// Collects what LLSDXMLParser streams to it
+	class TestStreamVisitor : public LLSDStreamVisitor
+	{
+	public:
+		TestStreamVisitor(const std::function<bool(const LLSD&)>& want) : mWant(want) {}
+
+		bool wantElements(const LLSD& array_path) override
+		{
+			return mWant(array_path);
+		}
+
+		void visitElement(const LLSD& element_path, const LLSD& element) override
+		{
+			mPaths.append(element_path);
+			mElements.append(element);
+		}
+
+		std::function<bool(const LLSD&)> mWant;
+		LLSD mPaths = LLSD::emptyArray();
+		LLSD mElements = LLSD::emptyArray();
+	};
+
+	template<> template<>
+	void TestLLSDXMLParsingObject::test<6>()
+	{
+		set_test_name("streaming to a visitor");
+
+		LLSD folders = LLSD::emptyArray();
+		for (S32 i = 0; i < 3; ++i)
+		{
+			LLSD folder;
+			folder["folder_id"] = LLUUID::generateNewID();
+			folder["version"] = i;
+			folder["items"] = llsd::array(llsd::map("name", "first"), llsd::map("name", "second"));
+			folders.append(folder);
+		}
+		LLSD document;
+		document["folders"] = folders;
+		document["bad_folders"] = llsd::array(LLUUID::generateNewID());
+		document["nested"] = llsd::array(llsd::array(1, 2), llsd::array(3, 4, 5));
+		std::ostringstream xml;
+		S32 count = LLSDSerialize::toXML(document, xml);
+
+		// top level array
+		TestStreamVisitor by_folder([](const LLSD& path)
+			{
+				return path.size() == 1 && path[0].asString() == "folders";
+			});
+		std::istringstream input(xml.str());
+		LLSD result;
+		ensure_equals("folder count", LLSDSerialize::fromXML(result, input, by_folder), count);
+		ensure_equals("folders", by_folder.mElements, folders);
+		ensure_equals("folder paths", by_folder.mPaths,
+					  llsd::array(llsd::array("folders", 0), llsd::array("folders", 1), llsd::array("folders", 2)));
+		ensure_equals("streamed array left empty", result["folders"], LLSD::emptyArray());
+		ensure_equals("rest kept", result["bad_folders"], document["bad_folders"]);
+		ensure_equals("nested kept", result["nested"], document["nested"]);
+
+		// arrays inside the elements of other arrays
+		TestStreamVisitor by_item([](const LLSD& path)
+			{
+				return (path.size() == 3 && path[2].asString() == "items") ||
+					   (path.size() == 2 && path[0].asString() == "nested" && path[1].asInteger() == 1);
+			});
+		std::istringstream input2(xml.str());
+		result.clear();
+		ensure_equals("item count", LLSDSerialize::fromXML(result, input2, by_item), count);
+		ensure_equals("items and numbers", by_item.mElements.size(), 6 + 3);
+		ensure_equals("item path", by_item.mPaths[3], llsd::array("folders", 1, "items", 1));
+		ensure_equals("item", by_item.mElements[3], llsd::map("name", "second"));
+		ensure_equals("number path", by_item.mPaths[8], llsd::array("nested", 1, 2));
+		ensure_equals("number", by_item.mElements[8].asInteger(), 5);
+		ensure_equals("folder kept", result["folders"][1]["folder_id"], folders[1]["folder_id"]);
+		ensure_equals("items left empty", result["folders"][1]["items"], LLSD::emptyArray());
+		ensure_equals("other nested array kept", result["nested"][0], document["nested"][0]);
+	}
 
 	/*
 	TODO:
@@ -1267,6 +1345,23 @@ namespace tut
 	{
 	public:
 		TestLLSDBinaryParsing() {}
+
+		// Every case also goes through the buffer parser, which has to
+		// agree with the stream parser.
+		void ensureParse(
+			const std::string& msg,
+			const std::string& in,
+			const LLSD& expected_value,
+			S32 expected_count,
+			S32 depth_limit = -1)
+		{
+			TestLLSDParsing<LLSDBinaryParser>::ensureParse(msg, in, expected_value, expected_count, depth_limit);
+
+			LLSD parsed_result;
+			S32 parsed_count = LLSDSerialize::fromBinary(parsed_result, (const U8*)in.data(), in.size(), depth_limit);
+			ensure_equals(msg + " (buffer)", parsed_result, expected_value);
+			ensure_equals(msg + " (buffer count)", parsed_count, expected_count);
+		}
 	};
 
 	typedef tut::test_group<TestLLSDBinaryParsing> TestLLSDBinaryParsingGroup;
@@ -1584,12 +1679,149 @@ namespace tut
 			1);
 	}
 
-/*
+	// A map shaped like one inventory item from a fetch response
+	LLSD make_inventory_item(S32 i)
+	{
+		LLSD item;
+		item["item_id"] = LLUUID::generateNewID();
+		item["parent_id"] = LLUUID::generateNewID();
+		item["asset_id"] = LLUUID::generateNewID();
+		item["name"] = llformat("Inventory item number %d", i);
+		item["desc"] = (i % 3) ? std::string("A 'quoted' description\nwith escapes") : std::string();
+		item["type"] = i % 20;
+		item["inv_type"] = i % 18;
+		item["flags"] = i * 7;
+		item["created_at"] = LLDate(1700000000.0 + i);
+		LLSD permissions;
+		permissions["creator_id"] = LLUUID::generateNewID();
+		permissions["owner_id"] = LLUUID::generateNewID();
+		permissions["base_mask"] = 0x7fffffff;
+		permissions["owner_mask"] = 0x7fffffff;
+		permissions["group_mask"] = 0;
+		permissions["everyone_mask"] = 0;
+		permissions["next_owner_mask"] = 0x82000;
+		item["permissions"] = permissions;
+		LLSD sale_info;
+		sale_info["sale_price"] = 10.5;
+		sale_info["sale_type"] = "not";
+		item["sale_info"] = sale_info;
+		return item;
+	}
+
+	LLSD make_inventory(S32 count)
+	{
+		LLSD items = LLSD::emptyArray();
+		for (S32 i = 0; i < count; ++i)
+		{
+			items.append(make_inventory_item(i));
+		}
+		LLSD folder;
+		folder["folder_id"] = LLUUID::generateNewID();
+		folder["version"] = 42;
+		folder["items"] = items;
+		folder["url"] = LLURI("http://example.com/cap");
+		folder["blob"] = LLSD::Binary(100, 0xa5);
+		return folder;
+	}
+
 	template<> template<> 
 	void TestLLSDBinaryParsingObject::test<11>()
 	{
+		set_test_name("buffer parser on a full document");
+
+		const LLSD input = make_inventory(50);
+		std::ostringstream ostr;
+		S32 count = LLSDSerialize::toBinary(input, ostr);
+		std::string buffer = ostr.str();
+
+		LLSD item;
+		{
+			LLSD parsed;
+			ensure_equals("count", LLSDSerialize::fromBinary(parsed, (const U8*)buffer.data(), buffer.size()), count);
+			ensure_equals("document", parsed, input);
+			item = parsed["items"][10];
+		}
+		// values taken from the result outlive it
+		ensure_equals("kept item", item, input["items"][10]);
+
+		// data after the document, as in a mesh asset, is not counted
+		{
+			const std::string padded = buffer + std::string("\x01\x02\x03", 3);
+			size_t bytes_parsed = 0;
+			LLSD parsed;
+			ensure_equals("count with trailing data",
+						  LLSDSerialize::fromBinary(parsed, (const U8*)padded.data(), padded.size(), -1, &bytes_parsed),
+						  count);
+			ensure_equals("bytes parsed", bytes_parsed, buffer.size());
+		}
+
+		// notation style quoted keys and strings, which binary LLSD also
+		// allows
+		std::string quoted("{");
+		quoted.append("\0\0\0\2", 4);
+		quoted.append("'a\\x41\\n'\"b\\\"\"");
+		quoted.append("\"q\\tz\"1}");
+		LLSD expected;
+		expected["aA\n"] = "b\"";
+		expected["q\tz"] = true;
+		ensureParse("quoted strings", quoted, expected, 3);
+
+		// anything cut short fails cleanly
+		for (size_t size = 1; size < buffer.size(); size += 7)
+		{
+			LLSD parsed;
+			ensure_equals(stringize("truncated to ", size),
+						  LLSDSerialize::fromBinary(parsed, (const U8*)buffer.data(), size),
+						  LLSDParser::PARSE_FAILURE);
+			ensure(stringize("undefined when truncated to ", size), parsed.isUndefined());
+		}
+
+		LLSD parsed;
+		ensure_equals("depth limit", LLSDSerialize::fromBinary(parsed, (const U8*)buffer.data(), buffer.size(), 2),
+					  LLSDParser::PARSE_FAILURE);
+	}
+
+	// Not a regression test: compares the stream and buffer parsers on an
+	// inventory fetch sized document and prints the result. It only runs
+	// with LL_LLSD_PARSER_BENCHMARK set.
+	template<> template<> 
+	void TestLLSDBinaryParsingObject::test<12>()
+	{
+		set_test_name("stream vs. buffer parser speed");
+		if (LLStringUtil::getenv("LL_LLSD_PARSER_BENCHMARK").empty())
+		{
+			skip("set LL_LLSD_PARSER_BENCHMARK to run the benchmark");
+		}
+
+		for (S32 items : { 100, 5000 })
+		{
+			std::ostringstream ostr;
+			LLSDSerialize::toBinary(make_inventory(items), ostr);
+			const std::string buffer = ostr.str();
+			const S32 repeat = llmax(1, 20000 / items);
+
+			auto start = std::chrono::steady_clock::now();
+			for (S32 i = 0; i < repeat; ++i)
+			{
+				LLMemoryStream istr((const U8*)buffer.data(), (S32)buffer.size());
+				LLSD parsed;
+				LLSDSerialize::fromBinary(parsed, istr, buffer.size());
+			}
+			F64 stream_sec = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			for (S32 i = 0; i < repeat; ++i)
+			{
+				LLSD parsed;
+				LLSDSerialize::fromBinary(parsed, (const U8*)buffer.data(), buffer.size());
+			}
+			F64 buffer_sec = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+
+			F64 mb = (F64)buffer.size() * repeat / (1024.0 * 1024.0);
+			std::cout << "\nLLSD binary, " << items << " inventory items (" << buffer.size() << " bytes): stream "
+					  << mb / stream_sec << " MB/s, buffer " << mb / buffer_sec << " MB/s" << std::endl;
+		}
 	}
-*/
 
    /**
 	 * @class TestLLSDCrossCompatible
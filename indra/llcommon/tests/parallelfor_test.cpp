@@ -0,0 +1,135 @@
+/**
+ * @file   parallelfor_test.cpp
+ * @date   2024-06-10
+ * @brief  Test for parallelFor()
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "parallelfor.h"
+// STL headers
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct parallelfor_data
+    {
+    };
+    typedef test_group<parallelfor_data> parallelfor_group;
+    typedef parallelfor_group::object object;
+    parallelfor_group parallelforgrp("parallelfor");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("every index once, across threads");
+        LL::ThreadPool pool("parallelfor", 3);
+        pool.start();
+
+        std::vector<std::atomic<U32>> visits(10000);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        LL::parallelFor("parallelfor", visits.size(), 100,
+                        [&](size_t begin, size_t end)
+                        {
+                            for (size_t i = begin; i < end; ++i)
+                            {
+                                ++visits[i];
+                            }
+                            std::lock_guard<std::mutex> lock(mutex);
+                            threads.insert(std::this_thread::get_id());
+                        });
+        for (size_t i = 0; i < visits.size(); ++i)
+        {
+            ensure_equals("visits", visits[i].load(), 1);
+        }
+        ensure("ran on the caller", threads.count(std::this_thread::get_id()) == 1);
+        ensure("ran on the pool", threads.size() > 1);
+        pool.close();
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("runs here without a pool, or when too small");
+        std::vector<std::pair<size_t, size_t>> slices;
+        auto record = [&slices](size_t begin, size_t end){ slices.emplace_back(begin, end); };
+
+        LL::parallelFor("nosuchpool", 1000, 10, record);
+        ensure_equals("no pool", slices.size(), 1);
+        ensure("no pool range", slices[0] == std::make_pair(size_t(0), size_t(1000)));
+
+        LL::ThreadPool pool("parallelfor", 3);
+        pool.start();
+        slices.clear();
+        LL::parallelFor("parallelfor", 15, 10, record);
+        ensure_equals("small", slices.size(), 1);
+
+        slices.clear();
+        LL::parallelFor("parallelfor", 0, 10, record);
+        ensure("empty", slices.empty());
+        pool.close();
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("exceptions come back to the caller");
+        LL::ThreadPool pool("parallelfor", 3);
+        pool.start();
+        std::atomic<U32> done{ 0 };
+        bool caught = false;
+        try
+        {
+            LL::parallelFor("parallelfor", 400, 100,
+                            [&done](size_t begin, size_t end)
+                            {
+                                if (begin == 0)
+                                {
+                                    throw std::runtime_error("first slice");
+                                }
+                                ++done;
+                            });
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        ensure("caught", caught);
+        // the other slices still ran to the end before parallelFor() returned
+        ensure_equals("others done", done.load(), 3);
+        pool.close();
+    }
+}
@@ -0,0 +1,261 @@
+/**
+ * @file   threadpool_test.cpp
+ * @date   2024-05-02
+ * @brief  Test for ThreadPool with a shared WorkQueue and with a
+ *         WorkStealingQueue, plus an opt-in throughput and latency
+ *         comparison of the two.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "threadpool.h"
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <vector>
+// std headers
+#include <chrono>
+#include <iostream>
+#include <thread>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "llstring.h"
+#include "stringize.h"
+
+using namespace LL;
+using namespace std::literals::chrono_literals; // ms suffix
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Just enough work per task that the queue, rather than the task, is
+    // what we're measuring.
+    U32 spin(U32 seed)
+    {
+        for (U32 i = 0; i < 64; ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+        }
+        return seed;
+    }
+
+    struct BenchmarkResult
+    {
+        F64 mTasksPerSecond{ 0 };
+        F64 mMedianUsec{ 0 };
+        F64 mP99Usec{ 0 };
+        F64 mP999Usec{ 0 };
+    };
+
+    /**
+     * Post (producers * tasks_per_producer) short tasks to a pool of
+     * workers threads, from producers threads at once, and time how long
+     * the pool takes to run them all and how long each one waited.
+     */
+    template <class POOL>
+    BenchmarkResult benchmark(const std::string& name, size_t workers,
+                              size_t producers, size_t tasks_per_producer)
+    {
+        const size_t total = producers * tasks_per_producer;
+        std::vector<F64> latency(total);
+        std::atomic<size_t> remaining{ total };
+        std::atomic<U32> sink{ 0 };
+
+        POOL pool(name, workers);
+        pool.start();
+
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back(
+                [&, p]()
+                {
+                    for (size_t i = 0; i < tasks_per_producer; ++i)
+                    {
+                        size_t index = p * tasks_per_producer + i;
+                        auto posted = Clock::now();
+                        pool.getQueue().post(
+                            [&, index, posted]()
+                            {
+                                latency[index] = std::chrono::duration<F64, std::micro>(
+                                    Clock::now() - posted).count();
+                                sink += spin((U32)index);
+                                --remaining;
+                            });
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        while (remaining)
+        {
+            std::this_thread::yield();
+        }
+        F64 elapsed = std::chrono::duration<F64>(Clock::now() - start).count();
+        pool.close();
+
+        std::sort(latency.begin(), latency.end());
+        BenchmarkResult result;
+        result.mTasksPerSecond = total / elapsed;
+        result.mMedianUsec = latency[total / 2];
+        result.mP99Usec = latency[total * 99 / 100];
+        result.mP999Usec = latency[total * 999 / 1000];
+        return result;
+    }
+
+    std::ostream& operator<<(std::ostream& out, const BenchmarkResult& result)
+    {
+        return out << (U64)result.mTasksPerSecond << " tasks/s, latency median "
+                   << result.mMedianUsec << " us, p99 " << result.mP99Usec
+                   << " us, p99.9 " << result.mP999Usec << " us";
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct threadpool_data
+    {
+    };
+    typedef test_group<threadpool_data> threadpool_group;
+    typedef threadpool_group::object object;
+    threadpool_group threadpoolgrp("threadpool");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("work stealing pool runs everything");
+        std::atomic<U32> count{ 0 };
+        ThreadPoolUsing<WorkStealingQueue> pool("stealing", 4);
+        ensure_equals("width", pool.getWidth(), 0);
+        pool.start();
+        ensure_equals("width", pool.getWidth(), 4);
+        for (U32 i = 0; i < 10000; ++i)
+        {
+            ensure("post", pool.getQueue().post([&count](){ ++count; }));
+        }
+        // close() drains the queue before the workers quit
+        pool.close();
+        ensure_equals("ran", count.load(), 10000);
+        ensure("done", pool.getQueue().done());
+        ensure("post after close", ! pool.getQueue().post([](){}));
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("work posted by workers");
+        std::atomic<U32> count{ 0 };
+        std::atomic<U32> remaining{ 0 };
+        ThreadPoolUsing<WorkStealingQueue> pool("fanout", 4);
+        auto& queue = pool.getQueue();
+        // each task posts two children until depth runs out: all the work
+        // after the first item is generated on worker threads
+        std::function<void(U32)> fanout = [&](U32 depth)
+        {
+            ++count;
+            if (depth)
+            {
+                remaining += 2;
+                queue.post([&fanout, depth](){ fanout(depth - 1); });
+                queue.post([&fanout, depth](){ fanout(depth - 1); });
+            }
+            --remaining;
+        };
+        pool.start();
+        ++remaining;
+        queue.post([&fanout](){ fanout(12); });
+        for (auto finish = Clock::now() + 10s; remaining && Clock::now() < finish; )
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+        pool.close();
+        ensure_equals("ran", count.load(), (1 << 13) - 1);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("capacity and close");
+        U32 count = 0;
+        WorkStealingQueue queue("capacity", 2, 4);
+        for (U32 i = 0; i < 4; ++i)
+        {
+            ensure(stringize("tryPost ", i), queue.tryPost([&count](){ ++count; }));
+        }
+        ensure("tryPost when full", ! queue.tryPost([&count](){ ++count; }));
+        ensure_equals("size", queue.size(), 4);
+        ensure("runPending", queue.runPending());
+        ensure_equals("ran", count, 4);
+        ensure_equals("drained", queue.size(), 0);
+
+        queue.post([&count](){ ++count; });
+        queue.close();
+        ensure("closed", queue.isClosed());
+        ensure("not done", ! queue.done());
+        ensure("post after close", ! queue.post([&count](){ ++count; }));
+        // like WorkQueue, work posted before close() still runs
+        queue.runUntilClose();
+        ensure_equals("ran after close", count, 5);
+        ensure("done", queue.done());
+    }
+
+    // Not a regression test: compares throughput and tail latency of the
+    // shared WorkQueue with the WorkStealingQueue and prints the result.
+    // Takes a while, so it only runs with LL_THREADPOOL_BENCHMARK set.
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("shared queue vs. work stealing");
+        if (LLStringUtil::getenv("LL_THREADPOOL_BENCHMARK").empty())
+        {
+            skip("set LL_THREADPOOL_BENCHMARK to run the benchmark");
+        }
+        // the shapes of the "ImageDecode" and "General" pools
+        const size_t widths[] = { 8, 3 };
+        for (size_t workers : widths)
+        {
+            for (size_t producers : { 1, 4 })
+            {
+                const size_t tasks = 400000 / producers;
+                auto shared{ benchmark<ThreadPool>(
+                    stringize("shared", workers, producers), workers, producers, tasks) };
+                auto stealing{ benchmark<ThreadPoolUsing<WorkStealingQueue>>(
+                    stringize("stealing", workers, producers), workers, producers, tasks) };
+                std::cout << "\n" << workers << " workers, " << producers << " producers:\n"
+                          << "  WorkQueue:         " << shared << "\n"
+                          << "  WorkStealingQueue: " << stealing << std::endl;
+            }
+        }
+    }
+} // namespace tut
@@ -134,47 +134,73 @@ void LL::ThreadPoolBase::run()
     mQueue->runUntilClose();
 }
 
-//static
-size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t dft)
+// <FS:Perf> Work stealing queue mode: share the lookup of per-pool settings
+namespace
 {
-    LLSD poolSizes;
-    try
+    LLSD getPoolSetting(const std::string& setting, const std::string& name, bool warn)
     {
-        poolSizes = LL::CommonControl::get("Global", "ThreadPoolSizes");
-        // "ThreadPoolSizes" is actually a map containing the sizes of
-        // interest -- or should be, if this process has an
-        // LLViewerControlListener instance and its settings include
-        // "ThreadPoolSizes". If we failed to retrieve it, perhaps we're in a
-        // program that doesn't define that, or perhaps there's no such
-        // setting, or perhaps we're asking too early, before the LLEventAPI
-        // itself has been instantiated. In any of those cases, it seems worth
-        // warning.
-        if (! poolSizes.isDefined())
+        LLSD poolSettings;
+        try
         {
-            // Note: we don't warn about absence of an override key for a
-            // particular ThreadPool name, that's fine. This warning is about
-            // complete absence of a ThreadPoolSizes setting, which we expect
-            // in a normal viewer session.
-            LL_WARNS("ThreadPool") << "No 'ThreadPoolSizes' setting for ThreadPool '"
-                                   << name << "'" << LL_ENDL;
+            poolSettings = LL::CommonControl::get("Global", setting);
+            // "ThreadPoolSizes" is actually a map containing the sizes of
+            // interest -- or should be, if this process has an
+            // LLViewerControlListener instance and its settings include
+            // "ThreadPoolSizes". If we failed to retrieve it, perhaps we're in a
+            // program that doesn't define that, or perhaps there's no such
+            // setting, or perhaps we're asking too early, before the LLEventAPI
+            // itself has been instantiated. In any of those cases, it seems worth
+            // warning.
+            if (warn && ! poolSettings.isDefined())
+            {
+                // Note: we don't warn about absence of an override key for a
+                // particular ThreadPool name, that's fine. This warning is about
+                // complete absence of a ThreadPoolSizes setting, which we expect
+                // in a normal viewer session.
+                LL_WARNS("ThreadPool") << "No '" << setting << "' setting for ThreadPool '"
+                                       << name << "'" << LL_ENDL;
+            }
         }
+        catch (const LL::CommonControl::Error& exc)
+        {
+            // We don't want ThreadPool to *require* LLViewerControlListener.
+            // Just log it and carry on.
+            if (warn)
+            {
+                LL_WARNS("ThreadPool") << "Can't check '" << setting << "': " << exc.what() << LL_ENDL;
+            }
+        }
+
+        LL_DEBUGS("ThreadPool") << setting << " = " << poolSettings << LL_ENDL;
+        // LLSD treats an undefined value as an empty map when asked to retrieve a
+        // key, so we don't need this to be conditional.
+        return poolSettings[name];
     }
-    catch (const LL::CommonControl::Error& exc)
-    {
-        // We don't want ThreadPool to *require* LLViewerControlListener.
-        // Just log it and carry on.
-        LL_WARNS("ThreadPool") << "Can't check 'ThreadPoolSizes': " << exc.what() << LL_ENDL;
-    }
+}
+// </FS:Perf>
 
-    LL_DEBUGS("ThreadPool") << "ThreadPoolSizes = " << poolSizes << LL_ENDL;
-    // LLSD treats an undefined value as an empty map when asked to retrieve a
-    // key, so we don't need this to be conditional.
-    LLSD sizeSpec{ poolSizes[name] };
+//static
+size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t dft)
+{
+    // <FS:Perf> Work stealing queue mode
+    LLSD sizeSpec{ getPoolSetting("ThreadPoolSizes", name, true) };
+    // </FS:Perf>
     // We retrieve sizeSpec as LLSD, rather than immediately as LLSD::Integer,
     // so we can distinguish the case when it's undefined.
     return sizeSpec.isInteger() ? sizeSpec.asInteger() : dft;
 }
 
+// <FS:Perf> Work stealing queue mode
+//static
+bool LL::ThreadPoolBase::getConfiguredWorkStealing(const std::string& name, bool dft)
+{
+    // Unlike "ThreadPoolSizes", this setting is optional: don't warn if
+    // it's missing.
+    LLSD modeSpec{ getPoolSetting("ThreadPoolWorkStealing", name, false) };
+    return modeSpec.isBoolean() ? modeSpec.asBoolean() : dft;
+}
+// </FS:Perf>
+
 //static
 size_t LL::ThreadPoolBase::getWidth(const std::string& name, size_t dft)
 {
@@ -18,6 +18,7 @@
 #include <memory>                   // std::unique_ptr
 #include <string>
 #include <thread>
+#include <type_traits>              // std::is_same
 #include <utility>                  // std::pair
 #include <vector>
 
@@ -77,6 +78,16 @@ namespace LL
         static
         size_t getConfiguredWidth(const std::string& name, size_t dft=0);
 
+        // <FS:Perf> Work stealing queue mode
+        /**
+         * getConfiguredWorkStealing() returns the setting, if any, for the
+         * specified ThreadPool name in the "ThreadPoolWorkStealing" LLSD
+         * map. Returns dft if the map does not contain the specified name.
+         */
+        static
+        bool getConfiguredWorkStealing(const std::string& name, bool dft=false);
+        // </FS:Perf>
+
         /**
          * This getWidth() returns the width of the instantiated ThreadPool
          * with the specified name, if any. If no instance exists, returns its
@@ -120,9 +131,16 @@ namespace LL
          * Pass an explicit capacity to limit the size of the queue.
          * Constraining the queue can cause a submitter to block. Do not
          * constrain any ThreadPool accepting work from the main thread.
+         *
+         * <FS:Perf> A ThreadPool using WorkQueue gets a WorkStealingQueue
+         * instead if the "ThreadPoolWorkStealing" setting says so for this
+         * ThreadPool name. </FS:Perf>
          */
         ThreadPoolUsing(const std::string& name, size_t threads=1, size_t capacity=1024*1024):
-            ThreadPoolBase(name, threads, new queue_t(name, capacity))
+            // <FS:Perf> Work stealing queue mode
+            //ThreadPoolBase(name, threads, new queue_t(name, capacity))
+            ThreadPoolBase(name, threads, makeQueue(name, threads, capacity))
+            // </FS:Perf>
         {}
         ~ThreadPoolUsing() override {}
 
@@ -131,6 +149,29 @@ namespace LL
          * post work to it
          */
         queue_t& getQueue() { return static_cast<queue_t&>(*mQueue); }
+
+    // <FS:Perf> Work stealing queue mode
+    private:
+        static WorkQueueBase* makeQueue(const std::string& name, size_t threads, size_t capacity)
+        {
+            if constexpr (std::is_same<queue_t, WorkStealingQueue>::value)
+            {
+                // one lane per worker thread
+                return new WorkStealingQueue(name, getConfiguredWidth(name, threads), capacity);
+            }
+            else
+            {
+                if constexpr (std::is_same<queue_t, WorkQueue>::value)
+                {
+                    if (getConfiguredWorkStealing(name))
+                    {
+                        return new WorkStealingQueue(name, getConfiguredWidth(name, threads), capacity);
+                    }
+                }
+                return new queue_t(name, capacity);
+            }
+        }
+    // </FS:Perf>
     };
 
     /// ThreadPool is shorthand for using the simpler WorkQueue
@@ -15,6 +15,7 @@
 #include "workqueue.h"
 // STL headers
 // std headers
+#include <algorithm>                // std::max
 // external library headers
 // other Linden headers
 #include "llcoros.h"
@@ -181,6 +182,213 @@ bool LL::WorkQueue::tryPop_(Work& work)
     return mQueue.tryPop(work);
 }
 
+// <FS:Perf> Work stealing queue mode for ThreadPool
+/*****************************************************************************
+*   WorkStealingQueue
+*****************************************************************************/
+namespace
+{
+    // Never reused, unlike the address of a destroyed queue
+    std::atomic<U64> sNextGeneration{ 0 };
+
+    // The WorkStealingQueue this thread last consumed from, by generation,
+    // and its lane in that queue. sLaneWorker is set once the thread blocks
+    // in pop_(), i.e. it is one of the queue's worker threads.
+    thread_local U64 sLaneGeneration = 0;
+    thread_local size_t sLane = 0;
+    thread_local bool sLaneWorker = false;
+}
+
+LL::WorkStealingQueue::WorkStealingQueue(const std::string& name, size_t width, size_t capacity):
+    super(name, capacity),
+    mWidth(std::max(width, size_t(1))),
+    mCapacity(capacity),
+    mLanes(new Lane[mWidth]),
+    mGeneration(++sNextGeneration)
+{
+}
+
+void LL::WorkStealingQueue::close()
+{
+    mClosed = true;
+    {
+        // Anyone about to wait has either seen mClosed or is waiting now.
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+    mWorkAvailable.notify_all();
+    mSpaceAvailable.notify_all();
+}
+
+size_t LL::WorkStealingQueue::size()
+{
+    return mSize;
+}
+
+bool LL::WorkStealingQueue::isClosed()
+{
+    return mClosed;
+}
+
+bool LL::WorkStealingQueue::done()
+{
+    return mClosed && ! mSize;
+}
+
+bool LL::WorkStealingQueue::post(const Work& callable)
+{
+    return push_(callable, true);
+}
+
+bool LL::WorkStealingQueue::tryPost(const Work& callable)
+{
+    return push_(callable, false);
+}
+
+bool LL::WorkStealingQueue::push_(const Work& work, bool block)
+{
+    // Reserve room for the new item before it shows up in a lane, so that
+    // mSize never undercounts what a consumer can find.
+    size_t size = mSize;
+    for (;;)
+    {
+        if (mClosed)
+        {
+            return false;
+        }
+        if (size < mCapacity)
+        {
+            if (mSize.compare_exchange_weak(size, size + 1))
+            {
+                break;
+            }
+            continue;
+        }
+        if (! block)
+        {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        ++mBlockedProducers;
+        mSpaceAvailable.wait(lock, [this]{ return mClosed || mSize < mCapacity; });
+        --mBlockedProducers;
+        size = mSize;
+    }
+
+    // A worker thread keeps the work it generates in its own lane, anyone
+    // else -- including a thread that only polls with tryPop() -- deals it
+    // out.
+    size_t index = (sLaneGeneration == mGeneration && sLaneWorker)? sLane : (mNextLane++ % mWidth);
+    Lane& lane = mLanes[index];
+    {
+        std::lock_guard<std::mutex> lock(lane.mMutex);
+        lane.mWork.push_back(work);
+        ++lane.mPending;
+    }
+    ++mQueued;
+
+    // mQueued was bumped before we looked at mIdleConsumers, and a consumer
+    // bumps mIdleConsumers before it looks at mQueued: so either it sees our
+    // item, or we see it and wake it.
+    if (mIdleConsumers)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+        }
+        mWorkAvailable.notify_one();
+    }
+    return true;
+}
+
+size_t LL::WorkStealingQueue::getLane()
+{
+    if (sLaneGeneration != mGeneration)
+    {
+        sLaneGeneration = mGeneration;
+        sLane = mNextConsumer++ % mWidth;
+        sLaneWorker = false;
+    }
+    return sLane;
+}
+
+bool LL::WorkStealingQueue::take_(Work& work, bool block)
+{
+    if (! mQueued)
+    {
+        return false;
+    }
+
+    size_t home = getLane();
+    for (size_t i = 0; i < mWidth; ++i)
+    {
+        Lane& lane = mLanes[(home + i) % mWidth];
+        if (! lane.mPending)
+        {
+            continue;
+        }
+        // Block on our own lane, but don't queue up behind another thread
+        // for a lane we're only stealing from unless told to.
+        std::unique_lock<std::mutex> lock(lane.mMutex, std::defer_lock);
+        if (i == 0 || block)
+        {
+            lock.lock();
+        }
+        else if (! lock.try_lock())
+        {
+            continue;
+        }
+
+        if (! lane.mWork.empty())
+        {
+            work = std::move(lane.mWork.front());
+            lane.mWork.pop_front();
+            --lane.mPending;
+            --mQueued;
+            lock.unlock();
+
+            --mSize;
+            if (mBlockedProducers)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mSleepMutex);
+                }
+                mSpaceAvailable.notify_one();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+LL::WorkQueue::Work LL::WorkStealingQueue::pop_()
+{
+    getLane();
+    sLaneWorker = true;
+
+    Work work;
+    // A lane we skipped because it was busy gets waited for on the second
+    // try, so we only sleep when every lane really was empty.
+    while (! take_(work) && ! take_(work, true))
+    {
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        if (mClosed && ! mSize)
+        {
+            LLTHROW(Closed());
+        }
+        // Work that was counted in mSize but not yet pushed to a lane wakes
+        // us when it lands.
+        ++mIdleConsumers;
+        mWorkAvailable.wait(lock, [this]{ return mClosed || mQueued; });
+        --mIdleConsumers;
+    }
+    return work;
+}
+
+bool LL::WorkStealingQueue::tryPop_(Work& work)
+{
+    return take_(work);
+}
+// </FS:Perf>
+
 /*****************************************************************************
 *   WorkSchedule
 *****************************************************************************/
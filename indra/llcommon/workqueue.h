@@ -17,9 +17,14 @@
 #include "llinstancetracker.h"
 #include "llinstancetrackersubclass.h"
 #include "threadsafeschedule.h"
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <exception>                // std::current_exception
 #include <functional>               // std::function
+#include <memory>                   // std::unique_ptr
+#include <mutex>
 #include <string>
 
 namespace LL
@@ -262,6 +267,92 @@ namespace LL
         bool tryPop_(Work&) override;
     };
 
+// <FS:Perf> Work stealing queue mode for ThreadPool
+/*****************************************************************************
+*   WorkStealingQueue: per-consumer lanes instead of one shared queue
+*****************************************************************************/
+    /**
+     * WorkStealingQueue spreads posted work over one lane per consumer
+     * thread, each with its own lock, so that many consumers pulling many
+     * short tasks don't all serialize on a single queue lock. A consumer
+     * takes work from its own lane first and steals from the other lanes
+     * when its own lane runs dry. Work posted by a consumer thread goes to
+     * that thread's lane; work posted by any other thread is dealt out to
+     * the lanes round-robin.
+     *
+     * Tasks are only run in posting order within a lane: with more than one
+     * consumer, there is no overall ordering guarantee -- but there is none
+     * for a WorkQueue serviced by several threads either.
+     *
+     * WorkStealingQueue is-a WorkQueue so that a ThreadPool configured for
+     * work stealing can hand it out from getQueue() unchanged.
+     */
+    class WorkStealingQueue: public LLInstanceTrackerSubclass<WorkStealingQueue, WorkQueue>
+    {
+    private:
+        using super = LLInstanceTrackerSubclass<WorkStealingQueue, WorkQueue>;
+
+    public:
+        /**
+         * width is the number of lanes, normally the number of threads
+         * that will service this queue. capacity limits the total number
+         * of pending work items across all lanes.
+         */
+        WorkStealingQueue(const std::string& name, size_t width, size_t capacity=1024);
+
+        void close() override;
+        size_t size() override;
+        bool isClosed() override;
+        bool done() override;
+
+        bool post(const Work&) override;
+        bool tryPost(const Work&) override;
+
+    private:
+        // keep each lane's lock on its own cache line
+        struct alignas(64) Lane
+        {
+            std::mutex mMutex;
+            std::deque<Work> mWork;
+            // mWork.size(), readable without mMutex so thieves can skip
+            // empty lanes
+            std::atomic<size_t> mPending{ 0 };
+        };
+
+        bool push_(const Work& work, bool block);
+        // With block, wait for busy lanes instead of skipping them
+        bool take_(Work& work, bool block=false);
+        size_t getLane();
+
+        Work pop_() override;
+        bool tryPop_(Work&) override;
+
+        const size_t mWidth;
+        const size_t mCapacity;
+        std::unique_ptr<Lane[]> mLanes;
+        // identifies this queue in the per-thread lane cache
+        const U64 mGeneration;
+        // next lane for work posted by a thread with no lane of its own
+        std::atomic<size_t> mNextLane{ 0 };
+        // next lane to hand to a thread that starts consuming
+        std::atomic<size_t> mNextConsumer{ 0 };
+        // pending work items, counted before they're pushed to a lane and
+        // after they're taken off one
+        std::atomic<size_t> mSize{ 0 };
+        // work items actually sitting in a lane
+        std::atomic<size_t> mQueued{ 0 };
+        std::atomic<bool> mClosed{ false };
+        // Consumers waiting in pop_() and producers waiting in post() for
+        // a full queue. Only when there are any does anyone have to take
+        // mSleepMutex.
+        std::atomic<size_t> mIdleConsumers{ 0 };
+        std::atomic<size_t> mBlockedProducers{ 0 };
+        std::mutex mSleepMutex;
+        std::condition_variable mWorkAvailable;
+        std::condition_variable mSpaceAvailable;
+    };
+// </FS:Perf>
+
 /*****************************************************************************
 *   WorkSchedule: add support for timestamped tasks
 *****************************************************************************/
@@ -153,6 +153,13 @@ const int HTTP_CONNECTION_LIMIT_MAX = 256;
 const long HTTP_PIPELINING_DEFAULT = 0L;
 const long HTTP_PIPELINING_MAX = 20L;
 
+const long HTTP_HTTP2_MULTIPLEXING_DEFAULT = 0L;		// <FS:Perf/> HTTP/2 multiplexing
+
+// <FS:Perf> Zero-copy access.  Largest Content-Length we trust enough
+// to allocate up front for HttpOptions::setContiguousBody().
+const size_t HTTP_CONTIGUOUS_BODY_MAX = 64U * 1024U * 1024U;
+// </FS:Perf>
+
 // Miscellaneous defaults
 const bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 const long HTTP_THROTTLE_RATE_DEFAULT = 0L;
@@ -163,6 +170,12 @@ const long HTTP_THROTTLE_RATE_DEFAULT = 0L;
 // request, ready and active queues.
 const int HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS = 2;
 
+// <FS:Perf> Longest time worker thread waits for socket activity
+// when it only has requests in flight.  New requests and libcurl's
+// own timers end the wait earlier.
+const int HTTP_SERVICE_LOOP_WAIT_MAX_MS = 100;
+// </FS:Perf>
+
 // Block allocation size (a tuning parameter) is found
 // in bufferarray.h.
 
@@ -30,8 +30,12 @@
 #include "bufferarray.h"
 #include "_httpoprequest.h"
 #include "_httppolicy.h"
+#include "httpstats.h" // <FS:Perf/> HTTP/2 multiplexing
 
 #include "llhttpconstants.h"
+#include "lltimer.h" // <FS:Perf/> ms_sleep
+
+#include <algorithm> // <FS:Perf/> std::min
 
 namespace
 {
@@ -49,6 +53,10 @@ void check_curl_multi_setopt(CURLM* handle, CURLMoption option, ARG argument)
     check_curl_multi_code(code, option);
 }
 
+// <FS:Perf> Event-driven service loop
+bool append_wait_fds(CURLM * multi_handle, std::vector<curl_waitfd> & fds);
+// </FS:Perf>
+
 static const char * const LOG_CORE("CoreHttp");
 
 } // end anonymous namespace
@@ -64,7 +72,9 @@ HttpLibcurl::HttpLibcurl(HttpService * service)
 	  mPolicyCount(0),
 	  mMultiHandles(NULL),
 	  mActiveHandles(NULL),
-	  mDirtyPolicy(NULL)
+	  mDirtyPolicy(NULL),
+	  mWaitHandle(NULL),			// <FS:Perf/> Event-driven service loop
+	  mRequestsCompleted(false)		// <FS:Perf/> Event-driven service loop
 {}
 
 
@@ -72,6 +82,14 @@ HttpLibcurl::~HttpLibcurl()
 {
 	shutdown();
 
+	// <FS:Perf> Event-driven service loop
+	if (mWaitHandle)
+	{
+		curl_multi_cleanup(mWaitHandle);
+		mWaitHandle = NULL;
+	}
+	// </FS:Perf>
+
 	mService = NULL;
 }
 
@@ -133,6 +151,15 @@ void HttpLibcurl::start(int policy_count)
 		mDirtyPolicy[policy_class] = false;
 		policyUpdated(policy_class);
 	}
+
+	// <FS:Perf> Event-driven service loop.  Kept over shutdown() and
+	// restarts as other threads may call wakeup() at any time.
+	if (! mWaitHandle && NULL == (mWaitHandle = curl_multi_init()))
+	{
+		LL_WARNS(LOG_CORE) << "Failed to allocate wait handle in libcurl, falling back to sleeps."
+						   << LL_ENDL;
+	}
+	// </FS:Perf>
 }
 
 
@@ -190,6 +217,7 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 
                     completeRequest(mMultiHandles[policy_class], handle, result);
                     handle = NULL;					// No longer valid on return
+                    mRequestsCompleted = true;		// <FS:Perf/> Event-driven service loop
                     ret = HttpService::NORMAL;		// If anything completes, we may have a free slot.
                                                     // Turning around quickly reduces connection gap by 7-10mS.
                 }
@@ -217,6 +245,82 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 }
 
 
+// <FS:Perf> Event-driven service loop
+void HttpLibcurl::waitForActivity(int timeout_ms)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+	if (mRequestsCompleted)
+	{
+		// Completions free up connections.  Go straight back to the
+		// policy layer so it can hand out the slots before we sleep.
+		mRequestsCompleted = false;
+		return;
+	}
+
+#if ! LLCORE_HTTP_MULTI_POLL
+	// Nothing can interrupt the wait, so keep it to the old loop sleep
+	timeout_ms = (std::min)(timeout_ms, HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+#endif
+
+	mWaitFds.clear();
+	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
+	{
+		if (! mMultiHandles[policy_class] || ! mActiveHandles[policy_class])
+		{
+			continue;
+		}
+
+		long curl_timeout(-1L);
+		check_curl_multi_code(curl_multi_timeout(mMultiHandles[policy_class], &curl_timeout));
+		if (curl_timeout >= 0L)
+		{
+			timeout_ms = (std::min)(timeout_ms, int(curl_timeout));
+		}
+		if (! append_wait_fds(mMultiHandles[policy_class], mWaitFds))
+		{
+			// Busy without a socket to show for it (name lookups or a
+			// descriptor beyond FD_SETSIZE).  Poll the old way.
+			timeout_ms = (std::min)(timeout_ms, HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+		}
+	}
+
+	if (timeout_ms <= 0)
+	{
+		return;
+	}
+	if (! mWaitHandle)
+	{
+		ms_sleep(timeout_ms);
+		return;
+	}
+
+	curl_waitfd * wait_fds(mWaitFds.empty() ? NULL : &mWaitFds[0]);
+#if LLCORE_HTTP_MULTI_POLL
+	check_curl_multi_code(curl_multi_poll(mWaitHandle, wait_fds, unsigned(mWaitFds.size()), timeout_ms, NULL));
+#else
+	if (! wait_fds)
+	{
+		// curl_multi_wait() returns at once when there is nothing to wait on
+		ms_sleep(timeout_ms);
+		return;
+	}
+	check_curl_multi_code(curl_multi_wait(mWaitHandle, wait_fds, unsigned(mWaitFds.size()), timeout_ms, NULL));
+#endif
+}
+
+
+void HttpLibcurl::wakeup()
+{
+#if LLCORE_HTTP_MULTI_POLL
+	if (mWaitHandle)
+	{
+		check_curl_multi_code(curl_multi_wakeup(mWaitHandle));
+	}
+#endif
+}
+// </FS:Perf>
+
+
 // Caller has provided us with a ref count on op.
 void HttpLibcurl::addOp(const HttpOpRequest::ptr_t &op)
 {
@@ -409,6 +513,21 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
         }
 	}
 
+	// <FS:Perf> HTTP/2 multiplexing: note how the transfer was carried
+	bool multiplexed(false);
+	if (handle)
+	{
+		long new_connections(0L);
+		curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections);
+#if LIBCURL_VERSION_NUM >= 0x073200
+		long http_version(CURL_HTTP_VERSION_NONE);
+		curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &http_version);
+		multiplexed = (CURL_HTTP_VERSION_2_0 == http_version);
+#endif
+		HTTPStats::instance().recordTransfer(op->mReqPolicy, multiplexed, new_connections);
+	}
+	// </FS:Perf>
+
 	// <FS:ND> See if the requested URL matches a X-LL-URL header (if present) and the requested range.
 	// If not, we assume http pipelining havng gone out of sync. If yes, yield a 503 status and switch
 	// pipelining off.
@@ -445,7 +564,10 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
 			bFailed = true;
 		}
 	}
-	if( bFailed )
+	// <FS:Perf> HTTP/2 streams can't get out of sync, pipelining isn't to blame
+	//if( bFailed )
+	if( bFailed && ! multiplexed )
+	// </FS:Perf>
 	{
 		HttpPolicy & policy(mService->getPolicy());
 		for( int i = 0; i < mPolicyCount; ++ i )
@@ -541,12 +663,17 @@ void HttpLibcurl::policyUpdated(int policy_class)
 		policy.stallPolicy(policy_class, false);
 		mDirtyPolicy[policy_class] = false;
 
+		// <FS:Perf> HTTP/2 multiplexing.  HTTP/1.1 servers keep the
+		// pipelining and connection limits set below.
+		const long multiplex(options.mHttp2Multiplexing ? long(CURLPIPE_MULTIPLEX) : long(CURLPIPE_NOTHING));
+		// </FS:Perf>
+
 		if (options.mPipelining > 1)
 		{
 			// We'll try to do pipelining on this multihandle
 			check_curl_multi_setopt(multi_handle,
 									 CURLMOPT_PIPELINING,
-									 1L);
+									 long(CURLPIPE_HTTP1) | multiplex);		// <FS:Perf/> was 1L
 			check_curl_multi_setopt(multi_handle,
 									 CURLMOPT_MAX_PIPELINE_LENGTH,
 									 long(options.mPipelining));
@@ -561,7 +688,7 @@ void HttpLibcurl::policyUpdated(int policy_class)
 		{
 			check_curl_multi_setopt(multi_handle,
 									 CURLMOPT_PIPELINING,
-									 0L);
+									 multiplex);		// <FS:Perf/> was 0L
 			check_curl_multi_setopt(multi_handle,
 									 CURLMOPT_MAX_HOST_CONNECTIONS,
 									 0L);
@@ -708,4 +835,67 @@ void check_curl_multi_code(CURLMcode code)
 	}
 }
 
+
+// <FS:Perf> Event-driven service loop
+// Add the sockets libcurl wants watched for one multi handle to @fds.
+// Returns false when libcurl has none it can report.
+bool append_wait_fds(CURLM * multi_handle, std::vector<curl_waitfd> & fds)
+{
+	fd_set read_fds, write_fds, exc_fds;
+	FD_ZERO(&read_fds);
+	FD_ZERO(&write_fds);
+	FD_ZERO(&exc_fds);
+	int max_fd(-1);
+	check_curl_multi_code(curl_multi_fdset(multi_handle, &read_fds, &write_fds, &exc_fds, &max_fd));
+	if (max_fd < 0)
+	{
+		return false;
+	}
+
+#if LL_WINDOWS
+	// Winsock fd_sets are lists of sockets rather than bitmaps
+	const struct
+	{
+		const fd_set &	mSet;
+		short			mEvents;
+	} sets[] = {
+		{ read_fds, CURL_WAIT_POLLIN },
+		{ write_fds, CURL_WAIT_POLLOUT },
+		{ exc_fds, CURL_WAIT_POLLPRI }
+	};
+	for (const auto & set : sets)
+	{
+		for (u_int i(0); i < set.mSet.fd_count; ++i)
+		{
+			curl_waitfd wait_fd = { set.mSet.fd_array[i], set.mEvents, 0 };
+			fds.push_back(wait_fd);
+		}
+	}
+#else
+	for (int fd(0); fd <= max_fd; ++fd)
+	{
+		short events(0);
+		if (FD_ISSET(fd, &read_fds))
+		{
+			events |= CURL_WAIT_POLLIN;
+		}
+		if (FD_ISSET(fd, &write_fds))
+		{
+			events |= CURL_WAIT_POLLOUT;
+		}
+		if (FD_ISSET(fd, &exc_fds))
+		{
+			events |= CURL_WAIT_POLLPRI;
+		}
+		if (events)
+		{
+			curl_waitfd wait_fd = { fd, events, 0 };
+			fds.push_back(wait_fd);
+		}
+	}
+#endif
+	return true;
+}
+// </FS:Perf>
+
 }  // end anonymous namespace
@@ -33,12 +33,24 @@
 #include <curl/multi.h>
 
 #include <set>
+#include <vector> // <FS:Perf/> Event-driven service loop
 
 #include "httprequest.h"
 #include "_httpservice.h"
 #include "_httpinternal.h"
 
 
+// <FS:Perf> Event-driven service loop.  curl_multi_poll() and
+// curl_multi_wakeup() arrived in libcurl 7.68.0.  Older libraries fall
+// back to curl_multi_wait() which can't be interrupted by new requests.
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define LLCORE_HTTP_MULTI_POLL 1
+#else
+#define LLCORE_HTTP_MULTI_POLL 0
+#endif
+// </FS:Perf>
+
+
 namespace LLCore
 {
 
@@ -77,6 +89,25 @@ public:
 	/// Threading:  called by worker thread.
 	HttpService::ELoopSpeed processTransport();
 
+	// <FS:Perf> Event-driven service loop
+	/// Sleep until a socket of an active request becomes ready, one
+	/// of libcurl's own timers expires, wakeup() is called or
+	/// @timeout_ms milliseconds pass, whichever comes first.  Without
+	/// curl_multi_wakeup() (see LLCORE_HTTP_MULTI_POLL) the wait is
+	/// never longer than HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS so that new
+	/// requests are still picked up in good time.
+	///
+	/// Threading:  called by worker thread.
+	void waitForActivity(int timeout_ms);
+
+	/// Cut a waitForActivity() short, or the next one if no thread is
+	/// waiting right now.  Does nothing without curl_multi_wakeup().
+	///
+	/// Threading:  callable by any thread between start() and
+	/// destruction.
+	void wakeup();
+	// </FS:Perf>
+
 	/// Add request to the active list.  Caller is expected to have
 	/// provided us with a reference count on the op to hold the
 	/// request.  (No additional references will be added.)
@@ -215,6 +246,11 @@ protected:
 	CURLM **			mMultiHandles;		// One handle per policy class
 	int *				mActiveHandles;		// Active count per policy class
 	bool *				mDirtyPolicy;		// Dirty policy update waiting for stall (per pc)
+	// <FS:Perf> Event-driven service loop
+	CURLM *				mWaitHandle;		// Multi handle without requests, used for waiting and wakeups
+	std::vector<curl_waitfd> mWaitFds;		// Sockets of all policy classes, rebuilt on each wait
+	bool				mRequestsCompleted;	// Requests completed since the last wait
+	// </FS:Perf>
 	
 }; // end class HttpLibcurl
 
@@ -763,6 +763,15 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 /******************************/
 		check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
 	}
+	// <FS:Perf> HTTP/2 multiplexing.  Ask for HTTP/2 over TLS and wait
+	// for a stream on a connection that is being set up in preference to
+	// opening another one.
+	if (cpolicy.mHttp2Multiplexing)
+	{
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+	}
+	// </FS:Perf>
 	// *DEBUG:  Enable following override for timeout handling and "[curl:bugs] #1420" tests
     //if (cpolicy.mPipelining)
     //{
@@ -802,6 +811,20 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
 	if (! op->mReplyBody)
 	{
 		op->mReplyBody = new BufferArray();
+
+		// <FS:Perf> Zero-copy access.  Headers are in by the first write
+		// so the announced length, if any, is known.
+		if (op->mReqOptions && op->mReqOptions->getContiguousBody() && op->mCurlHandle)
+		{
+			double content_length(-1.0);
+			if (CURLE_OK == curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &content_length)
+				&& content_length > 0.0
+				&& content_length <= double(HTTP_CONTIGUOUS_BODY_MAX))
+			{
+				op->mReplyBody->reserveContiguous(size_t(content_length));
+			}
+		}
+		// </FS:Perf>
 	}
 	const size_t req_size(size * nmemb);
 	const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
@@ -37,7 +37,8 @@ HttpPolicyClass::HttpPolicyClass()
 	: mConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
 	  mPerHostConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
 	  mPipelining(HTTP_PIPELINING_DEFAULT),
-	  mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT)
+	  mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT),
+	  mHttp2Multiplexing(HTTP_HTTP2_MULTIPLEXING_DEFAULT)		// <FS:Perf/> HTTP/2 multiplexing
 {}
 
 
@@ -53,6 +54,7 @@ HttpPolicyClass & HttpPolicyClass::operator=(const HttpPolicyClass & other)
 		mPerHostConnectionLimit = other.mPerHostConnectionLimit;
 		mPipelining = other.mPipelining;
 		mThrottleRate = other.mThrottleRate;
+		mHttp2Multiplexing = other.mHttp2Multiplexing;		// <FS:Perf/> HTTP/2 multiplexing
 	}
 	return *this;
 }
@@ -62,7 +64,8 @@ HttpPolicyClass::HttpPolicyClass(const HttpPolicyClass & other)
 	: mConnectionLimit(other.mConnectionLimit),
 	  mPerHostConnectionLimit(other.mPerHostConnectionLimit),
 	  mPipelining(other.mPipelining),
-	  mThrottleRate(other.mThrottleRate)
+	  mThrottleRate(other.mThrottleRate),
+	  mHttp2Multiplexing(other.mHttp2Multiplexing)			// <FS:Perf/> HTTP/2 multiplexing
 {}
 
 
@@ -86,6 +89,12 @@ HttpStatus HttpPolicyClass::set(HttpRequest::EPolicyOption opt, long value)
 		mThrottleRate = llclamp(value, 0L, 1000000L);
 		break;
 
+	// <FS:Perf> HTTP/2 multiplexing
+	case HttpRequest::PO_HTTP2_MULTIPLEXING:
+		mHttp2Multiplexing = (value ? 1L : 0L);
+		break;
+	// </FS:Perf>
+
 	default:
 		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
@@ -114,6 +123,12 @@ HttpStatus HttpPolicyClass::get(HttpRequest::EPolicyOption opt, long * value) co
 		*value = mThrottleRate;
 		break;
 
+	// <FS:Perf> HTTP/2 multiplexing
+	case HttpRequest::PO_HTTP2_MULTIPLEXING:
+		*value = mHttp2Multiplexing;
+		break;
+	// </FS:Perf>
+
 	default:
 		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
@@ -64,6 +64,7 @@ public:
 	long						mPerHostConnectionLimit;
 	long						mPipelining;
 	long						mThrottleRate;
+	long						mHttp2Multiplexing;		// <FS:Perf/> HTTP/2 multiplexing
 };  // end class HttpPolicyClass
 
 }  // end namespace LLCore
@@ -81,6 +81,12 @@ HttpStatus HttpRequestQueue::addOp(const HttpRequestQueue::opPtr_t &op)
 		}
 		wake = mQueue.empty();
 		mQueue.push_back(op);
+		// <FS:Perf> Event-driven service loop
+		if (wake && mWaker)
+		{
+			mWaker();
+		}
+		// </FS:Perf>
 	}
 	if (wake)
 	{
@@ -139,7 +145,23 @@ void HttpRequestQueue::fetchAll(bool wait, OpContainer & ops)
 void HttpRequestQueue::wakeAll()
 {
 	mQueueCV.notify_all();
+	// <FS:Perf> Event-driven service loop
+	HttpScopedLock lock(mQueueMutex);
+	if (mWaker)
+	{
+		mWaker();
+	}
+	// </FS:Perf>
+}
+
+
+// <FS:Perf> Event-driven service loop
+void HttpRequestQueue::setWaker(const waker_t & waker)
+{
+	HttpScopedLock lock(mQueueMutex);
+	mWaker = waker;
 }
+// </FS:Perf>
 
 
 bool HttpRequestQueue::stopQueue()
@@ -147,14 +169,25 @@ bool HttpRequestQueue::stopQueue()
 	{
 		HttpScopedLock lock(mQueueMutex);
 
-        if (!mQueueStopped)
+        // <FS:Perf> Event-driven service loop: wakeAll() takes the lock
+        // itself now, so wake the sleepers directly.
+        //if (!mQueueStopped)
+        //{
+        //    mQueueStopped = true;
+        //    wakeAll();
+        //    return true;
+        //}
+        //wakeAll();
+        //return false;
+        const bool stopped(! mQueueStopped);
+        mQueueStopped = true;
+        mQueueCV.notify_all();
+        if (mWaker)
         {
-            mQueueStopped = true;
-            wakeAll();
-            return true;
+            mWaker();
         }
-        wakeAll();
-        return false;
+        return stopped;
+        // </FS:Perf>
 	}
 }
 
@@ -30,6 +30,8 @@
 
 #include <vector>
 
+#include <boost/function.hpp> // <FS:Perf/> Waker
+
 #include "httpcommon.h"
 #include "_refcounted.h"
 #include "_mutex.h"
@@ -125,6 +127,20 @@ public:
 	///
 	/// Threading:  callable by any thread.
 	bool stopQueue();
+
+	// <FS:Perf> Event-driven service loop
+	typedef boost::function<void()> waker_t;
+
+	/// Install a functor that is called, in addition to the condition
+	/// variable notification, whenever the queue goes from empty to
+	/// non-empty or is stopped.  Lets the worker thread sleep somewhere
+	/// other than in @fetchAll, e.g. in a socket poll.  The functor is
+	/// run with the queue lock held so it must be quick and must not
+	/// call back into the queue.  Pass an empty functor to remove it.
+	///
+	/// Threading:  callable by any thread.
+	void setWaker(const waker_t & waker);
+	// </FS:Perf>
 	
 protected:
 	static HttpRequestQueue *			sInstance;
@@ -134,6 +150,7 @@ protected:
 	LLCoreInt::HttpMutex				mQueueMutex;
 	LLCoreInt::HttpConditionVariable	mQueueCV;
 	bool								mQueueStopped;
+	waker_t								mWaker;				// <FS:Perf/> Event-driven service loop
 	
 }; // end class HttpRequestQueue
 
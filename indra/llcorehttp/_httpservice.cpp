@@ -63,7 +63,8 @@ const HttpService::OptionDescriptor HttpService::sOptionDesc[] =
 	{	true,		true,		true,		false,		false	},		// PO_TRACE
 	{	true,		true,		false,		true,		false	},		// PO_ENABLE_PIPELINING
 	{	true,		true,		false,		true,		false	},		// PO_THROTTLE_RATE
-	{   false,		false,		true,		false,		true	}		// PO_SSL_VERIFY_CALLBACK
+	{   false,		false,		true,		false,		true	},		// PO_SSL_VERIFY_CALLBACK
+	{	true,		true,		false,		true,		false	}		// PO_HTTP2_MULTIPLEXING <FS:Perf/>
 };
 HttpService * HttpService::sInstance(NULL);
 volatile HttpService::EState HttpService::sState(NOT_INITIALIZED);
@@ -112,6 +113,7 @@ HttpService::~HttpService()
 	
 	if (mRequestQueue)
 	{
+		mRequestQueue->setWaker(HttpRequestQueue::waker_t());	// <FS:Perf/> Event-driven service loop
 		mRequestQueue->release();
 		mRequestQueue = NULL;
 	}
@@ -212,6 +214,11 @@ void HttpService::startThread()
 	mPolicy->start();
 	mTransport->start(mLastPolicy + 1);
 
+	// <FS:Perf> Event-driven service loop: new requests end the
+	// transport's socket wait.
+	mRequestQueue->setWaker(boost::bind(&HttpLibcurl::wakeup, mTransport));
+	// </FS:Perf>
+
 	mThread = new LLCoreInt::HttpThread(boost::bind(&HttpService::threadRun, this, _1));
 	sState = RUNNING;
 }
@@ -256,6 +263,7 @@ void HttpService::shutdown()
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
 	// Disallow future enqueue of requests
 	mRequestQueue->stopQueue();
+	mRequestQueue->setWaker(HttpRequestQueue::waker_t());	// <FS:Perf/> Event-driven service loop
 
 	// Cancel requests already on the request queue
 	HttpRequestQueue::OpContainer ops;
@@ -278,9 +286,9 @@ void HttpService::shutdown()
 
 // Working thread loop-forever method.  Gives time to
 // each of the request queue, policy layer and transport
-// layer pieces and then either sleeps for a small time
-// or waits for a request to come in.  Repeats until
-// requested to stop.
+// layer pieces and then either waits for socket activity
+// or a new request, or waits for a request to come in.
+// Repeats until requested to stop.
 void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 {
     LL_PROFILER_SET_THREAD_NAME("HttpService");
@@ -300,6 +308,7 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 		    // Process ready queue issuing new requests as needed
 		    ELoopSpeed new_loop = mPolicy->processReadyQueue();
 		    loop = (std::min)(loop, new_loop);
+		    const ELoopSpeed policy_loop(new_loop);		// <FS:Perf/> Event-driven service loop
 		
 		    // Give libcurl some cycles
 		    new_loop = mTransport->processTransport();
@@ -308,7 +317,15 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 		    // Determine whether to spin, sleep briefly or sleep for next request
 		    if (REQUEST_SLEEP != loop)
 		    {
-			    ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			    // <FS:Perf> Event-driven service loop.  Sleep until a socket is
+			    // ready or a request comes in rather than for a fixed time.
+			    // Retries and throttles in the policy layer come due by the
+			    // clock, so keep the short sleep while they are waiting.
+			    //ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			    mTransport->waitForActivity(NORMAL == policy_loop
+											? HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS
+											: HTTP_SERVICE_LOOP_WAIT_MAX_MS);
+			    // </FS:Perf>
 		    }
         }
         catch (const LLContinueError&)
@@ -71,14 +71,29 @@ public:
 	// Only public entry to get a block.
 	static Block * alloc(size_t len);
 
+	// <FS:Perf> Block whose data lives in a separate 16-byte aligned
+	// allocation that can be handed over with detachData().  Returns
+	// NULL when out of memory.  Data isn't cleared.
+	static Block * allocAligned(size_t len);
+
+	void * detachData();
+	// </FS:Perf>
+
 public:
 	size_t mUsed;
 	size_t mAlloced;
 
+	// <FS:Perf> Zero-copy access.  Points at mInline or at the
+	// separate allocation of allocAligned().
+	char * mData;
+	bool mAligned;
+	// </FS:Perf>
+
 	// *NOTE:  Must be last member of the object.  We'll
 	// overallocate as requested via operator new and index
 	// into the array at will.
-	char mData[1];		
+	//char mData[1];		
+	char mInline[1];		// <FS:Perf/> Zero-copy access
 };
 
 
@@ -282,6 +297,81 @@ size_t BufferArray::write(size_t pos, const void * src, size_t len)
 }
 		
 
+// <FS:Perf> Zero-copy access
+size_t BufferArray::getSegments(size_t pos, size_t len, segments_t & segments)
+{
+	if (pos >= mLen)
+		return 0;
+	len = (std::min)(len, mLen - pos);
+
+	size_t result(0), offset(0);
+	const auto block_limit(mBlocks.size());
+	int block_start(findBlock(pos, &offset));
+	if (block_start < 0)
+		return 0;
+
+	while (len && block_start < block_limit)
+	{
+		Block & block(*mBlocks[block_start]);
+		const size_t block_len((std::min)(block.mUsed - offset, len));
+		if (block_len)
+		{
+			Segment segment = { &block.mData[offset], block_len };
+			segments.push_back(segment);
+		}
+		result += block_len;
+		len -= block_len;
+		offset = 0;
+		++block_start;
+	}
+	return result;
+}
+
+
+char * BufferArray::getContiguous(size_t pos, size_t len)
+{
+	if (pos >= mLen || len > mLen - pos)
+		return NULL;
+
+	size_t offset(0);
+	int block(findBlock(pos, &offset));
+	if (block < 0 || len > mBlocks[block]->mUsed - offset)
+		return NULL;
+
+	return &mBlocks[block]->mData[offset];
+}
+
+
+bool BufferArray::reserveContiguous(size_t len)
+{
+	if (! mBlocks.empty() || ! len)
+		return false;
+
+	Block * block(Block::allocAligned(len));
+	if (! block)
+	{
+		LL_WARNS() << "Unable to reserve " << len << " contiguous bytes for BufferArray" << LL_ENDL;
+		return false;
+	}
+	mBlocks.push_back(block);
+	return true;
+}
+
+
+void * BufferArray::detachContiguous()
+{
+	if (mBlocks.size() != 1 || ! mBlocks[0]->mAligned)
+		return NULL;
+
+	void * data(mBlocks[0]->detachData());
+	delete mBlocks[0];
+	mBlocks.clear();
+	mLen = 0;
+	return data;
+}
+// </FS:Perf>
+
+
 int BufferArray::findBlock(size_t pos, size_t * ret_offset)
 {
 	*ret_offset = 0;
@@ -325,7 +415,9 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 
 BufferArray::Block::Block(size_t len)
 	: mUsed(0),
-	  mAlloced(len)
+	  mAlloced(len),
+	  mData(mInline),		// <FS:Perf/> Zero-copy access
+	  mAligned(false)		// <FS:Perf/> Zero-copy access
 {
 	memset(mData, 0, len);
 }
@@ -333,6 +425,13 @@ BufferArray::Block::Block(size_t len)
 
 BufferArray::Block::~Block()
 {
+	// <FS:Perf> Zero-copy access
+	if (mAligned)
+	{
+		ll_aligned_free_16(mData);
+	}
+	mData = NULL;
+	// </FS:Perf>
 	mUsed = 0;
 	mAlloced = 0;
 }
@@ -363,6 +462,34 @@ BufferArray::Block * BufferArray::Block::alloc(size_t len)
 	Block * block = new (len) Block(len);
 	return block;
 }
+
+
+// <FS:Perf> Zero-copy access
+BufferArray::Block * BufferArray::Block::allocAligned(size_t len)
+{
+	char * data(static_cast<char *>(ll_aligned_malloc_16(len)));
+	if (! data)
+	{
+		return NULL;
+	}
+	Block * block = new (0) Block(0);
+	block->mData = data;
+	block->mAligned = true;
+	block->mAlloced = len;
+	return block;
+}
+
+
+void * BufferArray::Block::detachData()
+{
+	void * data(mData);
+	mData = NULL;
+	mAligned = false;
+	mUsed = 0;
+	mAlloced = 0;
+	return data;
+}
+// </FS:Perf>
 	
 
 }  // end namespace LLCore
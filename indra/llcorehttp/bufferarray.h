@@ -120,6 +120,48 @@ public:
 	/// append data when current position is equal to the
 	/// size of the instance or do a mix of both.
 	size_t write(size_t pos, const void * src, size_t len);
+
+	// <FS:Perf> Zero-copy access
+	/// One contiguous run of bytes inside the instance, in the
+	/// manner of a struct iovec.
+	struct Segment
+	{
+		char *			mData;
+		size_t			mLen;
+	};
+	typedef std::vector<Segment> segments_t;
+
+	/// Describes the bytes starting at 'pos' as the runs of memory
+	/// that hold them, appending one Segment per block to 'segments'.
+	/// Nothing is copied.  Pointers stay valid until the instance is
+	/// modified or released.  Like @see read(), the result is short
+	/// if 'len' extends beyond the data.
+	///
+	/// @return			Count of bytes described
+	size_t getSegments(size_t pos, size_t len, segments_t & segments);
+
+	/// Pointer to the 'len' bytes starting at 'pos' if all of them
+	/// lie in a single block, NULL if they don't or aren't all there.
+	/// Same lifetime rules as @see getSegments().
+	char * getContiguous(size_t pos, size_t len);
+
+	/// On an empty instance, sets up a single 16-byte aligned
+	/// allocation of 'len' bytes that the following appends and
+	/// writes fill before anything else is allocated.  Used to
+	/// receive bodies of known length in one piece.
+	///
+	/// @return			False if not empty or out of memory
+	bool reserveContiguous(size_t len);
+
+	/// If all of the data is held in the allocation made by
+	/// @see reserveContiguous(), hands that allocation over to the
+	/// caller, who must release it with ll_aligned_free_16(), and
+	/// leaves the instance empty.  Returns NULL and changes nothing
+	/// otherwise.
+	///
+	/// @return			Data of size() bytes or NULL
+	void * detachContiguous();
+	// </FS:Perf>
 	
 protected:
 	int findBlock(size_t pos, size_t * ret_offset);
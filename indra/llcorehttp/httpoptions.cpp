@@ -48,7 +48,8 @@ HttpOptions::HttpOptions() :
     mVerifyHost(false),
     mDNSCacheTimeout(-1L),
     mNoBody(false),
-	mLastModified(0) // <FS:Ansariel> GetIfModified request
+	mLastModified(0), // <FS:Ansariel> GetIfModified request
+	mContiguousBody(false) // <FS:Perf/> Zero-copy access
 {}
 
 
@@ -135,6 +136,13 @@ void HttpOptions::setDefaultSSLVerifyPeer(bool verify)
     sDefaultVerifyPeer = verify;
 }
 
+// <FS:Perf> Zero-copy access
+void HttpOptions::setContiguousBody(bool contiguous)
+{
+	mContiguousBody = contiguous;
+}
+// </FS:Perf>
+
 // <FS:Ansariel> GetIfModified request
 void HttpOptions::setLastModified(long last_modified)
 {
@@ -185,6 +185,19 @@ public:
     /// NoVerifySSLCert
     static void         setDefaultSSLVerifyPeer(bool verify);
 
+	// <FS:Perf> Zero-copy access
+	/// Receive the response body into a single allocation when the
+	/// server announces its length, so that the consumer can use
+	/// BufferArray::getContiguous() or detachContiguous() instead of
+	/// copying it out with read().
+	/// Default: false
+	void				setContiguousBody(bool contiguous);
+	bool				getContiguousBody() const
+	{
+		return mContiguousBody;
+	}
+	// </FS:Perf>
+
 	// <FS:Ansariel> GetIfModified request
 	void                setLastModified(long last_modified);
 	long                getLastModified() const
@@ -211,6 +224,7 @@ protected:
     static bool         sDefaultVerifyPeer;
 
 	long				mLastModified; // <FS:Ansariel> GetIfModified request
+	bool				mContiguousBody; // <FS:Perf/> Zero-copy access
 }; // end class HttpOptions
 
 
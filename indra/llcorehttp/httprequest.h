@@ -232,6 +232,22 @@ public:
 		/// Global only
 		PO_SSL_VERIFY_CALLBACK,
 
+		// <FS:Perf> HTTP/2 multiplexing
+		/// If non-zero, requests in this class ask for HTTP/2
+		/// (negotiated during the TLS handshake, plain http:// stays
+		/// on HTTP/1.1) and libcurl multiplexes them as streams over
+		/// the connections it already has to the host.  New requests
+		/// wait for a stream on an existing connection rather than
+		/// opening another one, so a busy class typically needs a
+		/// single connection per host.  PO_CONNECTION_LIMIT still caps
+		/// the number of requests in flight.  PO_PER_HOST_CONNECTION_LIMIT
+		/// and PO_PIPELINING_DEPTH keep applying to servers that answer
+		/// in HTTP/1.1.  Zero, the default, turns it off.
+		///
+		/// Per-class only
+		PO_HTTP2_MULTIPLEXING,
+		// </FS:Perf>
+
 		PO_LAST  // Always at end
 	};
 
@@ -26,6 +26,8 @@
 
 #include "httpstats.h"
 #include "llerror.h"
+#include "httpcommon.h" // <FS:Perf/> HttpTime, for _httpinternal.h
+#include "_httpinternal.h" // <FS:Perf/> HTTP_POLICY_CLASS_LIMIT
 
 namespace LLCore
 {
@@ -45,6 +47,10 @@ void HTTPStats::resetStats()
     mDataDown.reset();
     mDataUp.reset();
     mRequests = 0;
+    // <FS:Perf> HTTP/2 multiplexing.  Sized once so the worker thread
+    // never reallocates it.
+    mClassStats.assign(HTTP_POLICY_CLASS_LIMIT, ClassStats());
+    // </FS:Perf>
 }
 
 
@@ -61,6 +67,23 @@ void HTTPStats::recordResultCode(S32 code)
 
 }
 
+// <FS:Perf> HTTP/2 multiplexing
+void HTTPStats::recordTransfer(S32 policy_class, bool multiplexed, long new_connections)
+{
+    if (policy_class < 0 || policy_class >= (S32)mClassStats.size())
+    {
+        return;
+    }
+    ClassStats & stats(mClassStats[policy_class]);
+    ++stats.mTransfers;
+    if (multiplexed)
+    {
+        ++stats.mStreams;
+    }
+    stats.mConnections += (S32)new_connections;
+}
+// </FS:Perf>
+
 namespace
 {
     std::string byte_count_converter(F32 bytes)
@@ -101,6 +124,19 @@ void HTTPStats::dumpStats()
         out << (*it).first << " " << (*it).second << std::endl;
     }
 
+    // <FS:Perf> HTTP/2 multiplexing
+    out << std::endl;
+    out << "Transfers per policy class:" << std::endl << "Class Transfers HTTP/2-Streams Connections" << std::endl;
+    for (size_t policy_class = 0; policy_class < mClassStats.size(); ++policy_class)
+    {
+        const ClassStats & stats(mClassStats[policy_class]);
+        if (stats.mTransfers)
+        {
+            out << policy_class << " " << stats.mTransfers << " " << stats.mStreams << " " << stats.mConnections << std::endl;
+        }
+    }
+    // </FS:Perf>
+
     LL_WARNS("HTTPCore") << out.str() << LL_ENDL;
 }
 
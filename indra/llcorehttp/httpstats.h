@@ -32,6 +32,7 @@
 #include "llstatsaccumulator.h"
 #include "llsingleton.h"
 #include "llsd.h"
+#include <vector> // <FS:Perf/> HTTP/2 multiplexing
 
 namespace LLCore
 {
@@ -59,6 +60,12 @@ namespace LLCore
 
         void    recordResultCode(S32 code);
 
+        // <FS:Perf> HTTP/2 multiplexing
+        // A finished transfer of a policy class, whether it was a stream
+        // on an HTTP/2 connection and how many connections it opened.
+        void    recordTransfer(S32 policy_class, bool multiplexed, long new_connections);
+        // </FS:Perf>
+
         void    dumpStats();
     private:
         StatsAccumulator mDataDown;
@@ -67,6 +74,16 @@ namespace LLCore
         S32              mRequests;
 
         std::map<S32, S32> mResutCodes;
+
+        // <FS:Perf> HTTP/2 multiplexing
+        struct ClassStats
+        {
+            S32          mTransfers = 0;
+            S32          mStreams = 0;              // transfers multiplexed over HTTP/2
+            S32          mConnections = 0;          // connections opened
+        };
+        std::vector<ClassStats> mClassStats;        // indexed by policy class, written by the worker thread
+        // </FS:Perf>
     };
 
 
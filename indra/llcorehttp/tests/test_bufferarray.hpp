@@ -374,6 +374,71 @@ void BufferArrayTestObjectType::test<8>()
 	ba->release();
 }
 
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+	set_test_name("BufferArray segments, contiguous reserve and detach");
+
+	// create a new ref counted object with an implicit reference
+	BufferArray * ba = new BufferArray();
+
+	// Spread data over three blocks
+	std::string str(2 * 65540 + 100, 'a');
+	for (size_t i(0); i < str.size(); ++i)
+	{
+		str[i] = char('a' + i % 26);
+	}
+	ba->append(str.data(), str.size());
+
+	BufferArray::segments_t segments;
+	size_t len(ba->getSegments(10, str.size(), segments));
+	ensure("Segments short at end of data", (str.size() - 10) == len);
+	ensure("Segment per block", segments.size() >= 2);
+	std::string gathered;
+	for (size_t i(0); i < segments.size(); ++i)
+	{
+		gathered.append(segments[i].mData, segments[i].mLen);
+	}
+	ensure("Segments describe the data", str.substr(10) == gathered);
+	ensure("Contiguous inside first block", NULL != ba->getContiguous(0, 100));
+	ensure("Contiguous content", 0 == strncmp(ba->getContiguous(5, 10), str.data() + 5, 10));
+	ensure("Not contiguous across blocks", NULL == ba->getContiguous(0, str.size()));
+	ensure("Not contiguous past end", NULL == ba->getContiguous(str.size() - 5, 10));
+	ensure("No reserve on non-empty", ! ba->reserveContiguous(100));
+	ensure("No detach of ordinary blocks", NULL == ba->detachContiguous());
+	ba->release();
+
+	// Reserved: all of the data lands in one aligned block
+	ba = new BufferArray();
+	ensure("Reserve on empty", ba->reserveContiguous(str.size()));
+	ensure("Reserve doesn't change size", 0 == ba->size());
+	ba->append(str.data(), 1000);
+	ba->append(str.data() + 1000, str.size() - 1000);
+	ensure("Size after appends", str.size() == ba->size());
+	char * data(ba->getContiguous(0, str.size()));
+	ensure("All of it contiguous", NULL != data);
+	ensure("Contiguous data aligned", 0 == (reinterpret_cast<uintptr_t>(data) & 0xf));
+	ensure("Contiguous data content", 0 == memcmp(data, str.data(), str.size()));
+
+	void * detached(ba->detachContiguous());
+	ensure("Detached the reserved data", data == detached);
+	ensure("Empty after detach", 0 == ba->size());
+	ll_aligned_free_16(detached);
+
+	// Reserved but overrun: falls back to more blocks
+	ensure("Reserve again", ba->reserveContiguous(10));
+	ba->append(str.data(), 20);
+	ensure("Size after overrun", 20 == ba->size());
+	ensure("Overrun not contiguous", NULL == ba->getContiguous(0, 20));
+	ensure("No detach after overrun", NULL == ba->detachContiguous());
+	char buffer[20];
+	ensure("Read after overrun", 20 == ba->read(0, buffer, sizeof(buffer)));
+	ensure("Content after overrun", 0 == memcmp(buffer, str.data(), sizeof(buffer)));
+
+	// release the implicit reference, causing the object to be released
+	ba->release();
+}
+
 }  // end namespace tut
 
 
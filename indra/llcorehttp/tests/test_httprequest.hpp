@@ -34,10 +34,15 @@
 #include "httpoptions.h"
 #include "_httpservice.h"
 #include "_httprequestqueue.h"
+#include "_httpinternal.h"
 
 #include <curl/curl.h>
 #include <boost/regex.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "llcorehttp_test.h"
 
@@ -3036,6 +3041,262 @@ void HttpRequestTestObjectType::test<23>()
 }
 
 
+namespace
+{
+	size_t discard_body(char *, size_t size, size_t nmemb, void *)
+	{
+		return size * nmemb;
+	}
+}
+
+// Issues one GET at a time against the test server, so each request finds
+// the service loop idle, and prints a histogram of the time from request to
+// completion. With the old fixed loop sleep every request waited out at
+// least one HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS pass; with the event-driven
+// loop the time to completion is bound by the round trip.
+template <> template <>
+void HttpRequestTestObjectType::test<24>()
+{
+	ScopedCurlInit ready;
+
+	std::string url_base(get_base_url());
+
+	set_test_name("HttpRequest GET latency with an idle service loop");
+
+	TestHandler2 handler(this, "handler");
+    LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+	mHandlerCalls = 0;
+
+	HttpRequest * req = NULL;
+
+	try
+	{
+		HttpRequest::createService();
+		HttpRequest::startThread();
+		req = new HttpRequest();
+
+		typedef std::chrono::steady_clock clock_t;
+
+		// Baseline: the same GETs made directly with libcurl, so the bound
+		// below scales with how fast the server and this machine are today.
+		const int baseline_count(50);
+		std::vector<double> baseline;
+		CURL * curl(curl_easy_init());
+		ensure("curl easy handle created", curl != NULL);
+		curl_easy_setopt(curl, CURLOPT_URL, url_base.c_str());
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard_body);
+		for (int i(0); i < baseline_count; ++i)
+		{
+			const clock_t::time_point start(clock_t::now());
+			const CURLcode result(curl_easy_perform(curl));
+			baseline.push_back(std::chrono::duration<double, std::micro>(clock_t::now() - start).count());
+			if (result != CURLE_OK)
+			{
+				curl_easy_cleanup(curl);
+				ensure("Baseline GET succeeded", false);
+			}
+		}
+		curl_easy_cleanup(curl);
+		std::nth_element(baseline.begin(), baseline.begin() + baseline_count / 2, baseline.end());
+		const double baseline_median(baseline[baseline_count / 2]);
+
+		const int request_count(200);
+		std::vector<double> latencies;
+		mStatus = HttpStatus(200);
+		for (int i(0); i < request_count; ++i)
+		{
+			const clock_t::time_point start(clock_t::now());
+			HttpHandle handle = req->requestGet(HttpRequest::DEFAULT_POLICY_ID,
+												url_base,
+												HttpOptions::ptr_t(),
+												HttpHeaders::ptr_t(),
+												handlerp);
+			ensure("Valid handle returned for request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+			// Pump hard so the consumer side adds as little as possible
+			const clock_t::time_point limit(start + std::chrono::seconds(30));
+			while (mHandlerCalls <= i && clock_t::now() < limit)
+			{
+				req->update(0);
+				usleep(50);
+			}
+			ensure("Request executed in reasonable time", mHandlerCalls == i + 1);
+			latencies.push_back(std::chrono::duration<double, std::micro>(clock_t::now() - start).count());
+		}
+
+		const double bounds[] = { 250.0, 500.0, 1000.0, 2000.0, 3000.0, 4000.0, 8000.0, 16000.0 };
+		const int bucket_count(sizeof(bounds) / sizeof(bounds[0]) + 1);
+		int buckets[bucket_count] = { 0 };
+		for (double latency : latencies)
+		{
+			buckets[std::upper_bound(bounds, bounds + bucket_count - 1, latency) - bounds]++;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		const double median(latencies[request_count / 2]);
+		std::cout << "\nGET latency over " << request_count << " requests, median "
+				  << int(median) << " us, p90 "
+				  << int(latencies[request_count * 9 / 10]) << " us, direct libcurl median "
+				  << int(baseline_median) << " us:" << std::endl;
+		for (int bucket(0); bucket < bucket_count; ++bucket)
+		{
+			std::ostringstream label;
+			if (bucket < bucket_count - 1)
+			{
+				label << "< " << int(bounds[bucket]) << " us";
+			}
+			else
+			{
+				label << ">= " << int(bounds[bucket - 1]) << " us";
+			}
+			std::cout << "  " << label.str() << std::string(12 - label.str().size(), ' ')
+					  << std::string(buckets[bucket] * 60 / request_count, '#')
+					  << " " << buckets[bucket] << std::endl;
+		}
+
+		// Only a gross regression fails: the service thread may double the
+		// direct round trip and still add a whole loop sleep on top. Medians
+		// keep the odd slow round trip on a busy machine out of it.
+		const double allowed(2.0 * baseline_median + HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS * 1000.0);
+		std::ostringstream message;
+		message << "Median GET latency " << int(median) << " us within " << int(allowed)
+				<< " us of a " << int(baseline_median) << " us direct round trip";
+		ensure(message.str(), median < allowed);
+
+		// Okay, request a shutdown of the servicing thread
+		mStatus = HttpStatus();
+		mHandlerCalls = 0;
+		HttpHandle handle = req->requestStopThread(handlerp);
+		ensure("Valid handle returned for stop request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+		int count(0);
+		int limit(LOOP_COUNT_LONG);
+		while (count++ < limit && mHandlerCalls < 1)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Stop request executed in reasonable time", count < limit);
+
+		count = 0;
+		limit = LOOP_COUNT_SHORT;
+		while (count++ < limit && ! HttpService::isStopped())
+		{
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Thread actually stopped running", HttpService::isStopped());
+
+		delete req;
+		req = NULL;
+
+		HttpRequest::destroyService();
+	}
+	catch (...)
+	{
+		stop_thread(req);
+		delete req;
+		HttpRequest::destroyService();
+		throw;
+	}
+}
+
+
+template <> template <>
+void HttpRequestTestObjectType::test<25>()
+{
+	ScopedCurlInit ready;
+
+	std::string url_base(get_base_url());
+
+	set_test_name("HttpRequest GETs in an HTTP/2 multiplexing class");
+
+	// The test server speaks HTTP/1.1 over plain http so this covers
+	// the fallback: the class must behave like any other.
+	TestHandler2 handler(this, "handler");
+    LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+	mHandlerCalls = 0;
+
+	HttpRequest * req = NULL;
+
+	try
+	{
+		HttpRequest::createService();
+
+		HttpRequest::policy_t policy(HttpRequest::createPolicyClass());
+		ensure("Policy class created", policy != HttpRequest::INVALID_POLICY_ID);
+
+		long value(0L);
+		HttpStatus status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_MULTIPLEXING,
+															   policy, 5L, &value);
+		ensure("Multiplexing accepted as a class option", bool(status));
+		ensure_equals("Multiplexing is a switch", value, 1L);
+		status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_MULTIPLEXING,
+													HttpRequest::GLOBAL_POLICY_ID, 1L, NULL);
+		ensure("Multiplexing refused as a global option", ! status);
+		HttpRequest::setStaticPolicyOption(HttpRequest::PO_CONNECTION_LIMIT, policy, 4L, NULL);
+
+		HttpRequest::startThread();
+		req = new HttpRequest();
+
+		const int request_count(10);
+		mStatus = HttpStatus(200);
+		for (int i(0); i < request_count; ++i)
+		{
+			HttpHandle handle = req->requestGet(policy,
+												url_base,
+												HttpOptions::ptr_t(),
+												HttpHeaders::ptr_t(),
+												handlerp);
+			ensure("Valid handle returned for request", handle != LLCORE_HTTP_HANDLE_INVALID);
+		}
+
+		int count(0);
+		int limit(LOOP_COUNT_LONG);
+		while (count++ < limit && mHandlerCalls < request_count)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Requests executed in reasonable time", count < limit);
+		ensure_equals("One handler invocation per request", mHandlerCalls, request_count);
+
+		// Okay, request a shutdown of the servicing thread
+		mStatus = HttpStatus();
+		mHandlerCalls = 0;
+		HttpHandle handle = req->requestStopThread(handlerp);
+		ensure("Valid handle returned for stop request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+		count = 0;
+		limit = LOOP_COUNT_LONG;
+		while (count++ < limit && mHandlerCalls < 1)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Stop request executed in reasonable time", count < limit);
+
+		count = 0;
+		limit = LOOP_COUNT_SHORT;
+		while (count++ < limit && ! HttpService::isStopped())
+		{
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Thread actually stopped running", HttpService::isStopped());
+
+		delete req;
+		req = NULL;
+
+		HttpRequest::destroyService();
+	}
+	catch (...)
+	{
+		stop_thread(req);
+		delete req;
+		HttpRequest::destroyService();
+		throw;
+	}
+}
+
+
 }  // end namespace tut
 
 namespace
@@ -151,6 +151,46 @@ void HttpRequestqueueTestObjectType::test<4>()
 	}
 }
 
+template <> template <>
+void HttpRequestqueueTestObjectType::test<5>()
+{
+	set_test_name("HttpRequestQueue waker");
+
+	HttpRequestQueue::init();
+
+	HttpRequestQueue * rq = HttpRequestQueue::instanceOf();
+	int wakes(0);
+	rq->setWaker([&wakes](){ ++wakes; });
+
+	HttpOperation::ptr_t op(new HttpOpNull());
+	rq->addOp(op);
+	ensure("Waker called when queue goes non-empty", 1 == wakes);
+
+	op.reset(new HttpOpNull());
+	rq->addOp(op);
+	ensure("Waker not called again for a non-empty queue", 1 == wakes);
+
+	{
+		HttpRequestQueue::OpContainer ops;
+		rq->fetchAll(false, ops);
+		ensure("Two come out", 2 == ops.size());
+	}
+
+	op.reset(new HttpOpNull());
+	rq->addOp(op);
+	ensure("Waker called again after queue was emptied", 2 == wakes);
+
+	rq->stopQueue();
+	ensure("Waker called on stop", 3 == wakes);
+
+	rq->setWaker(HttpRequestQueue::waker_t());
+	rq->wakeAll();
+	ensure("Removed waker not called", 3 == wakes);
+
+	op.reset();
+	HttpRequestQueue::term();
+}
+
 }  // end namespace tut
 
 
@@ -0,0 +1,603 @@
+/**
+ * @file llblobstore.cpp
+ * @brief Packed, memory-mapped asset store used by LLFileSystem.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llblobstore.h"
+#include "lldir.h"
+#include "llfile.h"
+
+#include <boost/filesystem.hpp>
+
+const U32 LLBlobStore::DEFAULT_SLAB_SIZE = 64 * 1024 * 1024;
+
+namespace
+{
+    const char* INDEX_FILENAME = "blobs.index";
+    const U32 INDEX_MAGIC = 0x424c4f42; // "BLOB"
+    const U32 INDEX_VERSION = 1;
+
+    // Removed blobs are journaled with this length
+    const U32 REMOVED_LENGTH = U32_MAX;
+
+    // On-disk journal record; written field by field so the layout does not
+    // depend on structure packing.
+    const size_t INDEX_RECORD_SIZE = UUID_BYTES + 3 * sizeof(U32);
+
+    // Slabs are never dropped below this count, so there is always room for
+    // the active slab and the one before it.
+    const U32 MIN_SLABS = 2;
+}
+
+LLBlobStore::LLBlobStore(const std::string& store_dir, const uintmax_t max_size_bytes, const U32 slab_size) :
+    mStoreDir(store_dir),
+    mIndexFile(nullptr),
+    mIndexRecords(0),
+    mMaxSizeBytes(max_size_bytes),
+    mSlabSize(slab_size),
+    mActiveSlab(0),
+    mActiveTail(0),
+    mLiveBytes(0),
+    mAccessClock(0)
+{
+    LLFile::mkdir(mStoreDir);
+    mIndexFilename = mStoreDir + gDirUtilp->getDirDelimiter() + INDEX_FILENAME;
+
+    LLMutexLock lock(&mMutex);
+    loadIndex();
+}
+
+LLBlobStore::~LLBlobStore()
+{
+    LLMutexLock lock(&mMutex);
+    writeIndexSnapshot();
+    if (mIndexFile)
+    {
+        fclose(mIndexFile);
+        mIndexFile = nullptr;
+    }
+    for (slab_map_t::value_type& slab : mSlabs)
+    {
+        slab.second.mFile->flush();
+    }
+}
+
+std::string LLBlobStore::slabFilename(U32 slab_id) const
+{
+    return mStoreDir + gDirUtilp->getDirDelimiter() + llformat("slab_%08u.dat", slab_id);
+}
+
+// Caller must hold mMutex
+LLBlobStore::Slab* LLBlobStore::openSlab(U32 slab_id, bool create)
+{
+    slab_map_t::iterator it = mSlabs.find(slab_id);
+    if (it != mSlabs.end())
+    {
+        return &it->second;
+    }
+
+    std::shared_ptr<LLMappedFile> file = std::make_shared<LLMappedFile>();
+    const bool exists = LLFile::isfile(slabFilename(slab_id));
+    if (!create && !exists)
+    {
+        return nullptr;
+    }
+    if (!file->open(slabFilename(slab_id), LLMappedFile::READ_WRITE, mSlabSize) || file->size() < mSlabSize)
+    {
+        LL_WARNS("BlobStore") << "Unable to map slab " << slabFilename(slab_id) << LL_ENDL;
+        if (!exists)
+        {
+            // Most likely out of disk space; don't leave a partial slab behind
+            file->close();
+            LLFile::remove(slabFilename(slab_id), ENOENT);
+        }
+        return nullptr;
+    }
+
+    Slab& slab = mSlabs[slab_id];
+    slab.mFile = file;
+    slab.mLastAccess = ++mAccessClock;
+    return &slab;
+}
+
+// Caller must hold mMutex
+bool LLBlobStore::reserve(U32 length, U32& slab_id, U32& offset)
+{
+    if (length > mSlabSize)
+    {
+        return false;
+    }
+
+    if (mSlabs.empty() || mActiveTail + length > mSlabSize)
+    {
+        U32 new_slab = mSlabs.empty() ? mActiveSlab + 1 : mSlabs.rbegin()->first + 1;
+        if (!openSlab(new_slab, true))
+        {
+            return false;
+        }
+        if (mSlabs.size() > 1)
+        {
+            // Let the OS write back the slab we just filled
+            mSlabs[mActiveSlab].mFile->flush();
+        }
+        mActiveSlab = new_slab;
+        mActiveTail = 0;
+
+        // Starting a new slab is the only way the store grows
+        dropColdSlabs();
+    }
+
+    slab_id = mActiveSlab;
+    offset = mActiveTail;
+    mActiveTail += length;
+    return true;
+}
+
+// Caller must hold mMutex
+void LLBlobStore::dropColdSlabs()
+{
+    while (mSlabs.size() > MIN_SLABS && (uintmax_t)mSlabs.size() * mSlabSize > mMaxSizeBytes)
+    {
+        // Drop the least recently used slab; the active one is never cold
+        slab_map_t::iterator coldest = mSlabs.end();
+        for (slab_map_t::iterator it = mSlabs.begin(); it != mSlabs.end(); ++it)
+        {
+            if (it->first != mActiveSlab && (coldest == mSlabs.end() || it->second.mLastAccess < coldest->second.mLastAccess))
+            {
+                coldest = it;
+            }
+        }
+        dropSlab(coldest->first);
+    }
+}
+
+// Caller must hold mMutex
+void LLBlobStore::dropSlab(U32 slab_id)
+{
+    for (blob_map_t::iterator it = mBlobs.begin(); it != mBlobs.end(); )
+    {
+        if (it->second.mSlab == slab_id)
+        {
+            mLiveBytes -= it->second.mLength;
+            appendIndexRecord(it->first, { slab_id, 0, REMOVED_LENGTH });
+            it = mBlobs.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Views handed out by getBlob() keep the mapping alive; the file itself
+    // can go away underneath them on every platform we support.
+    mSlabs.erase(slab_id);
+    LLFile::remove(slabFilename(slab_id), ENOENT);
+    LL_DEBUGS("BlobStore") << "Dropped slab " << slab_id << LL_ENDL;
+}
+
+// Caller must hold mMutex
+void LLBlobStore::eraseBlob(blob_map_t::iterator it)
+{
+    slab_map_t::iterator slab = mSlabs.find(it->second.mSlab);
+    if (slab != mSlabs.end())
+    {
+        slab->second.mLiveBytes -= it->second.mLength;
+    }
+    mLiveBytes -= it->second.mLength;
+    appendIndexRecord(it->first, { it->second.mSlab, 0, REMOVED_LENGTH });
+    mBlobs.erase(it);
+}
+
+bool LLBlobStore::getExists(const LLUUID& id)
+{
+    return getSize(id) > 0;
+}
+
+S32 LLBlobStore::getSize(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+    blob_map_t::const_iterator it = mBlobs.find(id);
+    return it != mBlobs.end() ? (S32)it->second.mLength : 0;
+}
+
+LLBlobStore::BlobView LLBlobStore::getBlob(const LLUUID& id)
+{
+    BlobView view;
+    LLMutexLock lock(&mMutex);
+    blob_map_t::const_iterator it = mBlobs.find(id);
+    if (it != mBlobs.end())
+    {
+        slab_map_t::iterator slab = mSlabs.find(it->second.mSlab);
+        if (slab != mSlabs.end())
+        {
+            slab->second.mLastAccess = ++mAccessClock;
+            view.mSlab = slab->second.mFile;
+            view.mData = view.mSlab->data() + it->second.mOffset;
+            view.mSize = (S32)it->second.mLength;
+        }
+    }
+    return view;
+}
+
+S32 LLBlobStore::read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes)
+{
+    // Published bytes are never rewritten (see write()), so the copy can
+    // run outside the lock without tearing.
+    BlobView view = getBlob(id);
+    if (!view.isValid() || offset < 0 || offset >= view.getSize() || bytes <= 0)
+    {
+        return 0;
+    }
+
+    S32 to_copy = llmin(bytes, view.getSize() - offset);
+    memcpy(buffer, view.getData() + offset, to_copy);
+    return to_copy;
+}
+
+bool LLBlobStore::write(const LLUUID& id, S32 offset, const U8* buffer, S32 bytes, bool truncate)
+{
+    if (offset < 0 || bytes < 0)
+    {
+        return false;
+    }
+
+    LLMutexLock lock(&mMutex);
+
+    blob_map_t::iterator it = mBlobs.find(id);
+    U32 old_length = (it != mBlobs.end()) ? it->second.mLength : 0;
+    const U64 end = (U64)offset + bytes;
+    const U64 new_length = truncate ? end : llmax((U64)old_length, end);
+    if (new_length > mSlabSize)
+    {
+        LL_WARNS("BlobStore") << "Blob " << id << " is too large for the store (" << new_length << " bytes)" << LL_ENDL;
+        return false;
+    }
+
+    // Bytes a reader may already see through a BlobView or read() are never
+    // touched: anything but a pure append to the last blob of the active
+    // slab writes a fresh copy and then swaps the index entry.
+    BlobLocation location;
+    if (it != mBlobs.end()
+        && it->second.mSlab == mActiveSlab
+        && it->second.mOffset + old_length == mActiveTail
+        && (U32)offset >= old_length
+        && it->second.mOffset + new_length <= mSlabSize)
+    {
+        // Last blob in the active slab: append in place
+        location = it->second;
+        mActiveTail = (U32)(location.mOffset + new_length);
+    }
+    else
+    {
+        const bool existed = (it != mBlobs.end());
+        if (!reserve((U32)new_length, location.mSlab, location.mOffset))
+        {
+            // reserve() may have dropped slabs before failing
+            flushIndex();
+            return false;
+        }
+        // reserve() may have dropped the slab holding the old copy
+        it = mBlobs.find(id);
+        if (it == mBlobs.end())
+        {
+            if (existed && offset > 0)
+            {
+                // The bytes in front of offset are gone; the blob already
+                // is too, so don't bring it back with a hole in it.
+                LL_DEBUGS("BlobStore") << "Blob " << id << " was purged while being written" << LL_ENDL;
+                flushIndex();
+                return false;
+            }
+            old_length = 0;
+        }
+        else
+        {
+            slab_map_t::iterator old_slab = mSlabs.find(it->second.mSlab);
+            if (old_slab != mSlabs.end())
+            {
+                // A truncating write still keeps what comes before offset
+                U64 keep = truncate ? llmin((U64)old_length, (U64)offset) : (U64)old_length;
+                memcpy(mSlabs[location.mSlab].mFile->data() + location.mOffset,
+                       old_slab->second.mFile->data() + it->second.mOffset,
+                       (size_t)keep);
+            }
+        }
+    }
+
+    Slab& slab = mSlabs[location.mSlab];
+    slab.mLastAccess = ++mAccessClock;
+    U8* base = slab.mFile->data() + location.mOffset;
+    if (offset > (S32)old_length)
+    {
+        // Writing past the end leaves a hole, like a sparse file would
+        memset(base + old_length, 0, offset - old_length);
+    }
+    memcpy(base + offset, buffer, bytes);
+
+    if (it != mBlobs.end())
+    {
+        mSlabs[it->second.mSlab].mLiveBytes -= it->second.mLength;
+        mLiveBytes -= it->second.mLength;
+    }
+    location.mLength = (U32)new_length;
+    mBlobs[id] = location;
+    mSlabs[location.mSlab].mLiveBytes += location.mLength;
+    mLiveBytes += location.mLength;
+    appendIndexRecord(id, location);
+    flushIndex();
+
+    return true;
+}
+
+bool LLBlobStore::rename(const LLUUID& old_id, const LLUUID& new_id)
+{
+    LLMutexLock lock(&mMutex);
+    blob_map_t::iterator it = mBlobs.find(old_id);
+    if (it == mBlobs.end())
+    {
+        return false;
+    }
+
+    BlobLocation location = it->second;
+    eraseBlob(it);
+
+    blob_map_t::iterator existing = mBlobs.find(new_id);
+    if (existing != mBlobs.end())
+    {
+        eraseBlob(existing);
+    }
+
+    mBlobs[new_id] = location;
+    mSlabs[location.mSlab].mLiveBytes += location.mLength;
+    mLiveBytes += location.mLength;
+    appendIndexRecord(new_id, location);
+    flushIndex();
+    return true;
+}
+
+bool LLBlobStore::remove(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+    blob_map_t::iterator it = mBlobs.find(id);
+    if (it == mBlobs.end())
+    {
+        return false;
+    }
+    eraseBlob(it);
+    flushIndex();
+    return true;
+}
+
+void LLBlobStore::purge()
+{
+    LLMutexLock lock(&mMutex);
+    dropColdSlabs();
+
+    // Keep the journal from growing without bound in long sessions
+    if (mIndexRecords > 2 * mBlobs.size() + 1024)
+    {
+        writeIndexSnapshot();
+    }
+    else
+    {
+        flushIndex();
+    }
+}
+
+void LLBlobStore::clear()
+{
+    LLMutexLock lock(&mMutex);
+    while (!mSlabs.empty())
+    {
+        dropSlab(mSlabs.begin()->first);
+    }
+    mBlobs.clear();
+    mLiveBytes = 0;
+    mActiveTail = 0;
+    writeIndexSnapshot();
+}
+
+uintmax_t LLBlobStore::getLiveBytes()
+{
+    LLMutexLock lock(&mMutex);
+    return mLiveBytes;
+}
+
+uintmax_t LLBlobStore::getSlabBytes()
+{
+    LLMutexLock lock(&mMutex);
+    return (uintmax_t)mSlabs.size() * mSlabSize;
+}
+
+void LLBlobStore::setMaxSizeBytes(uintmax_t size)
+{
+    LLMutexLock lock(&mMutex);
+    mMaxSizeBytes = size;
+}
+
+// Caller must hold mMutex
+void LLBlobStore::loadIndex()
+{
+    // Find the slabs on disk
+    boost::system::error_code ec;
+#if LL_WINDOWS
+    std::wstring store_path(utf8str_to_utf16str(mStoreDir));
+#else
+    std::string store_path(mStoreDir);
+#endif
+    if (boost::filesystem::is_directory(store_path, ec) && !ec.failed())
+    {
+        boost::filesystem::directory_iterator iter(store_path, ec);
+        while (iter != boost::filesystem::directory_iterator() && !ec.failed())
+        {
+            U32 slab_id = 0;
+            const std::string filename = (*iter).path().filename().string();
+            if (sscanf(filename.c_str(), "slab_%u.dat", &slab_id) == 1)
+            {
+                openSlab(slab_id, false);
+            }
+            iter.increment(ec);
+        }
+    }
+
+    // Replay the journal. Later records override earlier ones.
+    std::map<U32, U32> slab_tails;
+    LLFILE* index = LLFile::fopen(mIndexFilename, "rb");
+    if (index)
+    {
+        U32 header[2] = { 0, 0 };
+        if (fread(header, sizeof(U32), 2, index) == 2 && header[0] == INDEX_MAGIC && header[1] == INDEX_VERSION)
+        {
+            U8 record[INDEX_RECORD_SIZE];
+            while (fread(record, INDEX_RECORD_SIZE, 1, index) == 1)
+            {
+                LLUUID id;
+                BlobLocation location;
+                memcpy(id.mData, record, UUID_BYTES);
+                memcpy(&location.mSlab, record + UUID_BYTES, sizeof(U32));
+                memcpy(&location.mOffset, record + UUID_BYTES + sizeof(U32), sizeof(U32));
+                memcpy(&location.mLength, record + UUID_BYTES + 2 * sizeof(U32), sizeof(U32));
+
+                if (location.mLength == REMOVED_LENGTH)
+                {
+                    mBlobs.erase(id);
+                }
+                else if ((U64)location.mOffset + location.mLength <= mSlabSize)
+                {
+                    mBlobs[id] = location;
+                    U32& tail = slab_tails[location.mSlab];
+                    tail = llmax(tail, location.mOffset + location.mLength);
+                }
+            }
+        }
+        fclose(index);
+    }
+
+    // Drop blobs whose slab has gone
+    mLiveBytes = 0;
+    for (blob_map_t::iterator it = mBlobs.begin(); it != mBlobs.end(); )
+    {
+        slab_map_t::iterator slab = mSlabs.find(it->second.mSlab);
+        if (slab == mSlabs.end())
+        {
+            it = mBlobs.erase(it);
+        }
+        else
+        {
+            slab->second.mLiveBytes += it->second.mLength;
+            mLiveBytes += it->second.mLength;
+            ++it;
+        }
+    }
+
+    // Nothing has been read yet; fall back to dropping the oldest slabs first
+    for (slab_map_t::value_type& slab : mSlabs)
+    {
+        slab.second.mLastAccess = ++mAccessClock;
+    }
+
+    if (!mSlabs.empty())
+    {
+        mActiveSlab = mSlabs.rbegin()->first;
+        mActiveTail = slab_tails[mActiveSlab];
+    }
+
+    LL_INFOS("BlobStore") << "Loaded " << mBlobs.size() << " blobs (" << mLiveBytes << " bytes) in "
+                          << mSlabs.size() << " slabs from " << mStoreDir << LL_ENDL;
+
+    writeIndexSnapshot();
+}
+
+// Caller must hold mMutex
+void LLBlobStore::writeIndexSnapshot()
+{
+    if (mIndexFile)
+    {
+        fclose(mIndexFile);
+        mIndexFile = nullptr;
+    }
+
+    const std::string temp_filename = mIndexFilename + ".tmp";
+    mIndexFile = LLFile::fopen(temp_filename, "wb");
+    if (!mIndexFile)
+    {
+        LL_WARNS("BlobStore") << "Unable to write blob index " << temp_filename << LL_ENDL;
+        return;
+    }
+
+    U32 header[2] = { INDEX_MAGIC, INDEX_VERSION };
+    fwrite(header, sizeof(U32), 2, mIndexFile);
+    mIndexRecords = 0;
+    for (const blob_map_t::value_type& blob : mBlobs)
+    {
+        appendIndexRecord(blob.first, blob.second);
+    }
+    // The active slab tail is recovered from the largest blob end, so make
+    // sure a shrunk last blob does not let new data overwrite live bytes.
+    if (!mSlabs.empty() && mActiveTail > 0)
+    {
+        appendIndexRecord(LLUUID::null, { mActiveSlab, mActiveTail, 0 });
+        appendIndexRecord(LLUUID::null, { mActiveSlab, 0, REMOVED_LENGTH });
+    }
+    fclose(mIndexFile);
+    mIndexFile = nullptr;
+
+    LLFile::remove(mIndexFilename, ENOENT);
+    if (LLFile::rename(temp_filename, mIndexFilename) != 0)
+    {
+        LL_WARNS("BlobStore") << "Unable to replace blob index " << mIndexFilename << LL_ENDL;
+        return;
+    }
+    mIndexFile = LLFile::fopen(mIndexFilename, "ab");
+}
+
+// Caller must hold mMutex
+void LLBlobStore::appendIndexRecord(const LLUUID& id, const BlobLocation& location)
+{
+    if (!mIndexFile)
+    {
+        return;
+    }
+
+    U8 record[INDEX_RECORD_SIZE];
+    memcpy(record, id.mData, UUID_BYTES);
+    memcpy(record + UUID_BYTES, &location.mSlab, sizeof(U32));
+    memcpy(record + UUID_BYTES + sizeof(U32), &location.mOffset, sizeof(U32));
+    memcpy(record + UUID_BYTES + 2 * sizeof(U32), &location.mLength, sizeof(U32));
+    fwrite(record, INDEX_RECORD_SIZE, 1, mIndexFile);
+    ++mIndexRecords;
+}
+
+// Caller must hold mMutex. Called once per public call that changed the
+// index, so a crash loses at most the records of the call in flight.
+void LLBlobStore::flushIndex()
+{
+    if (mIndexFile)
+    {
+        fflush(mIndexFile);
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * @file llblobstore.h
+ * @brief Packed, memory-mapped asset store used by LLFileSystem.
+ *
+ * @Description:
+ * Instead of keeping every cached asset in a file of its own, the blob
+ * store appends assets to a small number of large "slab" files that are
+ * kept memory-mapped, and keeps an in-memory index of
+ * UUID -> (slab, offset, length). Opening, reading, renaming and removing
+ * an asset is then an index lookup plus a memcpy (or no copy at all when
+ * getBlob() is used) instead of a round of filesystem metadata operations.
+ *
+ * 1/ Slabs are fixed-size files named slab_<n>.dat. New data is always
+ *    appended to the newest slab; when it is full a new one is started.
+ * 2/ Rewriting or growing a blob that is not at the end of the newest
+ *    slab copies it to the end; the old bytes become garbage that is
+ *    reclaimed when the slab holding them is dropped.
+ * 3/ When the slabs use more than the configured maximum size, the oldest
+ *    slab is dropped as a whole together with every blob it holds.
+ * 4/ The index is persisted in an append-only binary journal
+ *    (blobs.index) that is replayed and compacted on startup.
+ *
+ * All public functions are thread safe.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLBLOBSTORE_H
+#define LL_LLBLOBSTORE_H
+
+#include "llsingleton.h"
+#include "llmappedfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+class LLBlobStore :
+    public LLParamSingleton<LLBlobStore>
+{
+public:
+    static const U32 DEFAULT_SLAB_SIZE;
+
+    LLSINGLETON(LLBlobStore,
+                /**
+                 * The folder holding the slab files and the index journal.
+                 * It is created if it does not exist.
+                 */
+                const std::string& store_dir,
+                /**
+                 * The maximum size of all slabs together in bytes.
+                 */
+                const uintmax_t max_size_bytes,
+                /**
+                 * Size of each slab file. A single blob can be no larger
+                 * than this.
+                 */
+                const U32 slab_size = DEFAULT_SLAB_SIZE);
+
+public:
+    ~LLBlobStore();
+
+    /**
+     * Read-only view of a stored blob. The slab holding the data stays
+     * mapped for as long as the view is alive, even if the blob is
+     * removed or its slab purged in the meantime.
+     */
+    class BlobView
+    {
+    public:
+        BlobView() : mData(nullptr), mSize(0) {}
+
+        bool isValid() const        { return mData != nullptr; }
+        const U8* getData() const   { return mData; }
+        S32 getSize() const         { return mSize; }
+
+    private:
+        friend class LLBlobStore;
+        std::shared_ptr<LLMappedFile> mSlab;
+        const U8* mData;
+        S32 mSize;
+    };
+
+    bool getExists(const LLUUID& id);
+
+    // Returns 0 if the blob does not exist
+    S32 getSize(const LLUUID& id);
+
+    // Zero-copy access to the bytes of a blob
+    BlobView getBlob(const LLUUID& id);
+
+    /**
+     * Copy up to bytes bytes starting at offset into buffer. Returns the
+     * number of bytes copied, 0 if the blob does not exist or offset is
+     * past its end.
+     */
+    S32 read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes);
+
+    /**
+     * Write bytes bytes at offset into the blob, creating it if needed.
+     * With truncate the blob ends up offset + bytes long, otherwise it
+     * only grows. Returns false if the resulting blob would not fit in a
+     * slab or the slab could not be created.
+     */
+    bool write(const LLUUID& id, S32 offset, const U8* buffer, S32 bytes, bool truncate);
+
+    // Only touches the index; the data is not moved
+    bool rename(const LLUUID& old_id, const LLUUID& new_id);
+    bool remove(const LLUUID& id);
+
+    // Drop the least recently used slabs until the store is within its
+    // maximum size
+    void purge();
+
+    // Remove every slab and blob
+    void clear();
+
+    // Sum of the sizes of all live blobs
+    uintmax_t getLiveBytes();
+
+    // Total size of the slab files
+    uintmax_t getSlabBytes();
+
+    U32 getSlabSize() const { return mSlabSize; }
+
+    void setMaxSizeBytes(uintmax_t size);
+
+private:
+    struct BlobLocation
+    {
+        U32 mSlab;
+        U32 mOffset;
+        U32 mLength;
+    };
+    typedef std::unordered_map<LLUUID, BlobLocation> blob_map_t;
+
+    struct Slab
+    {
+        std::shared_ptr<LLMappedFile> mFile;
+        U32 mLiveBytes{ 0 };
+        U64 mLastAccess{ 0 };   // mAccessClock when a blob in it was last read or written
+    };
+    typedef std::map<U32, Slab> slab_map_t;
+
+    std::string slabFilename(U32 slab_id) const;
+    Slab* openSlab(U32 slab_id, bool create);
+    bool reserve(U32 length, U32& slab_id, U32& offset);
+    void dropColdSlabs();
+    void dropSlab(U32 slab_id);
+    void eraseBlob(blob_map_t::iterator it);
+
+    void loadIndex();
+    void writeIndexSnapshot();
+    void appendIndexRecord(const LLUUID& id, const BlobLocation& location);
+    void flushIndex();
+
+    LLMutex mMutex;
+    std::string mStoreDir;
+    std::string mIndexFilename;
+    LLFILE* mIndexFile;
+    U32 mIndexRecords;
+    uintmax_t mMaxSizeBytes;
+    const U32 mSlabSize;
+
+    blob_map_t mBlobs;
+    slab_map_t mSlabs;
+    U32 mActiveSlab;        // slab new data is appended to
+    U32 mActiveTail;        // first free byte in mActiveSlab
+    uintmax_t mLiveBytes;
+    U64 mAccessClock;
+};
+
+#endif // LL_LLBLOBSTORE_H
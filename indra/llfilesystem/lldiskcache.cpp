@@ -38,10 +38,25 @@
 #include <chrono>
 
 #include "lldiskcache.h"
+#include "llblobstore.h" // <FS:Perf/> Packed blob store
 
 // <FS:Ansariel> Optimize asset simple disk cache
 static const char* subdirs = "0123456789abcdef";
 
+// <FS:Perf> Persistent LRU index of the cache contents
+namespace
+{
+    const char* INDEX_JOURNAL_FILENAME = "index.journal";
+    const char* INDEX_JOURNAL_HEADER = "LLDiskCacheIndex";
+    const S32 INDEX_JOURNAL_VERSION = 1;
+
+    // Access times are only written to the journal once they have moved by
+    // at least this much, for the same reason updateFileAccessTime() limits
+    // the rate it touches the file (SL-14582).
+    const std::time_t INDEX_JOURNAL_TIME_THRESHOLD = 1 * 60 * 60;
+}
+// </FS:Perf>
+
 LLDiskCache::LLDiskCache(const std::string cache_dir,
                          const uintmax_t max_size_bytes,
                          const bool enable_cache_debug_info
@@ -65,6 +80,10 @@ LLDiskCache::LLDiskCache(const std::string cache_dir,
         LLFile::mkdir(dirname);
     }
     // </FS:Ansariel>
+    // <FS:Perf> Persistent LRU index of the cache contents
+    mJournalFilename = cache_dir + gDirUtilp->getDirDelimiter() + INDEX_JOURNAL_FILENAME;
+    loadIndex();
+    // </FS:Perf>
     // <FS:Beq> add static assets into the new cache after clear.
     // Only missing entries are copied on init, skiplist is setup
     // For everything we populate FS specific assets to allow future updates
@@ -74,6 +93,7 @@ LLDiskCache::LLDiskCache(const std::string cache_dir,
 
 // WARNING: purge() is called by LLPurgeDiskCacheThread. As such it must
 // NOT touch any LLDiskCache data without introducing and locking a mutex!
+// <FS:Perf> The index data is guarded by mIndexMutex.
 
 // Interaction through the filesystem itself should be safe. Let’s say thread
 // A is accessing the cache file for reading/writing and thread B is trimming
@@ -102,29 +122,238 @@ LLDiskCache::LLDiskCache(const std::string cache_dir,
 // asset will have to be re-requested.
 void LLDiskCache::purge()
 {
-    if (mEnableCacheDebugInfo)
+    // <FS:Perf> Packed blob store
+    // Both backends share the one cache size setting; the files get
+    // whatever the slabs leave over.
+    uintmax_t max_size_bytes = mMaxSizeBytes;
+    if (LLBlobStore::instanceExists())
+    {
+        LLBlobStore::instance().purge();
+        const uintmax_t slab_bytes = LLBlobStore::instance().getSlabBytes();
+        max_size_bytes = (slab_bytes < max_size_bytes) ? max_size_bytes - slab_bytes : 0;
+    }
+    // </FS:Perf>
+
+    // <FS:Perf> Evict from the LRU index instead of scanning the whole cache directory
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    bool needs_rebuild = false;
+    {
+        LLMutexLock lock(&mIndexMutex);
+        needs_rebuild = mIndexNeedsRebuild;
+    }
+    if (needs_rebuild)
+    {
+        rebuildIndexFromDisk();
+    }
+
+    typedef std::pair<std::string, uintmax_t> victim_t;
+    std::vector<victim_t> victims;
+    uintmax_t file_size_total = 0;
+    uintmax_t deleted_size_total = 0;
+    size_t file_count = 0;
+    S32 skip = 0;
     {
-        LL_INFOS() << "Total dir size before purge is " << dirFileSize(mCacheDir) << LL_ENDL;
+        LLMutexLock lock(&mIndexMutex);
+        file_size_total = mIndexTotalBytes;
+        file_count = mIndex.size();
+
+        // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
+        LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/llmax(max_size_bytes, (uintmax_t)1)*100.0) << "% full" << LL_ENDL;
+        if( file_size_total < max_size_bytes * (mHighPercent/100) )
+        {
+            // Nothing to do here
+            LL_DEBUGS("LLDiskCache") << "Not exceded high water - do nothing" << LL_ENDL;
+            return;
+        }
+        // If we reach here we are above the trigger level so we must purge until we've removed enough to take us down to the low water mark.
+        auto target_size = (uintmax_t)(max_size_bytes * (mLowPercent/100));
+        LL_INFOS() << "Purging cache to a maximum of " << target_size << " bytes" << LL_ENDL;
+        // </FS:Beq>
+
+        // Oldest entries are at the front of the LRU list. Static assets
+        // are never purged; they are moved to the back so we only visit
+        // each of them once.
+        size_t visited = 0;
+        const size_t to_visit = mIndexLRU.size();
+        while (visited++ < to_visit && (file_size_total - deleted_size_total) > target_size)
+        {
+            const std::string key = *mIndexLRU.front();
+            index_map_t::iterator it = mIndex.find(key);
+
+            auto uuid_as_string = gDirUtilp->getBaseFileName(key, true);
+            if (uuid_as_string.size() > mCacheFilenamePrefix.size() + 1)
+            {
+                uuid_as_string = uuid_as_string.substr(mCacheFilenamePrefix.size() + 1, 36);// skip "sl_cache_" and trailing "_N"
+            }
+            if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
+            {
+                // this is one of our protected items so no purging
+                mIndexLRU.splice(mIndexLRU.end(), mIndexLRU, it->second.mLRUIter);
+                skip++;
+                continue;
+            }
+
+            deleted_size_total += it->second.mSize;
+            victims.emplace_back(pathFromIndexKey(key), it->second.mSize);
+            eraseIndexEntry(key);
+        }
     }
 
+    // Delete the files outside the lock so readers and writers are not held up
     boost::system::error_code ec;
+    for (const victim_t& victim : victims)
+    {
+        boost::filesystem::remove(victim.first, ec);
+        if (ec.failed())
+        {
+            LL_WARNS() << "Failed to delete cache file " << victim.first << ": " << ec.message() << LL_ENDL;
+        }
+        else if (mEnableCacheDebugInfo)
+        {
+            LL_INFOS("LLDiskCache") << "DELETE  " << victim.second << "  " << victim.first << LL_ENDL;
+        }
+    }
+
+    {
+        LLMutexLock lock(&mIndexMutex);
+        // Keep the journal from growing without bound in long sessions
+        if (mJournalRecords > 2 * mIndex.size() + 1024)
+        {
+            writeIndexSnapshot(false);
+        }
+        else if (mJournalFile)
+        {
+            fflush(mJournalFile);
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    auto newCacheSize = updateCacheSize(file_size_total - deleted_size_total);
+    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << file_count << " files" << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Deleted: " << victims.size() << " Skipped: " << skip << " Kept: " << file_count - victims.size() << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
+    LL_INFOS("LLDiskCache") << "Total of " << deleted_size_total << " bytes removed." << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
+    // </FS:Perf>
+}
+
+// <FS:Perf> Persistent LRU index of the cache contents
+std::string LLDiskCache::indexKeyFromPath(const std::string& file_path) const
+{
+    // Path relative to the cache dir, e.g. "a/sl_cache_a0..._0.asset"
+    if (file_path.size() > mCacheDir.size() + 1 && file_path.compare(0, mCacheDir.size(), mCacheDir) == 0)
+    {
+        return file_path.substr(mCacheDir.size() + 1);
+    }
+    return file_path;
+}
+
+std::string LLDiskCache::pathFromIndexKey(const std::string& key) const
+{
+    return mCacheDir + gDirUtilp->getDirDelimiter() + key;
+}
+
+void LLDiskCache::loadIndex()
+{
+    LLMutexLock lock(&mIndexMutex);
+
+    mIndex.clear();
+    mIndexLRU.clear();
+    mIndexTotalBytes = 0;
+    mIndexNeedsRebuild = true;
+
+    bool clean_close = false;
+    LLFILE* journal = LLFile::fopen(mJournalFilename, "rb");
+    if (journal)
+    {
+        char line[1024];
+        S32 version = 0;
+        char header[32];
+        if (fgets(line, sizeof(line), journal)
+            && sscanf(line, "%31s %d", header, &version) == 2
+            && !strcmp(header, INDEX_JOURNAL_HEADER)
+            && version == INDEX_JOURNAL_VERSION)
+        {
+            while (fgets(line, sizeof(line), journal))
+            {
+                size_t len = strlen(line);
+                if (!len || line[len - 1] != '\n')
+                {
+                    // Truncated trailing record from a crash
+                    break;
+                }
+                line[len - 1] = '\0';
+                clean_close = false;
+
+                long long access_time = 0;
+                unsigned long long file_size = 0;
+                int name_offset = 0;
+                if (line[0] == 'T'
+                    && sscanf(line, "T %lld %llu %n", &access_time, &file_size, &name_offset) == 2
+                    && name_offset > 0 && line[name_offset])
+                {
+                    IndexEntry& entry = mIndex[std::string(line + name_offset)];
+                    entry.mSize = (uintmax_t)file_size;
+                    entry.mAccessTime = (std::time_t)access_time;
+                }
+                else if (line[0] == 'D' && line[1] == ' ' && line[2])
+                {
+                    mIndex.erase(std::string(line + 2));
+                }
+                else if (line[0] == 'C')
+                {
+                    clean_close = true;
+                }
+            }
+        }
+        fclose(journal);
+    }
+
+    // Rebuild the LRU order from the recorded access times
+    std::vector<index_map_t::iterator> entries;
+    entries.reserve(mIndex.size());
+    for (index_map_t::iterator it = mIndex.begin(); it != mIndex.end(); ++it)
+    {
+        entries.push_back(it);
+    }
+    std::sort(entries.begin(), entries.end(), [](const index_map_t::iterator& a, const index_map_t::iterator& b)
+    {
+        return a->second.mAccessTime < b->second.mAccessTime;
+    });
+    for (index_map_t::iterator& it : entries)
+    {
+        it->second.mLRUIter = mIndexLRU.insert(mIndexLRU.end(), &it->first);
+        mIndexTotalBytes += it->second.mSize;
+    }
+
+    mIndexNeedsRebuild = !clean_close;
+    LL_INFOS("LLDiskCache") << "Loaded cache index with " << mIndex.size() << " entries, " << mIndexTotalBytes << " bytes"
+                            << (mIndexNeedsRebuild ? " (needs rebuild)" : "") << LL_ENDL;
+
+    // Compact the journal and drop the clean close marker; it is written
+    // again on a clean shutdown.
+    writeIndexSnapshot(false);
+}
+
+void LLDiskCache::rebuildIndexFromDisk()
+{
+    LL_INFOS("LLDiskCache") << "Rebuilding cache index from " << mCacheDir << LL_ENDL;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    typedef std::pair<std::time_t, std::pair<uintmax_t, std::string>> file_info_t;
+    typedef std::pair<std::string, std::pair<uintmax_t, std::time_t>> file_info_t;
     std::vector<file_info_t> file_info;
 
+    boost::system::error_code ec;
 #if LL_WINDOWS
     std::wstring cache_path(utf8str_to_utf16str(mCacheDir));
 #else
     std::string cache_path(mCacheDir);
 #endif
-    uintmax_t file_size_total = 0; // <FS:Beq/> try to make simple cache less naive.
-    
     if (boost::filesystem::is_directory(cache_path, ec) && !ec.failed())
     {
         // <FS:Ansariel> Optimize asset simple disk cache
-        //boost::filesystem::directory_iterator iter(cache_path, ec);
-        //while (iter != boost::filesystem::directory_iterator() && !ec.failed())
         boost::filesystem::recursive_directory_iterator iter(cache_path, ec);
         while (iter != boost::filesystem::recursive_directory_iterator() && !ec.failed())
         // </FS:Ansariel>
@@ -134,206 +363,214 @@ void LLDiskCache::purge()
                 if ((*iter).path().string().find(mCacheFilenamePrefix) != std::string::npos)
                 {
                     uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
-                    if (ec.failed())
-                    {
-                        continue;
-                    }
-                    const std::string file_path = (*iter).path().string();
-                    const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
-                    if (ec.failed())
+                    if (!ec.failed())
                     {
-                        continue;
+                        const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
+                        if (!ec.failed())
+                        {
+                            file_info.emplace_back(indexKeyFromPath((*iter).path().string()), std::make_pair(file_size, file_time));
+                        }
                     }
-                    file_size_total += file_size; // <FS:Beq/> try to make simple cache less naive.
-
-                    file_info.push_back(file_info_t(file_time, { file_size, file_path }));
                 }
             }
             iter.increment(ec);
         }
     }
 
-    // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
-    LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/mMaxSizeBytes*100.0) << "% full" << LL_ENDL;
-    if( file_size_total < mMaxSizeBytes * (mHighPercent/100) )
+    LLMutexLock lock(&mIndexMutex);
+
+    // Keep the access times recorded in the index where they are newer than
+    // the file time, and drop entries whose files have gone.
+    index_map_t old_index;
+    old_index.swap(mIndex);
+    mIndexLRU.clear();
+    mIndexTotalBytes = 0;
+    for (const file_info_t& info : file_info)
     {
-        // Nothing to do here 
-        LL_DEBUGS("LLDiskCache") << "Not exceded high water - do nothing" << LL_ENDL;
-        return;
+        std::time_t access_time = info.second.second;
+        index_map_t::const_iterator old_it = old_index.find(info.first);
+        if (old_it != old_index.end())
+        {
+            access_time = llmax(access_time, old_it->second.mAccessTime);
+        }
+        IndexEntry& entry = mIndex[info.first];
+        entry.mSize = info.second.first;
+        entry.mAccessTime = access_time;
     }
-    // If we reach here we are above the trigger level so we must purge until we've removed enough to take us down to the low water mark.
-    // </FS:Beq>
-    std::sort(file_info.begin(), file_info.end(), [](file_info_t& x, file_info_t& y)
+
+    std::vector<index_map_t::iterator> entries;
+    entries.reserve(mIndex.size());
+    for (index_map_t::iterator it = mIndex.begin(); it != mIndex.end(); ++it)
     {
-        return x.first < y.first; // <FS:Beq/> sort oldest to newest, to we can remove the oldest files first.
+        entries.push_back(it);
+    }
+    std::sort(entries.begin(), entries.end(), [](const index_map_t::iterator& a, const index_map_t::iterator& b)
+    {
+        return a->second.mAccessTime < b->second.mAccessTime;
     });
+    for (index_map_t::iterator& it : entries)
+    {
+        it->second.mLRUIter = mIndexLRU.insert(mIndexLRU.end(), &it->first);
+        mIndexTotalBytes += it->second.mSize;
+    }
 
+    mIndexNeedsRebuild = false;
+    writeIndexSnapshot(false);
 
-    // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
-    auto target_size = (uintmax_t)(mMaxSizeBytes * (mLowPercent/100));
-    LL_INFOS() << "Purging cache to a maximum of " << target_size << " bytes" << LL_ENDL;
-    // </FS:Beq>
+    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+    LL_INFOS("LLDiskCache") << "Rebuilt cache index with " << mIndex.size() << " entries, " << mIndexTotalBytes << " bytes in " << execute_time << " ms" << LL_ENDL;
+}
 
-    // <FS:Beq> Extra accounting to track the retention of static assets
-    //std::vector<bool> file_removed;
-    enum class purge_action { delete_file=0, keep_file, skip_file };
-    std::map<std::string,purge_action> file_removed;
-    auto keep{file_info.size()};
-    auto del{0};
-    auto skip{0};
-    // </FS:Beq>
-    // <FS:Beq> revised purge logic to track amount removed not retained to shortern loop
-    // uintmax_t file_size_total = 0;
-    // if (mEnableCacheDebugInfo)
-    // {
-    //     file_removed.reserve(file_info.size());
-    // }
-    // uintmax_t file_size_total = 0;
-    // for (file_info_t& entry : file_info)
-    // {
-    //     file_size_total += entry.second.first;
-
-    //     bool should_remove = file_size_total > mMaxSizeBytes;
-    //     // <FS> Make sure static assets are not eliminated
-    //     S32 action{ should_remove ? 0 : 1 };
-    //     if (should_remove)
-    //     {
-    //         auto uuid_as_string = gDirUtilp->getBaseFileName(entry.second.second, true);
-    //         uuid_as_string = uuid_as_string.substr(mCacheFilenamePrefix.size() + 1, 36);// skip "sl_cache_" and trailing "_N"
-    //         // LL_INFOS() << "checking UUID=" <<uuid_as_string<< LL_ENDL;
-    //         if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
-    //         {
-    //             // this is one of our protected items so no purging
-    //             should_remove = false;
-    //             action = 2;
-    //             updateFileAccessTime(entry.second.second); // force these to the front of the list next time so that purge size works 
-    //         }
-    //     }
-    //     // </FS>
-    //     if (mEnableCacheDebugInfo)
-    //     {
-    //         // <FS> Static asset stuff
-    //         //file_removed.push_back(should_remove);
-    //         file_removed.push_back(action);
-    //     }
-    uintmax_t deleted_size_total = 0;
-    for (file_info_t& entry : file_info)
+// Caller must hold mIndexMutex
+void LLDiskCache::writeIndexSnapshot(bool clean_close)
+{
+    if (mJournalFile)
     {
-        // first check if we still need to delete more files
-        bool should_remove = (file_size_total - deleted_size_total) > target_size;
+        fclose(mJournalFile);
+        mJournalFile = nullptr;
+    }
 
-        // <FS> Make sure static assets are not eliminated
-        auto action{ should_remove ? purge_action::delete_file : purge_action::keep_file };
-        if (!should_remove)
-        {
-            break;
-        }
+    const std::string temp_filename = mJournalFilename + ".tmp";
+    LLFILE* snapshot = LLFile::fopen(temp_filename, "wb");
+    if (!snapshot)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to write cache index " << temp_filename << LL_ENDL;
+        mIndexNeedsRebuild = true;
+        return;
+    }
 
-        auto this_file_size = entry.second.first;
-        deleted_size_total += this_file_size;
-        auto uuid_as_string = gDirUtilp->getBaseFileName(entry.second.second, true);
-        uuid_as_string = uuid_as_string.substr(mCacheFilenamePrefix.size() + 1, 36);// skip "sl_cache_" and trailing "_N"
-        // LL_INFOS() << "checking UUID=" <<uuid_as_string<< LL_ENDL;
-        if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
-        {
-            // this is one of our protected items so no purging
-            should_remove = false;
-            action = purge_action::skip_file;
-            updateFileAccessTime(entry.second.second); // force these to the front of the list next time so that purge size works 
-            skip++;
-        }
-        else{
-            del++;
-        }
-        keep--;
-        if (mEnableCacheDebugInfo)
-        {
-        // <FS> Static asset stuff
-        //file_removed.push_back(should_remove);
-            file_removed.emplace(entry.second.second, action);
-        }
-        // </FS>
-        if (should_remove)
-        {
-            boost::filesystem::remove(entry.second.second, ec);
-            if (ec.failed())
-            {
-                LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
-            }
-        }
+    fprintf(snapshot, "%s %d\n", INDEX_JOURNAL_HEADER, INDEX_JOURNAL_VERSION);
+    for (const std::string* key : mIndexLRU)
+    {
+        IndexEntry& entry = mIndex[*key];
+        fprintf(snapshot, "T %lld %llu %s\n", (long long)entry.mAccessTime, (unsigned long long)entry.mSize, key->c_str());
+        entry.mJournalTime = entry.mAccessTime;
     }
-// <FS:Beq> update the debug logging to be more useful
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-// </FS:Beq>
-    if (mEnableCacheDebugInfo)
+    if (clean_close && !mIndexNeedsRebuild)
     {
-        // <FS:Beq> update the debug logging to be more useful
-        // auto end_time = std::chrono::high_resolution_clock::now();
-        // auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        // </FS:Beq>
+        fputs("C\n", snapshot);
+    }
+    fclose(snapshot);
+    mJournalRecords = (U32)mIndex.size();
+
+    LLFile::remove(mJournalFilename, ENOENT);
+    if (LLFile::rename(temp_filename, mJournalFilename) != 0)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to replace cache index " << mJournalFilename << LL_ENDL;
+        mIndexNeedsRebuild = true;
+        return;
+    }
+
+    if (!clean_close)
+    {
+        mJournalFile = LLFile::fopen(mJournalFilename, "ab");
+    }
+}
+
+// Caller must hold mIndexMutex
+void LLDiskCache::appendJournalRecord(const std::string& record)
+{
+    if (mJournalFile)
+    {
+        fputs(record.c_str(), mJournalFile);
+        ++mJournalRecords;
+    }
+}
+
+// Caller must hold mIndexMutex
+void LLDiskCache::touchIndexEntry(const std::string& key, uintmax_t file_size, std::time_t access_time, bool journal_always)
+{
+    std::pair<index_map_t::iterator, bool> result = mIndex.emplace(key, IndexEntry());
+    IndexEntry& entry = result.first->second;
+    if (result.second)
+    {
+        entry.mLRUIter = mIndexLRU.insert(mIndexLRU.end(), &result.first->first);
+    }
+    else
+    {
+        mIndexLRU.splice(mIndexLRU.end(), mIndexLRU, entry.mLRUIter);
+        mIndexTotalBytes -= entry.mSize;
+    }
+    entry.mSize = file_size;
+    entry.mAccessTime = access_time;
+    mIndexTotalBytes += file_size;
+
+    if (journal_always || result.second || access_time - entry.mJournalTime > INDEX_JOURNAL_TIME_THRESHOLD)
+    {
+        appendJournalRecord(llformat("T %lld %llu %s\n", (long long)access_time, (unsigned long long)file_size, key.c_str()));
+        entry.mJournalTime = access_time;
+    }
+}
+
+// Caller must hold mIndexMutex
+void LLDiskCache::eraseIndexEntry(const std::string& key)
+{
+    index_map_t::iterator it = mIndex.find(key);
+    if (it != mIndex.end())
+    {
+        mIndexTotalBytes -= it->second.mSize;
+        mIndexLRU.erase(it->second.mLRUIter);
+        mIndex.erase(it);
+        appendJournalRecord(llformat("D %s\n", key.c_str()));
+    }
+}
 
-        // Log afterward so it doesn't affect the time measurement
-        // Logging thousands of file results can take hundreds of milliseconds
-        auto deleted_so_far = 0; // <FS:Beq/> update the debug logging to be more useful
-        for (size_t i = 0; i < file_info.size(); ++i)
+void LLDiskCache::recordFileAccess(const std::string& file_path)
+{
+    const std::string key = indexKeyFromPath(file_path);
+    {
+        LLMutexLock lock(&mIndexMutex);
+        index_map_t::iterator it = mIndex.find(key);
+        if (it != mIndex.end())
         {
-            const file_info_t& entry = file_info[i];
-            // <FS> Static asset stuff
-            deleted_so_far += entry.second.first; // <FS:Beq/> update the debug logging to be more useful
-            //const bool removed = file_removed[i];
-            //const std::string action = removed ? "DELETE:" : "KEEP:";
-            std::string action{};
-
-            // Check if the file exists in the map
-            auto& filename{ entry.second.second };
-            if (file_removed.find(filename) != file_removed.end()) {
-            // File found in the map, retrieve the corresponding enum value
-            switch (file_removed[filename]) {
-                case purge_action::delete_file:
-                    action = "DELETE";
-                    del++;
-                break;
-                case purge_action::skip_file:
-                    action = "STATIC";
-                    skip++;
-                break;
-                default:
-                // Handle any unexpected enum value
-                    action = "UNKNOWN";
-                break;
-            }
-            }
-            else 
-            {
-                action = "KEEP";
-            }            
-            // </FS>
-
-            // have to do this because of LL_INFO/LL_END weirdness
-            std::ostringstream line;
-
-            line << action << "  ";
-            line << entry.first << "  ";
-            line << entry.second.first << "  ";
-            line << entry.second.second;
-            line << " (" << file_size_total - deleted_so_far << "/" << mMaxSizeBytes << ")"; // <FS:Beq/> update the debug logging to be more useful
-            LL_INFOS() << line.str() << LL_ENDL;
+            touchIndexEntry(key, it->second.mSize, std::time(nullptr), false);
+            return;
         }
-// <FS:Beq> make the summary stats more easily enabled.
     }
-    // <FS:Beq> update the debug logging to be more useful
-        // LL_INFOS() << "Total dir size after purge is " << dirFileSize(mCacheDir) << LL_ENDL;
-        // LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
 
-    auto newCacheSize = updateCacheSize(file_size_total - deleted_size_total); 
-    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL; 
-    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
-// </FS:Beq>
-    LL_INFOS("LLDiskCache") << "Deleted: " << del << " Skipped: " << skip << " Kept: " << keep << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
-    LL_INFOS("LLDiskCache") << "Total of " << deleted_size_total << " bytes removed." << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
-    // } <FS:Beq/> this bracket was moved up a few lines.
+    // Not indexed yet (e.g. written by another viewer instance)
+    llstat file_stat;
+    if (LLFile::stat(file_path, &file_stat) == 0 && S_ISREG(file_stat.st_mode))
+    {
+        LLMutexLock lock(&mIndexMutex);
+        touchIndexEntry(key, (uintmax_t)file_stat.st_size, std::time(nullptr), true);
+    }
+}
+
+void LLDiskCache::recordFileWrite(const std::string& file_path, uintmax_t file_size)
+{
+    const std::string key = indexKeyFromPath(file_path);
+    LLMutexLock lock(&mIndexMutex);
+    touchIndexEntry(key, file_size, std::time(nullptr), true);
+}
+
+void LLDiskCache::recordFileRemoved(const std::string& file_path)
+{
+    const std::string key = indexKeyFromPath(file_path);
+    LLMutexLock lock(&mIndexMutex);
+    eraseIndexEntry(key);
+}
+
+void LLDiskCache::recordFileRenamed(const std::string& old_file_path, const std::string& new_file_path)
+{
+    const std::string old_key = indexKeyFromPath(old_file_path);
+    const std::string new_key = indexKeyFromPath(new_file_path);
+    LLMutexLock lock(&mIndexMutex);
+    index_map_t::iterator it = mIndex.find(old_key);
+    if (it != mIndex.end())
+    {
+        const uintmax_t file_size = it->second.mSize;
+        eraseIndexEntry(old_key);
+        touchIndexEntry(new_key, file_size, std::time(nullptr), true);
+    }
+}
+
+void LLDiskCache::cleanupSingleton()
+{
+    LLMutexLock lock(&mIndexMutex);
+    writeIndexSnapshot(true);
 }
+// </FS:Perf>
 
 const std::string LLDiskCache::assetTypeToString(LLAssetType::EType at)
 {
@@ -484,7 +721,15 @@ const std::string LLDiskCache::getCacheInfo()
     std::ostringstream cache_info;
 
     F32 max_in_mb = (F32)mMaxSizeBytes / (1024.0 * 1024.0);
-    F32 percent_used = ((F32)dirFileSize(mCacheDir) / (F32)mMaxSizeBytes) * 100.0;
+    // <FS:Perf> Packed blob store
+    //F32 percent_used = ((F32)dirFileSize(mCacheDir) / (F32)mMaxSizeBytes) * 100.0;
+    uintmax_t used_bytes = dirFileSize(mCacheDir);
+    if (LLBlobStore::instanceExists())
+    {
+        used_bytes += LLBlobStore::instance().getLiveBytes();
+    }
+    F32 percent_used = ((F32)used_bytes / (F32)mMaxSizeBytes) * 100.0;
+    // </FS:Perf>
 
     cache_info << std::fixed;
     cache_info << std::setprecision(1);
@@ -527,6 +772,16 @@ void LLDiskCache::prepopulateCacheWithStatic()
                     {
                         LL_WARNS("LLDiskCache") << "Failed to copy " << from_asset_file << " to " << to_asset_file << LL_ENDL;
                     }
+                    // <FS:Perf> Persistent LRU index of the cache contents
+                    else
+                    {
+                        llstat file_stat;
+                        if (LLFile::stat(to_asset_file, &file_stat) == 0)
+                        {
+                            recordFileWrite(to_asset_file, (uintmax_t)file_stat.st_size);
+                        }
+                    }
+                    // </FS:Perf>
                 }
                 if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) == mSkipList.end())
                 {
@@ -579,6 +834,22 @@ void LLDiskCache::clearCache()
             }
             iter.increment(ec);
         }
+        // <FS:Perf> Packed blob store
+        if (LLBlobStore::instanceExists())
+        {
+            LLBlobStore::instance().clear();
+        }
+        // </FS:Perf>
+        // <FS:Perf> Persistent LRU index of the cache contents
+        {
+            LLMutexLock lock(&mIndexMutex);
+            mIndex.clear();
+            mIndexLRU.clear();
+            mIndexTotalBytes = 0;
+            mIndexNeedsRebuild = false;
+            writeIndexSnapshot(false);
+        }
+        // </FS:Perf>
         // <FS:Beq> add static assets into the new cache after clear
     LL_INFOS() << "prepopulating new cache " << LL_ENDL;
         prepopulateCacheWithStatic();
@@ -646,6 +917,16 @@ uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force )
         return mStoredCacheSize;
     }
 // </FS:Beq>
+    // <FS:Perf> The index knows the size of the cache without a directory scan
+    if (dir == mCacheDir)
+    {
+        LLMutexLock lock(&mIndexMutex);
+        if (!mIndexNeedsRebuild)
+        {
+            return updateCacheSize(mIndexTotalBytes);
+        }
+    }
+    // </FS:Perf>
     uintmax_t total_file_size = 0;
 
     /**
@@ -28,6 +28,9 @@
  *    directory, sorts them by date of last access (write) and then
  *    deletes any files based on age until the total size of all
  *    the files is less than the maximum size specified.
+ *    <FS:Perf> The size and access time of every file is now kept in
+ *    an LRU index backed by a journal file, so the directory is only
+ *    scanned when that index has to be rebuilt. </FS:Perf>
  * 4/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
  * 5/ Performance on my modest system seems very acceptable. For
@@ -63,7 +66,10 @@
 #define _LLDISKCACHE
 
 #include "llsingleton.h"
+#include "llmutex.h"
 #include <chrono>
+#include <list>
+#include <unordered_map>
 using namespace std::chrono;
 
 
@@ -110,6 +116,9 @@ class LLDiskCache :
 
         virtual ~LLDiskCache() = default;
 
+        // <FS:Perf> Write a compacted copy of the index journal on shutdown
+        void cleanupSingleton() override;
+
     public:
         /**
          * Construct a filename and path to it based on the file meta data
@@ -137,6 +146,23 @@ class LLDiskCache :
         void updateFileAccessTime(const std::string& file_path);
         // </FS:Ansariel>
 
+        // <FS:Perf> Persistent LRU index of the cache contents
+        /**
+         * The following functions keep the in-memory index (and the journal
+         * that backs it on disk) in step with the files in the cache. They
+         * are called by LLFileSystem and are safe to call from any thread.
+         *
+         * recordFileAccess() replaces the stat()/utime() pair previously
+         * done by updateFileAccessTime() for each read: the access time is
+         * only kept in the index. Files the index does not know about yet
+         * are stat'ed once and added.
+         */
+        void recordFileAccess(const std::string& file_path);
+        void recordFileWrite(const std::string& file_path, uintmax_t file_size);
+        void recordFileRemoved(const std::string& file_path);
+        void recordFileRenamed(const std::string& old_file_path, const std::string& new_file_path);
+        // </FS:Perf>
+
         /**
          * Purge the oldest items in the cache so that the combined size of all files
          * is no bigger than mMaxSizeBytes.
@@ -198,6 +224,52 @@ class LLDiskCache :
         uintmax_t mStoredCacheSize{ 0 };
         time_point<system_clock> mLastScanTime{ };
 
+        // <FS:Perf> Persistent LRU index of the cache contents
+        /**
+         * Every cache file is tracked by its path relative to mCacheDir
+         * with its size and the time it was last accessed. mIndexLRU holds
+         * pointers to the keys of mIndex ordered from least to most recently
+         * used, so purge() can evict from the front without scanning the
+         * cache directory.
+         *
+         * The index is persisted in an append-only text journal in the cache
+         * directory, one record per line:
+         *   T <time> <size> <name>  - entry added, written or accessed
+         *   D <name>                - entry removed
+         *   C                       - index closed cleanly
+         * The journal is replayed and compacted on startup. If it is missing
+         * or the viewer did not shut down cleanly, the next purge() rebuilds
+         * the index from a single scan of the cache directory.
+         */
+        struct IndexEntry
+        {
+            uintmax_t mSize{ 0 };
+            std::time_t mAccessTime{ 0 };
+            std::time_t mJournalTime{ 0 };  // access time last written to the journal
+            std::list<const std::string*>::iterator mLRUIter;
+        };
+        typedef std::unordered_map<std::string, IndexEntry> index_map_t;
+
+        std::string indexKeyFromPath(const std::string& file_path) const;
+        std::string pathFromIndexKey(const std::string& key) const;
+
+        void loadIndex();
+        void rebuildIndexFromDisk();
+        void writeIndexSnapshot(bool clean_close);
+        void appendJournalRecord(const std::string& record);
+        void touchIndexEntry(const std::string& key, uintmax_t file_size, std::time_t access_time, bool journal_always);
+        void eraseIndexEntry(const std::string& key);
+
+        LLMutex mIndexMutex;
+        index_map_t mIndex;
+        std::list<const std::string*> mIndexLRU;
+        uintmax_t mIndexTotalBytes{ 0 };
+        bool mIndexNeedsRebuild{ true };
+        std::string mJournalFilename;
+        LLFILE* mJournalFile{ nullptr };
+        U32 mJournalRecords{ 0 };
+        // </FS:Perf>
+
     private:
         /**
          * The maximum size of the cache in bytes. After purge is called, the
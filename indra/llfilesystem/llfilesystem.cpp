@@ -33,6 +33,7 @@
 #include "llfilesystem.h"
 #include "llfasttimer.h"
 #include "lldiskcache.h"
+#include "llblobstore.h" // <FS:Perf/> Packed blob store
 
 const S32 LLFileSystem::READ        = 0x00000001;
 const S32 LLFileSystem::WRITE       = 0x00000002;
@@ -64,11 +65,18 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
         // even though we are reading and not writing because this is the
         // way the cache works - it relies on a valid "last accessed time" for
         // each file so it knows how to remove the oldest, unused files
-        bool exists = gDirUtilp->fileExists(filename);
-        if (exists)
+        // <FS:Perf> Access times live in the disk cache index now
+        //bool exists = gDirUtilp->fileExists(filename);
+        //if (exists)
+        //{
+        //    LLDiskCache::getInstance()->updateFileAccessTime(filename);
+        //}
+        // Blobs in the packed store have no file of their own
+        if (!LLBlobStore::instanceExists() || !LLBlobStore::instance().getExists(mFileID))
         {
-            LLDiskCache::getInstance()->updateFileAccessTime(filename);
+            LLDiskCache::getInstance()->recordFileAccess(filename);
         }
+        // </FS:Perf>
     }
 }
 
@@ -80,6 +88,12 @@ LLFileSystem::~LLFileSystem()
 bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS:Perf> Packed blob store; files from the one-file-per-asset layout are still served
+    if (LLBlobStore::instanceExists() && LLBlobStore::instance().getExists(file_id))
+    {
+        return true;
+    }
+    // </FS:Perf>
     std::string id_str;
     file_id.toString(id_str);
     const std::string extra_info = "";
@@ -106,12 +120,19 @@ bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType fil
 bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType file_type, int suppress_error /*= 0*/)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS:Perf> Packed blob store
+    if (LLBlobStore::instanceExists())
+    {
+        LLBlobStore::instance().remove(file_id);
+    }
+    // </FS:Perf>
     std::string id_str;
     file_id.toString(id_str);
     const std::string extra_info = "";
     const std::string filename =  LLDiskCache::getInstance()->metaDataToFilepath(id_str, file_type, extra_info);
 
     LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCache::getInstance()->recordFileRemoved(filename); // <FS:Perf/> Disk cache index
 
     return true;
 }
@@ -121,6 +142,12 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
                               const LLUUID& new_file_id, const LLAssetType::EType new_file_type)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS:Perf> Packed blob store: renaming only touches the index
+    if (LLBlobStore::instanceExists() && LLBlobStore::instance().rename(old_file_id, new_file_id))
+    {
+        return TRUE;
+    }
+    // </FS:Perf>
     std::string old_id_str;
     old_file_id.toString(old_id_str);
     const std::string extra_info = "";
@@ -141,6 +168,12 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return FALSE;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_id_str << " reason: "  << strerror(errno) << LL_ENDL;
     }
+    // <FS:Perf> Disk cache index
+    else
+    {
+        LLDiskCache::getInstance()->recordFileRenamed(old_filename, new_filename);
+    }
+    // </FS:Perf>
 
     return TRUE;
 }
@@ -149,6 +182,16 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
 S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS:Perf> Packed blob store
+    if (LLBlobStore::instanceExists())
+    {
+        S32 blob_size = LLBlobStore::instance().getSize(file_id);
+        if (blob_size > 0)
+        {
+            return blob_size;
+        }
+    }
+    // </FS:Perf>
     std::string id_str;
     file_id.toString(id_str);
     const std::string extra_info = "";
@@ -177,6 +220,15 @@ BOOL LLFileSystem::read(U8* buffer, S32 bytes)
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     BOOL success = FALSE;
 
+    // <FS:Perf> Packed blob store
+    if (LLBlobStore::instanceExists() && LLBlobStore::instance().getExists(mFileID))
+    {
+        mBytesRead = LLBlobStore::instance().read(mFileID, mPosition, buffer, bytes);
+        mPosition += mBytesRead;
+        return mBytesRead > 0;
+    }
+    // </FS:Perf>
+
     std::string id;
     mFileID.toString(id);
     const std::string extra_info = "";
@@ -250,6 +302,38 @@ BOOL LLFileSystem::write(const U8* buffer, S32 bytes)
     const std::string filename =  LLDiskCache::getInstance()->metaDataToFilepath(id_str, mFileType, extra_info);
 
     BOOL success = FALSE;
+    S32 file_size = -1; // <FS:Perf/> Disk cache index
+
+    // <FS:Perf> Packed blob store
+    if (LLBlobStore::instanceExists())
+    {
+        LLBlobStore& store = LLBlobStore::instance();
+        // Files from the one-file-per-asset layout are appended to or patched in place
+        bool in_store = store.getExists(mFileID);
+        if (in_store || mMode == WRITE || !gDirUtilp->fileExists(filename))
+        {
+            S32 offset = (mMode == APPEND) ? store.getSize(mFileID) : (mMode == READ_WRITE ? mPosition : 0);
+            if (store.write(mFileID, offset, buffer, bytes, mMode == WRITE))
+            {
+                mPosition = offset + bytes;
+                if (mMode == WRITE)
+                {
+                    // Drop any copy shadowed by the new blob
+                    LLFile::remove(filename, ENOENT);
+                    LLDiskCache::getInstance()->recordFileRemoved(filename);
+                }
+                return TRUE;
+            }
+            if (in_store)
+            {
+                // Grew too large for the store; don't leave a truncated blob behind
+                store.remove(mFileID);
+                return FALSE;
+            }
+            // Too large for the store: fall back to a file of its own
+        }
+    }
+    // </FS:Perf>
 
     // <FS:Ansariel> IO-streams replacement
     //if (mMode == APPEND)
@@ -321,6 +405,12 @@ BOOL LLFileSystem::write(const U8* buffer, S32 bytes)
             {
                 S32 bytes_written = fwrite(buffer, 1, bytes, ofs);
                 mPosition = ftell(ofs);
+                // <FS:Perf> Disk cache index needs the size of the whole file
+                if (fseek(ofs, 0, SEEK_END) == 0)
+                {
+                    file_size = ftell(ofs);
+                }
+                // </FS:Perf>
                 fclose(ofs);
                 success = (bytes_written == bytes);
             }
@@ -350,6 +440,14 @@ BOOL LLFileSystem::write(const U8* buffer, S32 bytes)
     }
     // </FS:Ansariel>
 
+    // <FS:Perf> Disk cache index
+    if (success)
+    {
+        // Everything but READ_WRITE leaves the position at the end of the file
+        LLDiskCache::getInstance()->recordFileWrite(filename, file_size >= 0 ? file_size : mPosition);
+    }
+    // </FS:Perf>
+
     return success;
 }
 
@@ -0,0 +1,415 @@
+/**
+ * @file llblobstore_test.cpp
+ * @brief LLBlobStore test cases, plus a read latency comparison with the
+ *        one-file-per-asset cache layout.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llblobstore.h"
+#include "../lldir.h"
+#include "llfile.h"
+
+#include "../test/lltut.h"
+
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    const U32 TEST_SLAB_SIZE = 1024 * 1024;
+
+    std::string make_test_dir(const std::string& name)
+    {
+        std::string dir = LLFile::tmpdir() + name;
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(dir, ec);
+        LLFile::mkdir(dir);
+        return dir;
+    }
+
+    std::vector<U8> make_payload(S32 size, U8 seed)
+    {
+        std::vector<U8> payload(size);
+        for (S32 i = 0; i < size; ++i)
+        {
+            payload[i] = (U8)(seed + i * 7);
+        }
+        return payload;
+    }
+}
+
+namespace tut
+{
+    struct LLBlobStoreFixture
+    {
+        std::string mDir;
+
+        LLBlobStoreFixture()
+        {
+            mDir = make_test_dir("llblobstore_test");
+        }
+
+        ~LLBlobStoreFixture()
+        {
+            if (LLBlobStore::instanceExists())
+            {
+                LLBlobStore::deleteSingleton();
+            }
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(mDir, ec);
+        }
+
+        LLBlobStore& store()
+        {
+            if (!LLBlobStore::instanceExists())
+            {
+                LLBlobStore::initParamSingleton(mDir, 4ULL * TEST_SLAB_SIZE, TEST_SLAB_SIZE);
+            }
+            return LLBlobStore::instance();
+        }
+
+        void reopen()
+        {
+            LLBlobStore::deleteSingleton();
+            store();
+        }
+    };
+
+    typedef test_group<LLBlobStoreFixture> blobstore_t;
+    typedef blobstore_t::object blobstore_object_t;
+    tut::blobstore_t tut_llblobstore("LLBlobStore");
+
+    template<> template<>
+    void blobstore_object_t::test<1>()
+    {
+        set_test_name("write, read and size");
+
+        LLUUID id;
+        id.generate();
+        std::vector<U8> payload = make_payload(1000, 3);
+
+        ensure("missing blob does not exist", !store().getExists(id));
+        ensure("write", store().write(id, 0, payload.data(), (S32)payload.size(), true));
+        ensure_equals("size", store().getSize(id), 1000);
+
+        std::vector<U8> buffer(2000);
+        ensure_equals("short read at end", store().read(id, 900, buffer.data(), 2000), 100);
+        ensure_equals("read", store().read(id, 0, buffer.data(), 1000), 1000);
+        ensure("contents", !memcmp(buffer.data(), payload.data(), 1000));
+
+        LLBlobStore::BlobView view = store().getBlob(id);
+        ensure("view", view.isValid());
+        ensure_equals("view size", view.getSize(), 1000);
+        ensure("view contents", !memcmp(view.getData(), payload.data(), 1000));
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<2>()
+    {
+        set_test_name("append, patch and truncate");
+
+        LLUUID id, other;
+        id.generate();
+        other.generate();
+        std::vector<U8> first = make_payload(100, 1);
+        std::vector<U8> second = make_payload(50, 2);
+
+        ensure("write", store().write(id, 0, first.data(), 100, true));
+        // Put another blob behind it so the append has to move it
+        ensure("write other", store().write(other, 0, first.data(), 100, true));
+        ensure("append", store().write(id, 100, second.data(), 50, false));
+        ensure_equals("size after append", store().getSize(id), 150);
+
+        std::vector<U8> buffer(150);
+        store().read(id, 0, buffer.data(), 150);
+        ensure("first part kept", !memcmp(buffer.data(), first.data(), 100));
+        ensure("appended part", !memcmp(buffer.data() + 100, second.data(), 50));
+
+        ensure("patch", store().write(id, 10, second.data(), 5, false));
+        ensure_equals("size after patch", store().getSize(id), 150);
+        store().read(id, 0, buffer.data(), 150);
+        ensure("patched", !memcmp(buffer.data() + 10, second.data(), 5));
+        ensure("after patch", !memcmp(buffer.data() + 15, first.data() + 15, 85));
+
+        ensure("truncate", store().write(id, 0, second.data(), 20, true));
+        ensure_equals("size after truncate", store().getSize(id), 20);
+        ensure_equals("other untouched", store().getSize(other), 100);
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<3>()
+    {
+        set_test_name("rename and remove");
+
+        LLUUID id, new_id;
+        id.generate();
+        new_id.generate();
+        std::vector<U8> payload = make_payload(64, 9);
+
+        store().write(id, 0, payload.data(), 64, true);
+        ensure("rename", store().rename(id, new_id));
+        ensure("old id gone", !store().getExists(id));
+        ensure_equals("new id size", store().getSize(new_id), 64);
+        ensure("rename missing fails", !store().rename(id, new_id));
+
+        ensure("remove", store().remove(new_id));
+        ensure("removed", !store().getExists(new_id));
+        ensure_equals("live bytes", store().getLiveBytes(), (uintmax_t)0);
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<4>()
+    {
+        set_test_name("index survives reopening");
+
+        std::vector<LLUUID> ids(100);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            ids[i].generate();
+            std::vector<U8> payload = make_payload(100 + (S32)i, (U8)i);
+            store().write(ids[i], 0, payload.data(), (S32)payload.size(), true);
+        }
+        store().remove(ids[0]);
+        // Shrink the last blob, new data must not land on the old tail
+        store().write(ids[99], 0, ids[99].mData, UUID_BYTES, true);
+
+        reopen();
+
+        ensure("removed blob stays removed", !store().getExists(ids[0]));
+        ensure_equals("shrunk blob", store().getSize(ids[99]), UUID_BYTES);
+        for (size_t i = 1; i < 99; ++i)
+        {
+            std::vector<U8> payload = make_payload(100 + (S32)i, (U8)i);
+            std::vector<U8> buffer(payload.size());
+            ensure_equals("size", store().read(ids[i], 0, buffer.data(), (S32)buffer.size()), (S32)payload.size());
+            ensure("contents", buffer == payload);
+        }
+
+        LLUUID id;
+        id.generate();
+        std::vector<U8> payload = make_payload(1000, 42);
+        store().write(id, 0, payload.data(), 1000, true);
+        std::vector<U8> buffer(100 + 98);
+        store().read(ids[98], 0, buffer.data(), (S32)buffer.size());
+        ensure("new write does not clobber old blobs", buffer == make_payload(100 + 98, 98));
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<5>()
+    {
+        set_test_name("oldest slab is dropped when over the maximum size");
+
+        store().setMaxSizeBytes(2ULL * TEST_SLAB_SIZE);
+
+        const S32 blob_size = TEST_SLAB_SIZE / 4;
+        std::vector<U8> payload = make_payload(blob_size, 5);
+        std::vector<LLUUID> ids(12);
+        for (LLUUID& id : ids)
+        {
+            id.generate();
+            ensure("write", store().write(id, 0, payload.data(), blob_size, true));
+        }
+        ensure("store stays within its maximum", store().getSlabBytes() <= 2ULL * TEST_SLAB_SIZE);
+        ensure("oldest blob purged", !store().getExists(ids[0]));
+        ensure("newest blob kept", store().getExists(ids.back()));
+
+        LLUUID too_big;
+        too_big.generate();
+        std::vector<U8> huge(TEST_SLAB_SIZE + 1);
+        ensure("blob larger than a slab is refused", !store().write(too_big, 0, huge.data(), (S32)huge.size(), true));
+    }
+
+    // Not a regression test: compares open/read latency of the store with the
+    // one-file-per-asset layout used by LLDiskCache and prints the result.
+    template<> template<>
+    void blobstore_object_t::test<6>()
+    {
+        set_test_name("read latency compared with one file per asset");
+
+        const S32 count = 2000;
+        const S32 sizes[] = { 512, 4096, 32768 };
+        std::vector<U8> buffer(32768);
+
+        store().setMaxSizeBytes(64ULL * TEST_SLAB_SIZE);
+        std::string file_dir = make_test_dir("llblobstore_test_files");
+        std::vector<LLUUID> ids(count);
+        for (S32 i = 0; i < count; ++i)
+        {
+            ids[i].generate();
+            std::vector<U8> payload = make_payload(sizes[i % 3], (U8)i);
+            store().write(ids[i], 0, payload.data(), (S32)payload.size(), true);
+
+            LLFILE* file = LLFile::fopen(file_dir + gDirUtilp->getDirDelimiter() + ids[i].asString() + ".asset", "wb");
+            fwrite(payload.data(), 1, payload.size(), file);
+            fclose(file);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t file_bytes = 0;
+        for (const LLUUID& id : ids)
+        {
+            const std::string filename = file_dir + gDirUtilp->getDirDelimiter() + id.asString() + ".asset";
+            llstat file_stat;
+            if (LLFile::stat(filename, &file_stat) == 0)
+            {
+                LLFILE* file = LLFile::fopen(filename, "rb");
+                file_bytes += fread(buffer.data(), 1, file_stat.st_size, file);
+                fclose(file);
+            }
+        }
+        auto file_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        size_t blob_bytes = 0;
+        for (const LLUUID& id : ids)
+        {
+            S32 size = store().getSize(id);
+            blob_bytes += store().read(id, 0, buffer.data(), size);
+        }
+        auto blob_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(file_dir, ec);
+
+        ensure_equals("same bytes read", blob_bytes, file_bytes);
+        std::cout << "\nLLBlobStore: " << count << " assets, one file per asset "
+                  << file_time << " us (" << (F64)file_time / count << " us/asset), blob store "
+                  << blob_time << " us (" << (F64)blob_time / count << " us/asset)" << std::endl;
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<7>()
+    {
+        set_test_name("least recently used slab is dropped first");
+
+        store().setMaxSizeBytes(2ULL * TEST_SLAB_SIZE);
+
+        const S32 blob_size = TEST_SLAB_SIZE / 4;
+        std::vector<U8> payload = make_payload(blob_size, 6);
+        std::vector<LLUUID> ids(9);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            ids[i].generate();
+            if (i == 8)
+            {
+                // Touch the first slab just before a third one is needed
+                std::vector<U8> buffer(blob_size);
+                ensure_equals("read", store().read(ids[0], 0, buffer.data(), blob_size), blob_size);
+            }
+            ensure("write", store().write(ids[i], 0, payload.data(), blob_size, true));
+        }
+        ensure("recently read slab kept", store().getExists(ids[0]));
+        ensure("least recently used slab dropped", !store().getExists(ids[4]));
+        ensure("newest blob kept", store().getExists(ids[8]));
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<8>()
+    {
+        set_test_name("published bytes are not rewritten");
+
+        LLUUID id;
+        id.generate();
+        std::vector<U8> first = make_payload(100, 7);
+        std::vector<U8> second = make_payload(100, 8);
+
+        ensure("write", store().write(id, 0, first.data(), 100, true));
+        LLBlobStore::BlobView view = store().getBlob(id);
+
+        // Each of these would have been done in place on the last blob
+        ensure("append", store().write(id, 100, second.data(), 10, false));
+        ensure("patch", store().write(id, 0, second.data(), 100, false));
+        ensure("shrink", store().write(id, 0, second.data(), 10, true));
+        LLUUID other;
+        other.generate();
+        ensure("write other", store().write(other, 0, second.data(), 100, true));
+
+        ensure_equals("view size", view.getSize(), 100);
+        ensure("view contents", !memcmp(view.getData(), first.data(), 100));
+
+        std::vector<U8> buffer(100);
+        ensure_equals("size", store().read(id, 0, buffer.data(), 100), 10);
+        ensure("contents", !memcmp(buffer.data(), second.data(), 10));
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<9>()
+    {
+        set_test_name("partial write to a blob purged by its own relocation");
+
+        store().setMaxSizeBytes(2ULL * TEST_SLAB_SIZE);
+
+        const S32 blob_size = TEST_SLAB_SIZE / 4;
+        std::vector<U8> payload = make_payload(blob_size, 9);
+        std::vector<LLUUID> ids(8);
+        for (LLUUID& id : ids)
+        {
+            id.generate();
+            ensure("write", store().write(id, 0, payload.data(), blob_size, true));
+        }
+
+        // Both slabs are full, so the patched copy needs a third slab, and
+        // making room for it drops the first one, which holds ids[0].
+        ensure("patch fails", !store().write(ids[0], 10, payload.data(), 5, false));
+        ensure("blob not brought back with a zeroed head", !store().getExists(ids[0]));
+        ensure("other slab kept", store().getExists(ids[4]));
+    }
+
+    template<> template<>
+    void blobstore_object_t::test<10>()
+    {
+        set_test_name("truncating write at an offset keeps the head");
+
+        LLUUID id, other;
+        id.generate();
+        other.generate();
+        std::vector<U8> first = make_payload(100, 10);
+        std::vector<U8> second = make_payload(20, 11);
+
+        ensure("write", store().write(id, 0, first.data(), 100, true));
+        // Put another blob behind it so the write has to move it
+        ensure("write other", store().write(other, 0, first.data(), 100, true));
+        ensure("truncate at offset", store().write(id, 50, second.data(), 20, true));
+        ensure_equals("size", store().getSize(id), 70);
+
+        std::vector<U8> buffer(70);
+        store().read(id, 0, buffer.data(), 70);
+        ensure("head kept", !memcmp(buffer.data(), first.data(), 50));
+        ensure("tail written", !memcmp(buffer.data() + 50, second.data(), 20));
+
+        // Past the old end the gap reads back as zeroes
+        ensure("write other again", store().write(other, 0, first.data(), 10, true));
+        ensure("truncate past end", store().write(id, 80, second.data(), 5, true));
+        ensure_equals("size past end", store().getSize(id), 85);
+        buffer.resize(85);
+        store().read(id, 0, buffer.data(), 85);
+        ensure("head still kept", !memcmp(buffer.data(), first.data(), 50));
+        ensure("gap zeroed", std::all_of(buffer.begin() + 70, buffer.begin() + 80, [](U8 b) { return b == 0; }));
+        ensure("new tail", !memcmp(buffer.data() + 80, second.data(), 5));
+    }
+}
@@ -39,6 +39,7 @@
 #include "llimagepng.h"
 #include "llimagedxt.h"
 #include "llmemory.h"
+#include "llimagesimd.h" // <FS:Perf/> SIMD pixel loops
 
 #include <boost/preprocessor.hpp>
 
@@ -459,6 +460,12 @@ inline void bilinear_scale(
 	}
 	else 
 	{ //scale x/y - down
+		// <FS:Perf> SSE2/AVX2 box filter, see llimagesimd.h. Same bytes as the code below.
+		for(y = 0; y < dstH; y++)
+		{
+			LLImageSIMD::downscaleRow(info.ystrides[y], srcStride, &info.xpoints[0], &info.xapoints[0], info.yapoints[y], dst + (y * dstStride), dstW, ch);
+		}
+		/*
 		S32 Cx, Cy, i, j;
 		S32 xap, yap;
 
@@ -553,6 +560,8 @@ inline void bilinear_scale(
 				typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff_t()(dptr, comp, 23);
 			}
 		}
+		*/
+		// </FS:Perf>
 	} //else
 }
 
@@ -1222,30 +1231,33 @@ void LLImageRaw::compositeUnscaled4onto3( LLImageRaw* src )
 		return;
 	}
 	// </FS:Beq>
-	while( pixels-- )
-	{
-		U8 alpha = src_data[3];
-		if( alpha )
-		{
-			if( 255 == alpha )
-			{
-				dst_data[0] = src_data[0];
-				dst_data[1] = src_data[1];
-				dst_data[2] = src_data[2];
-			}
-			else
-			{
-
-				U8 transparency = 255 - alpha;
-				dst_data[0] = fastFractionalMult( dst_data[0], transparency ) + fastFractionalMult( src_data[0], alpha );
-				dst_data[1] = fastFractionalMult( dst_data[1], transparency ) + fastFractionalMult( src_data[1], alpha );
-				dst_data[2] = fastFractionalMult( dst_data[2], transparency ) + fastFractionalMult( src_data[2], alpha );
-			}
-		}
-
-		src_data += 4;
-		dst_data += 3;
-	}
+	// <FS:Perf> SSE2/AVX2 blend, gives the same bytes as the loop below
+	LLImageSIMD::compositeRow4onto3(src_data, dst_data, pixels);
+	//while( pixels-- )
+	//{
+	//	U8 alpha = src_data[3];
+	//	if( alpha )
+	//	{
+	//		if( 255 == alpha )
+	//		{
+	//			dst_data[0] = src_data[0];
+	//			dst_data[1] = src_data[1];
+	//			dst_data[2] = src_data[2];
+	//		}
+	//		else
+	//		{
+	//
+	//			U8 transparency = 255 - alpha;
+	//			dst_data[0] = fastFractionalMult( dst_data[0], transparency ) + fastFractionalMult( src_data[0], alpha );
+	//			dst_data[1] = fastFractionalMult( dst_data[1], transparency ) + fastFractionalMult( src_data[1], alpha );
+	//			dst_data[2] = fastFractionalMult( dst_data[2], transparency ) + fastFractionalMult( src_data[2], alpha );
+	//		}
+	//	}
+	//
+	//	src_data += 4;
+	//	dst_data += 3;
+	//}
+	// </FS:Perf>
 }
 
 
@@ -2353,6 +2365,18 @@ void LLImageBase::generateMip(const U8* indata, U8* mipdata, S32 width, S32 heig
 	llassert(width > 0 && height > 0);
 	U8* data = mipdata;
 	S32 in_width = width*2;
+	// <FS:Perf> SSE2/AVX2 rows, see llimagesimd.h
+	if (nchannels >= 1 && nchannels <= 4)
+	{
+		for (S32 h=0; h<height; h++)
+		{
+			LLImageSIMD::mipRow(indata, indata + nchannels*in_width, data, width, nchannels);
+			indata += nchannels*in_width*2;
+			data += nchannels*width;
+		}
+		return;
+	}
+	// </FS:Perf>
 	for (S32 h=0; h<height; h++)
 	{
 		for (S32 w=0; w<width; w++)
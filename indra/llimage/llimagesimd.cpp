@@ -0,0 +1,782 @@
+/**
+ * @file llimagesimd.cpp
+ * @brief SSE2/AVX2 kernels for the LLImageRaw pixel loops.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagesimd.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LL_IMAGE_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define LL_IMAGE_SIMD 0
+#endif
+
+// MSVC lets any function use any intrinsic. GCC and clang need the AVX2
+// functions (and every helper inlined into them that uses instructions
+// beyond SSE2) marked, so the rest of the file can stay baseline SSE2.
+#if LL_IMAGE_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define LL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LL_TARGET_AVX2
+#endif
+
+namespace
+{
+    //------------------------------------------------------------------------
+    // Scalar kernels. These are the reference the SIMD versions have to
+    // match byte for byte, and they also finish the tail of every row.
+    //------------------------------------------------------------------------
+
+    void mip_row_scalar(const U8* row0, const U8* row1, U8* out, S32 out_width, S32 nchannels)
+    {
+        for (S32 w = 0; w < out_width; ++w)
+        {
+            for (S32 c = 0; c < nchannels; ++c)
+            {
+                *out++ = (U8)(((U32)(row0[c]) + row0[nchannels + c] + row1[c] + row1[nchannels + c]) >> 2);
+            }
+            row0 += nchannels * 2;
+            row1 += nchannels * 2;
+        }
+    }
+
+    // Same as LLImageRaw::fastFractionalMult()
+    inline U8 fast_fractional_mult(U8 a, U8 b)
+    {
+        U32 i = a * b + 128;
+        return U8((i + (i >> 8)) >> 8);
+    }
+
+    void composite_row_scalar(const U8* src, U8* dst, S32 pixels)
+    {
+        while (pixels-- > 0)
+        {
+            U8 alpha = src[3];
+            if (alpha)
+            {
+                if (255 == alpha)
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                }
+                else
+                {
+                    U8 transparency = 255 - alpha;
+                    dst[0] = fast_fractional_mult(dst[0], transparency) + fast_fractional_mult(src[0], alpha);
+                    dst[1] = fast_fractional_mult(dst[1], transparency) + fast_fractional_mult(src[1], alpha);
+                    dst[2] = fast_fractional_mult(dst[2], transparency) + fast_fractional_mult(src[2], alpha);
+                }
+            }
+            src += 4;
+            dst += 3;
+        }
+    }
+
+    // Weighted sum of the source pixels under one output pixel in one
+    // source row: the first with weight xap, then as many as fit with
+    // weight Cx, then the remainder. The weights add up to 1 << 14.
+    template <S32 CH>
+    inline void box_row_scalar(const U8* pix, S32 Cx, S32 xap, S32* cx)
+    {
+        for (S32 c = 0; c < CH; ++c)
+        {
+            cx[c] = pix[c] * xap;
+        }
+        pix += CH;
+
+        S32 i;
+        for (i = (1 << 14) - xap; i > Cx; i -= Cx)
+        {
+            for (S32 c = 0; c < CH; ++c)
+            {
+                cx[c] += pix[c] * Cx;
+            }
+            pix += CH;
+        }
+
+        if (i > 0)
+        {
+            for (S32 c = 0; c < CH; ++c)
+            {
+                cx[c] += pix[c] * i;
+            }
+        }
+    }
+
+    template <S32 CH>
+    void downscale_row_scalar(const U8* src_row, S32 src_stride, const S32* xpoints, const S32* xapoints,
+                              S32 yapoint, U8* dst, S32 dst_width)
+    {
+        const S32 Cy = yapoint >> 16;
+        const S32 yap = yapoint & 0xffff;
+        S32 cx[CH], comp[CH];
+
+        for (S32 x = 0; x < dst_width; ++x)
+        {
+            const S32 Cx = xapoints[x] >> 16;
+            const S32 xap = xapoints[x] & 0xffff;
+            const U8* sptr = src_row + xpoints[x] * CH;
+
+            box_row_scalar<CH>(sptr, Cx, xap, cx);
+            sptr += src_stride;
+            for (S32 c = 0; c < CH; ++c)
+            {
+                comp[c] = (cx[c] >> 5) * yap;
+            }
+
+            S32 j;
+            for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+            {
+                box_row_scalar<CH>(sptr, Cx, xap, cx);
+                sptr += src_stride;
+                for (S32 c = 0; c < CH; ++c)
+                {
+                    comp[c] += (cx[c] >> 5) * Cy;
+                }
+            }
+
+            if (j > 0)
+            {
+                box_row_scalar<CH>(sptr, Cx, xap, cx);
+                for (S32 c = 0; c < CH; ++c)
+                {
+                    comp[c] += (cx[c] >> 5) * j;
+                }
+            }
+
+            for (S32 c = 0; c < CH; ++c)
+            {
+                *dst++ = (comp[c] >> 23) & 0xff;
+            }
+        }
+    }
+
+    void downscale_row_scalar(const U8* src_row, S32 src_stride, const S32* xpoints, const S32* xapoints,
+                              S32 yapoint, U8* dst, S32 dst_width, S32 nchannels)
+    {
+        switch (nchannels)
+        {
+        case 1:
+            downscale_row_scalar<1>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+            break;
+        case 3:
+            downscale_row_scalar<3>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+            break;
+        case 4:
+            downscale_row_scalar<4>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+            break;
+        default:
+            llassert(!"Implement if need");
+            break;
+        }
+    }
+
+#if LL_IMAGE_SIMD
+    //------------------------------------------------------------------------
+    // SSE2
+    //------------------------------------------------------------------------
+
+    // 4 packed RGB pixels, without reading past the 12th byte
+    inline __m128i load_rgb4(const U8* p)
+    {
+        S32 tail;
+        memcpy(&tail, p + 8, 4);
+        return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)p), _mm_cvtsi32_si128(tail));
+    }
+
+    // Store the low 12 bytes of v
+    inline void store_rgb4(U8* p, __m128i v)
+    {
+        _mm_storel_epi64((__m128i*)p, v);
+        S32 tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+        memcpy(p + 8, &tail, 4);
+    }
+
+    // 4 packed RGB pixels to one pixel per 32 bit lane. The fourth byte of
+    // each lane is whatever followed the pixel.
+    inline __m128i expand_rgb(__m128i v)
+    {
+        __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+        __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+        return _mm_unpacklo_epi64(p01, p23);
+    }
+
+    // Inverse of expand_rgb(): drops the fourth byte of each lane and packs
+    // the pixels into the low 12 bytes.
+    inline __m128i compact_rgb(__m128i v)
+    {
+        const __m128i lane0 = _mm_setr_epi32(0x00ffffff, 0, 0, 0);
+        const __m128i lane1 = _mm_setr_epi32(0, 0x00ffffff, 0, 0);
+        const __m128i lane2 = _mm_setr_epi32(0, 0, 0x00ffffff, 0);
+        const __m128i lane3 = _mm_setr_epi32(0, 0, 0, 0x00ffffff);
+        return _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(v, lane0), _mm_srli_si128(_mm_and_si128(v, lane1), 1)),
+            _mm_or_si128(_mm_srli_si128(_mm_and_si128(v, lane2), 2), _mm_srli_si128(_mm_and_si128(v, lane3), 3)));
+    }
+
+    // 4 output pixels of a 4 channel mip from 8 input pixels of each row
+    inline __m128i mip_quads(__m128i a0, __m128i a1, __m128i b0, __m128i b1)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        // column sums, two pixels per register
+        __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+        // add neighbouring columns
+        __m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+        __m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+        return _mm_packus_epi16(_mm_srli_epi16(h0, 2), _mm_srli_epi16(h1, 2));
+    }
+
+    // Sums of neighbouring bytes as 8 16 bit values
+    inline __m128i add_byte_pairs(__m128i v)
+    {
+        return _mm_add_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00ff)), _mm_srli_epi16(v, 8));
+    }
+
+    void mip_row_sse2(const U8* row0, const U8* row1, U8* out, S32 out_width, S32 nchannels)
+    {
+        S32 w = 0;
+        switch (nchannels)
+        {
+        case 4:
+            for (; w + 4 <= out_width; w += 4)
+            {
+                __m128i a0 = _mm_loadu_si128((const __m128i*)row0);
+                __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + 16));
+                __m128i b0 = _mm_loadu_si128((const __m128i*)row1);
+                __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + 16));
+                _mm_storeu_si128((__m128i*)out, mip_quads(a0, a1, b0, b1));
+                row0 += 32;
+                row1 += 32;
+                out += 16;
+            }
+            break;
+        case 3:
+            for (; w + 4 <= out_width; w += 4)
+            {
+                __m128i a0 = expand_rgb(load_rgb4(row0));
+                __m128i a1 = expand_rgb(load_rgb4(row0 + 12));
+                __m128i b0 = expand_rgb(load_rgb4(row1));
+                __m128i b1 = expand_rgb(load_rgb4(row1 + 12));
+                store_rgb4(out, compact_rgb(mip_quads(a0, a1, b0, b1)));
+                row0 += 24;
+                row1 += 24;
+                out += 12;
+            }
+            break;
+        case 1:
+            for (; w + 16 <= out_width; w += 16)
+            {
+                __m128i s0 = _mm_add_epi16(add_byte_pairs(_mm_loadu_si128((const __m128i*)row0)),
+                                           add_byte_pairs(_mm_loadu_si128((const __m128i*)row1)));
+                __m128i s1 = _mm_add_epi16(add_byte_pairs(_mm_loadu_si128((const __m128i*)(row0 + 16))),
+                                           add_byte_pairs(_mm_loadu_si128((const __m128i*)(row1 + 16))));
+                _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(_mm_srli_epi16(s0, 2), _mm_srli_epi16(s1, 2)));
+                row0 += 32;
+                row1 += 32;
+                out += 16;
+            }
+            break;
+        default:
+            break;
+        }
+        mip_row_scalar(row0, row1, out, out_width - w, nchannels);
+    }
+
+    // fast_fractional_mult() on 16 bit lanes. Nothing overflows: a * b + 128
+    // is at most 65153.
+    inline __m128i fast_fractional_mult(__m128i a, __m128i b)
+    {
+        __m128i i = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(i, _mm_srli_epi16(i, 8)), 8);
+    }
+
+    // Blend two 16 bit RGBA src pixels over two 16 bit RGBx dst pixels.
+    // This is branch free: with alpha 0 the formula gives back dst, with
+    // alpha 255 it gives src, exactly like the scalar special cases.
+    inline __m128i blend_pixels(__m128i src, __m128i dst)
+    {
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i transparency = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+        return _mm_add_epi16(fast_fractional_mult(dst, transparency), fast_fractional_mult(src, alpha));
+    }
+
+    void composite_row_sse2(const U8* src, U8* dst, S32 pixels)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        S32 p = 0;
+        for (; p + 4 <= pixels; p += 4)
+        {
+            __m128i s = _mm_loadu_si128((const __m128i*)src);
+            __m128i d = expand_rgb(load_rgb4(dst));
+            __m128i lo = blend_pixels(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+            __m128i hi = blend_pixels(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+            store_rgb4(dst, compact_rgb(_mm_packus_epi16(lo, hi)));
+            src += 16;
+            dst += 12;
+        }
+        composite_row_scalar(src, dst, pixels - p);
+    }
+
+    // One source pixel widened to a 32 bit lane per channel
+    template <S32 CH>
+    inline __m128i load_pixel(const U8* p)
+    {
+        S32 bits;
+        if (CH == 4)
+        {
+            memcpy(&bits, p, 4);
+        }
+        else
+        {
+            // don't read past the last pixel of the image
+            bits = p[0] | (p[1] << 8) | (p[2] << 16);
+        }
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+    }
+
+    // Store the channels of a pixel held as 32 bit lanes in 0-255
+    template <S32 CH>
+    inline void store_pixel(U8* p, __m128i v)
+    {
+        v = _mm_packs_epi32(v, v);
+        S32 bits = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+        memcpy(p, &bits, CH);
+    }
+
+    // box_row_scalar() for all channels at once. Pixel values and weights
+    // (at most 1 << 14) both fit in 16 bits, so pmaddwd with a zero high
+    // half does the 32 bit multiply.
+    template <S32 CH>
+    inline __m128i box_row_sse2(const U8* pix, S32 Cx, S32 xap)
+    {
+        __m128i cx = _mm_madd_epi16(load_pixel<CH>(pix), _mm_set1_epi32(xap));
+        pix += CH;
+
+        const __m128i weight = _mm_set1_epi32(Cx);
+        S32 i;
+        for (i = (1 << 14) - xap; i > Cx; i -= Cx)
+        {
+            cx = _mm_add_epi32(cx, _mm_madd_epi16(load_pixel<CH>(pix), weight));
+            pix += CH;
+        }
+
+        if (i > 0)
+        {
+            cx = _mm_add_epi32(cx, _mm_madd_epi16(load_pixel<CH>(pix), _mm_set1_epi32(i)));
+        }
+        return cx;
+    }
+
+    // (cx >> 5) * weight. cx >> 5 needs 17 bits, so this is a real 32 bit
+    // multiply; SSE2 only has the even lane pmuludq.
+    inline __m128i scale_column_sse2(__m128i cx, S32 weight)
+    {
+        __m128i a = _mm_srli_epi32(cx, 5);
+        __m128i b = _mm_set1_epi32(weight);
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), b);
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    template <S32 CH>
+    void downscale_row_sse2(const U8* src_row, S32 src_stride, const S32* xpoints, const S32* xapoints,
+                            S32 yapoint, U8* dst, S32 dst_width)
+    {
+        const S32 Cy = yapoint >> 16;
+        const S32 yap = yapoint & 0xffff;
+
+        for (S32 x = 0; x < dst_width; ++x)
+        {
+            const S32 Cx = xapoints[x] >> 16;
+            const S32 xap = xapoints[x] & 0xffff;
+            const U8* sptr = src_row + xpoints[x] * CH;
+
+            __m128i comp = scale_column_sse2(box_row_sse2<CH>(sptr, Cx, xap), yap);
+            sptr += src_stride;
+
+            S32 j;
+            for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+            {
+                comp = _mm_add_epi32(comp, scale_column_sse2(box_row_sse2<CH>(sptr, Cx, xap), Cy));
+                sptr += src_stride;
+            }
+
+            if (j > 0)
+            {
+                comp = _mm_add_epi32(comp, scale_column_sse2(box_row_sse2<CH>(sptr, Cx, xap), j));
+            }
+
+            store_pixel<CH>(dst, _mm_srli_epi32(comp, 23));
+            dst += CH;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // AVX2. Anything that is not worth widening to 256 bits uses the SSSE3
+    // and SSE4.1 instructions that come with it instead.
+    //------------------------------------------------------------------------
+
+    LL_TARGET_AVX2 inline __m256i mip_quads_avx2(__m256i a0, __m256i a1, __m256i b0, __m256i b1)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i s0 = _mm256_add_epi16(_mm256_unpacklo_epi8(a0, zero), _mm256_unpacklo_epi8(b0, zero));
+        __m256i s1 = _mm256_add_epi16(_mm256_unpackhi_epi8(a0, zero), _mm256_unpackhi_epi8(b0, zero));
+        __m256i s2 = _mm256_add_epi16(_mm256_unpacklo_epi8(a1, zero), _mm256_unpacklo_epi8(b1, zero));
+        __m256i s3 = _mm256_add_epi16(_mm256_unpackhi_epi8(a1, zero), _mm256_unpackhi_epi8(b1, zero));
+        __m256i h0 = _mm256_add_epi16(_mm256_unpacklo_epi64(s0, s1), _mm256_unpackhi_epi64(s0, s1));
+        __m256i h1 = _mm256_add_epi16(_mm256_unpacklo_epi64(s2, s3), _mm256_unpackhi_epi64(s2, s3));
+        __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(h0, 2), _mm256_srli_epi16(h1, 2));
+        // pack works per 128 bit lane, put the 8 byte groups back in order
+        return _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    LL_TARGET_AVX2 inline __m256i add_byte_pairs_avx2(__m256i v)
+    {
+        return _mm256_add_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x00ff)), _mm256_srli_epi16(v, 8));
+    }
+
+    LL_TARGET_AVX2 void mip_row_avx2(const U8* row0, const U8* row1, U8* out, S32 out_width, S32 nchannels)
+    {
+        S32 w = 0;
+        switch (nchannels)
+        {
+        case 4:
+            for (; w + 8 <= out_width; w += 8)
+            {
+                __m256i a0 = _mm256_loadu_si256((const __m256i*)row0);
+                __m256i a1 = _mm256_loadu_si256((const __m256i*)(row0 + 32));
+                __m256i b0 = _mm256_loadu_si256((const __m256i*)row1);
+                __m256i b1 = _mm256_loadu_si256((const __m256i*)(row1 + 32));
+                _mm256_storeu_si256((__m256i*)out, mip_quads_avx2(a0, a1, b0, b1));
+                row0 += 64;
+                row1 += 64;
+                out += 32;
+            }
+            break;
+        case 3:
+        {
+            const __m128i expand_lo = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i expand_hi = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+            const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            for (; w + 4 <= out_width; w += 4)
+            {
+                // 8 input pixels are 24 bytes: bytes 0-15 and 8-23
+                __m128i a0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)row0), expand_lo);
+                __m128i a1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row0 + 8)), expand_hi);
+                __m128i b0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)row1), expand_lo);
+                __m128i b1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row1 + 8)), expand_hi);
+                store_rgb4(out, _mm_shuffle_epi8(mip_quads(a0, a1, b0, b1), compact));
+                row0 += 24;
+                row1 += 24;
+                out += 12;
+            }
+            break;
+        }
+        case 1:
+            for (; w + 32 <= out_width; w += 32)
+            {
+                __m256i s0 = _mm256_add_epi16(add_byte_pairs_avx2(_mm256_loadu_si256((const __m256i*)row0)),
+                                              add_byte_pairs_avx2(_mm256_loadu_si256((const __m256i*)row1)));
+                __m256i s1 = _mm256_add_epi16(add_byte_pairs_avx2(_mm256_loadu_si256((const __m256i*)(row0 + 32))),
+                                              add_byte_pairs_avx2(_mm256_loadu_si256((const __m256i*)(row1 + 32))));
+                __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(s0, 2), _mm256_srli_epi16(s1, 2));
+                _mm256_storeu_si256((__m256i*)out, _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+                row0 += 64;
+                row1 += 64;
+                out += 32;
+            }
+            break;
+        default:
+            break;
+        }
+        mip_row_sse2(row0, row1, out, out_width - w, nchannels);
+    }
+
+    LL_TARGET_AVX2 inline __m256i fast_fractional_mult_avx2(__m256i a, __m256i b)
+    {
+        __m256i i = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(i, _mm256_srli_epi16(i, 8)), 8);
+    }
+
+    LL_TARGET_AVX2 inline __m256i blend_pixels_avx2(__m256i src, __m256i dst)
+    {
+        __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m256i transparency = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+        return _mm256_add_epi16(fast_fractional_mult_avx2(dst, transparency), fast_fractional_mult_avx2(src, alpha));
+    }
+
+    LL_TARGET_AVX2 void composite_row_avx2(const U8* src, U8* dst, S32 pixels)
+    {
+        const __m128i expand = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i compact = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        const __m256i zero = _mm256_setzero_si256();
+        S32 p = 0;
+        for (; p + 8 <= pixels; p += 8)
+        {
+            __m256i s = _mm256_loadu_si256((const __m256i*)src);
+            __m256i d = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_shuffle_epi8(load_rgb4(dst), expand)),
+                _mm_shuffle_epi8(load_rgb4(dst + 12), expand), 1);
+            // unpack and pack both work per 128 bit lane, so pixels 0-3
+            // stay in the low lane and 4-7 in the high one
+            __m256i lo = blend_pixels_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+            __m256i hi = blend_pixels_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+            __m256i result = _mm256_shuffle_epi8(_mm256_packus_epi16(lo, hi), compact);
+            store_rgb4(dst, _mm256_castsi256_si128(result));
+            store_rgb4(dst + 12, _mm256_extracti128_si256(result, 1));
+            src += 32;
+            dst += 24;
+        }
+        composite_row_sse2(src, dst, pixels - p);
+    }
+
+    template <S32 CH>
+    LL_TARGET_AVX2 inline __m128i load_pixel_avx2(const U8* p)
+    {
+        S32 bits;
+        if (CH == 4)
+        {
+            memcpy(&bits, p, 4);
+        }
+        else
+        {
+            bits = p[0] | (p[1] << 8) | (p[2] << 16);
+        }
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bits));
+    }
+
+    template <S32 CH>
+    LL_TARGET_AVX2 inline __m128i box_row_avx2(const U8* pix, S32 Cx, S32 xap)
+    {
+        __m128i cx = _mm_madd_epi16(load_pixel_avx2<CH>(pix), _mm_set1_epi32(xap));
+        pix += CH;
+
+        const __m128i weight = _mm_set1_epi32(Cx);
+        S32 i;
+        for (i = (1 << 14) - xap; i > Cx; i -= Cx)
+        {
+            cx = _mm_add_epi32(cx, _mm_madd_epi16(load_pixel_avx2<CH>(pix), weight));
+            pix += CH;
+        }
+
+        if (i > 0)
+        {
+            cx = _mm_add_epi32(cx, _mm_madd_epi16(load_pixel_avx2<CH>(pix), _mm_set1_epi32(i)));
+        }
+        return cx;
+    }
+
+    LL_TARGET_AVX2 inline __m128i scale_column_avx2(__m128i cx, S32 weight)
+    {
+        return _mm_mullo_epi32(_mm_srli_epi32(cx, 5), _mm_set1_epi32(weight));
+    }
+
+    template <S32 CH>
+    LL_TARGET_AVX2 void downscale_row_avx2(const U8* src_row, S32 src_stride, const S32* xpoints, const S32* xapoints,
+                                           S32 yapoint, U8* dst, S32 dst_width)
+    {
+        const S32 Cy = yapoint >> 16;
+        const S32 yap = yapoint & 0xffff;
+
+        for (S32 x = 0; x < dst_width; ++x)
+        {
+            const S32 Cx = xapoints[x] >> 16;
+            const S32 xap = xapoints[x] & 0xffff;
+            const U8* sptr = src_row + xpoints[x] * CH;
+
+            __m128i comp = scale_column_avx2(box_row_avx2<CH>(sptr, Cx, xap), yap);
+            sptr += src_stride;
+
+            S32 j;
+            for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+            {
+                comp = _mm_add_epi32(comp, scale_column_avx2(box_row_avx2<CH>(sptr, Cx, xap), Cy));
+                sptr += src_stride;
+            }
+
+            if (j > 0)
+            {
+                comp = _mm_add_epi32(comp, scale_column_avx2(box_row_avx2<CH>(sptr, Cx, xap), j));
+            }
+
+            store_pixel<CH>(dst, _mm_srli_epi32(comp, 23));
+            dst += CH;
+        }
+    }
+#endif // LL_IMAGE_SIMD
+
+    LLImageSIMD::ELevel detect_level()
+    {
+#if !LL_IMAGE_SIMD
+        return LLImageSIMD::SCALAR;
+#elif defined(__AVX2__)
+        // built with USE_AVX2_OPTIMIZATION
+        return LLImageSIMD::AVX2;
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7)
+        {
+            __cpuid(info, 1);
+            // the CPU has AVX and the OS saves the YMM registers
+            const int osxsave_avx = (1 << 27) | (1 << 28);
+            if ((info[2] & osxsave_avx) == osxsave_avx && (_xgetbv(0) & 6) == 6)
+            {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5))
+                {
+                    return LLImageSIMD::AVX2;
+                }
+            }
+        }
+        return LLImageSIMD::SSE2;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? LLImageSIMD::AVX2 : LLImageSIMD::SSE2;
+#endif
+    }
+
+    std::atomic<S32>& current_level()
+    {
+        static std::atomic<S32> sLevel{ LLImageSIMD::getSupportedLevel() };
+        return sLevel;
+    }
+}
+
+LLImageSIMD::ELevel LLImageSIMD::getSupportedLevel()
+{
+    static const ELevel sSupported = detect_level();
+    return sSupported;
+}
+
+LLImageSIMD::ELevel LLImageSIMD::getLevel()
+{
+    return (ELevel)current_level().load(std::memory_order_relaxed);
+}
+
+void LLImageSIMD::setLevel(ELevel level)
+{
+    current_level() = llmin(level, getSupportedLevel());
+}
+
+const char* LLImageSIMD::getLevelName(ELevel level)
+{
+    switch (level)
+    {
+    case SSE2:
+        return "SSE2";
+    case AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+void LLImageSIMD::mipRow(const U8* row0, const U8* row1, U8* out, S32 out_width, S32 nchannels)
+{
+    switch (getLevel())
+    {
+#if LL_IMAGE_SIMD
+    case AVX2:
+        mip_row_avx2(row0, row1, out, out_width, nchannels);
+        break;
+    case SSE2:
+        mip_row_sse2(row0, row1, out, out_width, nchannels);
+        break;
+#endif
+    default:
+        mip_row_scalar(row0, row1, out, out_width, nchannels);
+        break;
+    }
+}
+
+void LLImageSIMD::compositeRow4onto3(const U8* src, U8* dst, S32 pixels)
+{
+    switch (getLevel())
+    {
+#if LL_IMAGE_SIMD
+    case AVX2:
+        composite_row_avx2(src, dst, pixels);
+        break;
+    case SSE2:
+        composite_row_sse2(src, dst, pixels);
+        break;
+#endif
+    default:
+        composite_row_scalar(src, dst, pixels);
+        break;
+    }
+}
+
+void LLImageSIMD::downscaleRow(const U8* src_row, S32 src_stride, const S32* xpoints, const S32* xapoints,
+                               S32 yapoint, U8* dst, S32 dst_width, S32 nchannels)
+{
+    // A single channel has nothing to spread across lanes
+    ELevel level = nchannels == 1 ? SCALAR : getLevel();
+    switch (level)
+    {
+#if LL_IMAGE_SIMD
+    case AVX2:
+        if (nchannels == 4)
+        {
+            downscale_row_avx2<4>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+        }
+        else
+        {
+            downscale_row_avx2<3>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+        }
+        break;
+    case SSE2:
+        if (nchannels == 4)
+        {
+            downscale_row_sse2<4>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+        }
+        else
+        {
+            downscale_row_sse2<3>(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width);
+        }
+        break;
+#endif
+    default:
+        downscale_row_scalar(src_row, src_stride, xpoints, xapoints, yapoint, dst, dst_width, nchannels);
+        break;
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file llimagesimd.h
+ * @brief SSE2/AVX2 kernels for the LLImageRaw pixel loops.
+ *
+ * @Description:
+ * Row kernels for the hot LLImageRaw/LLImageBase loops: mip generation,
+ * alpha compositing of RGBA onto RGB and the box-filtered downscale used
+ * by LLImageRaw::scale(). Each kernel has a scalar version, an SSE2
+ * version and an AVX2 version. The best level the CPU supports is picked
+ * once at runtime; every level produces exactly the same bytes as the
+ * scalar code.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGESIMD_H
+#define LL_LLIMAGESIMD_H
+
+#include "stdtypes.h"
+
+namespace LLImageSIMD
+{
+    enum ELevel
+    {
+        SCALAR = 0,
+        SSE2,
+        AVX2    // also uses the SSSE3 and SSE4.1 instructions AVX2 implies
+    };
+
+    // Best level this build and CPU support
+    ELevel getSupportedLevel();
+
+    // Level the kernels currently use, getSupportedLevel() by default
+    ELevel getLevel();
+
+    // Force a lower level, for tests and benchmarks. Clamped to the
+    // supported level.
+    void setLevel(ELevel level);
+
+    const char* getLevelName(ELevel level);
+
+    /**
+     * One output row of LLImageBase::generateMip(). Every output pixel is
+     * the truncated average of the 2x2 block of input pixels below it in
+     * row0 and row1. nchannels is 1 to 4.
+     */
+    void mipRow(const U8* row0, const U8* row1, U8* out, S32 out_width, S32 nchannels);
+
+    /**
+     * Blend a row of RGBA pixels from src over the same number of RGB
+     * pixels in dst, as LLImageRaw::compositeUnscaled4onto3() does.
+     */
+    void compositeRow4onto3(const U8* src, U8* dst, S32 pixels);
+
+    /**
+     * One output row of the box filter LLImageRaw::scale() uses when both
+     * dimensions shrink. src_row is the first source row under this
+     * output row, xpoints the first source column under each output
+     * pixel, and xapoints/yapoint the packed (count << 16 | first weight)
+     * filter weights computed by scale_info in llimage.cpp.
+     */
+    void downscaleRow(const U8* src_row, S32 src_stride, const S32* xpoints, const S32* xapoints,
+                      S32 yapoint, U8* dst, S32 dst_width, S32 nchannels);
+}
+
+#endif // LL_LLIMAGESIMD_H
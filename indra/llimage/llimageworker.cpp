@@ -28,6 +28,7 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "lltimer.h" // <FS:Perf/> Priority-aware decode queue
 #include "threadpool.h"
 
 /*--------------------------------------------------------------------------*/
@@ -61,11 +62,23 @@ private:
 //----------------------------------------------------------------------------
 
 // MAIN THREAD
-LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
+// <FS:Perf> Priority-aware decode queue
+//LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
+//{
+//    mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
+//    mThreadPool->start();
+//}
+LLImageDecodeThread::LLImageDecodeThread(bool threaded)
+	: mNextHandle(1),
+	  mNextSequence(0)
 {
-    mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
-    mThreadPool->start();
+	if (threaded)
+	{
+		mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
+		mThreadPool->start();
+	}
 }
+// </FS:Perf>
 
 //virtual 
 LLImageDecodeThread::~LLImageDecodeThread()
@@ -76,44 +89,157 @@ LLImageDecodeThread::~LLImageDecodeThread()
 size_t LLImageDecodeThread::update(F32 max_time_ms)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+	// <FS:Perf> Priority-aware decode queue
+	if (!mThreadPool)
+	{
+		LLTimer timer;
+		do
+		{
+			processNextRequest();
+		}
+		while (getPending() && timer.getElapsedTimeF32() * 1000.f < max_time_ms);
+	}
+	// </FS:Perf>
     return getPending();
 }
 
 size_t LLImageDecodeThread::getPending()
 {
-    return mThreadPool->getQueue().size();
+    // <FS:Perf> Priority-aware decode queue
+    //return mThreadPool->getQueue().size();
+    LLMutexLock lock(&mQueueMutex);
+    return mPending.size();
+    // </FS:Perf>
 }
 
 LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     const LLPointer<LLImageFormatted>& image, 
     S32 discard,
     BOOL needs_aux,
-    const LLPointer<LLImageDecodeThread::Responder>& responder)
+    const LLPointer<LLImageDecodeThread::Responder>& responder,
+    F32 priority) // <FS:Perf/> Priority-aware decode queue
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
-    // Instantiate the ImageRequest right in the lambda, why not?
-    bool posted = mThreadPool->getQueue().post(
-        [req = ImageRequest(image, discard, needs_aux, responder)]
-        () mutable
+    // <FS:Perf> Priority-aware decode queue
+    //// Instantiate the ImageRequest right in the lambda, why not?
+    //bool posted = mThreadPool->getQueue().post(
+    //    [req = ImageRequest(image, discard, needs_aux, responder)]
+    //    () mutable
+    //    {
+    //        auto done = req.processRequest();
+    //        req.finishRequest(done);
+    //    });
+    //if (! posted)
+    //{
+    //    LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
+    //    // should this return 0?
+    //}
+    //
+    //// It's important to our consumer (LLTextureFetchWorker) that we return a
+    //// nonzero handle. It is NOT important that the nonzero handle be unique:
+    //// nothing is ever done with it except to compare it to zero, or zero it.
+    //return 17;
+
+    handle_t handle;
+    {
+        LLMutexLock lock(&mQueueMutex);
+        // handles are never 0, which callers use for "no request"
+        do
         {
-            auto done = req.processRequest();
-            req.finishRequest(done);
-        });
-    if (! posted)
+            handle = mNextHandle++;
+        }
+        while (handle == 0 || mPending.find(handle) != mPending.end());
+
+        PendingRequest& pending = mPending[handle];
+        pending.mRequest.reset(new ImageRequest(image, discard, needs_aux, responder));
+        pending.mQueueIter = mQueue.insert({ priority, mNextSequence++, handle }).first;
+    }
+
+    // One task per request: the task decodes whatever is most important
+    // when it gets to run, not necessarily this request.
+    if (mThreadPool && !mThreadPool->getQueue().post([this]() { processNextRequest(); }))
     {
         LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
-        // should this return 0?
+        cancel(handle);
+        return 0;
+    }
+    return handle;
+    // </FS:Perf>
+}
+
+// <FS:Perf> Priority-aware decode queue
+bool LLImageDecodeThread::updatePriority(handle_t handle, F32 priority)
+{
+    LLMutexLock lock(&mQueueMutex);
+    pending_map_t::iterator it = mPending.find(handle);
+    if (it == mPending.end())
+    {
+        return false;
     }
+    if (it->second.mQueueIter->mPriority != priority)
+    {
+        QueueEntry entry = *it->second.mQueueIter;
+        entry.mPriority = priority;
+        mQueue.erase(it->second.mQueueIter);
+        it->second.mQueueIter = mQueue.insert(entry).first;
+    }
+    return true;
+}
+
+bool LLImageDecodeThread::cancel(handle_t handle)
+{
+    std::unique_ptr<ImageRequest> request;
+    {
+        LLMutexLock lock(&mQueueMutex);
+        pending_map_t::iterator it = mPending.find(handle);
+        if (it == mPending.end())
+        {
+            return false;
+        }
+        request = std::move(it->second.mRequest);
+        mQueue.erase(it->second.mQueueIter);
+        mPending.erase(it);
+    }
+    // The request (and the image and responder it holds) is released
+    // outside the lock.
+    return true;
+}
 
-    // It's important to our consumer (LLTextureFetchWorker) that we return a
-    // nonzero handle. It is NOT important that the nonzero handle be unique:
-    // nothing is ever done with it except to compare it to zero, or zero it.
-    return 17;
+void LLImageDecodeThread::processNextRequest()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    std::unique_ptr<ImageRequest> request;
+    {
+        LLMutexLock lock(&mQueueMutex);
+        if (mQueue.empty())
+        {
+            // the request this task was posted for has been cancelled
+            return;
+        }
+        pending_map_t::iterator it = mPending.find(mQueue.begin()->mHandle);
+        request = std::move(it->second.mRequest);
+        mQueue.erase(mQueue.begin());
+        mPending.erase(it);
+    }
+    bool done = request->processRequest();
+    request->finishRequest(done);
 }
+// </FS:Perf>
 
 void LLImageDecodeThread::shutdown()
 {
+    // <FS:Perf> Priority-aware decode queue: nobody is going to look at
+    // the results of decodes that have not started yet.
+    pending_map_t dropped;
+    {
+        LLMutexLock lock(&mQueueMutex);
+        mQueue.clear();
+        mPending.swap(dropped);
+    }
+    dropped.clear();
+    if (mThreadPool)
+    // </FS:Perf>
     mThreadPool->close();
 }
 
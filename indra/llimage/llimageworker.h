@@ -30,6 +30,14 @@
 #include "llimage.h"
 #include "llpointer.h"
 #include "threadpool_fwd.h"
+// <FS:Perf> Priority-aware decode queue
+#include "llmutex.h"
+#include <map>
+#include <memory>
+#include <set>
+
+class ImageRequest;
+// </FS:Perf>
 
 class LLImageDecodeThread
 {
@@ -48,17 +56,71 @@ public:
 
 	// meant to resemble LLQueuedThread::handle_t
 	typedef U32 handle_t;
+	// <FS:Perf> Priority-aware decode queue
+	//handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
+	//					 S32 discard, BOOL needs_aux,
+	//					 const LLPointer<Responder>& responder);
+
+	// Requests with a higher priority are decoded first, requests with the
+	// same priority in the order they were queued. Returns a handle for
+	// updatePriority() and cancel(), or 0 if the request was not queued
+	// because the thread is shutting down.
 	handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
 						 S32 discard, BOOL needs_aux,
-						 const LLPointer<Responder>& responder);
+						 const LLPointer<Responder>& responder,
+						 F32 priority = 0.f);
+	// Returns false if the request has already started decoding.
+	bool updatePriority(handle_t handle, F32 priority);
+	// Drops a request that has not started decoding yet; its responder is
+	// never called. Returns false if it is too late for that.
+	bool cancel(handle_t handle);
+	// </FS:Perf>
 	size_t getPending();
 	size_t update(F32 max_time_ms);
 	void shutdown();
 
 private:
+	// <FS:Perf> Priority-aware decode queue
+	struct QueueEntry
+	{
+		F32 mPriority;
+		U64 mSequence;
+		handle_t mHandle;
+
+		// highest priority first, then oldest first
+		bool operator<(const QueueEntry& rhs) const
+		{
+			return mPriority > rhs.mPriority ||
+				(mPriority == rhs.mPriority && mSequence < rhs.mSequence);
+		}
+	};
+	typedef std::set<QueueEntry> queue_t;
+
+	struct PendingRequest
+	{
+		std::unique_ptr<ImageRequest> mRequest;
+		queue_t::iterator mQueueIter;
+	};
+	typedef std::map<handle_t, PendingRequest> pending_map_t;
+
+	// Pops and decodes the highest priority request, if any
+	void processNextRequest();
+
+	LLMutex mQueueMutex;
+	queue_t mQueue;
+	pending_map_t mPending;
+	handle_t mNextHandle;
+	U64 mNextSequence;
+	// </FS:Perf>
+
 	// As of SL-17483, LLImageDecodeThread is no longer itself an
 	// LLQueuedThread - instead this is the API by which we submit work to the
 	// "ImageDecode" ThreadPool.
+	// <FS:Perf> Each task posted to the pool decodes whichever queued
+	// request has the highest priority by the time the task runs. Without
+	// a pool (threaded == false), update() does the decoding.
+	// Declared last so the workers are joined before the queue goes away.
+	// </FS:Perf>
 	std::unique_ptr<LL::ThreadPool> mThreadPool;
 };
 
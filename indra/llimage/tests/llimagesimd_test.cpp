@@ -0,0 +1,305 @@
+/**
+ * @file llimagesimd_test.cpp
+ * @brief Checks that every LLImageSIMD level gives exactly the bytes of the
+ *        scalar kernels, plus a speed comparison of the levels.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimagesimd.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::vector<U8> random_bytes(size_t size, std::mt19937& rng)
+    {
+        std::vector<U8> bytes(size);
+        std::uniform_int_distribution<int> dist(0, 255);
+        for (U8& byte : bytes)
+        {
+            byte = (U8)dist(rng);
+        }
+        return bytes;
+    }
+
+    // The downscale filter weights, computed the way scale_info in
+    // llimage.cpp does when shrinking
+    void downscale_points(U32 src_size, U32 dst_size, std::vector<S32>& points, std::vector<S32>& apoints)
+    {
+        points.resize(dst_size);
+        apoints.resize(dst_size);
+        S32 inc = (src_size << 16) / dst_size;
+        S32 Cp = ((dst_size << 14) / src_size) + 1;
+        U32 val = 0;
+        for (U32 i = 0; i < dst_size; ++i, val += inc)
+        {
+            points[i] = llmax(0, (S32)val >> 16);
+            S32 ap = ((0x100 - ((val >> 8) & 0xff)) * Cp) >> 8;
+            apoints[i] = ap | (Cp << 16);
+        }
+    }
+
+    void downscale(const std::vector<U8>& src, U32 src_w, U32 src_h, U8* dst, U32 dst_w, U32 dst_h, S32 ch)
+    {
+        std::vector<S32> xpoints, xapoints, ypoints, yapoints;
+        downscale_points(src_w, dst_w, xpoints, xapoints);
+        downscale_points(src_h, dst_h, ypoints, yapoints);
+        for (U32 y = 0; y < dst_h; ++y)
+        {
+            LLImageSIMD::downscaleRow(src.data() + ypoints[y] * src_w * ch, src_w * ch,
+                                      xpoints.data(), xapoints.data(), yapoints[y],
+                                      dst + y * dst_w * ch, dst_w, ch);
+        }
+    }
+
+    std::vector<LLImageSIMD::ELevel> levels()
+    {
+        std::vector<LLImageSIMD::ELevel> result;
+        for (S32 level = LLImageSIMD::SCALAR; level <= LLImageSIMD::getSupportedLevel(); ++level)
+        {
+            result.push_back((LLImageSIMD::ELevel)level);
+        }
+        return result;
+    }
+
+    // Microseconds per call of func, best of a few runs
+    F64 time_usec(const std::function<void()>& func, S32 repeat)
+    {
+        F64 best = 0.0;
+        for (S32 run = 0; run < 3; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (S32 i = 0; i < repeat; ++i)
+            {
+                func();
+            }
+            F64 usec = std::chrono::duration<F64, std::micro>(std::chrono::steady_clock::now() - start).count() / repeat;
+            best = (run == 0 || usec < best) ? usec : best;
+        }
+        return best;
+    }
+}
+
+namespace tut
+{
+    struct llimagesimd_data
+    {
+        std::mt19937 mRNG{ 20240517 };
+
+        ~llimagesimd_data()
+        {
+            LLImageSIMD::setLevel(LLImageSIMD::getSupportedLevel());
+        }
+    };
+    typedef test_group<llimagesimd_data> llimagesimd_t;
+    typedef llimagesimd_t::object llimagesimd_object_t;
+    tut::llimagesimd_t tut_llimagesimd("LLImageSIMD");
+
+    template<> template<>
+    void llimagesimd_object_t::test<1>()
+    {
+        set_test_name("mip rows match the scalar kernel");
+
+        for (S32 ch = 1; ch <= 4; ++ch)
+        {
+            // odd widths exercise the scalar tail after the vector loop
+            for (S32 width = 1; width <= 80; ++width)
+            {
+                std::vector<U8> in = random_bytes(width * 2 * ch * 2, mRNG);
+                const U8* row0 = in.data();
+                const U8* row1 = in.data() + width * 2 * ch;
+
+                LLImageSIMD::setLevel(LLImageSIMD::SCALAR);
+                std::vector<U8> expected(width * ch);
+                LLImageSIMD::mipRow(row0, row1, expected.data(), width, ch);
+                ensure_equals("scalar first pixel", (S32)expected[0],
+                              (S32)((row0[0] + row0[ch] + row1[0] + row1[ch]) >> 2));
+
+                for (LLImageSIMD::ELevel level : levels())
+                {
+                    LLImageSIMD::setLevel(level);
+                    std::vector<U8> actual(width * ch);
+                    LLImageSIMD::mipRow(row0, row1, actual.data(), width, ch);
+                    ensure(llformat("%s mip, %d channels, width %d", LLImageSIMD::getLevelName(level), ch, width),
+                           actual == expected);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void llimagesimd_object_t::test<2>()
+    {
+        set_test_name("composite rows match the scalar kernel");
+
+        // every combination of alpha and colour, which covers the
+        // transparent and opaque special cases of the scalar code
+        std::vector<U8> src(256 * 256 * 4), dst(256 * 256 * 3);
+        for (S32 alpha = 0; alpha < 256; ++alpha)
+        {
+            for (S32 value = 0; value < 256; ++value)
+            {
+                U8* s = &src[(alpha * 256 + value) * 4];
+                U8* d = &dst[(alpha * 256 + value) * 3];
+                s[0] = (U8)value;
+                s[1] = (U8)(255 - value);
+                s[2] = (U8)(value * 7);
+                s[3] = (U8)alpha;
+                d[0] = (U8)(255 - value);
+                d[1] = (U8)value;
+                d[2] = (U8)(value * 13);
+            }
+        }
+
+        LLImageSIMD::setLevel(LLImageSIMD::SCALAR);
+        std::vector<U8> expected = dst;
+        LLImageSIMD::compositeRow4onto3(src.data(), expected.data(), 256 * 256);
+        ensure_equals("transparent keeps dst", (S32)expected[5 * 3], (S32)dst[5 * 3]);
+        ensure_equals("opaque takes src", (S32)expected[(255 * 256 + 5) * 3], 5);
+
+        for (LLImageSIMD::ELevel level : levels())
+        {
+            LLImageSIMD::setLevel(level);
+            std::vector<U8> actual = dst;
+            LLImageSIMD::compositeRow4onto3(src.data(), actual.data(), 256 * 256);
+            ensure(llformat("%s composite", LLImageSIMD::getLevelName(level)), actual == expected);
+
+            // short rows, so the tails get covered
+            for (S32 pixels = 0; pixels <= 20; ++pixels)
+            {
+                std::vector<U8> row_src = random_bytes(pixels * 4, mRNG);
+                std::vector<U8> row_dst = random_bytes(pixels * 3, mRNG);
+                std::vector<U8> row_expected = row_dst;
+                LLImageSIMD::setLevel(LLImageSIMD::SCALAR);
+                LLImageSIMD::compositeRow4onto3(row_src.data(), row_expected.data(), pixels);
+                LLImageSIMD::setLevel(level);
+                LLImageSIMD::compositeRow4onto3(row_src.data(), row_dst.data(), pixels);
+                ensure(llformat("%s composite of %d pixels", LLImageSIMD::getLevelName(level), pixels),
+                       row_dst == row_expected);
+            }
+        }
+    }
+
+    template<> template<>
+    void llimagesimd_object_t::test<3>()
+    {
+        set_test_name("downscales match the scalar kernel");
+
+        const U32 sizes[][4] = {
+            { 512, 512, 256, 256 },
+            { 512, 512, 100, 37 },
+            { 97, 61, 96, 60 },
+            { 1024, 256, 3, 2 },
+            { 33, 17, 1, 1 },
+        };
+        for (S32 ch : { 1, 3, 4 })
+        {
+            for (const auto& size : sizes)
+            {
+                const U32 src_w = size[0], src_h = size[1], dst_w = size[2], dst_h = size[3];
+                std::vector<U8> src = random_bytes(src_w * src_h * ch, mRNG);
+
+                LLImageSIMD::setLevel(LLImageSIMD::SCALAR);
+                std::vector<U8> expected(dst_w * dst_h * ch);
+                downscale(src, src_w, src_h, expected.data(), dst_w, dst_h, ch);
+
+                for (LLImageSIMD::ELevel level : levels())
+                {
+                    LLImageSIMD::setLevel(level);
+                    std::vector<U8> actual(dst_w * dst_h * ch);
+                    downscale(src, src_w, src_h, actual.data(), dst_w, dst_h, ch);
+                    ensure(llformat("%s downscale %ux%u to %ux%u, %d channels", LLImageSIMD::getLevelName(level),
+                                    src_w, src_h, dst_w, dst_h, ch),
+                           actual == expected);
+                }
+            }
+        }
+
+        // a flat image stays flat
+        std::vector<U8> grey(64 * 64 * 4, 200);
+        std::vector<U8> small(16 * 16 * 4);
+        downscale(grey, 64, 64, small.data(), 16, 16, 4);
+        for (U8 value : small)
+        {
+            ensure_distance("flat downscale", (S32)value, 200, 1);
+        }
+    }
+
+    // Not a regression test: times each level on 1024x1024 images and
+    // prints the result.
+    template<> template<>
+    void llimagesimd_object_t::test<4>()
+    {
+        set_test_name("kernel speed per level");
+
+        const S32 size = 1024;
+        std::vector<U8> src = random_bytes(size * size * 4, mRNG);
+        std::vector<U8> dst = random_bytes(size * size * 4, mRNG);
+
+        std::cout << "\nLLImageSIMD, " << size << "x" << size << " source, microseconds per image:" << std::endl;
+        for (LLImageSIMD::ELevel level : levels())
+        {
+            LLImageSIMD::setLevel(level);
+            std::cout << "  " << LLImageSIMD::getLevelName(level) << ":";
+            for (S32 ch : { 1, 3, 4 })
+            {
+                F64 usec = time_usec([&]()
+                    {
+                        const S32 half = size / 2;
+                        for (S32 y = 0; y < half; ++y)
+                        {
+                            const U8* row0 = src.data() + y * 2 * size * ch;
+                            LLImageSIMD::mipRow(row0, row0 + size * ch, dst.data() + y * half * ch, half, ch);
+                        }
+                    }, 10);
+                std::cout << " mip" << ch << " " << (S32)usec;
+            }
+            F64 usec = time_usec([&]()
+                {
+                    for (S32 y = 0; y < size; ++y)
+                    {
+                        LLImageSIMD::compositeRow4onto3(src.data() + y * size * 4, dst.data() + y * size * 3, size);
+                    }
+                }, 10);
+            std::cout << ", composite " << (S32)usec;
+            for (S32 ch : { 3, 4 })
+            {
+                usec = time_usec([&]()
+                    {
+                        downscale(src, size, size, dst.data(), size / 4, size / 4, ch);
+                    }, 3);
+                std::cout << ", downscale" << ch << " " << (S32)usec;
+            }
+            std::cout << std::endl;
+        }
+    }
+}
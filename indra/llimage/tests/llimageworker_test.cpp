@@ -109,6 +109,23 @@ namespace tut
 			bool* done;
 	};
 
+	// Responder recording the order in which requests complete
+	class order_responder_test : public LLImageDecodeThread::Responder
+	{
+		public:
+			order_responder_test(std::vector<S32>* order, S32 id)
+				: mOrder(order), mID(id)
+			{
+			}
+			virtual void completed(bool success, LLImageRaw* raw, LLImageRaw* aux)
+			{
+				mOrder->push_back(mID);
+			}
+		private:
+			std::vector<S32>* mOrder;
+			S32 mID;
+	};
+
 	// Test wrapper declaration : decode thread
 	struct imagedecodethread_test
 	{
@@ -165,4 +182,45 @@ namespace tut
 		// Verifies that the responder has now been called
 		ensure("LLImageDecodeThread: threaded work unit not processed", done == true);
 	}
+
+	template<> template<>
+	void imagedecodethread_object_t::test<2>()
+	{
+		// Without a thread pool, update() decodes in priority order
+		mThread = new LLImageDecodeThread(false);
+		std::vector<S32> order;
+		mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 1), 1.f);
+		mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 2), 3.f);
+		mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 3), 2.f);
+		mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 4), 2.f);
+		ensure_equals("LLImageDecodeThread: pending before update", mThread->getPending(), 4);
+		ensure_equals("LLImageDecodeThread: pending after update", mThread->update(1000.f), 0);
+		ensure_equals("LLImageDecodeThread: all decoded", order.size(), 4);
+		ensure_equals("LLImageDecodeThread: highest priority first", order[0], 2);
+		ensure_equals("LLImageDecodeThread: equal priorities in order queued", order[1], 3);
+		ensure_equals("LLImageDecodeThread: equal priorities in order queued", order[2], 4);
+		ensure_equals("LLImageDecodeThread: lowest priority last", order[3], 1);
+	}
+
+	template<> template<>
+	void imagedecodethread_object_t::test<3>()
+	{
+		// Reprioritize and cancel queued requests
+		mThread = new LLImageDecodeThread(false);
+		std::vector<S32> order;
+		LLImageDecodeThread::handle_t a = mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 1), 1.f);
+		LLImageDecodeThread::handle_t b = mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 2), 2.f);
+		LLImageDecodeThread::handle_t c = mThread->decodeImage(NULL, 0, FALSE, new order_responder_test(&order, 3), 3.f);
+		ensure("LLImageDecodeThread: handles are unique", a != b && b != c && a != c);
+		ensure("LLImageDecodeThread: updatePriority()", mThread->updatePriority(a, 10.f));
+		ensure("LLImageDecodeThread: cancel()", mThread->cancel(b));
+		ensure("LLImageDecodeThread: cancel() twice", !mThread->cancel(b));
+		ensure("LLImageDecodeThread: updatePriority() after cancel()", !mThread->updatePriority(b, 10.f));
+		ensure_equals("LLImageDecodeThread: pending after cancel()", mThread->getPending(), 2);
+		mThread->update(1000.f);
+		ensure_equals("LLImageDecodeThread: cancelled request not decoded", order.size(), 2);
+		ensure_equals("LLImageDecodeThread: reprioritized request first", order[0], 1);
+		ensure_equals("LLImageDecodeThread: remaining request", order[1], 3);
+		ensure("LLImageDecodeThread: cancel() after decoding", !mThread->cancel(c));
+	}
 }
@@ -26,6 +26,7 @@
 
 #include "linden_common.h"
 #include "llimagej2coj.h"
+#include "llcrc.h" // <FS:Perf/> Keep decoder state between calls for the same image
 
 // this is defined so that we get static linking.
 #include "openjpeg.h"
@@ -336,7 +337,10 @@ public:
         return true;
     }
 
-    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level)
+    // <FS:Perf> Region limited decode
+    //bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level)
+    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level, const S32* region = nullptr)
+    // </FS:Perf>
     {
         parameters.flags &= ~OPJ_DPARAMETERS_DUMP_FLAG;
 
@@ -392,6 +396,14 @@ public:
             *channels = image->numcomps;
         }
 
+        // <FS:Perf> Region limited decode: only the code blocks covering
+        // the area get decoded
+        if (region && !opj_set_decode_area(decoder, image, region[0], region[1], region[2], region[3]))
+        {
+            return false;
+        }
+        // </FS:Perf>
+
         OPJ_BOOL decoded = opj_decode(decoder, stream, image);
 
         // count was zero.  The latter is just a sanity check before we
@@ -710,8 +722,54 @@ private:
 };
 
 
+// <FS:Perf> Keep decoder state between calls for the same image
+// Length of the main header of a J2K codestream, i.e. everything before the
+// first tile-part, or 0 if the header is malformed or not complete yet.
+static U32 mainHeaderLength(const U8* data, U32 size)
+{
+    // SOC marker
+    if (size < 2 || data[0] != 0xff || data[1] != 0x4f)
+    {
+        return 0;
+    }
+    U32 pos = 2;
+    while (pos + 4 <= size)
+    {
+        if (data[pos] != 0xff)
+        {
+            return 0;
+        }
+        if (data[pos + 1] == 0x90)
+        {
+            // SOT marker: start of the first tile-part
+            return pos;
+        }
+        // every main header marker segment has a 16 bit length that
+        // includes the length field itself
+        U32 length = (data[pos + 2] << 8) | data[pos + 3];
+        if (length < 2)
+        {
+            return 0;
+        }
+        pos += 2 + length;
+    }
+    return 0;
+}
+// </FS:Perf>
+
 LLImageJ2COJ::LLImageJ2COJ()
 	: LLImageJ2CImpl()
+	// <FS:Perf> Keep decoder state between calls for the same image
+	, mHeaderWidth(0)
+	, mHeaderHeight(0)
+	, mHeaderComponents(0)
+	, mHeaderDiscardLevel(0)
+	, mLastDecodeData(nullptr)
+	, mLastDecodeBytes(0)
+	, mLastDecodeDiscardLevel(-1)
+	, mLastDecodeCRC(0)
+	, mHasRegion(false)
+	// </FS:Perf>
 {
 }
 
@@ -723,6 +781,14 @@ LLImageJ2COJ::~LLImageJ2COJ()
 bool LLImageJ2COJ::initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level, int* region)
 {
     base.mDiscardLevel = discard_level;
+    // <FS:Perf> Region limited decode
+    mHasRegion = (region != NULL);
+    if (mHasRegion)
+    {
+        memcpy(mRegion, region, sizeof(mRegion));
+    }
+    mLastDecode.reset();
+    // </FS:Perf>
 	return false;
 }
 
@@ -735,7 +801,9 @@ bool LLImageJ2COJ::initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int block
 
 bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count)
 {
-    JPEG2KDecode decoder(0);
+    // <FS:Perf> Keep decoder state between calls for the same image
+    //JPEG2KDecode decoder(0);
+    // </FS:Perf>
 
     // <FS:Techwolf Lupindo> texture comment metadata reader
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;	// <FS:Beq> instrument image decodes
@@ -781,7 +849,35 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
     U32 image_channels = 0;
     S32 data_size = base.getDataSize();
     S32 max_bytes = (base.getMaxBytes() ? base.getMaxBytes() : data_size);
-    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel);
+    // <FS:Perf> Keep decoder state between calls for the same image
+    //bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel);
+    std::unique_ptr<JPEG2KDecode> decoder;
+    bool decoded = false;
+    if (mLastDecode &&
+        mLastDecodeData == base.getData() &&
+        mLastDecodeBytes == max_bytes &&
+        mLastDecodeDiscardLevel == base.mDiscardLevel)
+    {
+        // Same bytes as last time? Only checked when there is a candidate,
+        // and far cheaper than decoding them again.
+        LLCRC crc;
+        crc.update(base.getData(), max_bytes);
+        if (crc.getCRC() == mLastDecodeCRC)
+        {
+            decoder = std::move(mLastDecode);
+            image_channels = decoder->getImage()->numcomps;
+            decoded = true;
+        }
+    }
+    mLastDecode.reset();
+
+    if (!decoder)
+    {
+        decoder.reset(new JPEG2KDecode(0));
+        decoded = decoder->decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel,
+                                  mHasRegion ? mRegion : nullptr);
+    }
+    // </FS:Perf>
 
     // set correct channel count early so failed decodes don't miss it...
     S32 channels = (S32)image_channels - first_channel;
@@ -802,7 +898,10 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
         return true; // done
     }
 
-    opj_image_t *image = decoder.getImage();
+    // <FS:Perf> Keep decoder state between calls for the same image
+    //opj_image_t *image = decoder.getImage();
+    opj_image_t *image = decoder->getImage();
+    // </FS:Perf>
 
     // Component buffers are allocated in an image width by height buffer.
     // The image placed in that buffer is ceil(width/2^factor) by
@@ -860,6 +959,21 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 
     base.setDiscardLevel(f);
 
+    // <FS:Perf> Keep decoder state between calls for the same image
+    // Hang on to the decoded image if it has components beyond the ones
+    // just copied out, for the decodeChannels() that will want them.
+    if ((S32)image->numcomps > first_channel + channels)
+    {
+        LLCRC crc;
+        crc.update(base.getData(), max_bytes);
+        mLastDecode = std::move(decoder);
+        mLastDecodeData = base.getData();
+        mLastDecodeBytes = max_bytes;
+        mLastDecodeDiscardLevel = base.mDiscardLevel;
+        mLastDecodeCRC = crc.getCRC();
+    }
+    // </FS:Perf>
+
     return true; // done
 }
 
@@ -887,12 +1001,39 @@ bool LLImageJ2COJ::getMetadata(LLImageJ2C &base)
 
     U32 dataSize = base.getDataSize();
     U8* data = base.getData();
+
+    // <FS:Perf> Keep decoder state between calls for the same image
+    // getMetadata() is called again every time more of the image has
+    // arrived, but the main header stays the same.
+    U32 header_length = mainHeaderLength(data, dataSize);
+    if (header_length &&
+        header_length == mHeaderBytes.size() &&
+        !memcmp(data, mHeaderBytes.data(), header_length))
+    {
+        base.mDiscardLevel = mHeaderDiscardLevel;
+        base.setSize(mHeaderWidth, mHeaderHeight, mHeaderComponents);
+        return true;
+    }
+    mHeaderBytes.clear();
+    // </FS:Perf>
+
     bool header_read = decode.readHeader(data, dataSize, width, height, components, discard_level);
     if (!header_read)
     {
         return false;
     }
 
+    // <FS:Perf> Keep decoder state between calls for the same image
+    if (header_length)
+    {
+        mHeaderBytes.assign(data, data + header_length);
+        mHeaderWidth = width;
+        mHeaderHeight = height;
+        mHeaderComponents = components;
+        mHeaderDiscardLevel = discard_level;
+    }
+    // </FS:Perf>
+
     base.mDiscardLevel = discard_level;
     base.setSize(width, height, components);
     return true;
@@ -28,6 +28,12 @@
 #define LL_LLIMAGEJ2COJ_H
 
 #include "llimagej2c.h"
+// <FS:Perf> Keep decoder state between calls for the same image
+#include <memory>
+#include <vector>
+
+class JPEG2KDecode;
+// </FS:Perf>
 
 class LLImageJ2COJ : public LLImageJ2CImpl
 {	
@@ -42,6 +48,35 @@ protected:
 	virtual bool initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level = -1, int* region = NULL);
 	virtual bool initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size = -1, int precincts_size = -1, int levels = 0);
     virtual std::string getEngineInfo() const;
+
+private:
+	// <FS:Perf> Keep decoder state between calls for the same image
+	// There is one LLImageJ2COJ per LLImageJ2C, so this is state about a
+	// single texture that gets more bytes and more decodes over time.
+
+	// Main header of the codestream last parsed by getMetadata() and what
+	// was read from it. The header doesn't change as more of the image
+	// arrives, so it is only parsed again if these bytes differ.
+	std::vector<U8> mHeaderBytes;
+	S32 mHeaderWidth;
+	S32 mHeaderHeight;
+	S32 mHeaderComponents;
+	S32 mHeaderDiscardLevel;
+
+	// The last decode, kept only while the image has components that have
+	// not been copied out yet: a decode of the color channels is usually
+	// followed by a decodeChannels() of the aux channel from the same bytes.
+	std::unique_ptr<JPEG2KDecode> mLastDecode;
+	const U8* mLastDecodeData;
+	S32 mLastDecodeBytes;
+	S32 mLastDecodeDiscardLevel;
+	U32 mLastDecodeCRC;
+
+	// Area to decode as set by initDecode(): x0, y0, x1, y1 in full
+	// resolution pixels
+	bool mHasRegion;
+	S32 mRegion[4];
+	// </FS:Perf>
 };
 
 #endif
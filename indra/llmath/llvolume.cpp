@@ -2870,6 +2870,30 @@ void LLVolume::copyVolumeFaces(const LLVolume* volume)
 	mSculptLevel = 0;
 }
 
+// <FS:Perf>
+void LLVolume::moveVolumeFaces(LLVolume* volume)
+{
+	mVolumeFaces.swap(volume->mVolumeFaces);
+	volume->mVolumeFaces.clear();
+	mSculptLevel = 0;
+}
+
+void LLVolume::takeSculpt(LLVolume* volume)
+{
+	std::swap(mPathp, volume->mPathp);
+	std::swap(mProfilep, volume->mProfilep);
+	mMesh.swap(volume->mMesh);
+	mVolumeFaces.swap(volume->mVolumeFaces);
+	mFaceMask = volume->mFaceMask;
+	// sculpt() only measures real sculpt maps, and only above the lowest detail
+	if (volume->mSculptLevel >= 0 && mDetail > SCULPT_MIN_AREA_DETAIL)
+	{
+		mSurfaceArea = volume->mSurfaceArea;
+	}
+	mSculptLevel = volume->mSculptLevel;
+}
+// </FS:Perf>
+
 bool LLVolume::cacheOptimize(bool gen_tangents)
 {
 	for (S32 i = 0; i < mVolumeFaces.size(); ++i)
@@ -1098,6 +1098,14 @@ public:
 	// NaCl End
 
 	void copyVolumeFaces(const LLVolume* volume);
+	// <FS:Perf>
+	// Like copyVolumeFaces, for a volume that is discarded afterwards.
+	// Leaves volume without faces.
+	void moveVolumeFaces(LLVolume* volume);
+	// Takes the result of sculpt() on volume, a scratch volume with the same
+	// parameters and detail that was sculpted on another thread.
+	void takeSculpt(LLVolume* volume);
+	// </FS:Perf>
 	void copyFacesTo(std::vector<LLVolumeFace> &faces) const;
 	void copyFacesFrom(const std::vector<LLVolumeFace> &faces);
 
@@ -128,6 +128,27 @@ bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd)
     return true;
 }
 
+// <FS:Perf> Streaming XML parse
+bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd, LLSDStreamVisitor & visitor)
+{
+    BufferArray * body(response->getBody());
+    if (!body || !body->size())
+    {
+        return false;
+    }
+
+    LLCore::BufferArrayStream bas(body);
+    LLSD body_llsd;
+    S32 parse_status(LLSDSerialize::fromXML(body_llsd, bas, visitor, log));
+    if (LLSDParser::PARSE_FAILURE == parse_status)
+    {
+        return false;
+    }
+    out_llsd = body_llsd;
+    return true;
+}
+// </FS:Perf>
+
 
 HttpHandle requestPostWithLLSD(HttpRequest * request,
     HttpRequest::policy_t policy_id,
@@ -511,9 +532,27 @@ LLSD HttpCoroRawHandler::handleSuccess(LLCore::HttpResponse * response, LLCore::
 
     size_t size = body->size();
 
+    // <FS:Perf> Zero-copy access.  Gather the body blocks straight into the
+    // binary and move that into the result: one copy instead of a byte by
+    // byte stream copy plus another when assigning to the LLSD.
+    //LLCore::BufferArrayStream bas(body);
+#if 1
+    LLCore::BufferArray::segments_t segments;
+    body->getSegments(0, size, segments);
+
+    LLSD::Binary data;
+    data.reserve(size);
+    for (const LLCore::BufferArray::Segment & segment : segments)
+    {
+        data.insert(data.end(), (U8 *) segment.mData, (U8 *) segment.mData + segment.mLen);
+    }
+
+    result[HttpCoroutineAdapter::HTTP_RESULTS_RAW] = LLSD(std::move(data));
+    // </FS:Perf>
+
+#elif 0
     LLCore::BufferArrayStream bas(body);
 
-#if 1
     // This is the slower implementation.  It is safe vis-a-vi the const_cast<> and modification
     // of a LLSD managed array but contains an extra (potentially large) copy.
     // 
@@ -527,6 +566,8 @@ LLSD HttpCoroRawHandler::handleSuccess(LLCore::HttpResponse * response, LLCore::
     result[HttpCoroutineAdapter::HTTP_RESULTS_RAW] = data;
 
 #else
+    LLCore::BufferArrayStream bas(body);
+
     // This is disabled because it's dangerous.  See the other case for an 
     // alternate implementation.
     // We create a new LLSD::Binary object and assign it to the result map.
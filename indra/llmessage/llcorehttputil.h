@@ -46,6 +46,9 @@
 #include "llassettype.h"
 #include "lluuid.h"
 
+// <FS:Perf/> Streaming XML parse
+class LLSDStreamVisitor;
+
 ///
 /// The base llcorehttp library implements many HTTP idioms
 /// used in the viewer but not all.  That library intentionally
@@ -90,6 +93,16 @@ bool responseToLLSD(LLCore::HttpResponse * response,
 					bool log,
 					LLSD & out_llsd);
 
+// <FS:Perf> Streaming XML parse
+/// Same, but the elements of the arrays visitor asks for are handed
+/// to it while the body is parsed instead of ending up in out_llsd.
+/// See LLSDStreamVisitor.
+bool responseToLLSD(LLCore::HttpResponse * response,
+					bool log,
+					LLSD & out_llsd,
+					LLSDStreamVisitor & visitor);
+// </FS:Perf>
+
 /// Create a std::string representation of a response object
 /// suitable for logging.  Mainly intended for logging of
 /// failures and debug information.  This won't be fast,
@@ -0,0 +1,87 @@
+/**
+ * @file llmessagefield.h
+ * @brief Declaration of LLMessageField, a precompiled accessor for one
+ * variable of a template message.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGEFIELD_H
+#define LL_LLMESSAGEFIELD_H
+
+class LLMessageTemplate;
+
+/**
+ * A (message, block, variable) triple resolved once against the message
+ * template, typically when the message handler is registered. Reading the
+ * field of a message decoded by LLTemplateMessageReader is then an indexed
+ * load instead of a map lookup on the block name and another on the
+ * variable name.
+ *
+ * The block and variable names are kept, prehashed, for messages that
+ * don't come from the template reader (LLSD messages) or that are another
+ * message than the one the field was compiled for: those take the usual
+ * lookup by name.
+ */
+class LLMessageField
+{
+public:
+	LLMessageField()
+	:	mBlockName(NULL),
+		mVarName(NULL),
+		mTemplate(NULL),
+		mBlockIndex(-1),
+		mVarIndex(-1)
+	{
+	}
+
+	LLMessageField(const char* block, const char* var)
+	:	mBlockName(block),
+		mVarName(var),
+		mTemplate(NULL),
+		mBlockIndex(-1),
+		mVarIndex(-1)
+	{
+	}
+
+	// Resolves the block and variable against msg_template. Returns false,
+	// leaving the field uncompiled, if the template doesn't have them.
+	bool compile(const LLMessageTemplate* msg_template);
+
+	bool isCompiled() const { return mTemplate != NULL; }
+
+	const char* getBlockName() const { return mBlockName; }
+	const char* getVarName() const { return mVarName; }
+	const LLMessageTemplate* getTemplate() const { return mTemplate; }
+	S32 getBlockIndex() const { return mBlockIndex; }
+	S32 getVarIndex() const { return mVarIndex; }
+
+private:
+	const char*					mBlockName;
+	const char*					mVarName;
+	const LLMessageTemplate*	mTemplate;
+	S32							mBlockIndex;	// position of the block in the template
+	S32							mVarIndex;		// position of the variable in the block
+};
+
+#endif // LL_LLMESSAGEFIELD_H
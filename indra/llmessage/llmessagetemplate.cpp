@@ -45,12 +45,38 @@ void LLMsgVarData::addData(const void *data, S32 size, EMsgVariableType type, S3
 	}
 	if(size)
 	{
-		delete[] mData; // Delete it if it already exists
+		// <FS:Perf> In place decode
+		//delete[] mData; // Delete it if it already exists
+		deleteData(); // Delete it if it already exists
+		// </FS:Perf>
 		mData = new U8[size];
 		htolememcpy(mData, data, mType, size);
 	}
 }
 
+// <FS:Perf> In place decode
+void LLMsgVarData::addDataInPlace(const void *data, S32 size, EMsgVariableType type, S32 data_size)
+{
+	mSize = size;
+	mDataSize = data_size;
+	if ( (type != MVT_VARIABLE) && (type != MVT_FIXED) 
+		 && (mType != MVT_VARIABLE) && (mType != MVT_FIXED))
+	{
+		if (mType != type)
+		{
+			LL_WARNS() << "Type mismatch in LLMsgVarData::addDataInPlace for " << mName
+					<< LL_ENDL;
+		}
+	}
+	if(size)
+	{
+		deleteData();
+		mData = (U8*)data;
+		mOwnsData = false;
+	}
+}
+// </FS:Perf>
+
 void LLMsgData::addDataFast(char *blockname, char *varname, const void *data, S32 size, EMsgVariableType type, S32 data_size)
 {
 	// remember that if the blocknumber is > 0 then the number is appended to the name
@@ -67,6 +93,41 @@ void LLMsgData::addDataFast(char *blockname, char *varname, const void *data, S3
 	}
 }
 
+// <FS:Perf> LLMessageField functions
+
+bool LLMessageField::compile(const LLMessageTemplate* msg_template)
+{
+	mTemplate = NULL;
+	mBlockIndex = -1;
+	mVarIndex = -1;
+	if (!msg_template || !mBlockName || !mVarName)
+	{
+		return false;
+	}
+
+	// The decoded LLMsgData adds blocks, and variables within a block, in
+	// template order, so the template positions are valid for it too.
+	const LLMessageTemplate::message_block_map_t& blocks = msg_template->mMemberBlocks;
+	LLMessageTemplate::message_block_map_t::const_iterator block_iter = blocks.find(const_cast<char*>(mBlockName));
+	if (block_iter == blocks.end())
+	{
+		return false;
+	}
+
+	const LLMessageBlock::message_variable_map_t& variables = (*block_iter)->mMemberVariables;
+	LLMessageBlock::message_variable_map_t::const_iterator var_iter = variables.find(mVarName);
+	if (var_iter == variables.end())
+	{
+		return false;
+	}
+
+	mTemplate = msg_template;
+	mBlockIndex = (S32)(block_iter - blocks.begin());
+	mVarIndex = (S32)(var_iter - variables.begin());
+	return true;
+}
+// </FS:Perf>
+
 // LLMessageVariable functions and friends
 
 std::ostream& operator<<(std::ostream& s, LLMessageVariable &msg)
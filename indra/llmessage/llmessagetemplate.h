@@ -32,16 +32,19 @@
 #include "llindexedvector.h"
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
+#include "llmessagefield.h" // <FS:Perf/> Indexed access for LLMessageField
 
 class LLMsgVarData
 {
 public:
-	LLMsgVarData() : mName(NULL), mSize(-1), mDataSize(-1), mData(NULL), mType(MVT_U8)
+	// <FS:Perf> In place decode, added mOwnsData
+	LLMsgVarData() : mName(NULL), mSize(-1), mDataSize(-1), mData(NULL), mType(MVT_U8), mOwnsData(true)
 	{
 	}
 
-	LLMsgVarData(const char *name, EMsgVariableType type) : mSize(-1), mDataSize(-1), mData(NULL), mType(type)
+	LLMsgVarData(const char *name, EMsgVariableType type) : mSize(-1), mDataSize(-1), mData(NULL), mType(type), mOwnsData(true)
 	{
+	// </FS:Perf>
 		mName = (char *)name; 
 	}
 
@@ -52,11 +55,23 @@ public:
 	
 	void deleteData() 
 	{
-		delete[] mData;
+		// <FS:Perf> In place decode
+		//delete[] mData;
+		if (mOwnsData)
+		{
+			delete[] mData;
+		}
+		mOwnsData = true;
+		// </FS:Perf>
 		mData = NULL;
 	}
 	
 	void addData(const void *indata, S32 size, EMsgVariableType type, S32 data_size = -1);
+	// <FS:Perf> In place decode: references indata instead of copying it,
+	// indata has to outlive this variable and be in little endian order
+	void addDataInPlace(const void *indata, S32 size, EMsgVariableType type, S32 data_size = -1);
+	bool ownsData() const	{ return mOwnsData; }
+	// </FS:Perf>
 
 	char *getName() const	{ return mName; }
 	S32 getSize() const		{ return mSize; }
@@ -72,6 +87,7 @@ protected:
 
 	U8					*mData;
 	EMsgVariableType	mType;
+	bool				mOwnsData; // <FS:Perf/> In place decode
 };
 
 class LLMsgBlkData
@@ -103,6 +119,14 @@ public:
 		temp->addData(data, size, type, data_size);
 	}
 
+	// <FS:Perf> In place decode
+	void addDataInPlace(char *name, const void *data, S32 size, EMsgVariableType type, S32 data_size = -1)
+	{
+		LLMsgVarData* temp = &mMemberVarData[name]; // creates a new entry if one doesn't exist
+		temp->addDataInPlace(data, size, type, data_size);
+	}
+	// </FS:Perf>
+
 	S32									mBlockNumber;
 	typedef LLIndexedVector<LLMsgVarData, const char *, 8> msg_var_data_map_t;
 	msg_var_data_map_t					mMemberVarData;
@@ -130,11 +154,47 @@ public:
 
 	void addDataFast(char *blockname, char *varname, const void *data, S32 size, EMsgVariableType type, S32 data_size = -1);
 
+	// <FS:Perf> Indexed access for LLMessageField
+	// Repeat blocknum of the template block at block_index, NULL if the
+	// message doesn't have it
+	LLMsgBlkData* getBlock(S32 block_index, S32 blocknum) const
+	{
+		if (block_index < 0 || block_index + 1 >= (S32)mBlockListStart.size())
+		{
+			return NULL;
+		}
+		const S32 start = mBlockListStart[block_index];
+		if (blocknum < 0 || start + blocknum >= mBlockListStart[block_index + 1])
+		{
+			return NULL;
+		}
+		return mBlockList[start + blocknum];
+	}
+
+	// Number of repeats of the template block at block_index
+	S32 getBlockCount(S32 block_index) const
+	{
+		if (block_index < 0 || block_index + 1 >= (S32)mBlockListStart.size())
+		{
+			return 0;
+		}
+		return mBlockListStart[block_index + 1] - mBlockListStart[block_index];
+	}
+	// </FS:Perf>
+
 public:
 	typedef std::map<char*, LLMsgBlkData*> msg_blk_data_map_t;
 	msg_blk_data_map_t					mMemberBlocks;
 	char								*mName;
 	S32									mTotalSize;
+
+	// <FS:Perf> Indexed access for LLMessageField. The blocks of
+	// mMemberBlocks in template order, repeats next to each other, and
+	// for each template block the position of its first repeat in
+	// mBlockList followed by one past the last block.
+	std::vector<LLMsgBlkData*>			mBlockList;
+	std::vector<S32>					mBlockListStart;
+	// </FS:Perf>
 };
 
 // LLMessage* classes store the template of messages
@@ -55,7 +55,14 @@ LLPacketRing::LLPacketRing () :
 	mInBufferLength(0),
 	mOutBufferLength(0),
 	mDropPercentage(0.0f),
-	mPacketsToDrop(0x0)
+	mPacketsToDrop(0x0),
+	// <FS:Perf> Batched receive
+	mUseBatchReceive(TRUE),
+	mBatchCount(0),
+	mBatchNext(0),
+	mReceiveCalls(0),
+	mReceiveCallPackets(0)
+	// </FS:Perf>
 {
 }
 
@@ -83,6 +90,11 @@ void LLPacketRing::cleanup ()
 		delete packetp;
 		mSendQueue.pop();
 	}
+
+	// <FS:Perf> Batched receive
+	mBatchCount = 0;
+	mBatchNext = 0;
+	// </FS:Perf>
 }
 
 ///////////////////////////////////////////////////////////
@@ -244,13 +256,35 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 				packet_size = 0;
 			}
 		}
+		// <FS:Perf> Batched receive
+		//else
+		//{
+		//	packet_size = receive_packet(socket, datap);
+		//	mLastSender = ::get_sender();
+		//}
+		//
+		//mLastReceivingIF = ::get_receiving_interface();
+		else if (mUseBatchReceive)
+		{
+			// Sets mLastSender and mLastReceivingIF
+			packet_size = receiveFromBatch(socket, datap);
+		}
 		else
 		{
 			packet_size = receive_packet(socket, datap);
 			mLastSender = ::get_sender();
+			if (packet_size)
+			{
+				++mReceiveCalls;
+				++mReceiveCallPackets;
+			}
 		}
 
-		mLastReceivingIF = ::get_receiving_interface();
+		if (!mUseBatchReceive || LLProxy::isSOCKSProxyEnabled())
+		{
+			mLastReceivingIF = ::get_receiving_interface();
+		}
+		// </FS:Perf>
 
 		if (packet_size)  // did we actually get a packet?
 		{
@@ -270,6 +304,47 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 	return packet_size;
 }
 
+// <FS:Perf> Batched receive
+S32 LLPacketRing::receiveFromBatch(S32 socket, char *datap)
+{
+	if (mBatchNext >= mBatchCount)
+	{
+		// Batch used up, refill it with whatever is waiting on the socket
+		if (mBatchBuffers.empty())
+		{
+			mBatchBuffers.resize(NET_RECEIVE_BATCH_SIZE * NET_BUFFER_SIZE);
+			for (S32 i = 0; i < NET_RECEIVE_BATCH_SIZE; ++i)
+			{
+				mBatch[i].mData = &mBatchBuffers[i * NET_BUFFER_SIZE];
+			}
+		}
+		mBatchNext = 0;
+		mBatchCount = receive_packets(socket, mBatch, NET_RECEIVE_BATCH_SIZE);
+		if (mBatchCount <= 0)
+		{
+			mBatchCount = 0;
+			return 0;
+		}
+		++mReceiveCalls;
+		mReceiveCallPackets += mBatchCount;
+	}
+
+	const LLNetPacket& packet = mBatch[mBatchNext++];
+	memcpy(datap, packet.mData, packet.mSize);	/*Flawfinder: ignore*/
+	mLastSender = LLHost(packet.mSenderIP, packet.mSenderPort);
+	mLastReceivingIF = LLHost(packet.mReceivingIP, INVALID_PORT);
+	return packet.mSize;
+}
+
+F32 LLPacketRing::getAndResetPacketsPerReceiveCall()
+{
+	F32 packets_per_call = mReceiveCalls ? (F32)mReceiveCallPackets / (F32)mReceiveCalls : 0.f;
+	mReceiveCalls = 0;
+	mReceiveCallPackets = 0;
+	return packets_per_call;
+}
+// </FS:Perf>
+
 BOOL LLPacketRing::sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host)
 {
 	BOOL status = TRUE;
@@ -29,6 +29,7 @@
 #define LL_LLPACKETRING_H
 
 #include <queue>
+#include <vector>	// <FS:Perf/> Batched receive
 
 #include "llhost.h"
 #include "llpacketbuffer.h"
@@ -60,6 +61,15 @@ public:
 
 	S32 getAndResetActualInBits()				{ S32 bits = mActualBitsIn; mActualBitsIn = 0; return bits;}
 	S32 getAndResetActualOutBits()				{ S32 bits = mActualBitsOut; mActualBitsOut = 0; return bits;}
+
+	// <FS:Perf> Batched receive
+	// Drain the socket NET_RECEIVE_BATCH_SIZE packets per system call
+	// where the platform allows, on by default
+	void setUseBatchReceive(const BOOL use_batch)	{ mUseBatchReceive = use_batch; }
+
+	// Average packets received per receive system call since the last call
+	F32 getAndResetPacketsPerReceiveCall();
+	// </FS:Perf>
 protected:
 	BOOL mUseInThrottle;
 	BOOL mUseOutThrottle;
@@ -83,8 +93,19 @@ protected:
 	LLHost mLastSender;
 	LLHost mLastReceivingIF;
 
+	// <FS:Perf> Batched receive
+	BOOL mUseBatchReceive;
+	std::vector<char> mBatchBuffers;	// NET_RECEIVE_BATCH_SIZE buffers of NET_BUFFER_SIZE
+	LLNetPacket mBatch[NET_RECEIVE_BATCH_SIZE];
+	S32 mBatchCount;					// Packets in mBatch
+	S32 mBatchNext;						// Next one to hand out
+	U32 mReceiveCalls;
+	U32 mReceiveCallPackets;
+	// </FS:Perf>
+
 private:
 	BOOL sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
+	S32 receiveFromBatch(S32 socket, char *datap);	// <FS:Perf/> Batched receive
 };
 
 
@@ -45,10 +45,24 @@ LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
 	mReceiveSize(0),
 	mCurrentRMessageTemplate(NULL),
 	mCurrentRMessageData(NULL),
-	mMessageNumbers(number_template_map)
+	// <FS:Perf> In place decode
+	//mMessageNumbers(number_template_map)
+	mMessageNumbers(number_template_map),
+	mDecodeInPlace(false)
+	// </FS:Perf>
 {
 }
 
+// <FS:Perf> In place decode
+void LLTemplateMessageReader::setDecodeInPlace(bool in_place)
+{
+#ifdef LL_BIG_ENDIAN
+	in_place = false;
+#endif
+	mDecodeInPlace = in_place;
+}
+// </FS:Perf>
+
 //virtual 
 LLTemplateMessageReader::~LLTemplateMessageReader()
 {
@@ -104,6 +118,13 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 
 	LLMsgVarData& vardata = msg_block_data->mMemberVarData[vnamep];
 
+	// <FS:Perf> Compiled field access, moved to copyVarData()
+	copyVarData(vardata, vnamep, datap, size, max_size);
+}
+
+void LLTemplateMessageReader::copyVarData(LLMsgVarData& vardata, const char *vnamep, void *datap, S32 size, S32 max_size)
+{
+	// </FS:Perf>
 	if (size && size != vardata.getSize())
 	{
 		LL_ERRS() << "Msg " << mCurrentRMessageData->mName 
@@ -150,6 +171,62 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 	}
 }
 
+// <FS:Perf> Compiled field access
+void LLTemplateMessageReader::getFieldData(const LLMessageField& field, void *datap, S32 size, S32 blocknum, S32 max_size)
+{
+	if (!isCurrentMessage(field))
+	{
+		LL_ERRS() << "Field " << field.getBlockName() << " " << field.getVarName()
+			<< " doesn't belong to the current message" << LL_ENDL;
+		return;
+	}
+
+	LLMsgBlkData* msg_block_data = mCurrentRMessageData->getBlock(field.getBlockIndex(), blocknum);
+	if (!msg_block_data)
+	{
+		LL_ERRS() << "Block " << field.getBlockName() << " #" << blocknum
+			<< " not in message " << mCurrentRMessageData->mName << LL_ENDL;
+		return;
+	}
+
+	// Decoding adds every variable of the block in template order
+	LLMsgVarData& vardata = *(msg_block_data->mMemberVarData.begin() + field.getVarIndex());
+	copyVarData(vardata, field.getVarName(), datap, size, max_size);
+}
+
+S32 LLTemplateMessageReader::getFieldSize(const LLMessageField& field, S32 blocknum)
+{
+	if (!isCurrentMessage(field))
+	{
+		LL_ERRS() << "Field " << field.getBlockName() << " " << field.getVarName()
+			<< " doesn't belong to the current message" << LL_ENDL;
+		return LL_MESSAGE_ERROR;
+	}
+
+	LLMsgBlkData* msg_block_data = mCurrentRMessageData->getBlock(field.getBlockIndex(), blocknum);
+	if (!msg_block_data)
+	{	// don't crash
+		LL_INFOS() << "Block " << field.getBlockName() << " #" << blocknum
+			<< " not in message " << mCurrentRMessageData->mName << LL_ENDL;
+		return LL_BLOCK_NOT_IN_MESSAGE;
+	}
+
+	return (msg_block_data->mMemberVarData.begin() + field.getVarIndex())->getSize();
+}
+
+S32 LLTemplateMessageReader::getFieldNumberOfBlocks(const LLMessageField& field)
+{
+	if (!isCurrentMessage(field))
+	{
+		LL_ERRS() << "Field " << field.getBlockName() << " " << field.getVarName()
+			<< " doesn't belong to the current message" << LL_ENDL;
+		return -1;
+	}
+
+	return mCurrentRMessageData->getBlockCount(field.getBlockIndex());
+}
+// </FS:Perf>
+
 S32 LLTemplateMessageReader::getNumberOfBlocks(const char *blockname)
 {
 	// is there a message ready to go?
@@ -549,6 +626,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 
 	// create base working data set
 	mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+	mCurrentRMessageData->mBlockListStart.reserve(mCurrentRMessageTemplate->mMemberBlocks.size() + 1); // <FS:Perf/> Compiled field access
 	
 	// loop through the template building the data structure as we go
 	LLMessageTemplate::message_block_map_t::const_iterator iter;
@@ -560,6 +638,8 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 		U8	repeat_number;
 		S32	i;
 
+		mCurrentRMessageData->mBlockListStart.push_back((S32)mCurrentRMessageData->mBlockList.size()); // <FS:Perf/> Compiled field access
+
 		// how many of this block?
 
 		if (mbci->mType == MBT_SINGLE)
@@ -616,6 +696,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 
 			// add the block to the message
 			mCurrentRMessageData->addBlock(cur_data_block);
+			mCurrentRMessageData->mBlockList.push_back(cur_data_block); // <FS:Perf/> Compiled field access
 
 			// now read the variables
 			for (LLMessageBlock::message_variable_map_t::const_iterator iter = 
@@ -666,7 +747,17 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 					}
 					decode_pos += data_size;
 
-					cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+					// <FS:Perf> In place decode
+					//cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+					if (mDecodeInPlace)
+					{
+						cur_data_block->addDataInPlace(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+					}
+					else
+					{
+						cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+					}
+					// </FS:Perf>
 					decode_pos += tsize;
 				}
 				else
@@ -683,6 +774,15 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 						cur_data_block->addData(mvci.getName(), &(data[0]), 
 												size, mvci.getType());
 					}
+					// <FS:Perf> In place decode
+					else if (mDecodeInPlace)
+					{
+						cur_data_block->addDataInPlace(mvci.getName(), 
+													   &buffer[decode_pos], 
+													   mvci.getSize(), 
+													   mvci.getType());
+					}
+					// </FS:Perf>
 					else
 					{
 						cur_data_block->addData(mvci.getName(), 
@@ -696,6 +796,8 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 		}
 	}
 
+	mCurrentRMessageData->mBlockListStart.push_back((S32)mCurrentRMessageData->mBlockList.size()); // <FS:Perf/> Compiled field access
+
 	if (mCurrentRMessageData->mMemberBlocks.empty()
 		&& !mCurrentRMessageTemplate->mMemberBlocks.empty())
 	{
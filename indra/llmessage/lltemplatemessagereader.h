@@ -28,11 +28,13 @@
 #define LL_LLTEMPLATEMESSAGEREADER_H
 
 #include "llmessagereader.h"
+#include "llmessagefield.h"	// <FS:Perf/> Compiled field access
 
 #include <map>
 
 class LLMessageTemplate;
 class LLMsgData;
+class LLMsgVarData;			// <FS:Perf/> Compiled field access
 
 class LLTemplateMessageReader : public LLMessageReader
 {
@@ -105,12 +107,38 @@ public:
 	bool isTrusted() const;
 	bool isBanned(bool trusted_source) const;
 	bool isUdpBanned() const;
+
+	// <FS:Perf> Compiled field access, see LLMessageField. Fields only
+	// apply to the message they were compiled for, check with
+	// isCurrentMessage() first.
+	bool isCurrentMessage(const LLMessageField& field) const
+	{
+		return field.getTemplate() && field.getTemplate() == mCurrentRMessageTemplate && mCurrentRMessageData;
+	}
+	void getFieldData(const LLMessageField& field, void *datap, S32 size = 0,
+					  S32 blocknum = 0, S32 max_size = S32_MAX);
+	S32 getFieldSize(const LLMessageField& field, S32 blocknum = 0);
+	S32 getFieldNumberOfBlocks(const LLMessageField& field);
+	// </FS:Perf>
+
+	// <FS:Perf> In place decode: the decoded variables reference the
+	// buffer given to readMessage() instead of copying it, so that buffer
+	// has to stay unchanged until clearMessage(). Ignored on big endian
+	// hosts, where the variables are byte swapped as they are copied.
+	void setDecodeInPlace(bool in_place);
+	bool getDecodeInPlace() const { return mDecodeInPlace; }
+	// </FS:Perf>
 	
 private:
 
 	void getData(const char *blockname, const char *varname, void *datap, 
 				 S32 size = 0, S32 blocknum = 0, S32 max_size = S32_MAX);
 
+	// <FS:Perf> Compiled field access, shared tail of getData()
+	void copyVarData(LLMsgVarData& vardata, const char *varname, void *datap,
+					 S32 size, S32 max_size);
+	// </FS:Perf>
+
 	BOOL decodeTemplate(const U8* buffer, S32 buffer_size,  // inputs
 						LLMessageTemplate** msg_template ); // outputs
 
@@ -122,6 +150,7 @@ private:
 	LLMessageTemplate* mCurrentRMessageTemplate;
 	LLMsgData* mCurrentRMessageData;
 	message_template_number_map_t& mMessageNumbers;
+	bool mDecodeInPlace; // <FS:Perf/> In place decode
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
@@ -0,0 +1,132 @@
+/**
+ * @file llzerocode.cpp
+ * @brief Expansion of the zero-coded body of a template message packet.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llzerocode.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LL_ZERO_CODE_SIMD 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define LL_ZERO_CODE_SIMD 0
+#endif
+
+namespace
+{
+#if LL_ZERO_CODE_SIMD
+	inline U32 lowest_bit(U32 mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (U32)index;
+#else
+		return (U32)__builtin_ctz(mask);
+#endif
+	}
+#endif
+
+	// First zero byte in [begin, end), or end if there is none
+	inline const U8* find_zero(const U8* begin, const U8* end)
+	{
+#if LL_ZERO_CODE_SIMD
+		const __m128i zero = _mm_setzero_si128();
+		while (end - begin >= 16)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)begin);
+			U32 mask = (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero));
+			if (mask)
+			{
+				return begin + lowest_bit(mask);
+			}
+			begin += 16;
+		}
+		while (begin < end && *begin)
+		{
+			++begin;
+		}
+		return begin;
+#else
+		const void* found = memchr(begin, 0, end - begin);
+		return found ? (const U8*)found : end;
+#endif
+	}
+}
+
+S32 LLZeroCode::expand(const U8* in, S32 in_size, U8* out, S32 out_size)
+{
+	const U8* in_end = in + in_size;
+	U8* const out_begin = out;
+	U8* const out_end = out + out_size;
+
+	while (in < in_end)
+	{
+		// literal bytes up to the next zero
+		const U8* zero = find_zero(in, in_end);
+		S32 literal = (S32)(zero - in);
+		if (literal > out_end - out)
+		{
+			return -1;
+		}
+		memcpy(out, in, literal);
+		out += literal;
+		in = zero;
+		if (in == in_end)
+		{
+			break;
+		}
+
+		// the zero itself, 256 more for every zero after it, then the
+		// count byte adds the rest of the run
+		S32 zeros = 1;
+		++in;
+		while (in < in_end && !*in)
+		{
+			zeros += 256;
+			++in;
+		}
+		if (in < in_end)
+		{
+			zeros += *in - 1;
+			++in;
+		}
+		if (zeros > out_end - out)
+		{
+			return -1;
+		}
+		memset(out, 0, zeros);
+		out += zeros;
+	}
+
+	return (S32)(out - out_begin);
+}
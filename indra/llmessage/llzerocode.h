@@ -0,0 +1,49 @@
+/**
+ * @file llzerocode.h
+ * @brief Expansion of the zero-coded body of a template message packet.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLZEROCODE_H
+#define LL_LLZEROCODE_H
+
+/**
+ * Zero coding replaces a run of zero bytes with a zero followed by the
+ * length of the run. Runs longer than 255 are sent as 0 0 ... [count],
+ * where each extra zero stands for 256 more zero bytes.
+ *
+ * Rather than going byte by byte, expand() looks for the next zero 16
+ * bytes at a time, then copies the literal bytes before it and fills the
+ * zero run as single block operations.
+ */
+namespace LLZeroCode
+{
+	// Expands in_size bytes of zero-coded data into out. Returns the number
+	// of bytes written, or -1 if the expanded data doesn't fit in out_size.
+	// A zero run cut off by the end of the input expands to what has been
+	// read of it, as LLMessageSystem always did.
+	S32 expand(const U8* in, S32 in_size, U8* out, S32 out_size);
+}
+
+#endif // LL_LLZEROCODE_H
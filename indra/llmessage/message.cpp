@@ -70,6 +70,7 @@
 #include "lltransfermanager.h"
 #include "lluuid.h"
 #include "llxfermanager.h"
+#include "llzerocode.h" // <FS:Perf/> Zero-code expansion
 #include "llquaternion.h"
 #include "u64.h"
 #include "v3dmath.h"
@@ -233,6 +234,11 @@ LLMessageSystem::LLMessageSystem(const std::string& filename, U32 port,
 	mMessageBuilder = NULL;
 
 	mTemplateMessageReader = new LLTemplateMessageReader(mMessageNumbers);
+	// <FS:Perf> In place decode. checkMessages() only ever decodes from
+	// mTrueReceiveBuffer or mEncodedRecvBuffer, and clears the message
+	// before the next packet is received into them.
+	mTemplateMessageReader->setDecodeInPlace(true);
+	// </FS:Perf>
 	mLLSDMessageReader = new LLSDMessageReader();
 
 	// initialize various bits of net info
@@ -2849,70 +2855,84 @@ S32 LLMessageSystem::zeroCodeExpand(U8** data, S32* data_size)
 	
 	*data[0] &= (~LL_ZERO_CODE_FLAG);
 
-	S32 count = (*data_size);  
+	// <FS:Perf> Zero-code expansion by runs instead of bytes, see LLZeroCode
+//	S32 count = (*data_size);  
 	
-	U8 *inptr = (U8 *)*data;
-	U8 *outptr = (U8 *)mEncodedRecvBuffer;
+//	U8 *inptr = (U8 *)*data;
+//	U8 *outptr = (U8 *)mEncodedRecvBuffer;
 
-// skip the packet id field
+//// skip the packet id field
 
-	for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
-	{
-		count--;
-		*outptr++ = *inptr++;
-	}
+//	for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
+//	{
+//		count--;
+//		*outptr++ = *inptr++;
+//	}
 
-// reconstruct encoded packet, keeping track of net size gain
+//// reconstruct encoded packet, keeping track of net size gain
 
-// sequential zero bytes are encoded as 0 [U8 count] 
-// with 0 0 [count] representing wrap (>256 zeroes)
+//// sequential zero bytes are encoded as 0 [U8 count] 
+//// with 0 0 [count] representing wrap (>256 zeroes)
 
-	while (count--)
-	{
-		if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
-		{
-			LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
-			callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-			outptr = mEncodedRecvBuffer;					
-			break;
-		}
-		if (!((*outptr++ = *inptr++)))
-		{
-			while (((count--)) && (!(*inptr)))
-			{
-				*outptr++ = *inptr++;
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
-  				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;
-					count = -1;
-					break;
-  				}
-				memset(outptr,0,255);
-				outptr += 255;
-			}
+//	while (count--)
+//	{
+//		if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
+//		{
+//			LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
+//			callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+//			outptr = mEncodedRecvBuffer;					
+//			break;
+//		}
+//		if (!((*outptr++ = *inptr++)))
+//		{
+//			while (((count--)) && (!(*inptr)))
+//			{
+//				*outptr++ = *inptr++;
+//  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
+//  				{
+//  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
+//					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+//					outptr = mEncodedRecvBuffer;
+//					count = -1;
+//					break;
+//  				}
+//				memset(outptr,0,255);
+//				outptr += 255;
+//			}
 			
-			if (count < 0)
-			{
-				break;
-			}
-
-			else
-			{
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
-				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;					
-				}
-				memset(outptr,0,(*inptr) - 1);
-				outptr += ((*inptr) - 1);
-				inptr++;
-			}
-		}		
-	}
+//			if (count < 0)
+//			{
+//				break;
+//			}
+
+//			else
+//			{
+//  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
+//				{
+//  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
+//					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+//					outptr = mEncodedRecvBuffer;					
+//				}
+//				memset(outptr,0,(*inptr) - 1);
+//				outptr += ((*inptr) - 1);
+//				inptr++;
+//			}
+//		}		
+//	}
 	
+	// the packet id field isn't coded
+	memcpy(mEncodedRecvBuffer, *data, LL_PACKET_ID_SIZE);
+	S32 expanded_size = LLZeroCode::expand(*data + LL_PACKET_ID_SIZE, llmax(in_size - (S32)LL_PACKET_ID_SIZE, 0),
+										   mEncodedRecvBuffer + LL_PACKET_ID_SIZE, MAX_BUFFER_SIZE - LL_PACKET_ID_SIZE);
+	if (expanded_size < 0)
+	{
+		LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size" << LL_ENDL;
+		callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+	}
+	// an overflow leaves nothing, as before
+	U8 *outptr = (expanded_size < 0) ? mEncodedRecvBuffer : mEncodedRecvBuffer + LL_PACKET_ID_SIZE + expanded_size;
+	// </FS:Perf>
+
 	*data = mEncodedRecvBuffer;
 	*data_size = (S32)(outptr - mEncodedRecvBuffer);
 	mUncompressedBytesIn += *data_size;
@@ -3931,6 +3951,227 @@ void LLMessageSystem::getString(const char *block, const char *var,
 				  blocknum);
 }
 
+// <FS:Perf> Compiled field access
+LLMessageField LLMessageSystem::compileFieldFast(const char *msgname, const char *blockname, const char *varname) const
+{
+	LLMessageField field(blockname, varname);
+	message_template_name_map_t::const_iterator iter = mMessageTemplates.find(msgname);
+	if (iter == mMessageTemplates.end() || !field.compile(iter->second))
+	{
+		LL_WARNS("Messaging") << "Can't compile field " << blockname << " " << varname
+			<< " of message " << msgname << ", it will be read by name" << LL_ENDL;
+	}
+	return field;
+}
+
+bool LLMessageSystem::isCompiledFieldCurrent(const LLMessageField& field) const
+{
+	return mMessageReader == mTemplateMessageReader && mTemplateMessageReader->isCurrentMessage(field);
+}
+
+void LLMessageSystem::getBinaryDataFast(const LLMessageField& field, void *datap, S32 size, S32 blocknum, S32 max_size)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, datap, size, blocknum, max_size);
+	}
+	else
+	{
+		getBinaryDataFast(field.getBlockName(), field.getVarName(), datap, size, blocknum, max_size);
+	}
+}
+
+void LLMessageSystem::getBOOLFast(const LLMessageField& field, BOOL &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		U8 value(0);
+		mTemplateMessageReader->getFieldData(field, &value, sizeof(U8), blocknum);
+		d = (BOOL) value;
+	}
+	else
+	{
+		getBOOLFast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getU8Fast(const LLMessageField& field, U8 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(U8), blocknum);
+	}
+	else
+	{
+		getU8Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getS16Fast(const LLMessageField& field, S16 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(S16), blocknum);
+	}
+	else
+	{
+		getS16Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getU16Fast(const LLMessageField& field, U16 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(U16), blocknum);
+	}
+	else
+	{
+		getU16Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getS32Fast(const LLMessageField& field, S32 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(S32), blocknum);
+	}
+	else
+	{
+		getS32Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getU32Fast(const LLMessageField& field, U32 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(U32), blocknum);
+	}
+	else
+	{
+		getU32Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getU64Fast(const LLMessageField& field, U64 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(U64), blocknum);
+	}
+	else
+	{
+		getU64Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getF32Fast(const LLMessageField& field, F32 &d, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &d, sizeof(F32), blocknum);
+		if (!llfinite(d))
+		{
+			LL_WARNS() << "non-finite in getF32Fast " << field.getBlockName() << " " << field.getVarName()
+				<< LL_ENDL;
+			d = 0;
+		}
+	}
+	else
+	{
+		getF32Fast(field.getBlockName(), field.getVarName(), d, blocknum);
+	}
+}
+
+void LLMessageSystem::getVector3Fast(const LLMessageField& field, LLVector3 &v, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &v.mV[0], sizeof(v.mV), blocknum);
+		if (!v.isFinite())
+		{
+			LL_WARNS() << "non-finite in getVector3Fast " << field.getBlockName() << " " << field.getVarName()
+				<< LL_ENDL;
+			v.zeroVec();
+		}
+	}
+	else
+	{
+		getVector3Fast(field.getBlockName(), field.getVarName(), v, blocknum);
+	}
+}
+
+void LLMessageSystem::getQuatFast(const LLMessageField& field, LLQuaternion &q, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		LLVector3 vec;
+		mTemplateMessageReader->getFieldData(field, &vec.mV[0], sizeof(vec.mV), blocknum);
+		if (vec.isFinite())
+		{
+			q.unpackFromVector3(vec);
+		}
+		else
+		{
+			LL_WARNS() << "non-finite in getQuatFast " << field.getBlockName() << " " << field.getVarName()
+				<< LL_ENDL;
+			q.loadIdentity();
+		}
+	}
+	else
+	{
+		getQuatFast(field.getBlockName(), field.getVarName(), q, blocknum);
+	}
+}
+
+void LLMessageSystem::getUUIDFast(const LLMessageField& field, LLUUID &u, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		mTemplateMessageReader->getFieldData(field, &u.mData[0], sizeof(u.mData), blocknum);
+	}
+	else
+	{
+		getUUIDFast(field.getBlockName(), field.getVarName(), u, blocknum);
+	}
+}
+
+void LLMessageSystem::getStringFast(const LLMessageField& field, std::string& outstr, S32 blocknum)
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		char s[MTUBYTES + 1]= {0}; // every element is initialized with 0
+		mTemplateMessageReader->getFieldData(field, s, 0, blocknum, MTUBYTES);
+		s[MTUBYTES] = '\0';
+		outstr = s;
+	}
+	else
+	{
+		getStringFast(field.getBlockName(), field.getVarName(), outstr, blocknum);
+	}
+}
+
+S32	LLMessageSystem::getNumberOfBlocksFast(const LLMessageField& field) const
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		return mTemplateMessageReader->getFieldNumberOfBlocks(field);
+	}
+	return getNumberOfBlocksFast(field.getBlockName());
+}
+
+S32	LLMessageSystem::getSizeFast(const LLMessageField& field, S32 blocknum) const
+{
+	if (isCompiledFieldCurrent(field))
+	{
+		return mTemplateMessageReader->getFieldSize(field, blocknum);
+	}
+	return getSizeFast(field.getBlockName(), blocknum, field.getVarName());
+}
+// </FS:Perf>
+
 BOOL	LLMessageSystem::has(const char *blockname) const
 {
 	return getNumberOfBlocks(blockname) > 0;
@@ -52,6 +52,7 @@
 #include "message_prehash.h"
 #include "llstl.h"
 #include "llmsgvariabletype.h"
+#include "llmessagefield.h"	// <FS:Perf/> Compiled field access
 #include "llmessagesenderinterface.h"
 
 #include "llstoredmessage.h"
@@ -638,6 +639,27 @@ public:
 	void getStringFast(	const char *block, const char *var, std::string& outstr, S32 blocknum = 0);
 	void	getString(	const char *block, const char *var, std::string& outstr, S32 blocknum = 0);
 
+	// <FS:Perf> Compiled field access
+	// Resolve a variable of a message once, e.g. next to setHandlerFuncFast(),
+	// all names prehashed. While that message is the current one from the
+	// template reader, reading the field is an indexed load; otherwise it
+	// falls back to the lookup by name.
+	LLMessageField compileFieldFast(const char *msgname, const char *blockname, const char *varname) const;
+	void	getBinaryDataFast(const LLMessageField& field, void *datap, S32 size, S32 blocknum = 0, S32 max_size = S32_MAX);
+	void	getBOOLFast(	const LLMessageField& field, BOOL &data, S32 blocknum = 0);
+	void	getU8Fast(		const LLMessageField& field, U8 &data, S32 blocknum = 0);
+	void	getS16Fast(		const LLMessageField& field, S16 &data, S32 blocknum = 0);
+	void	getU16Fast(		const LLMessageField& field, U16 &data, S32 blocknum = 0);
+	void	getS32Fast(		const LLMessageField& field, S32 &data, S32 blocknum = 0);
+	void	getU32Fast(		const LLMessageField& field, U32 &data, S32 blocknum = 0);
+	void	getU64Fast(		const LLMessageField& field, U64 &data, S32 blocknum = 0);
+	void	getF32Fast(		const LLMessageField& field, F32 &data, S32 blocknum = 0);
+	void	getVector3Fast(	const LLMessageField& field, LLVector3 &vec, S32 blocknum = 0);
+	void	getQuatFast(	const LLMessageField& field, LLQuaternion &q, S32 blocknum = 0);
+	void	getUUIDFast(	const LLMessageField& field, LLUUID &uuid, S32 blocknum = 0);
+	void	getStringFast(	const LLMessageField& field, std::string& outstr, S32 blocknum = 0);
+	// </FS:Perf>
+
 
 	// Utility functions to generate a replay-resistant digest check
 	// against the shared secret. The window specifies how much of a
@@ -733,6 +755,10 @@ public:
 	S32		getSizeFast(const char *blockname, S32 blocknum, 
 						const char *varname) const; // size in bytes of data
 	S32		getSize(const char *blockname, S32 blocknum, const char *varname) const;
+	// <FS:Perf> Compiled field access
+	S32		getNumberOfBlocksFast(const LLMessageField& field) const;
+	S32		getSizeFast(const LLMessageField& field, S32 blocknum) const;
+	// </FS:Perf>
 
 	void	resetReceiveCounts();				// resets receive counts for all message types to 0
 	void	dumpReceiveCounts();				// dumps receive count for each message type to LL_INFOS()
@@ -917,6 +943,9 @@ private:
 	/** Find, create or revive circuit for host as needed */
 	LLCircuitData* findCircuit(const LLHost& host, bool resetPacketId);
 
+	// <FS:Perf> Compiled field access: true if field can be read by index
+	bool isCompiledFieldCurrent(const LLMessageField& field) const;
+
 	// <FS:Ansariel> Restore original LLMessageSystem HTTP options for OpenSim
 	bool mIsInSecondLife;
 };
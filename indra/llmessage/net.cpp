@@ -598,6 +598,68 @@ int receive_packet(int hSocket, char * receiveBuffer)
 	return nRet;
 }
 
+// <FS:Perf> Batched receive
+#if LL_LINUX
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets)
+{
+	struct mmsghdr msgs[NET_RECEIVE_BATCH_SIZE];
+	struct iovec iovs[NET_RECEIVE_BATCH_SIZE];
+	struct sockaddr_in addrs[NET_RECEIVE_BATCH_SIZE];
+	char cmsgs[NET_RECEIVE_BATCH_SIZE][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+	max_packets = llclamp(max_packets, 0, NET_RECEIVE_BATCH_SIZE);
+	for (S32 i = 0; i < max_packets; ++i)
+	{
+		iovs[i].iov_base = packets[i].mData;
+		iovs[i].iov_len = NET_BUFFER_SIZE;
+
+		memset(&msgs[i], 0, sizeof(msgs[i]));
+		msgs[i].msg_hdr.msg_name = &addrs[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_control = cmsgs[i];
+		msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+	}
+
+	// The socket is non-blocking, so this returns as soon as the waiting
+	// datagrams have been picked up.
+	int count = recvmmsg(hSocket, msgs, max_packets, 0, NULL);
+	if (count <= 0)
+	{
+		// Like receive_packet(), no packet on error
+		return 0;
+	}
+
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLNetPacket& packet = packets[i];
+		packet.mSize = msgs[i].msg_len;
+		packet.mSenderIP = addrs[i].sin_addr.s_addr;
+		packet.mSenderPort = ntohs(addrs[i].sin_port);
+		packet.mReceivingIP = INVALID_HOST_IP_ADDRESS;
+
+		for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+		{
+			if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+			{
+				// See recvfrom_destip() for the choice of address
+				in_pktinfo* pktinfo = (in_pktinfo*)CMSG_DATA(cmsgptr);
+				packet.mReceivingIP = pktinfo->ipi_spec_dst.s_addr;
+			}
+		}
+	}
+
+	// Keep the single packet accessors in step, they describe the last
+	// datagram received
+	stSrcAddr = addrs[count - 1];
+	gsnReceivingIFAddr = packets[count - 1].mReceivingIP;
+
+	return count;
+}
+#endif // LL_LINUX
+// </FS:Perf>
+
 BOOL send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient, int nPort)
 {
 	int		ret;
@@ -660,4 +722,28 @@ BOOL send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
 
 #endif
 
+// <FS:Perf> Batched receive, single packet fallback
+#if !LL_LINUX
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets)
+{
+	if (max_packets < 1)
+	{
+		return 0;
+	}
+
+	S32 size = receive_packet(hSocket, packets[0].mData);
+	if (size <= 0)
+	{
+		return 0;
+	}
+
+	packets[0].mSize = size;
+	packets[0].mSenderIP = get_sender_ip();
+	packets[0].mSenderPort = get_sender_port();
+	packets[0].mReceivingIP = get_receiving_interface_ip();
+	return 1;
+}
+#endif
+// </FS:Perf>
+
 //EOF
@@ -43,6 +43,27 @@ void	end_net(S32& socket_out);
 // returns size of packet or -1 in case of error
 S32		receive_packet(int hSocket, char * receiveBuffer);
 
+// <FS:Perf> Batched receive
+// Most packets receive_packets() asks for in one call
+#define NET_RECEIVE_BATCH_SIZE (32)
+
+// One datagram of a batch. mData points at NET_BUFFER_SIZE bytes
+// provided by the caller, the other members are filled in.
+struct LLNetPacket
+{
+	char*	mData;
+	S32		mSize;
+	U32		mSenderIP;
+	U32		mSenderPort;
+	U32		mReceivingIP;
+};
+
+// Receives up to max_packets datagrams that are already waiting, with a
+// single recvmmsg() call on Linux and a single receive_packet() elsewhere.
+// Returns the number of packets received, 0 if none are waiting.
+S32		receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets);
+// </FS:Perf>
+
 BOOL	send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);	// Returns TRUE on success.
 
 //void	get_sender(char * tmp);
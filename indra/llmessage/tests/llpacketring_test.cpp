@@ -0,0 +1,215 @@
+/**
+ * @file llpacketring_test.cpp
+ * @brief Checks LLPacketRing batched receive over loopback, plus a replay
+ *        benchmark of batched against single packet receive.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketring.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    typedef std::vector<std::string> trace_t;
+
+    /**
+     * Packet trace to replay. If LL_PACKET_TRACE names a file, it is read
+     * as a sequence of records, each a little-endian U16 length followed
+     * by that many bytes of UDP payload, as cut from a capture of a busy
+     * region arrival. Otherwise a trace of the same shape is made up:
+     * mostly ImprovedTerseObjectUpdate sized packets with runs of large
+     * ObjectUpdate ones.
+     */
+    trace_t load_trace()
+    {
+        trace_t trace;
+        const char* path = getenv("LL_PACKET_TRACE");
+        if (path && *path)
+        {
+            std::ifstream in(path, std::ios::binary);
+            unsigned char len[2];
+            while (in.read((char*)len, 2))
+            {
+                std::string packet(len[0] | (len[1] << 8), '\0');
+                if (!in.read(&packet[0], packet.size()))
+                {
+                    break;
+                }
+                if (!packet.empty() && packet.size() <= NET_BUFFER_SIZE)
+                {
+                    trace.push_back(packet);
+                }
+            }
+            if (!trace.empty())
+            {
+                return trace;
+            }
+            std::cout << "\nLL_PACKET_TRACE " << path << " has no packets, using a made up trace" << std::endl;
+        }
+
+        std::mt19937 rng(20240601);
+        std::uniform_int_distribution<int> terse(60, 450);
+        std::uniform_int_distribution<int> full(700, MTUBYTES);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (S32 i = 0; i < 20000; ++i)
+        {
+            std::string packet((i % 64) < 16 ? full(rng) : terse(rng), '\0');
+            for (char& c : packet)
+            {
+                c = (char)byte(rng);
+            }
+            trace.push_back(packet);
+        }
+        return trace;
+    }
+
+    // Receive everything waiting, return the number of packets
+    S32 drain(LLPacketRing& ring, S32 socket, char* buffer)
+    {
+        S32 count = 0;
+        while (ring.receivePacket(socket, buffer) > 0)
+        {
+            ++count;
+        }
+        return count;
+    }
+}
+
+namespace tut
+{
+    struct packetring_data
+    {
+        S32 mSocket;
+        int mPort;
+        U32 mLoopback;
+        char mBuffer[NET_BUFFER_SIZE];
+
+        packetring_data() :
+            mSocket(-1),
+            mPort(NET_USE_OS_ASSIGNED_PORT),
+            mLoopback(ip_string_to_u32(LOOPBACK_ADDRESS_STRING))
+        {
+            ensure_equals("start_net", start_net(mSocket, mPort), 0);
+        }
+
+        ~packetring_data()
+        {
+            end_net(mSocket);
+        }
+
+        // The socket sends to itself
+        void send(const std::string& packet)
+        {
+            send_packet(mSocket, packet.data(), (int)packet.size(), mLoopback, mPort);
+        }
+    };
+    typedef test_group<packetring_data> packetring_t;
+    typedef packetring_t::object packetring_object_t;
+    tut::packetring_t tut_packetring("LLPacketRing");
+
+    template<> template<>
+    void packetring_object_t::test<1>()
+    {
+        set_test_name("batched receive delivers every packet in order");
+
+        LLPacketRing ring;
+        ensure_equals("nothing waiting", ring.receivePacket(mSocket, mBuffer), 0);
+
+        // more than one batch
+        const S32 count = NET_RECEIVE_BATCH_SIZE * 2 + 5;
+        for (S32 i = 0; i < count; ++i)
+        {
+            send(llformat("packet %d", i));
+        }
+
+        for (S32 i = 0; i < count; ++i)
+        {
+            S32 size = ring.receivePacket(mSocket, mBuffer);
+            ensure_equals(llformat("packet %d content", i), std::string(mBuffer, size), llformat("packet %d", i));
+            ensure_equals("sender", ring.getLastSender(), LLHost(mLoopback, mPort));
+        }
+        ensure_equals("all received", ring.receivePacket(mSocket, mBuffer), 0);
+
+        F32 per_call = ring.getAndResetPacketsPerReceiveCall();
+#if LL_LINUX
+        ensure("more than one packet per call", per_call > 1.f);
+#else
+        ensure_equals("one packet per call", per_call, 1.f);
+#endif
+        ensure_equals("counter reset", ring.getAndResetPacketsPerReceiveCall(), 0.f);
+
+        // and the same without batching
+        ring.setUseBatchReceive(FALSE);
+        send("single");
+        S32 size = ring.receivePacket(mSocket, mBuffer);
+        ensure_equals("single content", std::string(mBuffer, size), std::string("single"));
+        ensure_equals("single per call", ring.getAndResetPacketsPerReceiveCall(), 1.f);
+    }
+
+    // Not a regression test: replays a packet trace over loopback in
+    // bursts and times draining it with and without batching.
+    template<> template<>
+    void packetring_object_t::test<2>()
+    {
+        set_test_name("batched receive speed");
+
+        const trace_t trace = load_trace();
+        // Bursts small enough for the socket receive buffer
+        const S32 burst = 128;
+
+        std::cout << "\nLLPacketRing replay of " << trace.size() << " packets:" << std::endl;
+        for (BOOL batched : { FALSE, TRUE })
+        {
+            LLPacketRing ring;
+            ring.setUseBatchReceive(batched);
+            F64 usec = 0.0;
+            S32 received = 0;
+            for (size_t start = 0; start < trace.size(); start += burst)
+            {
+                for (size_t i = start; i < trace.size() && i < start + burst; ++i)
+                {
+                    send(trace[i]);
+                }
+                auto begin = std::chrono::steady_clock::now();
+                received += drain(ring, mSocket, mBuffer);
+                usec += std::chrono::duration<F64, std::micro>(std::chrono::steady_clock::now() - begin).count();
+            }
+            std::cout << "  " << (batched ? "batched:" : "single: ") << " "
+                      << (S32)(received / (usec / 1000000.0)) << " packets/s, "
+                      << ring.getAndResetPacketsPerReceiveCall() << " packets per call, "
+                      << received << " received" << std::endl;
+        }
+    }
+}
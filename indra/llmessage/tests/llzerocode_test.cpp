@@ -0,0 +1,247 @@
+/**
+ * @file llzerocode_test.cpp
+ * @brief Checks LLZeroCode::expand against the byte at a time expansion it
+ *        replaces, plus a speed comparison of the two.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llzerocode.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    typedef std::vector<U8> bytes_t;
+
+    // Room for any expansion in these tests
+    const S32 OUT_SIZE = 32768;
+
+    // Zero coding as done by zero_code() in lltemplatemessagebuilder.cpp
+    bytes_t encode(const bytes_t& in)
+    {
+        bytes_t out;
+        U8 zeros = 0;
+        for (U8 byte : in)
+        {
+            if (!byte)
+            {
+                if (!zeros)
+                {
+                    out.push_back(0);
+                }
+                if (++zeros == 255)
+                {
+                    out.push_back(zeros);
+                    zeros = 0;
+                }
+            }
+            else
+            {
+                if (zeros)
+                {
+                    out.push_back(zeros);
+                    zeros = 0;
+                }
+                out.push_back(byte);
+            }
+        }
+        if (zeros)
+        {
+            out.push_back(zeros);
+        }
+        return out;
+    }
+
+    // The expansion loop LLMessageSystem::zeroCodeExpand() used to run,
+    // without its buffer size checks
+    S32 expand_bytewise(const U8* inptr, S32 count, U8* out)
+    {
+        U8* outptr = out;
+        while (count--)
+        {
+            if (!(*outptr++ = *inptr++))
+            {
+                while ((count--) && !*inptr)
+                {
+                    *outptr++ = *inptr++;
+                    memset(outptr, 0, 255);
+                    outptr += 255;
+                }
+                if (count < 0)
+                {
+                    break;
+                }
+                memset(outptr, 0, *inptr - 1);
+                outptr += *inptr - 1;
+                inptr++;
+            }
+        }
+        return (S32)(outptr - out);
+    }
+
+    bytes_t expand_bytewise(const bytes_t& in)
+    {
+        bytes_t out(OUT_SIZE);
+        out.resize(expand_bytewise(in.data(), (S32)in.size(), out.data()));
+        return out;
+    }
+
+    bytes_t expand(const bytes_t& in, S32 out_size = OUT_SIZE)
+    {
+        bytes_t out(out_size);
+        S32 size = LLZeroCode::expand(in.data(), (S32)in.size(), out.data(), out_size);
+        out.resize(llmax(size, 0));
+        return out;
+    }
+
+    // Object update shaped payload: runs of random bytes between runs of
+    // zeros, zero_density of the bytes being zeros
+    bytes_t random_payload(std::mt19937& rng, S32 size, F32 zero_density)
+    {
+        std::uniform_real_distribution<F32> chance(0.f, 1.f);
+        std::uniform_int_distribution<int> run(1, 12);
+        std::uniform_int_distribution<int> byte(1, 255);
+        bytes_t payload;
+        while ((S32)payload.size() < size)
+        {
+            S32 length = run(rng);
+            bool zeros = chance(rng) < zero_density;
+            for (S32 i = 0; i < length; ++i)
+            {
+                payload.push_back(zeros ? 0 : (U8)byte(rng));
+            }
+        }
+        payload.resize(size);
+        return payload;
+    }
+}
+
+namespace tut
+{
+    struct zerocode_data
+    {
+        std::mt19937 mRNG{ 20240602 };
+    };
+    typedef test_group<zerocode_data> zerocode_t;
+    typedef zerocode_t::object zerocode_object_t;
+    tut::zerocode_t tut_zerocode("LLZeroCode");
+
+    template<> template<>
+    void zerocode_object_t::test<1>()
+    {
+        set_test_name("expansion matches the bytewise loop");
+
+        for (F32 density : { 0.f, 0.1f, 0.4f, 0.8f, 1.f })
+        {
+            for (S32 size : { 0, 1, 15, 16, 17, 100, 600, 1200 })
+            {
+                bytes_t payload = random_payload(mRNG, size, density);
+                bytes_t coded = encode(payload);
+                ensure(llformat("round trip, %d bytes, density %.1f", size, density), expand(coded) == payload);
+                ensure(llformat("bytewise, %d bytes, density %.1f", size, density), expand(coded) == expand_bytewise(coded));
+            }
+        }
+
+        // long runs, past the 255 of one count byte
+        bytes_t payload(2000, 0);
+        payload[700] = 7;
+        ensure("long runs", expand(encode(payload)) == payload);
+    }
+
+    template<> template<>
+    void zerocode_object_t::test<2>()
+    {
+        set_test_name("wraps, truncated runs and overflow");
+
+        // 0 0 [count] is 256 zeros more than 0 [count]
+        bytes_t wrap = { 1, 0, 0, 5, 2 };
+        bytes_t expanded = expand(wrap);
+        ensure_equals("wrap size", expanded.size(), (size_t)(1 + 261 + 1));
+        ensure("wrap bytewise", expanded == expand_bytewise(wrap));
+
+        // runs without their count byte at the end of the packet
+        for (const bytes_t& truncated : { bytes_t{ 3, 0 }, bytes_t{ 3, 0, 0 }, bytes_t{ 0, 0, 0 } })
+        {
+            ensure("truncated run", expand(truncated) == expand_bytewise(truncated));
+        }
+
+        // expansion that doesn't fit
+        bytes_t coded = encode(bytes_t(100, 0));
+        ensure_equals("fits", LLZeroCode::expand(coded.data(), (S32)coded.size(), expanded.data(), 100), 100);
+        ensure_equals("zeros overflow", LLZeroCode::expand(coded.data(), (S32)coded.size(), expanded.data(), 99), -1);
+        bytes_t literal(50, 9);
+        ensure_equals("literal overflow", LLZeroCode::expand(literal.data(), (S32)literal.size(), expanded.data(), 49), -1);
+    }
+
+    // Not a regression test: times the expansion of object update sized
+    // packets against the bytewise loop.
+    template<> template<>
+    void zerocode_object_t::test<3>()
+    {
+        set_test_name("expansion speed");
+
+        std::vector<bytes_t> packets;
+        size_t expanded_bytes = 0;
+        for (S32 i = 0; i < 1000; ++i)
+        {
+            bytes_t payload = random_payload(mRNG, 1100, 0.3f);
+            expanded_bytes += payload.size();
+            packets.push_back(encode(payload));
+        }
+
+        bytes_t out(OUT_SIZE);
+        F64 usec[2];
+        for (S32 simd = 0; simd < 2; ++simd)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (S32 repeat = 0; repeat < 20; ++repeat)
+            {
+                for (const bytes_t& packet : packets)
+                {
+                    if (simd)
+                    {
+                        LLZeroCode::expand(packet.data(), (S32)packet.size(), out.data(), (S32)out.size());
+                    }
+                    else
+                    {
+                        expand_bytewise(packet.data(), (S32)packet.size(), out.data());
+                    }
+                }
+            }
+            usec[simd] = std::chrono::duration<F64, std::micro>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        const F64 mb = expanded_bytes * 20 / 1000000.0;
+        std::cout << "\nLLZeroCode, MB/s expanded: bytewise " << (S32)(mb / (usec[0] / 1000000.0))
+                  << ", runs " << (S32)(mb / (usec[1] / 1000000.0)) << std::endl;
+    }
+}
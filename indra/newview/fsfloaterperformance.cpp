@@ -735,6 +735,7 @@ void FSFloaterPerformance::populateNearbyList()
             auto render_av_geom  = LLPerfStats::StatsRecorder::get(AvType, avatar->getID(),LLPerfStats::StatType_t::RENDER_GEOMETRY);
             auto render_av_shadow  = LLPerfStats::StatsRecorder::get(AvType, avatar->getID(),LLPerfStats::StatType_t::RENDER_SHADOWS);
             auto render_av_idle  = LLPerfStats::StatsRecorder::get(AvType, avatar->getID(),LLPerfStats::StatType_t::RENDER_IDLE);
+            auto render_av_anim  = LLPerfStats::StatsRecorder::get(AvType, avatar->getID(),LLPerfStats::StatType_t::RENDER_ANIMATION); // <FS:Perf/> Animation LOD
             LLPerfStats::bufferToggleLock.unlock();
 
             auto is_slow = avatar->isTooSlow();
@@ -812,6 +813,21 @@ void FSFloaterPerformance::populateNearbyList()
             row[colno]["type"] = "text";
             row[colno]["value"] = llformat( "%.2f/%.2f/%.2f", LLPerfStats::raw_to_us( render_av_geom ), LLPerfStats::raw_to_us( render_av_shadow ), LLPerfStats::raw_to_us( render_av_idle ) );
             colno++;
+            // <FS:Perf> Animation LOD
+            row[colno]["column"] = "anim";
+            row[colno]["type"] = "text";
+            const LLMotionController& motion_controller = avatar->getMotionController();
+            if (motion_controller.getLODPeriod() > 1)
+            {
+                row[colno]["value"] = llformat( "%.2f 1/%u%s", LLPerfStats::raw_to_us( render_av_anim ), motion_controller.getLODPeriod(), motion_controller.getBaseJointsOnly() ? " B" : "" );
+            }
+            else
+            {
+                row[colno]["value"] = llformat( "%.2f", LLPerfStats::raw_to_us( render_av_anim ) );
+            }
+            row[colno]["font"]["name"] = "SANSSERIF";
+            colno++;
+            // </FS:Perf>
 
             LLScrollListItem* av_item = mNearbyList->addElement(item);
             if (av_item)
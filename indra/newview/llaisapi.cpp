@@ -41,6 +41,12 @@
 #include "llviewercontrol.h"
 
 #include "llviewernetwork.h"
+// <FS:Perf> Fetch replies are parsed on the general thread pool
+#include "llhttpconstants.h"
+#include "llmemorystream.h"
+#include "llsdserialize.h"
+#include "workqueue.h"
+// </FS:Perf>
 
 ///----------------------------------------------------------------------------
 /// Classes for AISv3 support.
@@ -59,6 +65,63 @@ const S32 MAX_SIMULTANEOUS_COROUTINES = 2048;
 // Specify own depth to be able to anticipate it and mark folders as incomplete
 const S32 MAX_FOLDER_DEPTH_REQUEST = 50;
 
+// <FS:Perf> Fetch replies are read with getRawAndSuspend(). This turns one
+// into what getAndSuspend() would have returned, see HttpCoroLLSDHandler,
+// and unpacks the inventory objects in it. It only uses what it is handed
+// so that it can run on the general thread pool.
+static LLSD decode_fetch_reply(const LLCore::HttpStatus& status, const LLSD::Binary& raw,
+                               const std::string& error_body, bool& parse_failed,
+                               AISDecodedObjects& decoded)
+{
+    LLSD content;
+    parse_failed = false;
+    if (status)
+    {
+        if (!raw.empty())
+        {
+            LLMemoryStream istr(raw.data(), (S32)raw.size());
+            parse_failed = LLSDSerialize::fromXML(content, istr, true) == LLSDParser::PARSE_FAILURE;
+        }
+
+        if (parse_failed)
+        {
+            content = LLSD::emptyMap();
+        }
+        else if (!content.isMap())
+        {
+            LLSD map = LLSD::emptyMap();
+            map[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS_CONTENT] = content;
+            content = map;
+        }
+    }
+    else
+    {
+        content = LLSD::emptyMap();
+        const S32 type = (S32)status.getType();
+        if (type >= 400 && type < 500 && !error_body.empty())
+        {
+            // Error replies may carry the id of what failed
+            std::istringstream istr(error_body);
+            LLSD body;
+            if (LLSDSerialize::fromXML(body, istr, true) != LLSDParser::PARSE_FAILURE && body.isDefined())
+            {
+                if (body.isMap())
+                {
+                    content = body;
+                }
+                else
+                {
+                    content[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS_CONTENT] = body;
+                }
+            }
+        }
+    }
+
+    AISUpdate::decodeObjects(content, decoded);
+    return content;
+}
+// </FS:Perf>
+
 //-------------------------------------------------------------------------
 /*static*/
 bool AISAPI::isAvailable()
@@ -440,7 +503,10 @@ void AISAPI::FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callba
 		// _4 -> body 
 		// _5 -> httpOptions
 		// _6 -> httpHeaders
-		(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+		// <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+		//(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+		(&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend), _1, _2, _3, _5, _6);
+		// </FS:Perf>
 
 	LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
 		_1, getFn, url, itemId, LLSD(), callback, FETCHITEM));
@@ -488,7 +554,10 @@ void AISAPI::FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type, bool rec
         // _4 -> body 
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend), _1, _2, _3, _5, _6);
+        // </FS:Perf>
 
     // get doesn't use body, can pass additional data
     LLSD body;
@@ -541,7 +610,10 @@ void AISAPI::FetchCategoryChildren(const std::string &identifier, bool recursive
         // _4 -> body 
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend), _1, _2, _3, _5, _6);
+        // </FS:Perf>
 
     // get doesn't use body, can pass additional data
     LLSD body;
@@ -592,7 +664,10 @@ void AISAPI::FetchCategoryCategories(const LLUUID &catId, ITEM_TYPE type, bool r
         // _4 -> body 
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend), _1, _2, _3, _5, _6);
+        // </FS:Perf>
 
     // get doesn't use body, can pass additional data
     LLSD body;
@@ -669,7 +744,10 @@ void AISAPI::FetchCategorySubset(const LLUUID& catId,
         // _4 -> body 
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend), _1, _2, _3, _5, _6);
+        // </FS:Perf>
 
     // get doesn't use body, can pass additional data
     LLSD body;
@@ -706,7 +784,10 @@ void AISAPI::FetchCOF(completion_t callback)
         // _4 -> body 
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend), _1, _2, _3, _5, _6);
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend), _1, _2, _3, _5, _6);
+        // </FS:Perf>
 
     LLSD body;
     // Only cof folder will be full, but cof can contain an outfit
@@ -743,7 +824,10 @@ void AISAPI::FetchCategoryLinks(const LLUUID &catId, completion_t callback)
         // _4 -> body
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend),
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend),
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend),
+        // </FS:Perf>
         _1, _2, _3, _5, _6);
 
     LLSD body;
@@ -779,7 +863,10 @@ void AISAPI::FetchOrphans(completion_t callback)
         // _4 -> body 
         // _5 -> httpOptions
         // _6 -> httpHeaders
-        (&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend) , _1 , _2 , _3 , _5 , _6);
+        // <FS:Perf> Parsed on the general thread pool, see InvokeAISCommandCoro()
+        //(&LLCoreHttpUtil::HttpCoroutineAdapter::getAndSuspend) , _1 , _2 , _3 , _5 , _6);
+        (&LLCoreHttpUtil::HttpCoroutineAdapter::getRawAndSuspend) , _1 , _2 , _3 , _5 , _6);
+        // </FS:Perf>
 
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro ,
                                                          _1 , getFn , url , LLUUID::null , LLSD() , callback , FETCHORPHANS));
@@ -838,7 +925,10 @@ void AISAPI::onIdle(void *userdata)
 }
 
 /*static*/
-void AISAPI::onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body)
+// <FS:Perf> Unpacked objects of fetch replies
+//void AISAPI::onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body)
+void AISAPI::onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body, AISDecodedObjects* decoded)
+// </FS:Perf>
 {
     LLTimer timer;
     if ( (type == UPDATECATEGORY || type == UPDATEITEM)
@@ -847,7 +937,7 @@ void AISAPI::onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD&
         dump_sequential_xml(gAgentAvatarp->getFullname() + "_ais_update", update);
     }
 
-    AISUpdate ais_update(update, type, request_body);
+    AISUpdate ais_update(update, type, request_body, decoded); // <FS:Perf/> Unpacked objects of fetch replies
     ais_update.doUpdate(); // execute the updates in the appropriate order.
     LL_DEBUGS("Inventory", "AIS3") << "Elapsed processing: " << timer.getElapsedTimeF32() << LL_ENDL;
 }
@@ -879,6 +969,64 @@ void AISAPI::InvokeAISCommandCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t ht
     LLCore::HttpStatus status;
 
     result = invoke(httpAdapter , httpRequest , url , body , httpOptions , httpHeaders);
+
+    // <FS:Perf> Parse fetch replies and unpack their inventory objects on
+    // the general thread pool while this coroutine waits, leaving only the
+    // model updates for the main thread.
+    AISDecodedObjects decoded;
+    const bool fetch = (type == FETCHITEM)
+        || (type == FETCHCATEGORYCHILDREN)
+        || (type == FETCHCATEGORYCATEGORIES)
+        || (type == FETCHCATEGORYSUBSET)
+        || (type == FETCHCOF)
+        || (type == FETCHCATEGORYLINKS)
+        || (type == FETCHORPHANS);
+    if (fetch)
+    {
+        LLSD& raw_results = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS];
+        LLCore::HttpStatus fetch_status = LLCoreHttpUtil::HttpCoroutineAdapter::getStatusFromLLSD(raw_results);
+        const LLSD::Binary& raw = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS_RAW].asBinary();
+        const std::string error_body = raw_results["error_body"].asString();
+        bool parse_failed = false;
+
+        LLSD content;
+        bool decoded_off_thread = false;
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        if (general_queue)
+        {
+            try
+            {
+                // Nothing else touches these while we wait. The reply is
+                // stored by the worker rather than returned, so that no
+                // copy of it is released there once we have resumed.
+                general_queue->waitForResult(
+                    [&fetch_status, &raw, &error_body, &parse_failed, &decoded, &content]()
+                    {
+                        content = decode_fetch_reply(fetch_status, raw, error_body, parse_failed, decoded);
+                    });
+                decoded_off_thread = true;
+            }
+            catch (const LL::WorkQueueBase::Closed&)
+            {
+            }
+        }
+        if (!decoded_off_thread)
+        {
+            content = decode_fetch_reply(fetch_status, raw, error_body, parse_failed, decoded);
+        }
+
+        if (parse_failed
+            && raw_results[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS_HEADERS][HTTP_IN_HEADER_CONTENT_TYPE].asString() == HTTP_CONTENT_LLSD_XML)
+        {
+            LL_WARNS("Inventory") << "Failed to deserialize " << url << LL_ENDL;
+            fetch_status = LLCore::HttpStatus(499, "Failed to deserialize LLSD.");
+            LLCoreHttpUtil::HttpCoroHandler::writeStatusCodes(fetch_status, url, raw_results);
+        }
+        content[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS] = raw_results;
+        result = content;
+    }
+    // </FS:Perf>
+
     httpResults = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS];
     status = LLCoreHttpUtil::HttpCoroutineAdapter::getStatusFromLLSD(httpResults);
 
@@ -953,7 +1101,10 @@ void AISAPI::InvokeAISCommandCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t ht
     }
 
 	LL_DEBUGS("Inventory", "AIS3") << "Result: " << result << LL_ENDL;
-    onUpdateReceived(result, type, body);
+    // <FS:Perf> Unpacked objects of fetch replies
+    //onUpdateReceived(result, type, body);
+    onUpdateReceived(result, type, body, fetch ? &decoded : NULL);
+    // </FS:Perf>
 
     if (callback && !callback.empty())
     {
@@ -1078,8 +1229,13 @@ void AISAPI::InvokeAISCommandCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t ht
 }
 
 //-------------------------------------------------------------------------
-AISUpdate::AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD& request_body)
+// <FS:Perf> Unpacked objects of fetch replies
+//AISUpdate::AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD& request_body)
+//: mType(type)
+AISUpdate::AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD& request_body, AISDecodedObjects* decoded)
 : mType(type)
+, mDecoded(decoded)
+// </FS:Perf>
 {
     mFetch = (type == AISAPI::FETCHITEM)
         || (type == AISAPI::FETCHCATEGORYCHILDREN)
@@ -1100,6 +1256,80 @@ AISUpdate::AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD&
 	parseUpdate(update);
 }
 
+// <FS:Perf> Unpacked objects of fetch replies
+// static
+void AISUpdate::decodeObjects(const LLSD& content, AISDecodedObjects& decoded)
+{
+    if (content.isMap())
+    {
+        // Same as parseItem(), parseLink() and parseCategory() do for
+        // objects that are not in the inventory yet
+        if (content.has("item_id"))
+        {
+            LLPointer<LLViewerInventoryItem> new_item(new LLViewerInventoryItem);
+            if (new_item->unpackMessage(content))
+            {
+                decoded.mItems[content["item_id"].asUUID()] = new_item;
+            }
+        }
+        else if (content.has("category_id"))
+        {
+            LLPointer<LLViewerInventoryCategory> new_cat(
+                new LLViewerInventoryCategory(content.has("agent_id") ? content["agent_id"].asUUID() : LLUUID::null));
+            if (new_cat->unpackMessage(content))
+            {
+                decoded.mCategories[content["category_id"].asUUID()] = new_cat;
+            }
+        }
+
+        for (LLSD::map_const_iterator it = content.beginMap(); it != content.endMap(); ++it)
+        {
+            if (it->second.isMap() || it->second.isArray())
+            {
+                decodeObjects(it->second, decoded);
+            }
+        }
+    }
+    else if (content.isArray())
+    {
+        for (LLSD::array_const_iterator it = content.beginArray(); it != content.endArray(); ++it)
+        {
+            decodeObjects(*it, decoded);
+        }
+    }
+}
+
+LLPointer<LLViewerInventoryItem> AISUpdate::takeDecodedItem(const LLUUID& item_id)
+{
+    LLPointer<LLViewerInventoryItem> item;
+    if (mDecoded)
+    {
+        std::map<LLUUID, LLPointer<LLViewerInventoryItem> >::iterator it = mDecoded->mItems.find(item_id);
+        if (it != mDecoded->mItems.end())
+        {
+            item = it->second;
+            mDecoded->mItems.erase(it);
+        }
+    }
+    return item;
+}
+
+LLPointer<LLViewerInventoryCategory> AISUpdate::takeDecodedCategory(const LLUUID& category_id)
+{
+    LLPointer<LLViewerInventoryCategory> category;
+    if (mDecoded)
+    {
+        std::map<LLUUID, LLPointer<LLViewerInventoryCategory> >::iterator it = mDecoded->mCategories.find(category_id);
+        if (it != mDecoded->mCategories.end())
+        {
+            category = it->second;
+            mDecoded->mCategories.erase(it);
+        }
+    }
+    return category;
+}
+// </FS:Perf>
+
 void AISUpdate::clearParseResults()
 {
 	mCatDescendentDeltas.clear();
@@ -1250,14 +1480,29 @@ void AISUpdate::parseContent(const LLSD& update)
 void AISUpdate::parseItem(const LLSD& item_map)
 {
 	LLUUID item_id = item_map["item_id"].asUUID();
-	LLPointer<LLViewerInventoryItem> new_item(new LLViewerInventoryItem);
+	// <FS:Perf> Unpacked objects of fetch replies
+	//LLPointer<LLViewerInventoryItem> new_item(new LLViewerInventoryItem);
+	//LLViewerInventoryItem *curr_item = gInventory.getItem(item_id);
+	//if (curr_item)
+	//{
+	//	// Default to current values where not provided.
+	//	new_item->copyViewerItem(curr_item);
+	//}
+	//BOOL rv = new_item->unpackMessage(item_map);
 	LLViewerInventoryItem *curr_item = gInventory.getItem(item_id);
-	if (curr_item)
+	LLPointer<LLViewerInventoryItem> new_item(curr_item ? LLPointer<LLViewerInventoryItem>() : takeDecodedItem(item_id));
+	BOOL rv = new_item.notNull();
+	if (!rv)
 	{
-		// Default to current values where not provided.
-		new_item->copyViewerItem(curr_item);
+		new_item = new LLViewerInventoryItem;
+		if (curr_item)
+		{
+			// Default to current values where not provided.
+			new_item->copyViewerItem(curr_item);
+		}
+		rv = new_item->unpackMessage(item_map);
 	}
-	BOOL rv = new_item->unpackMessage(item_map);
+	// </FS:Perf>
 	if (rv)
 	{
         if (mFetch)
@@ -1295,14 +1540,29 @@ void AISUpdate::parseItem(const LLSD& item_map)
 void AISUpdate::parseLink(const LLSD& link_map, S32 depth)
 {
 	LLUUID item_id = link_map["item_id"].asUUID();
-	LLPointer<LLViewerInventoryItem> new_link(new LLViewerInventoryItem);
+	// <FS:Perf> Unpacked objects of fetch replies
+	//LLPointer<LLViewerInventoryItem> new_link(new LLViewerInventoryItem);
+	//LLViewerInventoryItem *curr_link = gInventory.getItem(item_id);
+	//if (curr_link)
+	//{
+	//	// Default to current values where not provided.
+	//	new_link->copyViewerItem(curr_link);
+	//}
+	//BOOL rv = new_link->unpackMessage(link_map);
 	LLViewerInventoryItem *curr_link = gInventory.getItem(item_id);
-	if (curr_link)
+	LLPointer<LLViewerInventoryItem> new_link(curr_link ? LLPointer<LLViewerInventoryItem>() : takeDecodedItem(item_id));
+	BOOL rv = new_link.notNull();
+	if (!rv)
 	{
-		// Default to current values where not provided.
-		new_link->copyViewerItem(curr_link);
+		new_link = new LLViewerInventoryItem;
+		if (curr_link)
+		{
+			// Default to current values where not provided.
+			new_link->copyViewerItem(curr_link);
+		}
+		rv = new_link->unpackMessage(link_map);
 	}
-	BOOL rv = new_link->unpackMessage(link_map);
+	// </FS:Perf>
 	if (rv)
 	{
 		const LLUUID& parent_id = new_link->getParentUUID();
@@ -1391,11 +1651,20 @@ void AISUpdate::parseCategory(const LLSD& category_map, S32 depth)
     }
 
 	LLPointer<LLViewerInventoryCategory> new_cat;
+	// <FS:Perf> Unpacked objects of fetch replies
+	BOOL rv = FALSE;
+	// </FS:Perf>
 	if (curr_cat)
 	{
 		// Default to current values where not provided.
         new_cat = new LLViewerInventoryCategory(curr_cat);
     }
+    // <FS:Perf> Unpacked objects of fetch replies
+    else if ((new_cat = takeDecodedCategory(category_id)).notNull())
+    {
+        rv = TRUE;
+    }
+    // </FS:Perf>
     else
     {
         if (category_map.has("agent_id"))
@@ -1408,7 +1677,13 @@ void AISUpdate::parseCategory(const LLSD& category_map, S32 depth)
             new_cat = new LLViewerInventoryCategory(LLUUID::null);
         }
     }
-	BOOL rv = new_cat->unpackMessage(category_map);
+	// <FS:Perf> Unpacked objects of fetch replies
+	//BOOL rv = new_cat->unpackMessage(category_map);
+	if (!rv)
+	{
+		rv = new_cat->unpackMessage(category_map);
+	}
+	// </FS:Perf>
 	// *NOTE: unpackMessage does not unpack version or descendent count.
 	if (rv)
 	{
@@ -35,6 +35,15 @@
 #include "llcorehttputil.h"
 #include "llcoproceduremanager.h"
 
+// <FS:Perf> Items, links and categories of a fetch reply, unpacked on the
+// general thread pool before the reply is handed to AISUpdate
+struct AISDecodedObjects
+{
+	std::map<LLUUID, LLPointer<LLViewerInventoryItem> > mItems;
+	std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > mCategories;
+};
+// </FS:Perf>
+
 class AISAPI
 {
 public:
@@ -94,7 +103,10 @@ private:
 
     static void EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc);
     static void onIdle(void *userdata); // launches postponed AIS commands
-    static void onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body);
+    // <FS:Perf> Unpacked objects of fetch replies
+    //static void onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body);
+    static void onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body, AISDecodedObjects* decoded = NULL);
+    // </FS:Perf>
 
     static std::string getInvCap();
     static std::string getLibCap();
@@ -110,7 +122,12 @@ private:
 class AISUpdate
 {
 public:
-	AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD& request_body);
+	// <FS:Perf> Unpacked objects of fetch replies
+	//AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD& request_body);
+	AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD& request_body, AISDecodedObjects* decoded = NULL);
+	// Safe to call off the main thread
+	static void decodeObjects(const LLSD& content, AISDecodedObjects& decoded);
+	// </FS:Perf>
 	void parseUpdate(const LLSD& update);
 	void parseMeta(const LLSD& update);
 	void parseContent(const LLSD& update);
@@ -132,6 +149,11 @@ public:
 private:
 	void clearParseResults();
     void checkTimeout();
+    // <FS:Perf> Unpacked objects of fetch replies, only usable when there
+    // is no current object to take defaults from
+    LLPointer<LLViewerInventoryItem> takeDecodedItem(const LLUUID& item_id);
+    LLPointer<LLViewerInventoryCategory> takeDecodedCategory(const LLUUID& category_id);
+    // </FS:Perf>
 
     // Fetch can return large packets of data, throttle it to not cause lags
     // Todo: make throttle work over all fetch requests isntead of per-request
@@ -159,6 +181,7 @@ private:
     S32 mFetchDepth;
     LLTimer mTimer;
     AISAPI::COMMAND_TYPE mType;
+    AISDecodedObjects* mDecoded; // <FS:Perf/> May be NULL
 };
 
 #endif
@@ -459,6 +459,26 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 					mHttpClasses[app_policy].mPipelined = to_pipeline;
 				}
 			}
+
+			// <FS:Perf> HTTP/2 multiplexing for the classes that pipeline,
+			// which are the ones served by the CDN.
+			static LLCachedControl<bool> http_multiplexing(gSavedSettings, "HttpMultiplexing", true);
+			if (http_multiplexing && init_data[i].mPipelined)
+			{
+				LLCore::HttpHandle handle;
+				handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_MULTIPLEXING,
+												   mHttpClasses[app_policy].mPolicy,
+												   1L,
+												   LLCore::HttpHandler::ptr_t());
+				if (LLCORE_HTTP_HANDLE_INVALID == handle)
+				{
+					status = mRequest->getStatus();
+					LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+									 << " HTTP/2 multiplexing.  Reason:  " << status.toString()
+									 << LL_ENDL;
+				}
+			}
+			// </FS:Perf>
 		}
 		
 		// Get target connection concurrency value
@@ -102,6 +102,7 @@
 #include "llprogressview.h"
 #include "llvocache.h"
 #include "lldiskcache.h"
+#include "llblobstore.h" // <FS:Perf/> Packed blob store
 #include "llvopartgroup.h"
 // [SL:KB] - Patch: Appearance-Misc | Checked: 2013-02-12 (Catznip-3.4)
 #include "llappearancemgr.h"
@@ -4929,7 +4930,10 @@ U32 LLAppViewer::getObjectCacheVersion()
 {
 	// Viewer object cache version, change if object update
 	// format changes. JC
-	const U32 INDRA_OBJECT_CACHE_VERSION = 17;
+	// <FS:Perf> Memory mapped region object cache files
+	//const U32 INDRA_OBJECT_CACHE_VERSION = 17;
+	const U32 INDRA_OBJECT_CACHE_VERSION = 18;
+	// </FS:Perf>
 
 	return INDRA_OBJECT_CACHE_VERSION;
 }
@@ -5044,6 +5048,14 @@ bool LLAppViewer::initCache()
     // LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info);
     LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info, gSavedSettings.getF32("FSDiskCacheHighWaterPercent"), gSavedSettings.getF32("FSDiskCacheLowWaterPercent"));
 	// </FS:Beq>
+	// <FS:Perf> Packed blob store for cached assets
+	// The blob store and LLDiskCache share disk_cache_size: LLDiskCache::purge()
+	// only leaves the files what the slabs do not use.
+	if (gSavedSettings.getBOOL("FSDiskCacheBlobStore") && !read_only)
+	{
+		LLBlobStore::initParamSingleton(cache_dir + gDirUtilp->getDirDelimiter() + "blobs", disk_cache_size);
+	}
+	// </FS:Perf>
 
 	if (!read_only)
 	{
@@ -374,6 +374,12 @@ void LLControlAvatar::idleUpdate(LLAgent &agent, const F64 &time)
         markDead();
         mMarkedForDeath = false;
     }
+    // <FS:Perf> Parallel motion evaluation
+    else if (deferIdleUpdate(time))
+    {
+        // LLVOAvatar::evaluateMotionBatch() runs it after the attached avatar
+    }
+    // </FS:Perf>
     else
     {
         LLVOAvatar::idleUpdate(agent,time);
@@ -328,11 +328,16 @@ namespace
 
 void LLGLTFMaterialList::applyOverrideMessage(LLMessageSystem* msg, const std::string& data_in)
 {
-    std::istringstream str(data_in);
-
+    // <FS:Perf> Parse straight out of the message string
+    //std::istringstream str(data_in);
+    //
+    //LLSD data;
+    //
+    //LLSDSerialize::fromNotation(data, str, data_in.length());
     LLSD data;
 
-    LLSDSerialize::fromNotation(data, str, data_in.length());
+    LLSDSerialize::fromNotation(data, data_in.data(), data_in.length());
+    // </FS:Perf>
 
     const LLHost& host = msg->getSender();
     
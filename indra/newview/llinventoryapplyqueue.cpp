@@ -0,0 +1,133 @@
+/**
+ * @file llinventoryapplyqueue.cpp
+ * @brief Decodes inventory replies off the main thread and applies them
+ * to the inventory model a few at a time.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventoryapplyqueue.h"
+
+#include "llcallbacklist.h"
+#include "llcontrol.h"
+#include "lltimer.h"
+#include "llviewercontrol.h"
+#include "workqueue.h"
+
+LLInventoryApplyQueue::LLInventoryApplyQueue()
+:	mNextSequence(0),
+	mIdleRegistered(false)
+{
+}
+
+LLInventoryApplyQueue::~LLInventoryApplyQueue()
+{
+	if (mIdleRegistered)
+	{
+		gIdleCallbacks.deleteFunction(onIdle, this);
+	}
+}
+
+void LLInventoryApplyQueue::post(const decode_t& decode, const std::shared_ptr<void>& owner)
+{
+	const U64 sequence = mNextSequence++;
+	mBatches[sequence].mOwner = owner;
+
+	if (!mIdleRegistered)
+	{
+		gIdleCallbacks.addFunction(onIdle, this);
+		mIdleRegistered = true;
+	}
+
+	LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+	LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+	// A copy of decode, so that it can still be run here if posting fails
+	if (main_queue && general_queue &&
+		main_queue->postTo(general_queue,
+						   decode_t(decode),
+						   [sequence](steps_t steps)
+						   {
+							   LLInventoryApplyQueue::instance().addDecoded(sequence, std::move(steps));
+						   }))
+	{
+		return;
+	}
+
+	addDecoded(sequence, decode());
+}
+
+void LLInventoryApplyQueue::addDecoded(U64 sequence, steps_t&& steps)
+{
+	std::map<U64, Batch>::iterator it = mBatches.find(sequence);
+	if (it == mBatches.end())
+	{
+		LL_WARNS() << "Decoded inventory batch " << sequence << " is not queued" << LL_ENDL;
+		return;
+	}
+	it->second.mSteps = std::move(steps);
+	it->second.mDecoded = true;
+}
+
+void LLInventoryApplyQueue::applySteps(F32 budget_ms)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	const F64 budget = (F64)budget_ms / 1000.0;
+	LLTimer timer;
+	bool over_budget = false;
+	// Batches further back wait for the ones in front to be decoded
+	while (!over_budget && !mBatches.empty() && mBatches.begin()->second.mDecoded)
+	{
+		std::map<U64, Batch>::iterator it = mBatches.begin();
+		Batch& batch = it->second;
+		while (!over_budget && batch.mNextStep < batch.mSteps.size())
+		{
+			step_t step;
+			step.swap(batch.mSteps[batch.mNextStep++]);
+			step();
+			over_budget = timer.getElapsedTimeF64() >= budget;
+		}
+
+		if (batch.mNextStep >= batch.mSteps.size())
+		{
+			mBatches.erase(it);
+		}
+	}
+}
+
+// static
+void LLInventoryApplyQueue::onIdle(void* userdata)
+{
+	LLInventoryApplyQueue* self = static_cast<LLInventoryApplyQueue*>(userdata);
+
+	static LLCachedControl<F32> budget_ms(gSavedSettings, "InventoryApplyTimeBudget", 2.f);
+	self->applySteps(llmax((F32)budget_ms, 0.f));
+
+	if (self->mBatches.empty())
+	{
+		gIdleCallbacks.deleteFunction(onIdle, self);
+		self->mIdleRegistered = false;
+	}
+}
@@ -0,0 +1,87 @@
+/**
+ * @file llinventoryapplyqueue.h
+ * @brief Decodes inventory replies off the main thread and applies them
+ * to the inventory model a few at a time.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYAPPLYQUEUE_H
+#define LL_LLINVENTORYAPPLYQUEUE_H
+
+#include "llsingleton.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * Inventory replies are parsed, and their items and categories built, on
+ * the "General" thread pool. What that leaves for the main thread is a
+ * list of steps that update the inventory model, which are run from the
+ * idle loop within InventoryApplyTimeBudget milliseconds per frame.
+ * Observers are told about the changes by the usual idle notification.
+ *
+ * Steps run in the order their batches were posted, whichever batch
+ * finished decoding first.
+ */
+class LLInventoryApplyQueue : public LLSingleton<LLInventoryApplyQueue>
+{
+	LLSINGLETON(LLInventoryApplyQueue);
+	~LLInventoryApplyQueue();
+	LOG_CLASS(LLInventoryApplyQueue);
+
+public:
+	typedef std::function<void()> step_t;
+	typedef std::vector<step_t> steps_t;
+	typedef std::function<steps_t()> decode_t;
+
+	// Runs decode on the general thread pool, or right here when there is
+	// none, and queues the steps it returns. owner is released on the main
+	// thread once the last of those steps has run, so the steps may keep
+	// plain pointers to it.
+	void post(const decode_t& decode, const std::shared_ptr<void>& owner = std::shared_ptr<void>());
+
+	// True when nothing is being decoded or waiting to be applied
+	bool isIdle() const { return mBatches.empty(); }
+
+private:
+	void addDecoded(U64 sequence, steps_t&& steps);
+	void applySteps(F32 budget_ms);
+	static void onIdle(void* userdata);
+
+	struct Batch
+	{
+		std::shared_ptr<void> mOwner;
+		steps_t mSteps;
+		size_t mNextStep = 0;
+		bool mDecoded = false;
+	};
+	// Keyed by the order of post() calls
+	std::map<U64, Batch> mBatches;
+	U64 mNextSequence;
+	bool mIdleRegistered;
+};
+
+#endif // LL_LLINVENTORYAPPLYQUEUE_H
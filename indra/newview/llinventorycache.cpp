@@ -0,0 +1,817 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary, incrementally updated inventory cache files.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorycache.h"
+
+#include "hbxxh.h"
+#include "llfile.h"
+#include "llmappedfile.h"
+#include "llviewerinventory.h"
+#include "llxorcipher.h"
+#include "parallelfor.h"
+
+#include <atomic>
+
+namespace
+{
+	const U32 SNAPSHOT_MAGIC = 0x43494c53; // "SLIC"
+	const U32 LOG_MAGIC = 0x4c494c53; // "SLIL"
+	const U32 FORMAT_VERSION = 2;
+
+	// Asset ids are stored XOR-ciphered, like the shadow_id that
+	// LLInventoryItem::asLLSD() writes to the LLSD inventory cache.
+	const LLUUID MAGIC_ID("3c115e51-04f4-523c-9fa6-98aff1034730");
+
+	// The log is folded into a new snapshot once it has more entries than
+	// this, or than a quarter of the objects in the snapshot.
+	const U32 MIN_LOG_ENTRIES_TO_COMPACT = 1024;
+
+	// Records per slice when the snapshot is parsed on the "General" pool
+	const size_t PARSE_GRAIN = 4096;
+
+	// Log size when the log can't be appended to
+	const U64 LOG_UNUSABLE = ~0ULL;
+
+	struct SnapshotHeader
+	{
+		U32 mMagic;
+		U32 mFormatVersion;
+		S32 mInvCacheVersion;
+		U32 mNumCategories;
+		U32 mNumItems;
+		U32 mStringsSize;
+		U64 mGeneration;
+	};
+
+	struct LogHeader
+	{
+		U32 mMagic;
+		U32 mFormatVersion;
+		U64 mGeneration;
+	};
+
+	enum ELogEntry
+	{
+		LOG_CATEGORY = 1,	// CategoryRecord, then its name
+		LOG_ITEM = 2,		// ItemRecord, then its name and description
+		LOG_REMOVE = 3		// id of an object no longer in inventory
+	};
+
+	struct LogEntryHeader
+	{
+		U32 mType;
+		U32 mSize;		// of what follows
+	};
+
+	// String offsets are into the string table of the snapshot, or from the
+	// end of the record for a log entry.
+	struct CategoryRecord
+	{
+		U8  mID[UUID_BYTES];
+		U8  mParentID[UUID_BYTES];
+		U8  mOwnerID[UUID_BYTES];
+		U8  mThumbnailID[UUID_BYTES];
+		S32 mVersion;
+		U32 mNameOffset;
+		U32 mNameLength;
+		S8  mType;
+		S8  mPreferredType;
+		U8  mPad[2];
+	};
+
+	struct ItemRecord
+	{
+		U8  mID[UUID_BYTES];
+		U8  mParentID[UUID_BYTES];
+		U8  mAssetID[UUID_BYTES];
+		U8  mThumbnailID[UUID_BYTES];
+		U8  mCreatorID[UUID_BYTES];
+		U8  mOwnerID[UUID_BYTES];
+		U8  mLastOwnerID[UUID_BYTES];
+		U8  mGroupID[UUID_BYTES];
+		U32 mMaskBase;
+		U32 mMaskOwner;
+		U32 mMaskGroup;
+		U32 mMaskEveryone;
+		U32 mMaskNextOwner;
+		U32 mFlags;
+		S32 mCreationDate;
+		S32 mSalePrice;
+		U32 mNameOffset;
+		U32 mNameLength;
+		U32 mDescOffset;
+		U32 mDescLength;
+		S8  mType;
+		S8  mInventoryType;
+		U8  mSaleType;
+		U8  mPad;
+	};
+
+	// No padding, so that records hash and compare as plain bytes
+	static_assert(sizeof(SnapshotHeader) == 32, "SnapshotHeader has padding");
+	static_assert(sizeof(CategoryRecord) == 4 * UUID_BYTES + 16, "CategoryRecord has padding");
+	static_assert(sizeof(ItemRecord) == 8 * UUID_BYTES + 12 * 4 + 4, "ItemRecord has padding");
+
+	inline LLUUID to_uuid(const U8* bytes)
+	{
+		LLUUID id;
+		memcpy(id.mData, bytes, UUID_BYTES);
+		return id;
+	}
+
+	inline void put_string(std::string& strings, const std::string& value, U32& offset, U32& length)
+	{
+		offset = (U32)strings.size();
+		length = (U32)value.size();
+		strings.append(value);
+	}
+
+	inline bool get_string(const char* strings, U32 strings_size, U32 offset, U32 length, std::string& value)
+	{
+		if (offset > strings_size || length > strings_size - offset)
+		{
+			return false;
+		}
+		value.assign(strings + offset, length);
+		return true;
+	}
+
+	// Hash of an object, wherever its strings are stored
+	U64 hash_category(CategoryRecord record, const std::string& name)
+	{
+		record.mNameOffset = 0;
+		HBXXH64 hash;
+		hash.update(&record, sizeof(record));
+		hash.update(name);
+		return hash.digest();
+	}
+
+	U64 hash_item(ItemRecord record, const std::string& name, const std::string& desc)
+	{
+		record.mNameOffset = 0;
+		record.mDescOffset = 0;
+		HBXXH64 hash;
+		hash.update(&record, sizeof(record));
+		hash.update(name);
+		hash.update(desc);
+		return hash.digest();
+	}
+
+	// Links answer most getters for their target, so take the values of the
+	// object itself, as LLSD export does.
+	void make_record(const LLViewerInventoryCategory* cat, CategoryRecord& record, std::string& strings)
+	{
+		memset(&record, 0, sizeof(record));
+		memcpy(record.mID, cat->getUUID().mData, UUID_BYTES);
+		memcpy(record.mParentID, cat->getParentUUID().mData, UUID_BYTES);
+		memcpy(record.mOwnerID, cat->getOwnerID().mData, UUID_BYTES);
+		memcpy(record.mThumbnailID, cat->LLInventoryCategory::getThumbnailUUID().mData, UUID_BYTES);
+		record.mVersion = cat->getVersion();
+		record.mType = (S8)cat->getActualType();
+		record.mPreferredType = (S8)cat->getPreferredType();
+		put_string(strings, cat->LLInventoryCategory::getName(), record.mNameOffset, record.mNameLength);
+	}
+
+	void make_record(const LLViewerInventoryItem* item, ItemRecord& record, std::string& strings)
+	{
+		const LLPermissions& perm = item->LLInventoryItem::getPermissions();
+		const LLSaleInfo& sale_info = item->LLInventoryItem::getSaleInfo();
+
+		memset(&record, 0, sizeof(record));
+		memcpy(record.mID, item->getUUID().mData, UUID_BYTES);
+		memcpy(record.mParentID, item->getParentUUID().mData, UUID_BYTES);
+		memcpy(record.mAssetID, item->LLInventoryItem::getAssetUUID().mData, UUID_BYTES);
+		LLXORCipher cipher(MAGIC_ID.mData, UUID_BYTES);
+		cipher.encrypt(record.mAssetID, UUID_BYTES);
+		memcpy(record.mThumbnailID, item->LLInventoryItem::getThumbnailUUID().mData, UUID_BYTES);
+		memcpy(record.mCreatorID, perm.getCreator().mData, UUID_BYTES);
+		memcpy(record.mOwnerID, perm.getOwner().mData, UUID_BYTES);
+		memcpy(record.mLastOwnerID, perm.getLastOwner().mData, UUID_BYTES);
+		memcpy(record.mGroupID, perm.getGroup().mData, UUID_BYTES);
+		record.mMaskBase = perm.getMaskBase();
+		record.mMaskOwner = perm.getMaskOwner();
+		record.mMaskGroup = perm.getMaskGroup();
+		record.mMaskEveryone = perm.getMaskEveryone();
+		record.mMaskNextOwner = perm.getMaskNextOwner();
+		record.mFlags = item->LLInventoryItem::getFlags();
+		record.mCreationDate = (S32)item->LLInventoryItem::getCreationDate();
+		record.mSalePrice = sale_info.getSalePrice();
+		record.mType = (S8)item->getActualType();
+		record.mInventoryType = (S8)item->LLInventoryItem::getInventoryType();
+		record.mSaleType = (U8)sale_info.getSaleType();
+		put_string(strings, item->LLInventoryItem::getName(), record.mNameOffset, record.mNameLength);
+		put_string(strings, item->LLInventoryItem::getDescription(), record.mDescOffset, record.mDescLength);
+	}
+
+	LLPointer<LLViewerInventoryCategory> make_category(const CategoryRecord& record, const std::string& name)
+	{
+		LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(to_uuid(record.mID),
+																				 to_uuid(record.mParentID),
+																				 (LLFolderType::EType)record.mPreferredType,
+																				 name,
+																				 to_uuid(record.mOwnerID));
+		cat->setType((LLAssetType::EType)record.mType);
+		cat->setThumbnailUUID(to_uuid(record.mThumbnailID));
+		cat->setVersion(record.mVersion);
+		return cat;
+	}
+
+	LLPointer<LLViewerInventoryItem> make_item(const ItemRecord& record, const std::string& name, const std::string& desc)
+	{
+		// Same steps as ll_permissions_from_sd()
+		LLPermissions perm;
+		perm.init(to_uuid(record.mCreatorID), to_uuid(record.mOwnerID), to_uuid(record.mLastOwnerID), to_uuid(record.mGroupID));
+		perm.setMaskBase(record.mMaskBase);
+		perm.setMaskOwner(record.mMaskOwner);
+		perm.setMaskEveryone(record.mMaskEveryone);
+		perm.setMaskGroup(record.mMaskGroup);
+		perm.setMaskNext(record.mMaskNextOwner);
+		perm.fix();
+
+		LLUUID asset_id = to_uuid(record.mAssetID);
+		LLXORCipher cipher(MAGIC_ID.mData, UUID_BYTES);
+		cipher.decrypt(asset_id.mData, UUID_BYTES);
+
+		LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem(to_uuid(record.mID),
+																		 to_uuid(record.mParentID),
+																		 perm,
+																		 asset_id,
+																		 (LLAssetType::EType)record.mType,
+																		 (LLInventoryType::EType)record.mInventoryType,
+																		 name,
+																		 desc,
+																		 LLSaleInfo((LLSaleInfo::EForSale)record.mSaleType, record.mSalePrice),
+																		 record.mFlags,
+																		 (time_t)record.mCreationDate);
+		item->setThumbnailUUID(to_uuid(record.mThumbnailID));
+		return item;
+	}
+
+	void append_bytes(std::vector<U8>& out, const void* data, size_t size)
+	{
+		const U8* bytes = (const U8*)data;
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	// A log entry for an added or changed object: the record, with its
+	// strings right behind it.
+	template <typename RECORD>
+	void append_log_entry(std::vector<U8>& out, U32 type, RECORD record, const char* strings, U32 offset, U32 length)
+	{
+		LogEntryHeader header = { type, (U32)sizeof(RECORD) + length };
+		append_bytes(out, &header, sizeof(header));
+		append_bytes(out, &record, sizeof(RECORD));
+		append_bytes(out, strings + offset, length);
+	}
+
+	// Objects as the loader hands them out, plus the hash that goes into
+	// the map of what is on disk
+	struct LoadedObject
+	{
+		LLPointer<LLViewerInventoryCategory> mCategory;
+		LLPointer<LLViewerInventoryItem> mItem;
+		U64 mHash = 0;
+	};
+
+	bool read_log_entry(U32 type, const U8* data, U32 size, LLUUID& id, LoadedObject& object)
+	{
+		std::string name;
+		std::string desc;
+		if (type == LOG_CATEGORY && size >= sizeof(CategoryRecord))
+		{
+			CategoryRecord record;
+			memcpy(&record, data, sizeof(record));
+			const char* strings = (const char*)data + sizeof(record);
+			if (!get_string(strings, size - sizeof(record), record.mNameOffset, record.mNameLength, name))
+			{
+				return false;
+			}
+			id = to_uuid(record.mID);
+			object.mCategory = make_category(record, name);
+			object.mHash = hash_category(record, name);
+			return true;
+		}
+		if (type == LOG_ITEM && size >= sizeof(ItemRecord))
+		{
+			ItemRecord record;
+			memcpy(&record, data, sizeof(record));
+			const char* strings = (const char*)data + sizeof(record);
+			const U32 strings_size = size - sizeof(record);
+			if (!get_string(strings, strings_size, record.mNameOffset, record.mNameLength, name)
+				|| !get_string(strings, strings_size, record.mDescOffset, record.mDescLength, desc))
+			{
+				return false;
+			}
+			id = to_uuid(record.mID);
+			object.mItem = make_item(record, name, desc);
+			object.mHash = hash_item(record, name, desc);
+			return true;
+		}
+		if (type == LOG_REMOVE && size == UUID_BYTES)
+		{
+			id = to_uuid(data);
+			return true;
+		}
+		return false;
+	}
+}
+
+LLInventoryBinaryCache::LLInventoryBinaryCache(const std::string& snapshot_filename)
+:	mSnapshotFilename(snapshot_filename),
+	mLogFilename(snapshot_filename + ".log")
+{
+	reset();
+}
+
+void LLInventoryBinaryCache::reset()
+{
+	mOnDisk.clear();
+	mLoaded = false;
+	mInvCacheVersion = 0;
+	mGeneration = 0;
+	mSnapshotCount = 0;
+	mLogCount = 0;
+	mLogSize = 0;
+}
+
+//static
+void LLInventoryBinaryCache::removeFiles(const std::string& snapshot_filename)
+{
+	LLFile::remove(snapshot_filename, ENOENT);
+	LLFile::remove(snapshot_filename + ".log", ENOENT);
+}
+
+bool LLInventoryBinaryCache::load(S32 inv_cache_version,
+								  LLInventoryModel::cat_array_t& categories,
+								  LLInventoryModel::item_array_t& items,
+								  LLInventoryModel::changed_items_t& cats_to_update)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	reset();
+	if (!LLFile::isfile(mSnapshotFilename))
+	{
+		return false;
+	}
+
+	LLMappedFile snapshot;
+	if (!snapshot.open(mSnapshotFilename, LLMappedFile::READ_ONLY))
+	{
+		return false;
+	}
+
+	SnapshotHeader header;
+	if (snapshot.size() < sizeof(header))
+	{
+		LL_WARNS() << "Inventory cache " << mSnapshotFilename << " is truncated" << LL_ENDL;
+		return false;
+	}
+	memcpy(&header, snapshot.data(), sizeof(header));
+	if (header.mMagic != SNAPSHOT_MAGIC || header.mFormatVersion != FORMAT_VERSION || header.mInvCacheVersion != inv_cache_version)
+	{
+		LL_WARNS() << "Inventory cache " << mSnapshotFilename << " is out of date" << LL_ENDL;
+		return false;
+	}
+	const U64 categories_start = sizeof(header);
+	const U64 items_start = categories_start + (U64)header.mNumCategories * sizeof(CategoryRecord);
+	const U64 strings_start = items_start + (U64)header.mNumItems * sizeof(ItemRecord);
+	if (strings_start + header.mStringsSize != snapshot.size())
+	{
+		LL_WARNS() << "Inventory cache " << mSnapshotFilename << " is corrupt" << LL_ENDL;
+		return false;
+	}
+
+	// The log is small: read it whole and keep the last entry for each id.
+	// Snapshot records with an entry here are replaced or removed by it.
+	std::vector<U8> log;
+	U64 log_size = 0;
+	U32 log_count = 0;
+	std::unordered_map<LLUUID, LoadedObject> replaced;
+	std::vector<LLUUID> replaced_order;
+	if (LLFile::isfile(mLogFilename))
+	{
+		llifstream log_file(mLogFilename.c_str(), std::ios::in | std::ios::binary);
+		if (log_file.is_open())
+		{
+			log.assign(std::istreambuf_iterator<char>(log_file), std::istreambuf_iterator<char>());
+		}
+
+		LogHeader log_header;
+		if (log.size() >= sizeof(log_header))
+		{
+			memcpy(&log_header, log.data(), sizeof(log_header));
+		}
+		if (log.size() < sizeof(log_header) || log_header.mMagic != LOG_MAGIC
+			|| log_header.mFormatVersion != FORMAT_VERSION || log_header.mGeneration != header.mGeneration)
+		{
+			// Left over from another snapshot: the next save writes a new one
+			LL_WARNS() << "Ignoring inventory cache log " << mLogFilename << LL_ENDL;
+			log_size = LOG_UNUSABLE;
+		}
+		else
+		{
+			size_t offset = sizeof(log_header);
+			while (log.size() - offset >= sizeof(LogEntryHeader))
+			{
+				LogEntryHeader entry;
+				memcpy(&entry, log.data() + offset, sizeof(entry));
+				if (entry.mSize > log.size() - offset - sizeof(entry))
+				{
+					break; // cut short by a crash
+				}
+				LLUUID id;
+				LoadedObject object;
+				if (!read_log_entry(entry.mType, log.data() + offset + sizeof(entry), entry.mSize, id, object))
+				{
+					break;
+				}
+				if (replaced.find(id) == replaced.end())
+				{
+					replaced_order.push_back(id);
+				}
+				replaced[id] = object;
+				offset += sizeof(entry) + entry.mSize;
+				++log_count;
+			}
+			// A partial entry at the end means the log has to be rewritten
+			log_size = (offset == log.size()) ? offset : LOG_UNUSABLE;
+		}
+	}
+
+	// Records are fixed size, so the snapshot is parsed in slices on the
+	// general thread pool.
+	const U8* data = snapshot.data();
+	const char* strings = (const char*)data + strings_start;
+	const U32 strings_size = header.mStringsSize;
+	std::vector<LoadedObject> loaded_categories(header.mNumCategories);
+	std::vector<LoadedObject> loaded_items(header.mNumItems);
+	std::atomic<bool> corrupt(false);
+
+	LL::parallelFor("General", header.mNumCategories, PARSE_GRAIN,
+		[&](size_t begin, size_t end)
+		{
+			std::string name;
+			for (size_t i = begin; i < end && !corrupt; ++i)
+			{
+				CategoryRecord record;
+				memcpy(&record, data + categories_start + i * sizeof(CategoryRecord), sizeof(record));
+				if (!get_string(strings, strings_size, record.mNameOffset, record.mNameLength, name))
+				{
+					corrupt = true;
+					break;
+				}
+				loaded_categories[i].mHash = hash_category(record, name);
+				if (replaced.find(to_uuid(record.mID)) == replaced.end())
+				{
+					loaded_categories[i].mCategory = make_category(record, name);
+				}
+			}
+		});
+
+	LL::parallelFor("General", header.mNumItems, PARSE_GRAIN,
+		[&](size_t begin, size_t end)
+		{
+			std::string name;
+			std::string desc;
+			for (size_t i = begin; i < end && !corrupt; ++i)
+			{
+				ItemRecord record;
+				memcpy(&record, data + items_start + i * sizeof(ItemRecord), sizeof(record));
+				if (!get_string(strings, strings_size, record.mNameOffset, record.mNameLength, name)
+					|| !get_string(strings, strings_size, record.mDescOffset, record.mDescLength, desc))
+				{
+					corrupt = true;
+					break;
+				}
+				loaded_items[i].mHash = hash_item(record, name, desc);
+				if (replaced.find(to_uuid(record.mID)) == replaced.end())
+				{
+					loaded_items[i].mItem = make_item(record, name, desc);
+				}
+			}
+		});
+
+	if (corrupt)
+	{
+		LL_WARNS() << "Inventory cache " << mSnapshotFilename << " is corrupt" << LL_ENDL;
+		return false;
+	}
+
+	// Hand the objects out and note what the files hold
+	mOnDisk.reserve(header.mNumCategories + header.mNumItems + replaced.size());
+	auto add_category = [&](const LLPointer<LLViewerInventoryCategory>& cat, U64 hash)
+	{
+		mOnDisk[cat->getUUID()] = hash;
+		categories.push_back(cat);
+	};
+	auto add_item = [&](const LLPointer<LLViewerInventoryItem>& item, U64 hash)
+	{
+		mOnDisk[item->getUUID()] = hash;
+		if (item->getUUID().isNull())
+		{
+			LL_DEBUGS("Inventory") << "Ignoring inventory with null item id: " << item->getName() << LL_ENDL;
+		}
+		else if (item->getActualType() == LLAssetType::AT_UNKNOWN)
+		{
+			cats_to_update.insert(item->getParentUUID());
+		}
+		else
+		{
+			items.push_back(item);
+		}
+	};
+
+	categories.reserve(categories.size() + header.mNumCategories);
+	for (const LoadedObject& object : loaded_categories)
+	{
+		if (object.mCategory.notNull())
+		{
+			add_category(object.mCategory, object.mHash);
+		}
+	}
+	items.reserve(items.size() + header.mNumItems);
+	for (const LoadedObject& object : loaded_items)
+	{
+		if (object.mItem.notNull())
+		{
+			add_item(object.mItem, object.mHash);
+		}
+	}
+	for (const LLUUID& id : replaced_order)
+	{
+		const LoadedObject& object = replaced[id];
+		if (object.mCategory.notNull())
+		{
+			add_category(object.mCategory, object.mHash);
+		}
+		else if (object.mItem.notNull())
+		{
+			add_item(object.mItem, object.mHash);
+		}
+	}
+
+	mLoaded = true;
+	mInvCacheVersion = inv_cache_version;
+	mGeneration = header.mGeneration;
+	mSnapshotCount = header.mNumCategories + header.mNumItems;
+	mLogCount = log_count;
+	mLogSize = log_size;
+
+	LL_INFOS() << "Loaded inventory cache " << mSnapshotFilename << ": " << header.mNumCategories << " categories, "
+			   << header.mNumItems << " items, " << log_count << " log entries" << LL_ENDL;
+	return true;
+}
+
+bool LLInventoryBinaryCache::save(S32 inv_cache_version,
+								  const LLInventoryModel::cat_array_t& categories,
+								  const LLInventoryModel::item_array_t& items)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	// Records and strings for a snapshot, hashes to compare with the files
+	std::vector<U8> category_records;
+	std::vector<U8> item_records;
+	std::string strings;
+	hash_map_t current;
+	category_records.reserve(categories.size() * sizeof(CategoryRecord));
+	item_records.reserve(items.size() * sizeof(ItemRecord));
+	current.reserve(categories.size() + items.size());
+
+	// Entries for the log, in case it is enough to append to it
+	std::vector<U8> log_entries;
+	U32 log_count = 0;
+
+	std::string name;
+	std::string desc;
+	for (const LLPointer<LLViewerInventoryCategory>& cat : categories)
+	{
+		if (cat->getVersion() == LLViewerInventoryCategory::VERSION_UNKNOWN)
+		{
+			continue;
+		}
+		CategoryRecord record;
+		make_record(cat, record, strings);
+		name.assign(strings, record.mNameOffset, record.mNameLength);
+		const U64 hash = hash_category(record, name);
+		current[cat->getUUID()] = hash;
+		append_bytes(category_records, &record, sizeof(record));
+
+		hash_map_t::const_iterator found = mOnDisk.find(cat->getUUID());
+		if (mLoaded && (found == mOnDisk.end() || found->second != hash))
+		{
+			CategoryRecord entry = record;
+			entry.mNameOffset = 0;
+			append_log_entry(log_entries, LOG_CATEGORY, entry, strings.data(), record.mNameOffset, record.mNameLength);
+			++log_count;
+		}
+	}
+
+	for (const LLPointer<LLViewerInventoryItem>& item : items)
+	{
+		ItemRecord record;
+		make_record(item, record, strings);
+		name.assign(strings, record.mNameOffset, record.mNameLength);
+		desc.assign(strings, record.mDescOffset, record.mDescLength);
+		const U64 hash = hash_item(record, name, desc);
+		current[item->getUUID()] = hash;
+		append_bytes(item_records, &record, sizeof(record));
+
+		hash_map_t::const_iterator found = mOnDisk.find(item->getUUID());
+		if (mLoaded && (found == mOnDisk.end() || found->second != hash))
+		{
+			// name and description are next to each other in strings
+			ItemRecord entry = record;
+			entry.mNameOffset = 0;
+			entry.mDescOffset = record.mNameLength;
+			append_log_entry(log_entries, LOG_ITEM, entry, strings.data(), record.mNameOffset, record.mNameLength + record.mDescLength);
+			++log_count;
+		}
+	}
+
+	if (mLoaded)
+	{
+		for (const hash_map_t::value_type& on_disk : mOnDisk)
+		{
+			if (current.find(on_disk.first) == current.end())
+			{
+				LogEntryHeader header = { LOG_REMOVE, UUID_BYTES };
+				append_bytes(log_entries, &header, sizeof(header));
+				append_bytes(log_entries, on_disk.first.mData, UUID_BYTES);
+				++log_count;
+			}
+		}
+	}
+
+	const U32 total_log_count = mLogCount + log_count;
+	const bool append = mLoaded
+		&& inv_cache_version == mInvCacheVersion
+		&& total_log_count <= llmax(MIN_LOG_ENTRIES_TO_COMPACT, mSnapshotCount / 4)
+		&& filesUnchanged();
+
+	bool success;
+	if (append)
+	{
+		success = log_entries.empty() || appendToLog(log_entries);
+		if (success)
+		{
+			mLogCount = total_log_count;
+			LL_INFOS() << "Inventory cache " << mSnapshotFilename << ": " << log_count << " changes logged" << LL_ENDL;
+		}
+	}
+	else
+	{
+		success = writeSnapshot(inv_cache_version, category_records, item_records, strings);
+		if (success)
+		{
+			mSnapshotCount = (U32)current.size();
+			LL_INFOS() << "Inventory cache " << mSnapshotFilename << ": wrote " << category_records.size() / sizeof(CategoryRecord)
+					   << " categories and " << items.size() << " items" << LL_ENDL;
+		}
+	}
+
+	if (!success)
+	{
+		// Never leave files that don't match the inventory
+		removeFiles(mSnapshotFilename);
+		reset();
+		return false;
+	}
+
+	mOnDisk.swap(current);
+	mLoaded = true;
+	mInvCacheVersion = inv_cache_version;
+	return true;
+}
+
+bool LLInventoryBinaryCache::filesUnchanged() const
+{
+	// Another viewer instance may have written the files since we read them
+	if (mLogSize == LOG_UNUSABLE)
+	{
+		return false;
+	}
+
+	llifstream snapshot(mSnapshotFilename.c_str(), std::ios::in | std::ios::binary);
+	SnapshotHeader header;
+	if (!snapshot.is_open() || !snapshot.read((char*)&header, sizeof(header)) || header.mGeneration != mGeneration)
+	{
+		return false;
+	}
+
+	llstat log_stat;
+	if (LLFile::stat(mLogFilename, &log_stat))
+	{
+		return mLogSize == 0;
+	}
+	return (U64)log_stat.st_size == mLogSize;
+}
+
+bool LLInventoryBinaryCache::writeSnapshot(S32 inv_cache_version, const std::vector<U8>& categories, const std::vector<U8>& items,
+										   const std::string& strings)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	SnapshotHeader header;
+	header.mMagic = SNAPSHOT_MAGIC;
+	header.mFormatVersion = FORMAT_VERSION;
+	header.mInvCacheVersion = inv_cache_version;
+	header.mNumCategories = (U32)(categories.size() / sizeof(CategoryRecord));
+	header.mNumItems = (U32)(items.size() / sizeof(ItemRecord));
+	header.mStringsSize = (U32)strings.size();
+	LLUUID generation;
+	generation.generate();
+	memcpy(&header.mGeneration, generation.mData, sizeof(header.mGeneration));
+
+	// Write next to the old snapshot and move it over, so that a crash
+	// never leaves half a snapshot behind
+	const std::string temp_filename = mSnapshotFilename + ".tmp";
+	bool success = false;
+	{
+		llofstream out(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (out.is_open())
+		{
+			out.write((const char*)&header, sizeof(header));
+			out.write((const char*)categories.data(), categories.size());
+			out.write((const char*)items.data(), items.size());
+			out.write(strings.data(), strings.size());
+			out.close();
+			success = !out.fail();
+		}
+	}
+
+	// The old log goes with the old snapshot
+	LLFile::remove(mLogFilename, ENOENT);
+	if (success)
+	{
+		LLFile::remove(mSnapshotFilename, ENOENT);
+		success = LLFile::rename(temp_filename, mSnapshotFilename) == 0;
+	}
+	if (!success)
+	{
+		LL_WARNS() << "Unable to save inventory to: " << mSnapshotFilename << LL_ENDL;
+		LLFile::remove(temp_filename, ENOENT);
+		return false;
+	}
+
+	mGeneration = header.mGeneration;
+	mLogCount = 0;
+	mLogSize = 0;
+	return true;
+}
+
+bool LLInventoryBinaryCache::appendToLog(const std::vector<U8>& entries)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	llofstream out(mLogFilename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+	if (!out.is_open())
+	{
+		LL_WARNS() << "Unable to open inventory cache log " << mLogFilename << LL_ENDL;
+		return false;
+	}
+
+	U64 written = 0;
+	if (mLogSize == 0)
+	{
+		LogHeader header = { LOG_MAGIC, FORMAT_VERSION, mGeneration };
+		out.write((const char*)&header, sizeof(header));
+		written += sizeof(header);
+	}
+	out.write((const char*)entries.data(), entries.size());
+	written += entries.size();
+	out.close();
+	if (out.fail())
+	{
+		LL_WARNS() << "Unable to write inventory cache log " << mLogFilename << LL_ENDL;
+		return false;
+	}
+
+	mLogSize += written;
+	return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file llinventorycache.h
+ * @brief Binary, incrementally updated inventory cache files.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include "llinventorymodel.h"
+
+#include <unordered_map>
+
+/**
+ * The inventory cache of one owner, kept as a snapshot file and a log of
+ * the changes made since the snapshot was written.
+ *
+ * The snapshot holds fixed size category and item records followed by a
+ * table of their names and descriptions, so it is mapped and its records
+ * are turned into inventory objects by several threads at once. The log
+ * holds whole records for objects that were added or changed, and the ids
+ * of objects that went away.
+ *
+ * The cache remembers a hash of every object in the files it loaded or
+ * wrote. Saving only appends the objects whose hash changed to the log,
+ * until the log gets large enough that a new snapshot is cheaper to read.
+ */
+class LLInventoryBinaryCache
+{
+	LOG_CLASS(LLInventoryBinaryCache);
+
+public:
+	LLInventoryBinaryCache(const std::string& snapshot_filename);
+
+	// Reads the snapshot and replays the log. Returns false, with nothing
+	// added to categories or items, if there is no usable cache for
+	// inv_cache_version. Items of unknown type aren't returned: their
+	// folder goes into cats_to_update, as the LLSD cache does it.
+	bool load(S32 inv_cache_version,
+			  LLInventoryModel::cat_array_t& categories,
+			  LLInventoryModel::item_array_t& items,
+			  LLInventoryModel::changed_items_t& cats_to_update);
+
+	// Brings the files in line with categories and items, the way
+	// LLInventoryModel::cache() collects them. Folders of unknown version
+	// are left out.
+	bool save(S32 inv_cache_version,
+			  const LLInventoryModel::cat_array_t& categories,
+			  const LLInventoryModel::item_array_t& items);
+
+	const std::string& getSnapshotFilename() const { return mSnapshotFilename; }
+	const std::string& getLogFilename() const { return mLogFilename; }
+
+	// Deletes both files of the cache whose snapshot is snapshot_filename
+	static void removeFiles(const std::string& snapshot_filename);
+
+private:
+	bool writeSnapshot(S32 inv_cache_version, const std::vector<U8>& categories, const std::vector<U8>& items,
+					   const std::string& strings);
+	bool appendToLog(const std::vector<U8>& entries);
+	bool filesUnchanged() const;
+	void reset();
+
+private:
+	std::string mSnapshotFilename;
+	std::string mLogFilename;
+
+	// What the files hold: a hash of each object by id
+	typedef std::unordered_map<LLUUID, U64> hash_map_t;
+	hash_map_t	mOnDisk;
+	bool		mLoaded;		// mOnDisk matches the files
+	S32			mInvCacheVersion;
+	U64			mGeneration;	// of the snapshot, the log has to match it
+	U32			mSnapshotCount;	// objects in the snapshot
+	U32			mLogCount;		// entries in the log
+	U64			mLogSize;		// bytes in the log
+};
+
+#endif // LL_LLINVENTORYCACHE_H
@@ -40,6 +40,7 @@
 #include "lldispatcher.h"
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
+#include "llinventorycache.h" // <FS:Perf/> Binary inventory cache
 #include "llinventoryfunctions.h"
 #include "llinventorymodelbackgroundfetch.h"
 #include "llinventoryobserver.h"
@@ -66,6 +67,7 @@
 #include "bufferstream.h"
 #include "llcorehttputil.h"
 #include "hbxxh.h"
+#include "parallelfor.h" // <FS:Perf/> Validate on the general thread pool
 #include "llstartup.h"
 // [RLVa:KB] - Checked: 2011-05-22 (RLVa-1.3.1a)
 #include "rlvhandler.h"
@@ -694,6 +696,14 @@ LLInventoryObject* LLInventoryModel::getObject(const LLUUID& id) const
 LLViewerInventoryItem* LLInventoryModel::getItem(const LLUUID& id) const
 {
 	LLViewerInventoryItem* item = NULL;
+	// <FS:Perf> validate() looks items up from the general thread pool: only
+	// the main thread uses the cache of the last lookup.
+	if (!on_main_thread())
+	{
+		item_map_t::const_iterator iter = mItemMap.find(id);
+		return iter != mItemMap.end() ? iter->second.get() : NULL;
+	}
+	// </FS:Perf>
 	if(mLastItem.notNull() && mLastItem->getUUID() == id)
 	{
 		item = mLastItem;
@@ -2505,6 +2515,26 @@ std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
     return inventory_addr;
 }
 
+// <FS:Perf> Binary inventory cache
+//static
+std::string LLInventoryModel::getInvBinaryCacheAddres(const LLUUID& owner_id)
+{
+	// "<id>.inv.llsd" becomes "<id>.inv.bin"
+	std::string inventory_addr = getInvCacheAddres(owner_id);
+	return inventory_addr.replace(inventory_addr.size() - 4, 4, "bin");
+}
+
+LLInventoryBinaryCache& LLInventoryModel::getBinaryCache(const LLUUID& owner_id)
+{
+	std::shared_ptr<LLInventoryBinaryCache>& cache = mBinaryCaches[owner_id];
+	if (!cache)
+	{
+		cache = std::make_shared<LLInventoryBinaryCache>(getInvBinaryCacheAddres(owner_id));
+	}
+	return *cache;
+}
+// </FS:Perf>
+
 void LLInventoryModel::cache(
 	const LLUUID& parent_folder_id,
 	const LLUUID& agent_id)
@@ -2525,6 +2555,21 @@ void LLInventoryModel::cache(
 		items,
 		INCLUDE_TRASH,
 		can_cache);
+
+	// <FS:Perf> Binary inventory cache
+	// Only what changed since the last load or save is written, the LLSD
+	// cache below is kept as a fallback for when that fails.
+	if (getBinaryCache(agent_id).save(sCurrentInvCacheVersion, categories, items))
+	{
+		std::string gzip_filename = getInvCacheAddres(agent_id) + ".gz";
+		if (LLFile::isfile(gzip_filename))
+		{
+			LLFile::remove(gzip_filename);
+		}
+		return;
+	}
+	// </FS:Perf>
+
     // Use temporary file to avoid potential conflicts with other
     // instances (even a 'read only' instance unzips into a file)
     std::string temp_file = gDirUtilp->getTempFilename();
@@ -2859,6 +2904,12 @@ bool LLInventoryModel::loadSkeleton(
 			LLFile::remove(inventory_filename);
 		}
 
+		// <FS:Perf> Binary inventory cache
+		mBinaryCaches.clear();
+		LLInventoryBinaryCache::removeFiles(getInvBinaryCacheAddres(owner_id));
+		LLInventoryBinaryCache::removeFiles(getInvBinaryCacheAddres(gInventory.getLibraryOwnerID()));
+		// </FS:Perf>
+
 		// also delete library cache if inventory cache is purged, so issues with EEP settings going missing
 		// and bridge objects not being found can be resolved
 		// <FS:Beq> correct OS library owner.
@@ -2939,7 +2990,13 @@ bool LLInventoryModel::loadSkeleton(
 		const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
 		std::string gzip_filename(inventory_filename);
 		gzip_filename.append(".gz");
-		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+		// <FS:Perf> Binary inventory cache
+		// The LLSD cache is only read when there is no binary one yet, and
+		// replaced by the binary cache on the next save.
+		//LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+		const bool loaded_binary = getBinaryCache(owner_id).load(sCurrentInvCacheVersion, categories, items, categories_to_update);
+		LLFILE* fp = loaded_binary ? NULL : LLFile::fopen(gzip_filename, "rb");
+		// </FS:Perf>
 		bool remove_inventory_file = false;
 		if(fp)
 		{
@@ -2958,7 +3015,10 @@ bool LLInventoryModel::loadSkeleton(
 			}
 		}
 		bool is_cache_obsolete = false;
-		if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		// <FS:Perf> Binary inventory cache
+		//if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		if (loaded_binary || loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		// </FS:Perf>
 		{
 			// We were able to find a cache of files. So, use what we
 			// found to generate a set of categories we should add. We
@@ -3303,23 +3363,112 @@ void LLInventoryModel::buildParentChildMap()
 	// Now the items. We allocated in the last step, so now all we
 	// have to do is iterate over the items and put them in the right
 	// place.
-	item_array_t items;
-	if(!mItemMap.empty())
+	// <FS:Perf> Bucket the items by parent on the general thread pool, then
+	// file each bucket with a single lookup. Buckets are built per chunk of
+	// mItemMap and filed chunk by chunk, so that children keep their order.
+	//item_array_t items;
+	//if(!mItemMap.empty())
+	//{
+	//	LLPointer<LLViewerInventoryItem> item;
+	//	for(item_map_t::iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
+	//	{
+	//		item = (*iit).second;
+	//		items.push_back(item);
+	//	}
+	//}
+	//count = items.size();
+	//lost = 0;
+	//uuid_vec_t lost_item_ids;
+	//for(i = 0; i < count; ++i)
+	//{
+	//	LLPointer<LLViewerInventoryItem> item;
+	//	item = items.at(i);
+	//	itemsp = getUnlockedItemArray(item->getParentUUID());
+	//	if(itemsp)
+	//	{
+	//		itemsp->push_back(item);
+	//	}
+	//	else
+	//	{
+	//		LL_INFOS(LOG_INV) << "Lost item: " << item->getUUID() << " - "
+	//						  << item->getName() << LL_ENDL;
+	//		++lost;
+	//		// plop it into the lost & found.
+	//		//
+	//		item->setParent(findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
+	//		// move it later using a special message to move items. If
+	//		// we update server here, the client might crash.
+	//		//item->updateServer();
+	//		lost_item_ids.push_back(item->getUUID());
+	//		itemsp = getUnlockedItemArray(item->getParentUUID());
+	//		if(itemsp)
+	//		{
+	//			itemsp->push_back(item);
+	//		}
+	//		else
+	//		{
+	//			LL_WARNS(LOG_INV) << "Lost and found Not there!!" << LL_ENDL;
+	//		}
+	//	}
+	//}
+	std::vector<LLViewerInventoryItem*> items;
+	items.reserve(mItemMap.size());
+	for (item_map_t::iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
 	{
-		LLPointer<LLViewerInventoryItem> item;
-		for(item_map_t::iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
+		items.push_back(iit->second);
+	}
+
+	typedef std::unordered_map<LLUUID, std::vector<LLViewerInventoryItem*> > item_buckets_t;
+	const size_t BUCKET_GRAIN = 4096;
+	std::vector<item_buckets_t> buckets((items.size() + BUCKET_GRAIN - 1) / BUCKET_GRAIN);
+	LL::parallelFor("General", buckets.size(), 1,
+		[&](size_t begin, size_t end)
 		{
-			item = (*iit).second;
-			items.push_back(item);
+			for (size_t chunk = begin; chunk < end; ++chunk)
+			{
+				item_buckets_t& bucket = buckets[chunk];
+				const size_t last = llmin(items.size(), (chunk + 1) * BUCKET_GRAIN);
+				for (size_t i = chunk * BUCKET_GRAIN; i < last; ++i)
+				{
+					bucket[items[i]->getParentUUID()].push_back(items[i]);
+				}
+			}
+		});
+
+	std::vector<LLViewerInventoryItem*> lost_items;
+	for (item_buckets_t& bucket : buckets)
+	{
+		for (item_buckets_t::value_type& children : bucket)
+		{
+			itemsp = getUnlockedItemArray(children.first);
+			if (itemsp)
+			{
+				itemsp->insert(itemsp->end(), children.second.begin(), children.second.end());
+			}
+			else
+			{
+				lost_items.insert(lost_items.end(), children.second.begin(), children.second.end());
+			}
 		}
 	}
-	count = items.size();
+	// Buckets are unordered: handle the lost items in mItemMap order
+	std::sort(lost_items.begin(), lost_items.end(),
+			  [](const LLViewerInventoryItem* a, const LLViewerInventoryItem* b) { return a->getUUID() < b->getUUID(); });
+
 	lost = 0;
 	uuid_vec_t lost_item_ids;
-	for(i = 0; i < count; ++i)
+	for (LLViewerInventoryItem* item : lost_items)
 	{
-		LLPointer<LLViewerInventoryItem> item;
-		item = items.at(i);
+		LL_INFOS(LOG_INV) << "Lost item: " << item->getUUID() << " - "
+						  << item->getName() << LL_ENDL;
+		++lost;
+		// plop it into the lost & found.
+		//
+		item->setParent(findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
+		// move it later using a special message to move items. If
+		// we update server here, the client might crash.
+		//item->updateServer();
+		lost_item_ids.push_back(item->getUUID());
 		itemsp = getUnlockedItemArray(item->getParentUUID());
 		if(itemsp)
 		{
@@ -3327,27 +3476,10 @@ void LLInventoryModel::buildParentChildMap()
 		}
 		else
 		{
-			LL_INFOS(LOG_INV) << "Lost item: " << item->getUUID() << " - "
-							  << item->getName() << LL_ENDL;
-			++lost;
-			// plop it into the lost & found.
-			//
-			item->setParent(findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
-			// move it later using a special message to move items. If
-			// we update server here, the client might crash.
-			//item->updateServer();
-			lost_item_ids.push_back(item->getUUID());
-			itemsp = getUnlockedItemArray(item->getParentUUID());
-			if(itemsp)
-			{
-				itemsp->push_back(item);
-			}
-			else
-			{
-				LL_WARNS(LOG_INV) << "Lost and found Not there!!" << LL_ENDL;
-			}
+			LL_WARNS(LOG_INV) << "Lost and found Not there!!" << LL_ENDL;
 		}
 	}
+	// </FS:Perf>
 	if(lost)
 	{
 		LL_WARNS(LOG_INV) << "Found " << lost << " lost items." << LL_ENDL;
@@ -4897,26 +5029,62 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 		validation_info->mWarnings["category_map_size"]++;
 		warning_count++;
 	}
-	S32 cat_lock = 0;
-	S32 item_lock = 0;
-	S32 desc_unknown_count = 0;
-	S32 version_unknown_count = 0;
+	// <FS:Perf> Validate on the general thread pool
+	//S32 cat_lock = 0;
+	//S32 item_lock = 0;
+	//S32 desc_unknown_count = 0;
+	//S32 version_unknown_count = 0;
 
 	typedef std::map<LLFolderType::EType, S32> ft_count_map;
-	ft_count_map ft_counts_under_root;
-	ft_count_map ft_counts_elsewhere;
+	//ft_count_map ft_counts_under_root;
+	//ft_count_map ft_counts_elsewhere;
+
+	struct ValidationTally
+	{
+		S32 mWarningCount = 0;
+		S32 mLoopCount = 0;
+		S32 mOrphanedCount = 0;
+		S32 mCatLockCount = 0;
+		S32 mItemLockCount = 0;
+		S32 mDescUnknownCount = 0;
+		S32 mVersionUnknownCount = 0;
+		std::map<std::string, U32> mWarnings;
+		ft_count_map mUnderRoot;
+		ft_count_map mElsewhere;
+
+		void add(const ValidationTally& other)
+		{
+			mWarningCount += other.mWarningCount;
+			mLoopCount += other.mLoopCount;
+			mOrphanedCount += other.mOrphanedCount;
+			mCatLockCount += other.mCatLockCount;
+			mItemLockCount += other.mItemLockCount;
+			mDescUnknownCount += other.mDescUnknownCount;
+			mVersionUnknownCount += other.mVersionUnknownCount;
+			for (const auto& warning : other.mWarnings)
+			{
+				mWarnings[warning.first] += warning.second;
+			}
+			for (const auto& count : other.mUnderRoot)
+			{
+				mUnderRoot[count.first] += count.second;
+			}
+			for (const auto& count : other.mElsewhere)
+			{
+				mElsewhere[count.first] += count.second;
+			}
+		}
+	};
 	
-	// Loop over all categories and check.
-	for(cat_map_t::const_iterator cit = mCategoryMap.begin(); cit != mCategoryMap.end(); ++cit)
+	// Check one category.
+	auto validate_category = [this](const LLUUID& cat_id, const LLViewerInventoryCategory* cat, ValidationTally& tally)
 	{
-		const LLUUID& cat_id = cit->first;
-		const LLViewerInventoryCategory *cat = cit->second;
 		if (!cat)
 		{
 			LL_WARNS("Inventory") << "null cat" << LL_ENDL;
-			validation_info->mWarnings["null_cat"]++;
-			warning_count++;
-			continue;
+			tally.mWarnings["null_cat"]++;
+			tally.mWarningCount++;
+			return;
 		}
 		LLUUID topmost_ancestor_id;
 		// Will leave as null uuid on failure
@@ -4924,25 +5092,25 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
         switch (res)
         {
         case ANCESTOR_MISSING:
-            orphaned_count++;
+            tally.mOrphanedCount++;
             break;
         case ANCESTOR_LOOP:
-            loop_count++;
+            tally.mLoopCount++;
             break;
         case ANCESTOR_OK:
             break;
         default:
             LL_WARNS("Inventory") << "Unknown ancestor error for " << cat_id << LL_ENDL;
-			validation_info->mWarnings["unknown_ancestor_status"]++;
-            warning_count++;
+			tally.mWarnings["unknown_ancestor_status"]++;
+            tally.mWarningCount++;
             break;
         }
 
 		if (cat_id != cat->getUUID())
 		{
 			LL_WARNS("Inventory") << "cat id/index mismatch " << cat_id << " " << cat->getUUID() << LL_ENDL;
-			validation_info->mWarnings["cat_id_index_mismatch"]++;
-			warning_count++;
+			tally.mWarnings["cat_id_index_mismatch"]++;
+			tally.mWarningCount++;
 		}
 
 		if (cat->getParentUUID().isNull())
@@ -4952,8 +5120,8 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 				LL_WARNS("Inventory") << "cat " << cat_id << " has no parent, but is not root ("
 									  << getRootFolderID() << ") or library root ("
 									  << getLibraryRootFolderID() << ")" << LL_ENDL;
-				validation_info->mWarnings["null_parent"]++;
-				warning_count++;
+				tally.mWarnings["null_parent"]++;
+				tally.mWarningCount++;
 			}
 		}
 		// <FS:Beq> FIRE-31674 Suitcase contents do not need checking. 
@@ -4961,7 +5129,7 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 		if (isInSuitcase(cat))
 		{
 			LL_DEBUGS("Inventory") << "cat " << cat->getName() << " skipped because it is a child of Suitcase" << LL_ENDL;
-			continue;
+			return;
 		}
 		#endif
 		// </FS:Beq>
@@ -4971,13 +5139,13 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 		if (!cats || !items)
 		{
 			LL_WARNS("Inventory") << "invalid direct descendents for " << cat_id << LL_ENDL;
-			validation_info->mWarnings["direct_descendents"]++;
-			warning_count++;
-			continue;
+			tally.mWarnings["direct_descendents"]++;
+			tally.mWarningCount++;
+			return;
 		}
 		if (cat->getDescendentCount() == LLViewerInventoryCategory::DESCENDENT_COUNT_UNKNOWN)
 		{
-			desc_unknown_count++;
+			tally.mDescUnknownCount++;
 		}
 		else if (cats->size() + items->size() != cat->getDescendentCount())
 		{
@@ -4990,23 +5158,23 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 									  << " cached " << cat->getDescendentCount()
 									  << " expected " << cats->size() << "+" << items->size()
 									  << "=" << cats->size() +items->size() << LL_ENDL;
-				validation_info->mWarnings["invalid_descendent_count"]++;
-				warning_count++;
+				tally.mWarnings["invalid_descendent_count"]++;
+				tally.mWarningCount++;
 			}
 		}
 		if (cat->getVersion() == LLViewerInventoryCategory::VERSION_UNKNOWN)
 		{
-			version_unknown_count++;
+			tally.mVersionUnknownCount++;
 		}
 		auto cat_lock_it = mCategoryLock.find(cat_id);
 		if (cat_lock_it != mCategoryLock.end() && cat_lock_it->second)
 		{
-			cat_lock++;
+			tally.mCatLockCount++;
 		}
 		auto item_lock_it = mItemLock.find(cat_id);
 		if (item_lock_it != mItemLock.end() && item_lock_it->second)
 		{
-			item_lock++;
+			tally.mItemLockCount++;
 		}
 		for (S32 i = 0; i<items->size(); i++)
 		{
@@ -5015,8 +5183,8 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			if (!item)
 			{
 				LL_WARNS("Inventory") << "null item at index " << i << " for cat " << cat_id << LL_ENDL;
-				validation_info->mWarnings["null_item_at_index"]++;
-				warning_count++;
+				tally.mWarnings["null_item_at_index"]++;
+				tally.mWarningCount++;
 				continue;
 			}
 
@@ -5027,8 +5195,8 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 				LL_WARNS("Inventory") << "wrong parent for " << item_id << " found "
 									  << item->getParentUUID() << " expected " << cat_id
 									  << LL_ENDL;
-				validation_info->mWarnings["wrong_parent_for_item"]++;
-				warning_count++;
+				tally.mWarnings["wrong_parent_for_item"]++;
+				tally.mWarningCount++;
 			}
 
 
@@ -5038,8 +5206,8 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			{
 				LL_WARNS("Inventory") << "item " << item_id << " found as child of "
 									  << cat_id << " but not in top level mItemMap" << LL_ENDL;
-				validation_info->mWarnings["item_not_in_top_map"]++;
-				warning_count++;
+				tally.mWarnings["item_not_in_top_map"]++;
+				tally.mWarningCount++;
 			}
 			else
 			{
@@ -5057,8 +5225,8 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			if (found != ANCESTOR_OK)
 			{
 				LL_WARNS("Inventory") << "unable to find topmost ancestor for " << item_id << LL_ENDL;
-				validation_info->mWarnings["topmost_ancestor_not_found"]++;
-				warning_count++;
+				tally.mWarnings["topmost_ancestor_not_found"]++;
+				tally.mWarningCount++;
 			}
 			else
 			{
@@ -5069,8 +5237,8 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 										  << " got " << topmost_ancestor_id
 										  << " expected " << getRootFolderID()
 										  << " or " << getLibraryRootFolderID() << LL_ENDL;
-					validation_info->mWarnings["topmost_ancestor_not_recognized"]++;
-					warning_count++;
+					tally.mWarnings["topmost_ancestor_not_recognized"]++;
+					tally.mWarningCount++;
 				}
 			}
 		}
@@ -5086,7 +5254,7 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			{
 				LL_WARNS("Inventory") << "cat " << cat_id << " name [" << cat->getName()
 									  << "] orphaned - no child cat array for alleged parent " << parent_id << LL_ENDL;
-                orphaned_count++;
+                tally.mOrphanedCount++;
 			}
 			else
 			{
@@ -5104,7 +5272,7 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 				{
 					LL_WARNS("Inventory") << "cat " << cat_id << " name [" << cat->getName()
 										  << "] orphaned - not found in child cat array of alleged parent " << parent_id << LL_ENDL;
-                    orphaned_count++;
+                    tally.mOrphanedCount++;
 				}
 			}
 		}
@@ -5130,7 +5298,7 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			// </FS:Beq>
 			if (getRootFolderID().notNull() && (cat->getUUID()==getRootFolderID() || cat->getParentUUID()==getRootFolderID()))
 			{
-				ft_counts_under_root[folder_type]++;
+				tally.mUnderRoot[folder_type]++;
 				if (folder_type != LLFolderType::FT_NONE)
 				{
 					LL_DEBUGS("Inventory") << "Under root cat: " << getFullPath(cat) << " folder_type " << folder_type << LL_ENDL;
@@ -5138,32 +5306,30 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			}
 			else
 			{
-				ft_counts_elsewhere[folder_type]++;
+				tally.mElsewhere[folder_type]++;
 				if (folder_type != LLFolderType::FT_NONE)
 				{
 					LL_DEBUGS("Inventory") << "Elsewhere cat: " << getFullPath(cat) << " folder_type " << folder_type << LL_ENDL;
 				}
 			}
 		}
-	}
+	};
 
-	// Loop over all items and check
-	for(item_map_t::const_iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
+	// Check one item.
+	auto validate_item = [this](const LLUUID& item_id, const LLViewerInventoryItem* item, ValidationTally& tally)
 	{
-		const LLUUID& item_id = iit->first;
-		LLViewerInventoryItem *item = iit->second;
 		if (item->getUUID() != item_id)
 		{
 			LL_WARNS("Inventory") << "item_id " << item_id << " does not match " << item->getUUID() << LL_ENDL;
-			validation_info->mWarnings["item_id_mismatch"]++;
-			warning_count++;
+			tally.mWarnings["item_id_mismatch"]++;
+			tally.mWarningCount++;
 		}
 
 		const LLUUID& parent_id = item->getParentUUID();
 		if (parent_id.isNull())
 		{
 			LL_WARNS("Inventory") << "item " << item_id << " name [" << item->getName() << "] has null parent id!" << LL_ENDL;
-            orphaned_count++;
+            tally.mOrphanedCount++;
 		}
 		else
 		{
@@ -5174,7 +5340,7 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 			{
 				LL_WARNS("Inventory") << "item " << item_id << " name [" << item->getName()
 									  << "] orphaned - alleged parent has no child items list " << parent_id << LL_ENDL;
-                orphaned_count++;
+                tally.mOrphanedCount++;
 			}
 			else
 			{
@@ -5191,7 +5357,7 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 				{
 					LL_WARNS("Inventory") << "item " << item_id << " name [" << item->getName()
 										  << "] orphaned - not found as child of alleged parent " << parent_id << LL_ENDL;
-                    orphaned_count++;
+                    tally.mOrphanedCount++;
 				}
 			}
 				
@@ -5210,18 +5376,18 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 				LL_WARNS("Inventory") << "link " << item->getUUID() << " type " << item->getActualType()
 									  << " missing backlink info at target_id " << target_id
 									  << LL_ENDL;
-                orphaned_count++;
+                tally.mOrphanedCount++;
 			}
 			// Links should have referents.
 			if (item->getActualType() == LLAssetType::AT_LINK && !target_item)
 			{
 				LL_WARNS("Inventory") << "broken item link " << item->getName() << " id " << item->getUUID() << LL_ENDL;
-                orphaned_count++;
+                tally.mOrphanedCount++;
 			}
 			else if (item->getActualType() == LLAssetType::AT_LINK_FOLDER && !target_cat)
 			{
 				LL_WARNS("Inventory") << "broken folder link " << item->getName() << " id " << item->getUUID() << LL_ENDL;
-                orphaned_count++;
+                tally.mOrphanedCount++;
 			}
 			if (target_item && target_item->getIsLinkType())
 			{
@@ -5251,7 +5417,66 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
 				}
 			}
 		}
+	};
+
+	// Categories and items are checked in slices on the general pool, each
+	// slice counting into a tally of its own. Nothing changes the model
+	// meanwhile: this thread runs a slice too, then waits for the others.
+	typedef std::pair<LLUUID, const LLViewerInventoryCategory*> cat_entry_t;
+	typedef std::pair<LLUUID, const LLViewerInventoryItem*> item_entry_t;
+	std::vector<cat_entry_t> cat_entries;
+	std::vector<item_entry_t> item_entries;
+	cat_entries.reserve(mCategoryMap.size());
+	item_entries.reserve(mItemMap.size());
+	for (cat_map_t::const_iterator cit = mCategoryMap.begin(); cit != mCategoryMap.end(); ++cit)
+	{
+		cat_entries.emplace_back(cit->first, cit->second.get());
 	}
+	for (item_map_t::const_iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
+	{
+		item_entries.emplace_back(iit->first, iit->second.get());
+	}
+
+	const size_t VALIDATE_GRAIN = 1024;
+	ValidationTally total;
+	std::mutex total_mutex;
+	LL::parallelFor("General", cat_entries.size(), VALIDATE_GRAIN,
+		[&](size_t begin, size_t end)
+		{
+			ValidationTally tally;
+			for (size_t i = begin; i < end; ++i)
+			{
+				validate_category(cat_entries[i].first, cat_entries[i].second, tally);
+			}
+			std::lock_guard<std::mutex> lock(total_mutex);
+			total.add(tally);
+		});
+	LL::parallelFor("General", item_entries.size(), VALIDATE_GRAIN,
+		[&](size_t begin, size_t end)
+		{
+			ValidationTally tally;
+			for (size_t i = begin; i < end; ++i)
+			{
+				validate_item(item_entries[i].first, item_entries[i].second, tally);
+			}
+			std::lock_guard<std::mutex> lock(total_mutex);
+			total.add(tally);
+		});
+
+	warning_count += total.mWarningCount;
+	loop_count += total.mLoopCount;
+	orphaned_count += total.mOrphanedCount;
+	for (const auto& warning : total.mWarnings)
+	{
+		validation_info->mWarnings[warning.first] += warning.second;
+	}
+	const S32 cat_lock = total.mCatLockCount;
+	const S32 item_lock = total.mItemLockCount;
+	const S32 desc_unknown_count = total.mDescUnknownCount;
+	const S32 version_unknown_count = total.mVersionUnknownCount;
+	ft_count_map& ft_counts_under_root = total.mUnderRoot;
+	ft_count_map& ft_counts_elsewhere = total.mElsewhere;
+	// </FS:Perf>
 
 	// Check system folders
 	for (auto fit=ft_counts_under_root.begin(); fit != ft_counts_under_root.end(); ++fit)
@@ -57,6 +57,7 @@ class LLInventoryItem;
 class LLInventoryCategory;
 class LLMessageSystem;
 class LLInventoryCollectFunctor;
+class LLInventoryBinaryCache; // <FS:Perf/> Binary inventory cache
 
 ///----------------------------------------------------------------------------
 /// LLInventoryValidationInfo 
@@ -204,6 +205,9 @@ public:
 	void createCommonSystemCategories();
 
 	static std::string getInvCacheAddres(const LLUUID& owner_id);
+	// <FS:Perf> Binary inventory cache
+	static std::string getInvBinaryCacheAddres(const LLUUID& owner_id);
+	// </FS:Perf>
 
 	// Call on logout to save a terse representation.
 	void cache(const LLUUID& parent_folder_id, const LLUUID& agent_id);
@@ -718,6 +722,12 @@ public:
 	//--------------------------------------------------------------------
 	// File I/O
 	//--------------------------------------------------------------------
+	// <FS:Perf> Binary inventory cache
+private:
+	LLInventoryBinaryCache& getBinaryCache(const LLUUID& owner_id);
+	// Kept between load and save, so that saving only logs the changes
+	std::map<LLUUID, std::shared_ptr<LLInventoryBinaryCache> > mBinaryCaches;
+	// </FS:Perf>
 protected:
 	static bool loadFromFile(const std::string& filename,
 							 cat_array_t& categories,
@@ -44,6 +44,8 @@
 #include "bufferarray.h"
 #include "bufferstream.h"
 #include "llcorehttputil.h"
+#include "llsdserialize.h" // <FS:Perf/> LLSDStreamVisitor
+#include "llinventoryapplyqueue.h" // <FS:Perf/> Decode replies off the main thread
 #include "llviewermenu.h"
 #include "llviewernetwork.h"
 
@@ -136,6 +138,18 @@ protected:
 /// Class <anonymous>::BGFolderHttpHandler
 ///----------------------------------------------------------------------------
 
+// <FS:Perf> One folder of a reply, its categories and items already
+// turned into inventory objects on the general thread pool.
+struct BGFetchedFolder
+{
+	LLUUID mFolderID;
+	S32 mVersion = 0;
+	S32 mDescendents = 0;
+	std::vector<LLPointer<LLViewerInventoryCategory> > mCategories;
+	std::vector<LLPointer<LLViewerInventoryItem> > mItems;
+};
+// </FS:Perf>
+
 // Http request handler class for folders.
 //
 // Handler for FetchInventoryDescendents2 and FetchLibDescendents2
@@ -170,6 +184,14 @@ public:
 
 private:
 	void processData(LLSD & body, LLCore::HttpResponse * response);
+	// <FS:Perf> Streaming XML parse: one entry of the "folders" array
+	void processFolder(const LLSD & folder_sd);
+	// Decode on the general thread pool, apply on the main thread
+	LLInventoryApplyQueue::steps_t decodeResponse(LLCore::HttpResponse * response);
+	static BGFetchedFolder decodeFolder(const LLSD & folder_sd);
+	void applyFolder(const BGFetchedFolder & folder);
+	friend class BGFolderStreamVisitor;
+	// </FS:Perf>
 	void processFailure(LLCore::HttpStatus status, LLCore::HttpResponse * response);
 	void processFailure(const char * const reason, LLCore::HttpResponse * response);
 
@@ -178,6 +200,31 @@ private:
 	const uuid_vec_t mRecursiveCatUUIDs; // hack for storing away which cat fetches are recursive
 };
 
+// <FS:Perf> Decode each entry of the response's "folders" array as soon
+// as the XML parser has finished it, so large descendent fetches never
+// hold the whole reply in memory.
+class BGFolderStreamVisitor : public LLSDStreamVisitor
+{
+public:
+	BGFolderStreamVisitor(std::vector<BGFetchedFolder> & folders)
+		: mFolders(folders)
+		{}
+
+	bool wantElements(const LLSD & array_path) override
+		{
+			return array_path.size() == 1 && array_path[0].asString() == "folders";
+		}
+
+	void visitElement(const LLSD & element_path, const LLSD & element) override
+		{
+			mFolders.push_back(BGFolderHttpHandler::decodeFolder(element));
+		}
+
+private:
+	std::vector<BGFetchedFolder> & mFolders;
+};
+// </FS:Perf>
+
 
 const S32 MAX_FETCH_RETRIES = 10; // <FS:ND/> For legacy inventory
 
@@ -1410,44 +1457,119 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
 			break;			// Goto common exit
 		}
 
-		// Could test 'Content-Type' header but probably unreliable.
+		// <FS:Perf> Parse the reply and build its inventory objects on the
+		// general thread pool, leaving only the updates of the model for
+		// the main thread. Those are done by a second handler for the same
+		// request, which counts as a fetch in flight until it is finished.
+		//// Could test 'Content-Type' header but probably unreliable.
+
+		//// Convert response to LLSD
+		//// body->write(0, "Garbage Response", 16);		// Dev tool to force error handling
+		//LLSD body_llsd;
+		//if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd))
+		//{
+		//	// INFOS-level logging will occur on the parsed failure
+		//	processFailure("HTTP response contained malformed LLSD", response);
+		//	break;			// goto common exit
+		//}
+
+		//// Expect top-level structure to be a map
+		//// body_llsd = LLSD::emptyArray();				// Dev tool to force error handling
+		//if (! body_llsd.isMap())
+		//{
+		//	processFailure("LLSD response not a map", response);
+		//	break;			// goto common exit
+		//}
+
+		//// Check for 200-with-error failures
+		////
+		//// See comments in llinventorymodel.cpp about this mode of error.
+		////
+		//// body_llsd["error"] = LLSD::emptyMap();		// Dev tool to force error handling
+		//// body_llsd["error"]["identifier"] = "Development";
+		//// body_llsd["error"]["message"] = "You left development code in the viewer";
+		//if (body_llsd.has("error"))
+		//{
+		//	processFailure("Inventory application error (200-with-error)", response);
+		//	break;			// goto common exit
+		//}
+
+		//// Okay, process data if possible
+		//processData(body_llsd, response);
+		std::shared_ptr<BGFolderHttpHandler> applier = std::make_shared<BGFolderHttpHandler>(mRequestSD, mRecursiveCatUUIDs);
+		BGFolderHttpHandler * applier_ptr(applier.get());
+		response->addRef();		// Released by the last step
+		LLInventoryApplyQueue::instance().post([applier_ptr, response]()
+			{
+				return applier_ptr->decodeResponse(response);
+			},
+			applier);
+		// </FS:Perf>
+	}
+	while (false);
+}
 
-		// Convert response to LLSD
-		// body->write(0, "Garbage Response", 16);		// Dev tool to force error handling
-		LLSD body_llsd;
-		if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd))
-		{
-			// INFOS-level logging will occur on the parsed failure
-			processFailure("HTTP response contained malformed LLSD", response);
-			break;			// goto common exit
-		}
 
-		// Expect top-level structure to be a map
-		// body_llsd = LLSD::emptyArray();				// Dev tool to force error handling
-		if (! body_llsd.isMap())
-		{
-			processFailure("LLSD response not a map", response);
-			break;			// goto common exit
-		}
+// <FS:Perf> Runs on the general thread pool. Nothing here touches the
+// inventory model, the steps returned do that on the main thread.
+LLInventoryApplyQueue::steps_t BGFolderHttpHandler::decodeResponse(LLCore::HttpResponse * response)
+{
+	LLInventoryApplyQueue::steps_t steps;
+	const char * failure(NULL);
+
+	// Could test 'Content-Type' header but probably unreliable.
+
+	// Convert response to LLSD. Folders are decoded as they are parsed,
+	// and applied before anything that could fail below, which only
+	// matters for partial replies: the update of a folder stands on its
+	// own, and failing folders get retried anyway.
+	LLSD body_llsd;
+	std::vector<BGFetchedFolder> folders;
+	BGFolderStreamVisitor visitor(folders);
+	if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd, visitor))
+	{
+		// INFOS-level logging will occur on the parsed failure
+		failure = "HTTP response contained malformed LLSD";
+	}
+	// Expect top-level structure to be a map
+	else if (! body_llsd.isMap())
+	{
+		failure = "LLSD response not a map";
+	}
+	// Check for 200-with-error failures
+	//
+	// See comments in llinventorymodel.cpp about this mode of error.
+	else if (body_llsd.has("error"))
+	{
+		failure = "Inventory application error (200-with-error)";
+	}
 
-		// Check for 200-with-error failures
-		//
-		// See comments in llinventorymodel.cpp about this mode of error.
-		//
-		// body_llsd["error"] = LLSD::emptyMap();		// Dev tool to force error handling
-		// body_llsd["error"]["identifier"] = "Development";
-		// body_llsd["error"]["message"] = "You left development code in the viewer";
-		if (body_llsd.has("error"))
+	steps.reserve(folders.size() + 1);
+	for (BGFetchedFolder & folder : folders)
+	{
+		steps.push_back([this, folder = std::move(folder)]()
+			{
+				applyFolder(folder);
+			});
+	}
+
+	steps.push_back([this, response, failure, content = std::move(body_llsd)]() mutable
 		{
-			processFailure("Inventory application error (200-with-error)", response);
-			break;			// goto common exit
-		}
+			if (failure)
+			{
+				processFailure(failure, response);
+			}
+			else
+			{
+				// Okay, process data if possible
+				processData(content, response);
+			}
+			response->release();
+		});
 
-		// Okay, process data if possible
-		processData(body_llsd, response);
-	}
-	while (false);
+	return steps;
 }
+// </FS:Perf>
 
 
 void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * response)
@@ -1466,103 +1588,11 @@ void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * res
 			folder_it != folders.endArray();
 			++folder_it)
 		{	
-			LLSD folder_sd(*folder_it);
-
-			//LLUUID agent_id = folder_sd["agent_id"];
-
-			//if(agent_id != gAgent.getID())	//This should never happen.
-			//{
-			//	LL_WARNS(LOG_INV) << "Got a UpdateInventoryItem for the wrong agent."
-			//			<< LL_ENDL;
-			//	break;
-			//}
-
-			LLUUID parent_id(folder_sd["folder_id"].asUUID());
-			LLUUID owner_id(folder_sd["owner_id"].asUUID());
-			S32    version(folder_sd["version"].asInteger());
-			S32    descendents(folder_sd["descendents"].asInteger());
-			LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(owner_id);
-
-            if (parent_id.isNull())
-            {
-				LLSD items(folder_sd["items"]);
-			    LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
-				
-			    for (LLSD::array_const_iterator item_it = items.beginArray();
-				    item_it != items.endArray();
-				    ++item_it)
-			    {	
-                    const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
-
-                    if (lost_uuid.notNull())
-                    {
-				        LLSD item(*item_it);
-
-				        titem->unpackMessage(item);
-				
-                        LLInventoryModel::update_list_t update;
-                        LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
-                        update.push_back(new_folder);
-                        gInventory.accountForUpdate(update);
-
-                        titem->setParent(lost_uuid);
-                        titem->updateParentOnServer(FALSE);
-                        gInventory.updateItem(titem);
-                        // <FS:Ansariel> FIRE-21376: Inventory not loading properly on OpenSim
-                        if (!LLGridManager::getInstance()->isInSecondLife())
-                        {
-                            gInventory.notifyObservers();
-                        }
-                        // </FS:Ansariel>
-                    }
-                }
-            }
-
-	        LLViewerInventoryCategory * pcat(gInventory.getCategory(parent_id));
-			if (! pcat)
-			{
-				continue;
-			}
-
-			LLSD categories(folder_sd["categories"]);
-			for (LLSD::array_const_iterator category_it = categories.beginArray();
-				category_it != categories.endArray();
-				++category_it)
-			{	
-				LLSD category(*category_it);
-				tcategory->fromLLSD(category); 
-				
-				const bool recursive(getIsRecursive(tcategory->getUUID()));
-				if (recursive)
-				{
-					fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
-				}
-				else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
-				{
-					gInventory.updateCategory(tcategory);
-				}
-			}
-
-			LLSD items(folder_sd["items"]);
-			LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
-			for (LLSD::array_const_iterator item_it = items.beginArray();
-				 item_it != items.endArray();
-				 ++item_it)
-			{	
-				LLSD item(*item_it);
-				titem->unpackMessage(item);
-				
-				gInventory.updateItem(titem);
-			}
-
-			// Set version and descendentcount according to message.
-			LLViewerInventoryCategory * cat(gInventory.getCategory(parent_id));
-			if (cat)
-			{
-				cat->setVersion(version);
-				cat->setDescendentCount(descendents);
-				cat->determineFolderType();
-			}
+			// <FS:Perf> Streaming XML parse: the folders usually got
+			// handled by processFolder() while the reply was parsed, this
+			// is only for replies that came in some other way
+			processFolder(*folder_it);
+			// </FS:Perf>
 		}
 	}
 		
@@ -1596,6 +1626,125 @@ void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * res
 }
 
 
+// <FS:Perf> Streaming XML parse
+void BGFolderHttpHandler::processFolder(const LLSD & folder_sd)
+{
+	applyFolder(decodeFolder(folder_sd));
+}
+
+
+// static
+BGFetchedFolder BGFolderHttpHandler::decodeFolder(const LLSD & folder_sd)
+{
+	//LLUUID agent_id = folder_sd["agent_id"];
+
+	//if(agent_id != gAgent.getID())	//This should never happen.
+	//{
+	//	LL_WARNS(LOG_INV) << "Got a UpdateInventoryItem for the wrong agent."
+	//			<< LL_ENDL;
+	//	break;
+	//}
+
+	BGFetchedFolder folder;
+	folder.mFolderID = folder_sd["folder_id"].asUUID();
+	folder.mVersion = folder_sd["version"].asInteger();
+	folder.mDescendents = folder_sd["descendents"].asInteger();
+	const LLUUID owner_id(folder_sd["owner_id"].asUUID());
+
+	const LLSD & categories(folder_sd["categories"]);
+	folder.mCategories.reserve(categories.size());
+	for (LLSD::array_const_iterator category_it = categories.beginArray();
+		category_it != categories.endArray();
+		++category_it)
+	{
+		LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(owner_id);
+		tcategory->fromLLSD(*category_it);
+		folder.mCategories.push_back(tcategory);
+	}
+
+	const LLSD & items(folder_sd["items"]);
+	folder.mItems.reserve(items.size());
+	for (LLSD::array_const_iterator item_it = items.beginArray();
+		 item_it != items.endArray();
+		 ++item_it)
+	{
+		LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+		titem->unpackMessage(*item_it);
+		folder.mItems.push_back(titem);
+	}
+
+	return folder;
+}
+
+
+void BGFolderHttpHandler::applyFolder(const BGFetchedFolder & folder)
+{
+	LLInventoryModelBackgroundFetch * fetcher(LLInventoryModelBackgroundFetch::getInstance());
+
+	const LLUUID & parent_id(folder.mFolderID);
+
+	if (parent_id.isNull())
+	{
+		for (LLPointer<LLViewerInventoryItem> titem : folder.mItems)
+		{
+			const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
+
+			if (lost_uuid.notNull())
+			{
+				LLInventoryModel::update_list_t update;
+				LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
+				update.push_back(new_folder);
+				gInventory.accountForUpdate(update);
+
+				titem->setParent(lost_uuid);
+				titem->updateParentOnServer(FALSE);
+				gInventory.updateItem(titem);
+				// <FS:Ansariel> FIRE-21376: Inventory not loading properly on OpenSim
+				if (!LLGridManager::getInstance()->isInSecondLife())
+				{
+					gInventory.notifyObservers();
+				}
+				// </FS:Ansariel>
+			}
+		}
+	}
+
+	LLViewerInventoryCategory * pcat(gInventory.getCategory(parent_id));
+	if (! pcat)
+	{
+		return;
+	}
+
+	for (const LLPointer<LLViewerInventoryCategory> & tcategory : folder.mCategories)
+	{
+		const bool recursive(getIsRecursive(tcategory->getUUID()));
+		if (recursive)
+		{
+			fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
+		}
+		else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
+		{
+			gInventory.updateCategory(tcategory);
+		}
+	}
+
+	for (const LLPointer<LLViewerInventoryItem> & titem : folder.mItems)
+	{
+		gInventory.updateItem(titem);
+	}
+
+	// Set version and descendentcount according to message.
+	LLViewerInventoryCategory * cat(gInventory.getCategory(parent_id));
+	if (cat)
+	{
+		cat->setVersion(folder.mVersion);
+		cat->setDescendentCount(folder.mDescendents);
+		cat->determineFolderType();
+	}
+}
+// </FS:Perf>
+
+
 void BGFolderHttpHandler::processFailure(LLCore::HttpStatus status, LLCore::HttpResponse * response)
 {
 	const std::string & ct(response->getContentType());
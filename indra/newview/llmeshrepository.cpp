@@ -871,6 +871,10 @@ LLMeshRepoThread::LLMeshRepoThread()
 	mHttpLargeOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpLargeOptions->setTransferTimeout(LARGE_MESH_XFER_TIMEOUT);
 	mHttpLargeOptions->setUseRetryAfter(gSavedSettings.getBOOL("MeshUseHttpRetryAfter"));
+	// <FS:Perf> Zero-copy access: receive mesh data in one piece
+	mHttpOptions->setContiguousBody(true);
+	mHttpLargeOptions->setContiguousBody(true);
+	// </FS:Perf>
 	mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
 	mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_VND_LL_MESH);
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH2);
@@ -1976,9 +1980,13 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
 		data_size = dsize;
 
-		boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
-
-		if (!LLSDSerialize::fromBinary(header_data, stream, data_size))
+		// <FS:Perf> Parse straight out of the buffer
+		//boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
+		//
+		//if (!LLSDSerialize::fromBinary(header_data, stream, data_size))
+		size_t header_bytes = 0;
+		if (!LLSDSerialize::fromBinary(header_data, (const U8*)result_ptr, data_size, -1, &header_bytes))
+		// </FS:Perf>
 		{
 			LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
 							   << LL_ENDL;
@@ -2001,7 +2009,10 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 		// make sure there is at least one lod, function returns -1 and marks as 404 otherwise
 		else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
 		{
-			header_size += stream.tellg();
+			// <FS:Perf> Parse straight out of the buffer
+			//header_size += stream.tellg();
+			header_size += (llssize)header_bytes;
+			// </FS:Perf>
 		}
 	}
 	else
@@ -3240,6 +3251,17 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 			// handler, optional first that takes a body, fallback second
 			// that requires a temporary allocation and data copy.
 			body_offset = mOffset - offset;
+			// <FS:Perf> Zero-copy access.  Bodies received in one piece
+			// are handed over as they are, processData() doesn't keep
+			// the pointer.
+			data = (U8 *) body->getContiguous(body_offset, data_size - body_offset);
+			if (data)
+			{
+				LLMeshRepository::sBytesReceived += data_size;
+				processData(body, body_offset, data, data_size - body_offset);
+				goto common_exit;
+			}
+			// </FS:Perf>
 			data = new(std::nothrow) U8[data_size - body_offset];
 			if (data)
 			{
@@ -4243,7 +4265,10 @@ void LLMeshRepository::notifyMeshLoaded(const LLVolumeParams& mesh_params, LLVol
 			LLVolume* sys_volume = LLPrimitive::getVolumeManager()->refVolume(mesh_params, detail);
 			if (sys_volume)
 			{
-				sys_volume->copyVolumeFaces(volume);
+				// <FS:Perf> The loaded volume is dropped after this, take its faces instead of copying them
+				//sys_volume->copyVolumeFaces(volume);
+				sys_volume->moveVolumeFaces(volume);
+				// </FS:Perf>
 				sys_volume->setMeshAssetLoaded(true);
 				LLPrimitive::getVolumeManager()->unrefVolume(sys_volume);
 			}
@@ -112,6 +112,7 @@ namespace LLPerfStats
         RENDER_FPSLIMIT,// <FS:Beq/> restore this for FS
         RENDER_FPS,
         RENDER_IDLE,
+        RENDER_ANIMATION, // <FS:Perf/> Motion evaluation; per avatar for OT_AVATAR, wall clock for OT_GENERAL
         RENDER_DONE, // toggle buffer & clearbuffer (see processUpdate for hackery)
         STATS_COUNT
     };
@@ -295,9 +296,21 @@ namespace LLPerfStats
                 doUpd(key, ot, type,val);
                 return;
             }
+
+            // <FS:Perf> Per avatar animation time. Kept out of RENDER_COMBINED, which
+            // FSFloaterPerformance reads as avatar render time.
+            if (ot == ObjType_t::OT_AVATAR && type == StatType_t::RENDER_ANIMATION)
+            {
+                doUpd(upd.avID, ot, type, val, false);
+                return;
+            }
+            // </FS:Perf>
         }
 
-        static inline void doUpd(const LLUUID& key, ObjType_t ot, StatType_t type, uint64_t val)
+        // <FS:Perf> Per avatar animation time
+        //static inline void doUpd(const LLUUID& key, ObjType_t ot, StatType_t type, uint64_t val)
+        static inline void doUpd(const LLUUID& key, ObjType_t ot, StatType_t type, uint64_t val, bool combined = true)
+        // </FS:Perf>
         {
             LL_PROFILE_ZONE_SCOPED_CATEGORY_STATS;
             using ST = StatType_t;
@@ -305,10 +318,22 @@ namespace LLPerfStats
             auto& thisAsset = stm[key];
 
             thisAsset[static_cast<size_t>(type)] += val;
-            thisAsset[static_cast<size_t>(ST::RENDER_COMBINED)] += val;
+            // <FS:Perf> Per avatar animation time
+            //thisAsset[static_cast<size_t>(ST::RENDER_COMBINED)] += val;
+            if (combined)
+            {
+                thisAsset[static_cast<size_t>(ST::RENDER_COMBINED)] += val;
+            }
+            // </FS:Perf>
 
             sum[writeBuffer][static_cast<size_t>(ot)][static_cast<size_t>(type)] += val;
-            sum[writeBuffer][static_cast<size_t>(ot)][static_cast<size_t>(ST::RENDER_COMBINED)] += val;
+            // <FS:Perf> Per avatar animation time
+            //sum[writeBuffer][static_cast<size_t>(ot)][static_cast<size_t>(ST::RENDER_COMBINED)] += val;
+            if (combined)
+            {
+                sum[writeBuffer][static_cast<size_t>(ot)][static_cast<size_t>(ST::RENDER_COMBINED)] += val;
+            }
+            // </FS:Perf>
 
             if(max[writeBuffer][static_cast<size_t>(ot)][static_cast<size_t>(type)] < thisAsset[static_cast<size_t>(type)])
             {
@@ -454,6 +479,7 @@ namespace LLPerfStats
     
 
     using RecordSceneTime = RecordTime<ObjType_t::OT_GENERAL>;
+    using RecordAvatarTime = RecordTime<ObjType_t::OT_AVATAR>; // <FS:Perf/> Per avatar animation time
 
 };// namespace LLPerfStats
 
@@ -151,7 +151,10 @@ protected:
 				const controller_map_t::const_iterator& entry = mParamControllers.find(controller_key[param]);
                 if (entry == mParamControllers.end())
                 {
-                        return sDefaultController[controller_key[param]];
+                        // <FS:Perf> Parallel motion evaluation: operator[] would insert into the shared map
+                        //return sDefaultController[controller_key[param]];
+                        return getDefaultParamValue(controller_key[param]);
+                        // </FS:Perf>
                 }
                 const std::string& param_name = (*entry).second.c_str();
                 mParamCache[param] = mCharacter->getVisualParam(param_name.c_str());
@@ -163,10 +166,21 @@ protected:
 			}
 			else
 			{
-				return sDefaultController[controller_key[param]];
+				// <FS:Perf> Parallel motion evaluation
+				//return sDefaultController[controller_key[param]];
+				return getDefaultParamValue(controller_key[param]);
+				// </FS:Perf>
 			}
 		}
 
+		// <FS:Perf> Parallel motion evaluation
+		static F32 getDefaultParamValue(const std::string& key)
+		{
+			default_controller_map_t::const_iterator it = sDefaultController.find(key);
+			return (it != sDefaultController.end()) ? it->second : 0.f;
+		}
+		// </FS:Perf>
+
         
         void setParamValue(const LLViewerVisualParam *param,
                            const F32 new_value_local,
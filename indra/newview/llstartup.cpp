@@ -3510,6 +3510,7 @@ void register_viewer_callbacks(LLMessageSystem* msg)
 	msg->setHandlerFunc("ObjectUpdateCompressed",				process_compressed_object_update );
 	msg->setHandlerFunc("ObjectUpdateCached",					process_cached_object_update );
 	msg->setHandlerFuncFast(_PREHASH_ImprovedTerseObjectUpdate, process_terse_object_update_improved );
+	LLViewerObjectList::compileMessageFields(msg); // <FS:Perf/> Compiled field access
 	msg->setHandlerFunc("SimStats",				process_sim_stats);
 	msg->setHandlerFuncFast(_PREHASH_HealthMessage,			process_health_message );
 	msg->setHandlerFuncFast(_PREHASH_EconomyData,				process_economy_data);
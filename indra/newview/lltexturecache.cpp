@@ -56,6 +56,8 @@ const S32 TEXTURE_FAST_CACHE_DATA_SIZE = 16 * 16 * 4;
 const S32 TEXTURE_FAST_CACHE_ENTRY_SIZE = TEXTURE_FAST_CACHE_DATA_SIZE + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
 const F32 TEXTURE_LAZY_PURGE_TIME_LIMIT = .004f; // 4ms. Would be better to autoadjust, but there is a major cache rework in progress.
 const F32 TEXTURE_PRUNING_MAX_TIME = 15.f;
+const U32 TEXTURE_HEADER_WRITE_BACK_INTERVAL = 5; // <FS:Perf/> seconds between batched writes of changed header entries
+const S32 TEXTURE_FAST_CACHE_GROWTH_ENTRIES = 16 * 1024; // <FS:Perf/> slots the fast cache file grows by (~16 MB)
 
 class LLTextureCacheWorker : public LLWorkerClass
 {
@@ -799,9 +801,24 @@ LLTextureCache::LLTextureCache(bool threaded)
 	  mReadOnly(TRUE), //do not allow to change the texture cache until setReadOnly() is called.
 	  mTexturesSizeTotal(0),
 	  mDoPurge(FALSE),
-	  mFastCachep(NULL),
-	  mFastCachePoolp(NULL),
-	  mFastCachePadBuffer(NULL)
+	  // <FS:Perf> Memory-mapped fast cache
+	  //mFastCachep(NULL),
+	  //mFastCachePoolp(NULL),
+	  //mFastCachePadBuffer(NULL),
+	  // </FS:Perf>
+	  // <FS:Perf> Lock-sharded header index
+	  mNextLRUShard(0),
+	  mHeaderEntriesLoaded(false),
+	  mHeaderEntriesOnDisk(0),
+	  mHeaderEntryCount(0),
+	  mHeaderWriteTime((U32)time(NULL)),
+	  mHeaderLockWaitUsec(0),
+	  mHeaderLockContentions(0),
+	  mHeaderLookups(0),
+	  mHeaderEntriesRead(0),
+	  mHeaderEntriesWritten(0),
+	  mHeaderWriteBatches(0)
+	  // </FS:Perf>
 {
     mHeaderAPRFilePoolp = new LLVolatileAPRPool(); // is_local = true, because this pool is for headers, headers are under own mutex
 }
@@ -810,10 +827,25 @@ LLTextureCache::~LLTextureCache()
 {
 	clearDeleteList() ;
 	writeUpdatedEntries() ;
-	delete mFastCachep;
-	delete mFastCachePoolp;
+
+	// <FS:Perf> Header index counters
+	HeaderStats stats;
+	getHeaderStats(stats);
+	LL_INFOS("TextureCache") << "Header index: " << stats.mLookups << " lookups, "
+		<< stats.mLockContentions << " lock contentions, "
+		<< stats.mLockWaitUsec / 1000 << " ms waiting for locks, "
+		<< stats.mEntriesRead << " entries read, "
+		<< stats.mEntriesWritten << " entries written in "
+		<< stats.mWriteBatches << " batches" << LL_ENDL;
+	// </FS:Perf>
+
+	// <FS:Perf> Memory-mapped fast cache
+	//delete mFastCachep;
+	//delete mFastCachePoolp;
+	closeFastCache();
+	// </FS:Perf>
 	delete mHeaderAPRFilePoolp;
-	ll_aligned_free_16(mFastCachePadBuffer);
+	//ll_aligned_free_16(mFastCachePadBuffer); // <FS:Perf/>
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -875,10 +907,15 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
 //debug
 BOOL LLTextureCache::isInCache(const LLUUID& id) 
 {
-	LLMutexLock lock(&mHeaderMutex);
-	id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-	
-	return (iter != mHeaderIDMap.end()) ;
+	// <FS:Perf> Lock-sharded header index
+	//LLMutexLock lock(&mHeaderMutex);
+	//id_map_t::const_iterator iter = mHeaderIDMap.find(id);
+	//
+	//return (iter != mHeaderIDMap.end()) ;
+	HeaderShard& shard = getHeaderShard(id);
+	LLMutexLock lock(&shard.mMutex);
+	return (shard.mIDMap.find(id) != shard.mIDMap.end());
+	// </FS:Perf>
 }
 
 //debug
@@ -1041,7 +1078,10 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, BOOL texture_cache
 	purgeTextures(true); // calc mTexturesSize and make some room in the texture cache if we need it
 
 	llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
-	openFastCache(true);
+	// <FS:Perf> Memory-mapped fast cache
+	//openFastCache(true);
+	openFastCache();
+	// </FS:Perf>
 
 	return max_size; // unused cache space
 }
@@ -1080,6 +1120,10 @@ void LLTextureCache::readEntriesHeader()
 	{
 		LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
 						  mHeaderAPRFilePoolp);
+		// <FS:Perf> Lock-sharded header index
+		mHeaderEntriesOnDisk = mHeaderEntriesInfo.mEntries;
+		mHeaderEntryCount = mHeaderEntriesInfo.mEntries;
+		// </FS:Perf>
 	}
 	else //create an empty entries header.
 	{
@@ -1103,6 +1147,7 @@ void LLTextureCache::setEntriesHeader()
 	mHeaderEntriesInfo.mAdressSize = sHeaderCacheAddressSize;
 	strcpy(mHeaderEntriesInfo.mEncoderVersion, sHeaderCacheEncoderVersion.c_str());
 	mHeaderEntriesInfo.mEntries = 0;
+	mHeaderEntryCount = 0; // <FS:Perf/> Lock-sharded header index
 }
 
 void LLTextureCache::writeEntriesHeader()
@@ -1112,16 +1157,109 @@ void LLTextureCache::writeEntriesHeader()
 	{
 		LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
 						   mHeaderAPRFilePoolp);
+		mHeaderEntriesOnDisk = mHeaderEntriesInfo.mEntries; // <FS:Perf/> Lock-sharded header index
+	}
+}
+
+// <FS:Perf> Lock-sharded header index
+LLTextureCache::HeaderShard& LLTextureCache::getHeaderShard(const LLUUID& id)
+{
+	// Texture UUIDs are random, any byte spreads them evenly over the shards
+	return mHeaderShards[id.mData[UUID_BYTES - 1] % HEADER_SHARD_COUNT];
+}
+
+// Locks mutex, accounting for the time spent waiting if it is not free
+void LLTextureCache::lockHeaderMutex(LLMutex& mutex)
+{
+	if (!mutex.trylock())
+	{
+		LLTimer timer;
+		mutex.lock();
+		mHeaderLockWaitUsec += (U64)(timer.getElapsedTimeF64() * 1000000.0);
+		++mHeaderLockContentions;
 	}
 }
 
+//mHeaderMutex is locked before calling this.
+void LLTextureCache::lockAllHeaderShards()
+{
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		lockHeaderMutex(mHeaderShards[i].mMutex);
+	}
+}
+
+void LLTextureCache::unlockAllHeaderShards()
+{
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		mHeaderShards[i].mMutex.unlock();
+	}
+}
+
+//mHeaderMutex is locked before calling this.
+S32 LLTextureCache::appendHeaderEntry()
+{
+	if (mHeaderEntries.capacity() < sCacheMaxEntries)
+	{
+		// Growing moves the entries, so keep the readers out while doing it
+		lockAllHeaderShards();
+		mHeaderEntries.reserve(sCacheMaxEntries);
+		unlockAllHeaderShards();
+	}
+
+	S32 idx = mHeaderEntriesInfo.mEntries++;
+	llassert(idx == (S32)mHeaderEntries.size());
+	mHeaderEntries.push_back(Entry());
+	mHeaderEntryCount = mHeaderEntriesInfo.mEntries;
+
+	// <FS:Perf> Memory-mapped fast cache
+	if (!mReadOnly && mFastCacheMap.isOpen() && !getFastCacheSlot(idx))
+	{
+		// Remapping moves the slots, so keep the readers out while doing it
+		lockAllHeaderShards();
+		openFastCache();
+		unlockAllHeaderShards();
+	}
+	// </FS:Perf>
+	return idx;
+}
+
+//the shard is locked before calling this.
+void LLTextureCache::markEntryDirty(HeaderShard& shard, S32 idx, const Entry& entry)
+{
+	llassert(idx >= 0 && idx < (S32)mHeaderEntries.size());
+	mHeaderEntries[idx] = entry;
+	if (!mReadOnly)
+	{
+		shard.mDirty.insert(idx);
+	}
+}
+
+void LLTextureCache::getHeaderStats(HeaderStats& stats) const
+{
+	stats.mLockWaitUsec = mHeaderLockWaitUsec;
+	stats.mLockContentions = mHeaderLockContentions;
+	stats.mLookups = mHeaderLookups;
+	stats.mEntriesRead = mHeaderEntriesRead;
+	stats.mEntriesWritten = mHeaderEntriesWritten;
+	stats.mWriteBatches = mHeaderWriteBatches;
+}
+// </FS:Perf>
+
 //mHeaderMutex is locked before calling this.
 S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create)
 {
 	S32 idx = -1;
 	
-	id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-	if (iter1 != mHeaderIDMap.end())
+	// <FS:Perf> Lock-sharded header index
+	//id_map_t::iterator iter1 = mHeaderIDMap.find(id);
+	//if (iter1 != mHeaderIDMap.end())
+	HeaderShard& shard = getHeaderShard(id);
+	LLMutexLock shard_lock(&shard.mMutex);
+	id_map_t::iterator iter1 = shard.mIDMap.find(id);
+	if (iter1 != shard.mIDMap.end())
+	// </FS:Perf>
 	{
 		idx = iter1->second;
 	}
@@ -1133,7 +1271,10 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 			if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
 			{
 				// Add an entry to the end of the list
-				idx = mHeaderEntriesInfo.mEntries++;
+				// <FS:Perf> Lock-sharded header index
+				//idx = mHeaderEntriesInfo.mEntries++;
+				idx = appendHeaderEntry();
+				// </FS:Perf>
 
 			}
 			else if (!mFreeList.empty())
@@ -1143,22 +1284,30 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 			}
 			else
 			{
+				// <FS:Perf> Look for a still valid entry in the LRU of each shard in turn
+				for (U32 i = 0; i < HEADER_SHARD_COUNT && idx < 0; ++i)
+				{
+				HeaderShard& lru_shard = mHeaderShards[mNextLRUShard];
+				mNextLRUShard = (mNextLRUShard + 1) % HEADER_SHARD_COUNT;
+				LLMutexLock lru_lock(&lru_shard.mMutex);
+				// </FS:Perf>
 				// Look for a still valid entry in the LRU
-				for (std::set<LLUUID>::iterator iter2 = mLRU.begin(); iter2 != mLRU.end();)
+				for (std::set<LLUUID>::iterator iter2 = lru_shard.mLRU.begin(); iter2 != lru_shard.mLRU.end();)
 				{
 					std::set<LLUUID>::iterator curiter2 = iter2++;
 					LLUUID oldid = *curiter2;
 					// Erase entry from LRU regardless
-					mLRU.erase(curiter2);
+					lru_shard.mLRU.erase(curiter2);
 					// Look up entry and use it if it is valid
-					id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-					if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
+					id_map_t::iterator iter3 = lru_shard.mIDMap.find(oldid);
+					if (iter3 != lru_shard.mIDMap.end() && iter3->second >= 0)
 					{
 						idx = iter3->second;
 						removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
 						break;
 					}
 				}
+				} // <FS:Perf/>
 				// if (idx < 0) at this point, we will rebuild the LRU 
 				//  and retry if called from setHeaderCacheEntry(),
 				//  otherwise this shouldn't happen and will trigger an error
@@ -1174,17 +1323,22 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 	else
 	{
 		// Remove this entry from the LRU if it exists
-		mLRU.erase(id);
-		// Read the entry
-		idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
-		if(iter != mUpdatedEntryMap.end())
-		{
-			entry = iter->second ;
-		}
-		else
-		{
-			readEntryFromHeaderImmediately(idx, entry) ;
-		}
+		// <FS:Perf> Lock-sharded header index, entries are read from memory
+		//mLRU.erase(id);
+		//// Read the entry
+		//idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
+		//if(iter != mUpdatedEntryMap.end())
+		//{
+		//	entry = iter->second ;
+		//}
+		//else
+		//{
+		//	readEntryFromHeaderImmediately(idx, entry) ;
+		//}
+		shard.mLRU.erase(id);
+		entry = mHeaderEntries[idx];
+		++mHeaderLookups;
+		// </FS:Perf>
 		if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
 		{
 			LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
@@ -1192,7 +1346,7 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 			//erase this entry and the cached texture from the cache.
 			std::string tex_filename = getTextureFileName(id);
 			removeEntry(idx, entry, tex_filename) ;
-			mUpdatedEntryMap.erase(idx) ;
+			//mUpdatedEntryMap.erase(idx) ; // <FS:Perf/> removeEntry() flags the entry for write back
 			idx = -1 ;
 		}
 	}
@@ -1232,31 +1386,39 @@ void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool
 	}
 
 	closeHeaderEntriesFile();
-	mUpdatedEntryMap.erase(idx) ;
-}
-
-//mHeaderMutex is locked before calling this.
-void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
-{
-	S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-	LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
-	S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
-	closeHeaderEntriesFile();
-
-	if(bytes_read != sizeof(Entry))
-	{
-		clearCorruptedCache() ; //clear the cache.
-		idx = -1 ;//mark the idx invalid.
-	}
+	// <FS:Perf> Lock-sharded header index
+	//mUpdatedEntryMap.erase(idx) ;
+	++mHeaderEntriesWritten;
+	// </FS:Perf>
 }
 
-//mHeaderMutex is locked before calling this.
+// <FS:Perf> Entries are read from mHeaderEntries instead of the file
+////mHeaderMutex is locked before calling this.
+//void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
+//{
+//	S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
+//	LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
+//	S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
+//	closeHeaderEntriesFile();
+//
+//	if(bytes_read != sizeof(Entry))
+//	{
+//		clearCorruptedCache() ; //clear the cache.
+//		idx = -1 ;//mark the idx invalid.
+//	}
+//}
+// </FS:Perf>
+
+//the shard of entry.mID is locked before calling this. // <FS:Perf/>
 //update an existing entry time stamp, delay writing.
 void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
 {
 	static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
 
-	if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+	// <FS:Perf> Lock-sharded header index
+	//if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+	if(mHeaderEntryCount < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+	// </FS:Perf>
 	{
 		return ; //there are enough empty entry index space, no need to stamp time.
 	}
@@ -1266,7 +1428,10 @@ void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
 		if (!mReadOnly)
 		{
 			entry.mTime = time(NULL);			
-			mUpdatedEntryMap[idx] = entry ;
+			// <FS:Perf> Lock-sharded header index
+			//mUpdatedEntryMap[idx] = entry ;
+			markEntryDirty(getHeaderShard(entry.mID), idx, entry);
+			// </FS:Perf>
 		}
 	}
 }
@@ -1286,11 +1451,26 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 		bool purge = false ;
 
 		lockHeaders() ;
+		// <FS:Perf> Lock-sharded header index
+		HeaderShard& shard = getHeaderShard(entry.mID);
+		lockHeaderMutex(shard.mMutex);
+		// </FS:Perf>
 
 		bool update_header = false ;
 		if(entry.mImageSize < 0) //is a brand-new entry
 		{
-			mHeaderIDMap[entry.mID] = idx;
+			// <FS:Perf> Lock-sharded header index
+			//mHeaderIDMap[entry.mID] = idx;
+			shard.mIDMap[entry.mID] = idx;
+			// </FS:Perf>
+			// <FS:Perf> Memory-mapped fast cache
+			// Invalidate the slot until writeToFastCache() fills it, it may
+			// still hold the preview of the texture that used this entry before.
+			if (U8* slot = getFastCacheSlot(idx))
+			{
+				memset(slot, 0, TEXTURE_FAST_CACHE_ENTRY_OVERHEAD);
+			}
+			// </FS:Perf>
 			mTexturesSizeMap[entry.mID] = new_body_size ;
 			mTexturesSizeTotal += new_body_size ;
 			
@@ -1308,7 +1488,22 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 		entry.mImageSize = new_image_size ; 
 		entry.mBodySize = new_body_size ;
 		
-		writeEntryToHeaderImmediately(idx, entry, update_header) ;
+		// <FS:Perf> Lock-sharded header index
+		// Only a new entry that recycles a slot already on disk is written
+		// immediately, before its header data replaces the previous one in
+		// texture.cache. Everything else is written back in batches.
+		//writeEntryToHeaderImmediately(idx, entry, update_header) ;
+		if (update_header && idx < (S32)mHeaderEntriesOnDisk)
+		{
+			mHeaderEntries[idx] = entry;
+			writeEntryToHeaderImmediately(idx, entry);
+		}
+		else
+		{
+			markEntryDirty(shard, idx, entry);
+		}
+		shard.mMutex.unlock();
+		// </FS:Perf>
 	
 		if (mTexturesSizeTotal > sCacheMaxTexturesSize)
 		{
@@ -1317,6 +1512,8 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 		
 		unlockHeaders() ;
 
+		writeUpdatedEntriesIfDue(); // <FS:Perf/> Lock-sharded header index
+
 		if (purge)
 		{
 			mDoPurge = TRUE;
@@ -1330,26 +1527,29 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
 {
 	U32 num_entries = mHeaderEntriesInfo.mEntries;
 
-	mHeaderIDMap.clear();
+	// <FS:Perf> Lock-sharded header index
+	//mHeaderIDMap.clear();
+	lockAllHeaderShards();
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		mHeaderShards[i].mIDMap.clear();
+	}
+	// </FS:Perf>
 	mTexturesSizeMap.clear();
 	mFreeList.clear();
 	mTexturesSizeTotal = 0;
 
-	LLAPRFile* aprfile = NULL; 
-	if(mUpdatedEntryMap.empty())
+	// <FS:Perf> Lock-sharded header index
+	// Once loaded, mHeaderEntries is always up to date and the file only
+	// needs to be read again by a read only cache.
+	if (mHeaderEntriesLoaded && !mReadOnly && mHeaderEntries.size() == num_entries)
 	{
-		aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+		entries = mHeaderEntries;
 	}
-	else //update the header file first.
+	else
 	{
-		aprfile = openHeaderEntriesFile(false, 0);
-		updatedHeaderEntriesFile() ;
-		if(!aprfile)
-		{
-			return 0;
-		}
-		aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
-	}
+	LLAPRFile* aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+	// </FS:Perf>
 	for (U32 idx=0; idx<num_entries; idx++)
 	{
 		Entry entry;
@@ -1358,14 +1558,37 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
 		{
 			LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
 			closeHeaderEntriesFile();
+			unlockAllHeaderShards(); // <FS:Perf/>
 			purgeAllTextures(false);
 			return 0;
 		}
 		entries.push_back(entry);
+	}
+	closeHeaderEntriesFile();
+
+	// <FS:Perf> Lock-sharded header index
+	mHeaderEntriesRead += num_entries;
+	mHeaderEntries.clear();
+	mHeaderEntries.reserve(llmax(num_entries, sCacheMaxEntries));
+	mHeaderEntries.assign(entries.begin(), entries.end());
+	mHeaderEntriesLoaded = true;
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		mHeaderShards[i].mDirty.clear();
+	}
+	}
+
+	for (U32 idx=0; idx<num_entries; idx++)
+	{
+		const Entry& entry = entries[idx];
+	// </FS:Perf>
 // 		LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
 		if(entry.mImageSize > entry.mBodySize)
 		{
-			mHeaderIDMap[entry.mID] = idx;
+			// <FS:Perf> Lock-sharded header index
+			//mHeaderIDMap[entry.mID] = idx;
+			getHeaderShard(entry.mID).mIDMap[entry.mID] = idx;
+			// </FS:Perf>
 			mTexturesSizeMap[entry.mID] = entry.mBodySize;
 			mTexturesSizeTotal += entry.mBodySize;
 		}
@@ -1374,10 +1597,13 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
 			mFreeList.insert(idx);
 		}
 	}
-	closeHeaderEntriesFile();
+	unlockAllHeaderShards(); // <FS:Perf/>
 	return num_entries;
 }
 
+// <FS:Perf> Lock-sharded header index
+// Every change to the entries has already been applied to mHeaderEntries by
+// removeEntry(), so that is what gets written, in a single call.
 void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
 {
 	S32 num_entries = entries.size();
@@ -1385,77 +1611,158 @@ void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
 	
 	if (!mReadOnly)
 	{
+		lockAllHeaderShards();
+		std::vector<Entry> snapshot(mHeaderEntries);
+		for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+		{
+			mHeaderShards[i].mDirty.clear();
+		}
+		unlockAllHeaderShards();
+		llassert_always(num_entries == (S32)snapshot.size());
+
 		LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
-		for (S32 idx=0; idx<num_entries; idx++)
+		S32 bytes = num_entries * (S32)sizeof(Entry);
+		if (bytes && aprfile->write((void*)snapshot.data(), bytes) != bytes)
 		{
-			S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
-			if(bytes_written != sizeof(Entry))
-			{
-				clearCorruptedCache() ; //clear the cache.
-				return ;
-			}
+			clearCorruptedCache() ; //clear the cache.
+			return ;
+		}
+		// The entries are written first so that the count on disk never
+		// covers entries that are not there yet
+		aprfile->seek(APR_SET, 0);
+		if (aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) != sizeof(EntriesInfo))
+		{
+			clearCorruptedCache() ; //clear the cache.
+			return ;
 		}
 		closeHeaderEntriesFile();
+
+		mHeaderEntriesOnDisk = num_entries;
+		mHeaderEntriesWritten += num_entries;
+		++mHeaderWriteBatches;
+		mHeaderWriteTime = (U32)time(NULL);
 	}
 }
 
 void LLTextureCache::writeUpdatedEntries()
 {
 	lockHeaders() ;
-	if (!mReadOnly && !mUpdatedEntryMap.empty())
+	//if (!mReadOnly && !mUpdatedEntryMap.empty())
+	//{
+	//	openHeaderEntriesFile(false, 0);
+	//	updatedHeaderEntriesFile() ;
+	//	closeHeaderEntriesFile();
+	//}
+	updatedHeaderEntriesFile();
+	unlockHeaders() ;
+}
+
+// Called by the workers after changing an entry
+void LLTextureCache::writeUpdatedEntriesIfDue()
+{
+	if ((U32)time(NULL) - mHeaderWriteTime >= TEXTURE_HEADER_WRITE_BACK_INTERVAL)
 	{
-		openHeaderEntriesFile(false, 0);
-		updatedHeaderEntriesFile() ;
-		closeHeaderEntriesFile();
+		writeUpdatedEntries();
 	}
-	unlockHeaders() ;
 }
 
-//mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
+//mHeaderMutex is locked before calling this.
+//Writes the dirty entries of all shards and any entries appended since the
+//last write, coalescing consecutive entries into a single write.
 void LLTextureCache::updatedHeaderEntriesFile()
 {
-	if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
+	mHeaderWriteTime = (U32)time(NULL);
+	if (mReadOnly || !mHeaderEntriesLoaded)
 	{
-		//entriesInfo
-		mHeaderAPRFile->seek(APR_SET, 0);
-		S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-		if(bytes_written != sizeof(EntriesInfo))
+		return;
+	}
+
+	std::set<S32> dirty;
+	idx_entry_vector_t updated;
+	lockAllHeaderShards();
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		dirty.insert(mHeaderShards[i].mDirty.begin(), mHeaderShards[i].mDirty.end());
+		mHeaderShards[i].mDirty.clear();
+	}
+	U32 num_entries = mHeaderEntriesInfo.mEntries;
+	for (U32 idx = mHeaderEntriesOnDisk; idx < num_entries; ++idx)
+	{
+		dirty.insert((S32)idx);
+	}
+	updated.reserve(dirty.size());
+	for (std::set<S32>::iterator iter = dirty.begin(); iter != dirty.end(); ++iter)
+	{
+		if (*iter < (S32)mHeaderEntries.size())
+		{
+			updated.push_back(std::make_pair(*iter, mHeaderEntries[*iter]));
+		}
+	}
+	unlockAllHeaderShards();
+
+	if (updated.empty())
+	{
+		return;
+	}
+
+	LLAPRFile* aprfile = openHeaderEntriesFile(false, 0);
+	std::vector<Entry> run;
+	size_t i = 0;
+	while (i < updated.size())
+	{
+		S32 first_idx = updated[i].first;
+		run.clear();
+		do
+		{
+			run.push_back(updated[i].second);
+			++i;
+		}
+		while (i < updated.size() && updated[i].first == first_idx + (S32)run.size());
+
+		aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo) + first_idx * (S32)sizeof(Entry));
+		S32 bytes = (S32)(run.size() * sizeof(Entry));
+		if (aprfile->write((void*)run.data(), bytes) != bytes)
 		{
 			clearCorruptedCache() ; //clear the cache.
 			return ;
 		}
-		
-		//write each updated entry
-		S32 entry_size = (S32)sizeof(Entry) ;
-		S32 prev_idx = -1 ;
-		S32 delta_idx ;
-		for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
-		{
-			delta_idx = iter->first - prev_idx - 1;
-			prev_idx = iter->first ;
-			if(delta_idx)
-			{
-				mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
-			}
-			
-			bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
-			if(bytes_written != entry_size)
-			{
-				clearCorruptedCache() ; //clear the cache.
-				return ;
-			}
-		}
-		mUpdatedEntryMap.clear() ;
 	}
+
+	//entriesInfo, after the entries it counts
+	aprfile->seek(APR_SET, 0);
+	if (aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) != sizeof(EntriesInfo))
+	{
+		clearCorruptedCache() ; //clear the cache.
+		return ;
+	}
+	closeHeaderEntriesFile();
+
+	mHeaderEntriesOnDisk = num_entries;
+	mHeaderEntriesWritten += updated.size();
+	++mHeaderWriteBatches;
+	LL_DEBUGS("TextureCache") << "Wrote " << updated.size() << " header entries" << LL_ENDL;
 }
+// </FS:Perf>
 //----------------------------------------------------------------------------
 
 // Called from either the main thread or the worker thread
 void LLTextureCache::readHeaderCache()
 {
-	mHeaderMutex.lock();
+	// <FS:Perf> Lock-sharded header index
+	//mHeaderMutex.lock();
+	//
+	//mLRU.clear(); // always clear the LRU
+	lockHeaders();
 
-	mLRU.clear(); // always clear the LRU
+	// Write back pending changes before the header is read from disk again
+	updatedHeaderEntriesFile();
+
+	lockAllHeaderShards();
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		mHeaderShards[i].mLRU.clear(); // always clear the LRU
+	}
+	// </FS:Perf>
 
 	readEntriesHeader();
 	
@@ -1521,7 +1828,11 @@ void LLTextureCache::readHeaderCache()
 				S32 lru_entries = (S32)((F32)sCacheMaxEntries * TEXTURE_CACHE_LRU_SIZE);
 				for (std::set<lru_data_t>::iterator iter = lru.begin(); iter != lru.end(); ++iter)
 				{
-					mLRU.insert(entries[iter->second].mID);
+					// <FS:Perf> Lock-sharded header index
+					//mLRU.insert(entries[iter->second].mID);
+					const LLUUID& lru_id = entries[iter->second].mID;
+					getHeaderShard(lru_id).mLRU.insert(lru_id);
+					// </FS:Perf>
 // 					LL_INFOS() << "LRU: " << iter->first << " : " << iter->second << LL_ENDL;
 					if (--lru_entries <= 0)
 						break;
@@ -1550,6 +1861,7 @@ void LLTextureCache::readHeaderCache()
 			}
 		}
 	}
+	unlockAllHeaderShards(); // <FS:Perf/>
 	mHeaderMutex.unlock();
 }
 
@@ -1580,6 +1892,21 @@ void LLTextureCache::clearCorruptedCache()
 
 void LLTextureCache::purgeAllTextures(bool purge_directories)
 {
+	// <FS:Perf> Memory-mapped fast cache
+	// The fast cache file is deleted with the rest and a mapped file can't be
+	// renamed or deleted on Windows, so unmap it first and map it again once
+	// no entry refers to the old slots.
+	bool remap_fast_cache = false;
+	if (!mReadOnly)
+	{
+		lockHeaders();
+		lockAllHeaderShards();
+		remap_fast_cache = mFastCacheMap.isOpen();
+		closeFastCache();
+		unlockAllHeaderShards();
+		unlockHeaders();
+	}
+	// </FS:Perf>
 	if (!mReadOnly)
 	{
 // <FS:ND> Windows can be really slow deleting a huge texture cache.
@@ -1637,16 +1964,40 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
 		// </FS:Ansariel>
 		}
 	}
-	mHeaderIDMap.clear();
+	// <FS:Perf> Lock-sharded header index
+	//mHeaderIDMap.clear();
+	lockHeaders();
+	lockAllHeaderShards();
+	for (U32 i = 0; i < HEADER_SHARD_COUNT; ++i)
+	{
+		mHeaderShards[i].mIDMap.clear();
+		mHeaderShards[i].mLRU.clear();
+		mHeaderShards[i].mDirty.clear();
+	}
+	mHeaderEntries.clear();
+	mHeaderEntriesLoaded = true;
+	// </FS:Perf>
+	// <FS:Perf> Memory-mapped fast cache
+	if (remap_fast_cache)
+	{
+		// Sized for the empty header written below
+		mHeaderEntriesInfo.mEntries = 0;
+		openFastCache();
+	}
+	// </FS:Perf>
+	// <FS:Perf> Lock-sharded header index
+	unlockAllHeaderShards();
+	// </FS:Perf>
 	mTexturesSizeMap.clear();
 	mTexturesSizeTotal = 0;
 	mFreeList.clear();
 	mTexturesSizeTotal = 0;
-	mUpdatedEntryMap.clear();
+	//mUpdatedEntryMap.clear(); // <FS:Perf/>
 
 	// Info with 0 entries
 	setEntriesHeader();
 	writeEntriesHeader();
+	unlockHeaders(); // <FS:Perf/>
 
 	LL_INFOS() << "The entire texture cache is cleared." << LL_ENDL ;
 }
@@ -1684,8 +2035,14 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
 		{
 			if (iter1->second > 0)
 			{
-				id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-				if (iter2 != mHeaderIDMap.end())
+				// <FS:Perf> Lock-sharded header index
+				//id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
+				//if (iter2 != mHeaderIDMap.end())
+				HeaderShard& shard = getHeaderShard(iter1->first);
+				LLMutexLock shard_lock(&shard.mMutex);
+				id_map_t::iterator iter2 = shard.mIDMap.find(iter1->first);
+				if (iter2 != shard.mIDMap.end())
+				// </FS:Perf>
 				{
 					S32 idx = iter2->second;
 					time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
@@ -1725,12 +2082,22 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
 			Entry entry = mPurgeEntryList.back().second;
 			mPurgeEntryList.pop_back();
 			// make sure record is still valid
-			id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
-			if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+			// <FS:Perf> Lock-sharded header index
+			//id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
+			//if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+			bool valid = false;
+			{
+				HeaderShard& shard = getHeaderShard(entry.mID);
+				LLMutexLock shard_lock(&shard.mMutex);
+				id_map_t::iterator iter_header = shard.mIDMap.find(entry.mID);
+				valid = (iter_header != shard.mIDMap.end() && iter_header->second == idx);
+			}
+			if (valid)
+			// </FS:Perf>
 			{
 				std::string tex_filename = getTextureFileName(entry.mID);
 				removeEntry(idx, entry, tex_filename);
-				writeEntryToHeaderImmediately(idx, entry);
+				//writeEntryToHeaderImmediately(idx, entry); // <FS:Perf/> removeEntry() flags the entry for write back
 			}
 		}
 	}
@@ -1769,8 +2136,14 @@ void LLTextureCache::purgeTextures(bool validate)
 	{
 		if (iter1->second > 0)
 		{
-			id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-			if (iter2 != mHeaderIDMap.end())
+			// <FS:Perf> Lock-sharded header index
+			//id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
+			//if (iter2 != mHeaderIDMap.end())
+			HeaderShard& shard = getHeaderShard(iter1->first);
+			LLMutexLock shard_lock(&shard.mMutex);
+			id_map_t::iterator iter2 = shard.mIDMap.find(iter1->first);
+			if (iter2 != shard.mIDMap.end())
+			// </FS:Perf>
 			{
 				S32 idx = iter2->second;
 				time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
@@ -1886,20 +2259,52 @@ LLTextureCacheWorker* LLTextureCache::getWriter(handle_t handle)
 S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-	LLMutexLock lock(&mHeaderMutex);	
-	S32 idx = openAndReadEntry(id, entry, false);
+	// <FS:Perf> Lock-sharded header index: only the shard of id is locked
+	//LLMutexLock lock(&mHeaderMutex);	
+	//S32 idx = openAndReadEntry(id, entry, false);
+	//if (idx >= 0)
+	//{		
+	//	updateEntryTimeStamp(idx, entry); // updates time
+	//}
+	//return idx;
+	HeaderShard& shard = getHeaderShard(id);
+	lockHeaderMutex(shard.mMutex);
+	S32 idx = -1;
+	id_map_t::iterator iter = shard.mIDMap.find(id);
+	if (iter != shard.mIDMap.end())
+	{
+		idx = iter->second;
+		entry = mHeaderEntries[idx];
+		++mHeaderLookups;
+		if (entry.mImageSize > entry.mBodySize)
+		{
+			shard.mLRU.erase(id);
+			updateEntryTimeStamp(idx, entry); // updates time
+			shard.mMutex.unlock();
+			return idx;
+		}
+	}
+	shard.mMutex.unlock();
+
 	if (idx >= 0)
-	{		
-		updateEntryTimeStamp(idx, entry); // updates time
+	{
+		// Corrupted entry, openAndReadEntry() removes it under the header mutex
+		lockHeaders();
+		idx = openAndReadEntry(id, entry, false);
+		unlockHeaders();
 	}
 	return idx;
+	// </FS:Perf>
 }
 
 // Writes imagesize to the header, updates timestamp
 S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-	mHeaderMutex.lock();
+	// <FS:Perf> Account for the time spent waiting on the header mutex
+	//mHeaderMutex.lock();
+	lockHeaders();
+	// </FS:Perf>
 	S32 idx = openAndReadEntry(id, entry, true); // read or create
 	mHeaderMutex.unlock();
 
@@ -1907,7 +2312,10 @@ S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imag
 	{
 		readHeaderCache(); // We couldn't write an entry, so refresh the LRU
 
-		mHeaderMutex.lock();
+		// <FS:Perf> Account for the time spent waiting on the header mutex
+		//mHeaderMutex.lock();
+		lockHeaders();
+		// </FS:Perf>
 		idx = openAndReadEntry(id, entry, true);
 		mHeaderMutex.unlock();
 	}
@@ -2031,58 +2439,43 @@ LLTextureCache::handle_t LLTextureCache::writeToCache(const LLUUID& id,
 //called in the main thread
 LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& discardlevel)
 {
-	U32 offset;
+	// <FS:Perf> Memory-mapped fast cache
+	// The image is built straight from the mapped slot. The shard lock keeps
+	// the slot from being rewritten or handed to another texture meanwhile.
+	HeaderShard& shard = getHeaderShard(id);
+	LLMutexLock lock(&shard.mMutex);
+	id_map_t::const_iterator iter = shard.mIDMap.find(id);
+	if(iter == shard.mIDMap.end())
 	{
-		LLMutexLock lock(&mHeaderMutex);
-		id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-		if(iter == mHeaderIDMap.end())
-		{
-			return NULL; //not in the cache
-		}
-
-		offset = iter->second;
+		return NULL; //not in the cache
 	}
-	offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
 
-	U8* data;
-	S32 head[4];
+	const U8* slot = getFastCacheSlot(iter->second);
+	if (!slot)
 	{
-		LLMutexLock lock(&mFastCacheMutex);
+		return NULL;
+	}
 
-		openFastCache();
+	S32 head[4];
+	memcpy(head, slot, TEXTURE_FAST_CACHE_ENTRY_OVERHEAD);
 
-		mFastCachep->seek(APR_SET, offset);		
-	
-		if(mFastCachep->read(head, TEXTURE_FAST_CACHE_ENTRY_OVERHEAD) != TEXTURE_FAST_CACHE_ENTRY_OVERHEAD)
-		{
-			//cache corrupted or under thread race condition
-			closeFastCache(); 
-			return NULL;
-		}
-		
-		S32 image_size = head[0] * head[1] * head[2];
-        if(image_size <= 0
-           || image_size > TEXTURE_FAST_CACHE_DATA_SIZE
-           || head[3] < 0) //invalid
-		{
-			closeFastCache();
-			return NULL;
-		}
-		discardlevel = head[3];
-		
-		data = (U8*)ll_aligned_malloc_16(image_size);
-		if(mFastCachep->read(data, image_size) != image_size)
-		{
-			ll_aligned_free_16(data);
-			closeFastCache();
-			return NULL;
-		}
+	S32 image_size = head[0] * head[1] * head[2];
+	if(image_size <= 0
+	   || image_size > TEXTURE_FAST_CACHE_DATA_SIZE
+	   || head[3] < 0) //invalid, or the slot was never written
+	{
+		return NULL;
+	}
+	discardlevel = head[3];
 
-		closeFastCache();
+	LLPointer<LLImageRaw> raw = new LLImageRaw(slot + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, head[0], head[1], head[2]);
+	if (raw->isBufferInvalid())
+	{
+		return NULL;
 	}
-	LLPointer<LLImageRaw> raw = new LLImageRaw(data, head[0], head[1], head[2], true);
 
 	return raw;
+	// </FS:Perf>
 }
 
 //return the fast cache location
@@ -2130,86 +2523,92 @@ bool LLTextureCache::writeToFastCache(LLUUID image_id, S32 id, LLPointer<LLImage
 		}
 	}
 	
+	// <FS:Perf> Memory-mapped fast cache: copy straight into the mapped slot
+	HeaderShard& shard = getHeaderShard(image_id);
+	LLMutexLock lock(&shard.mMutex);
+
+	// The entry may have been purged and its slot reused since it was created
+	id_map_t::const_iterator iter = shard.mIDMap.find(image_id);
+	U8* slot = getFastCacheSlot(id);
+	if (iter == shard.mIDMap.end() || iter->second != id || !slot)
+	{
+		//no need to fail here, the texture simply won't be in the fast cache.
+		return true;
+	}
+
 	//copy data
-	memcpy(mFastCachePadBuffer, &w, sizeof(S32));
-	memcpy(mFastCachePadBuffer + sizeof(S32), &h, sizeof(S32));
-	memcpy(mFastCachePadBuffer + sizeof(S32) * 2, &c, sizeof(S32));
-	memcpy(mFastCachePadBuffer + sizeof(S32) * 3, &discardlevel, sizeof(S32));
+	memcpy(slot, &w, sizeof(S32));
+	memcpy(slot + sizeof(S32), &h, sizeof(S32));
+	memcpy(slot + sizeof(S32) * 2, &c, sizeof(S32));
+	memcpy(slot + sizeof(S32) * 3, &discardlevel, sizeof(S32));
 
 	S32 copy_size = w * h * c;
 	if(copy_size > 0) //valid
 	{
 		copy_size = llmin(copy_size, TEXTURE_FAST_CACHE_ENTRY_SIZE - TEXTURE_FAST_CACHE_ENTRY_OVERHEAD);
-		memcpy(mFastCachePadBuffer + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, raw->getData(), copy_size);
-	}
-	S32 offset = id * TEXTURE_FAST_CACHE_ENTRY_SIZE;
-
-	{
-		LLMutexLock lock(&mFastCacheMutex);
-
-		openFastCache();
-
-		mFastCachep->seek(APR_SET, offset);	
-		
-		//no need to do this assertion check. When it fails, let it fail quietly.
-		//this failure could happen because other viewer removes the fast cache file when clearing cache.
-		//--> llassert_always(mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE) == TEXTURE_FAST_CACHE_ENTRY_SIZE);
-		mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE);
-
-		closeFastCache(true);
+		memcpy(slot + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, raw->getData(), copy_size);
 	}
+	// </FS:Perf>
 
 	return true;
 }
 
-void LLTextureCache::openFastCache(bool first_time)
+// <FS:Perf> Memory-mapped fast cache
+// Maps the file with a slot for every header entry in use, rounded up to
+// TEXTURE_FAST_CACHE_GROWTH_ENTRIES, and remaps it larger when
+// appendHeaderEntry() goes past the end. Disk space for the mapped slots
+// is reserved by LLMappedFile, so the file only takes what the cache
+// uses, up to the sCacheMaxEntries slots already counted in the cache
+// size budget by initCache(). An existing larger file is mapped whole.
+// Slot readers hold a header shard lock, so all shards must be locked
+// when this is called on an open cache, or when closing it.
+void LLTextureCache::openFastCache()
 {
-	if(!mFastCachep)
+	LLMutexLock lock(&mFastCacheMutex);
+	bool opened = false;
+	if (mReadOnly)
 	{
-		if(first_time)
-		{
-			if(!mFastCachePadBuffer)
-			{
-				mFastCachePadBuffer = (U8*)ll_aligned_malloc_16(TEXTURE_FAST_CACHE_ENTRY_SIZE);
-			}
-			mFastCachePoolp = new LLVolatileAPRPool(); // is_local= true by default, so not thread safe by default
-			if (LLAPRFile::isExist(mFastCacheFileName, mFastCachePoolp))
-			{
-				mFastCachep = new LLAPRFile(mFastCacheFileName, APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;				
-			}
-			else
-			{
-				mFastCachep = new LLAPRFile(mFastCacheFileName, APR_CREATE|APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
-			}
-		}
-		else
+		opened = mFastCacheMap.isOpen() || mFastCacheMap.open(mFastCacheFileName, LLMappedFile::READ_ONLY);
+	}
+	else
+	{
+		S32 entries = llmin(mHeaderEntriesInfo.mEntries + TEXTURE_FAST_CACHE_GROWTH_ENTRIES, (S32)sCacheMaxEntries);
+		entries -= entries % TEXTURE_FAST_CACHE_GROWTH_ENTRIES;
+		entries = llmax(entries, mHeaderEntriesInfo.mEntries);
+		size_t size = (size_t)entries * TEXTURE_FAST_CACHE_ENTRY_SIZE;
+		if (mFastCacheMap.isOpen() && size <= mFastCacheMap.size())
 		{
-			mFastCachep = new LLAPRFile(mFastCacheFileName, APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
+			return;
 		}
-
-		mFastCacheTimer.reset();
+		opened = mFastCacheMap.open(mFastCacheFileName, LLMappedFile::READ_WRITE, size);
+	}
+	if (!opened)
+	{
+		LL_WARNS("TextureCache") << "Could not map " << mFastCacheFileName << ", fast cache disabled" << LL_ENDL;
 	}
-	return;
 }
-	
-void LLTextureCache::closeFastCache(bool forced)
-{	
-	static const F32 timeout = 10.f ; //seconds
 
-	if(!mFastCachep)
+void LLTextureCache::closeFastCache()
+{
+	LLMutexLock lock(&mFastCacheMutex);
+	mFastCacheMap.close();
+}
+
+// Returns the mapped slot of header entry idx, or NULL if it is out of the mapping
+U8* LLTextureCache::getFastCacheSlot(S32 idx)
+{
+	if (idx < 0 || !mFastCacheMap.isOpen())
 	{
-		return ;
+		return NULL;
 	}
-
-	if(!forced && mFastCacheTimer.getElapsedTimeF32() < timeout)
+	size_t offset = (size_t)idx * TEXTURE_FAST_CACHE_ENTRY_SIZE;
+	if (offset + TEXTURE_FAST_CACHE_ENTRY_SIZE > mFastCacheMap.size())
 	{
-		return ;
+		return NULL;
 	}
-
-	delete mFastCachep;
-	mFastCachep = NULL;
-	return;
+	return mFastCacheMap.data() + offset;
 }
+// </FS:Perf>
 	
 bool LLTextureCache::writeComplete(handle_t handle, bool abort)
 {
@@ -2255,7 +2654,14 @@ void LLTextureCache::removeCachedTexture(const LLUUID& id)
 		mTexturesSizeTotal -= mTexturesSizeMap[id] ;
 		mTexturesSizeMap.erase(id);
 	}
-	mHeaderIDMap.erase(id);
+	// <FS:Perf> Lock-sharded header index
+	//mHeaderIDMap.erase(id);
+	{
+		HeaderShard& shard = getHeaderShard(id);
+		LLMutexLock shard_lock(&shard.mMutex);
+		shard.mIDMap.erase(id);
+	}
+	// </FS:Perf>
 	// We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
 	// but getLocalAPRFilePool() is not safe, it might be in use by worker
 	LLAPRFile::remove(getTextureFileName(id), mHeaderAPRFilePoolp);
@@ -2286,7 +2692,15 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
 
 		entry.mImageSize = -1;
 		entry.mBodySize = 0;
-		mHeaderIDMap.erase(entry.mID);
+		// <FS:Perf> Lock-sharded header index
+		//mHeaderIDMap.erase(entry.mID);
+		{
+			HeaderShard& shard = getHeaderShard(entry.mID);
+			LLMutexLock shard_lock(&shard.mMutex);
+			shard.mIDMap.erase(entry.mID);
+			markEntryDirty(shard, idx, entry);
+		}
+		// </FS:Perf>
 		mTexturesSizeMap.erase(entry.mID);		
 		mFreeList.insert(idx);	
 	}
@@ -28,12 +28,16 @@
 #define LL_LLTEXTURECACHE_H
 
 #include "lldir.h"
+#include "llmappedfile.h"
 #include "llstl.h"
 #include "llstring.h"
 #include "lluuid.h"
 
 #include "llworkerthread.h"
 
+#include <atomic>
+#include <unordered_map>
+
 class LLImageFormatted;
 class LLTextureCacheWorker;
 class LLImageRaw;
@@ -149,6 +153,19 @@ public:
 	BOOL isInCache(const LLUUID& id) ;
 	BOOL isInLocal(const LLUUID& id) ; //not thread safe at the moment
 
+	// <FS:Perf> Header index counters
+	struct HeaderStats
+	{
+		U64 mLockWaitUsec;		// time spent blocked on header locks
+		U64 mLockContentions;	// number of times a header lock was not free
+		U64 mLookups;			// entry lookups served from memory
+		U64 mEntriesRead;		// entries read from texture.entries
+		U64 mEntriesWritten;	// entries written to texture.entries
+		U64 mWriteBatches;		// number of write backs
+	};
+	void getHeaderStats(HeaderStats& stats) const;
+	// </FS:Perf>
+
 protected:
 	// Accessed by LLTextureCacheWorker
 	std::string getLocalFileName(const LLUUID& id);
@@ -175,7 +192,9 @@ private:
 	void updateEntryTimeStamp(S32 idx, Entry& entry) ;
 	U32 openAndReadEntries(std::vector<Entry>& entries);
 	void writeEntriesAndClose(const std::vector<Entry>& entries);
-	void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
+	// <FS:Perf> Entries are read from mHeaderEntries instead of the file
+	//void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
+	// </FS:Perf>
 	void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
 	void removeEntry(S32 idx, Entry& entry, std::string& filename);
 	void removeCachedTexture(const LLUUID& id) ;
@@ -183,11 +202,30 @@ private:
 	S32 setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize);
 	void writeUpdatedEntries() ;
 	void updatedHeaderEntriesFile() ;
-	void lockHeaders() { mHeaderMutex.lock(); }
+	// <FS:Perf> Lock-sharded header index
+	//void lockHeaders() { mHeaderMutex.lock(); }
+	void lockHeaders() { lockHeaderMutex(mHeaderMutex); }
+	// </FS:Perf>
 	void unlockHeaders() { mHeaderMutex.unlock(); }
+
+	// <FS:Perf> Lock-sharded header index
+	struct HeaderShard;
+	HeaderShard& getHeaderShard(const LLUUID& id);
+	void lockHeaderMutex(LLMutex& mutex);
+	void lockAllHeaderShards();
+	void unlockAllHeaderShards();
+	S32 appendHeaderEntry();
+	void markEntryDirty(HeaderShard& shard, S32 idx, const Entry& entry);
+	void writeUpdatedEntriesIfDue();
+	// </FS:Perf>
 	
-	void openFastCache(bool first_time = false);
-	void closeFastCache(bool forced = false);
+	// <FS:Perf> Memory-mapped fast cache
+	//void openFastCache(bool first_time = false);
+	//void closeFastCache(bool forced = false);
+	void openFastCache();
+	void closeFastCache();
+	U8* getFastCacheSlot(S32 idx);
+	// </FS:Perf>
 	bool writeToFastCache(LLUUID image_id, S32 cache_id, LLPointer<LLImageRaw> raw, S32 discardlevel);	
 
 private:
@@ -197,7 +235,7 @@ private:
 	LLMutex mListMutex;
 	LLMutex mFastCacheMutex;
 	LLAPRFile* mHeaderAPRFile;
-	LLVolatileAPRPool* mFastCachePoolp;
+	//LLVolatileAPRPool* mFastCachePoolp; // <FS:Perf/> Memory-mapped fast cache
 
 	// mLocalAPRFilePoolp is not thread safe and is meant only for workers
 	// howhever mHeaderEntriesFileName is accessed not from workers' threads
@@ -224,13 +262,59 @@ private:
 	std::string mFastCacheFileName;
 	EntriesInfo mHeaderEntriesInfo;
 	std::set<S32> mFreeList; // deleted entries
-	std::set<LLUUID> mLRU;
-	typedef std::map<LLUUID, S32> id_map_t;
-	id_map_t mHeaderIDMap;
+	// <FS:Perf> Lock-sharded header index
+	//std::set<LLUUID> mLRU;
+	//typedef std::map<LLUUID, S32> id_map_t;
+	//id_map_t mHeaderIDMap;
+
+	// Every entry of texture.entries is kept in mHeaderEntries and the
+	// UUID -> index map is split over HEADER_SHARD_COUNT shards, each with
+	// its own mutex. Looking up an entry only takes the mutex of its shard;
+	// mHeaderMutex is still taken to allocate, free and purge entries and
+	// for all file I/O. A thread may hold more than one shard mutex only
+	// while it also holds mHeaderMutex.
+	// mHeaderEntries[idx] is guarded by the shard of the UUID stored in it,
+	// or by mHeaderMutex when the entry is free. Its capacity is reserved up
+	// front so that appending never moves entries under a concurrent reader.
+	// Changed entries are flagged dirty in their shard and written back in
+	// batches by writeUpdatedEntries(). Only entries that recycle a slot
+	// already on disk are written immediately, before their header data is
+	// replaced in texture.cache.
+	typedef std::unordered_map<LLUUID, S32> id_map_t;
+	struct HeaderShard
+	{
+		LLMutex mMutex;
+		id_map_t mIDMap;
+		std::set<LLUUID> mLRU;	// entries that may be recycled
+		std::set<S32> mDirty;	// entries not yet written back
+	};
+	static const U32 HEADER_SHARD_COUNT = 16;
+	HeaderShard mHeaderShards[HEADER_SHARD_COUNT];
+	U32 mNextLRUShard;
+	std::vector<Entry> mHeaderEntries;
+	bool mHeaderEntriesLoaded;
+	U32 mHeaderEntriesOnDisk;	// entry count last written to texture.entries
+	LLAtomicU32 mHeaderEntryCount;
+	LLAtomicU32 mHeaderWriteTime;	// time(NULL) of the last write back
+
+	std::atomic<U64> mHeaderLockWaitUsec;
+	std::atomic<U64> mHeaderLockContentions;
+	std::atomic<U64> mHeaderLookups;
+	std::atomic<U64> mHeaderEntriesRead;
+	std::atomic<U64> mHeaderEntriesWritten;
+	std::atomic<U64> mHeaderWriteBatches;
+	// </FS:Perf>
 
-	LLAPRFile*   mFastCachep;
-	LLFrameTimer mFastCacheTimer;
-	U8*          mFastCachePadBuffer;
+	// <FS:Perf> Memory-mapped fast cache
+	// FastCache.cache holds one fixed-size slot per header entry and grows
+	// with the header. Slot idx belongs to the entry with the same index,
+	// so reads and writes of a slot are serialized by the header shard of
+	// its texture rather than by a global mutex.
+	//LLAPRFile*   mFastCachep;
+	//LLFrameTimer mFastCacheTimer;
+	//U8*          mFastCachePadBuffer;
+	LLMappedFile mFastCacheMap;
+	// </FS:Perf>
 
 	// BODIES (TEXTURES minus headers)
 	std::string mTexturesDirName;
@@ -239,8 +323,10 @@ private:
 	S64 mTexturesSizeTotal;
 	LLAtomicBool mDoPurge;
 
-	typedef std::map<S32, Entry> idx_entry_map_t;
-	idx_entry_map_t mUpdatedEntryMap;
+	// <FS:Perf> Replaced by HeaderShard::mDirty
+	//typedef std::map<S32, Entry> idx_entry_map_t;
+	//idx_entry_map_t mUpdatedEntryMap;
+	// </FS:Perf>
 	typedef std::vector<std::pair<S32, Entry> > idx_entry_vector_t;
 	idx_entry_vector_t mPurgeEntryList;
 
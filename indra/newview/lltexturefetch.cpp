@@ -999,6 +999,13 @@ LLTextureFetchWorker::~LLTextureFetchWorker()
 	{
 		mFetcher->mTextureCache->writeComplete(mCacheWriteHandle, true);
 	}
+	// <FS:Perf> Priority-aware decode queue: don't decode deleted textures
+	if (mDecodeHandle != 0 && LLAppViewer::getImageDecodeThread())
+	{
+		LLAppViewer::getImageDecodeThread()->cancel(mDecodeHandle);
+		mDecodeHandle = 0;
+	}
+	// </FS:Perf>
 	mFormattedImage = NULL;
 	clearPackets();
 	if (mHttpBufferArray)
@@ -1093,6 +1100,13 @@ void LLTextureFetchWorker::setDesiredDiscard(S32 discard, S32 size)
 void LLTextureFetchWorker::setImagePriority(F32 priority)
 {
 	mImagePriority = priority; //should map to max virtual size, abort if zero
+	// <FS:Perf> Priority-aware decode queue: a texture that just came into
+	// view jumps ahead of stale decodes
+	if (mDecodeHandle != 0 && LLAppViewer::getImageDecodeThread())
+	{
+		LLAppViewer::getImageDecodeThread()->updatePriority(mDecodeHandle, priority);
+	}
+	// </FS:Perf>
 }
 
 // Locks:  Mw
@@ -1840,7 +1854,21 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mRequestedOffset += src_offset;
 			}
 
-			U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+			// <FS:Perf> Zero-copy access.  A first response received in
+			// one piece already is the buffer we would build here.
+			//U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+			U8 * buffer(NULL);
+			bool buffer_filled(false);
+			if (0 == cur_size && 0 == src_offset)
+			{
+				buffer = (U8 *) mHttpBufferArray->detachContiguous();
+				buffer_filled = (NULL != buffer);
+			}
+			if (! buffer)
+			{
+				buffer = (U8 *) ll_aligned_malloc_16(total_size);
+			}
+			// </FS:Perf>
 			if (!buffer)
 			{
 				// abort. If we have no space for packet, we have not enough space to decode image
@@ -1870,12 +1898,23 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mFileSize = total_size + 1 ; //flag the file is not fully loaded.
 			}
 
-			if (cur_size > 0)
+			// <FS:Perf> Zero-copy access
+			//if (cur_size > 0)
+			//{
+			//	// Copy previously collected data into buffer
+			//	memcpy(buffer, mFormattedImage->getData(), cur_size);
+			//}
+			//mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+			if (! buffer_filled)
 			{
-				// Copy previously collected data into buffer
-				memcpy(buffer, mFormattedImage->getData(), cur_size);
+				if (cur_size > 0)
+				{
+					// Copy previously collected data into buffer
+					memcpy(buffer, mFormattedImage->getData(), cur_size);
+				}
+				mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
 			}
-			mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+			// </FS:Perf>
 
 			// NOTE: setData releases current data and owns new data (buffer)
 			mFormattedImage->setData(buffer, total_size);
@@ -1961,8 +2000,12 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		setState(DECODE_IMAGE_UPDATE);
 		LL_DEBUGS(LOG_TXT) << mID << ": Decoding. Bytes: " << mFormattedImage->getDataSize() << " Discard: " << discard
 						   << " All Data: " << mHaveAllData << LL_ENDL;
+		// <FS:Perf> Priority-aware decode queue
+		//mDecodeHandle = LLAppViewer::getImageDecodeThread()->decodeImage(mFormattedImage, discard, mNeedsAux,
+		//														  new DecodeResponder(mFetcher, mID, this));
 		mDecodeHandle = LLAppViewer::getImageDecodeThread()->decodeImage(mFormattedImage, discard, mNeedsAux,
-																  new DecodeResponder(mFetcher, mID, this));
+																  new DecodeResponder(mFetcher, mID, this), mImagePriority);
+		// </FS:Perf>
 		// fall though
 	}
 	
@@ -2209,7 +2252,14 @@ void LLTextureFetchWorker::endWork(S32 param, bool aborted)
 	LL_PROFILE_ZONE_SCOPED;
 	if (mDecodeHandle != 0)
 	{
-		// LL::ThreadPool has no operation to cancel a particular work item
+		// <FS:Perf> Priority-aware decode queue
+		//// LL::ThreadPool has no operation to cancel a particular work item
+		// Drop the decode unless it has already started
+		if (LLAppViewer::getImageDecodeThread())
+		{
+			LLAppViewer::getImageDecodeThread()->cancel(mDecodeHandle);
+		}
+		// </FS:Perf>
 		mDecodeHandle = 0;
 	}
 	mFormattedImage = NULL;
@@ -2670,6 +2720,11 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, bool threaded, bool qa_mod
 	mHttpOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpOptionsWithHeaders = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpOptionsWithHeaders->setWantHeaders(true);
+	// <FS:Perf> Zero-copy access: bodies come in one aligned piece that
+	// can become the formatted image data
+	mHttpOptions->setContiguousBody(true);
+	mHttpOptionsWithHeaders->setContiguousBody(true);
+	// </FS:Perf>
     mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
 	mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_IMAGE_X_J2C);
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_TEXTURE);
@@ -101,6 +101,7 @@
 #include "fsradar.h"
 #include "llavataractions.h"
 #include "lldiskcache.h"
+#include "llblobstore.h" // <FS:Perf/> Packed blob store
 #include "llfloaterreg.h"
 #include "llfloatersidepanelcontainer.h"
 #include "llhudtext.h"
@@ -1013,6 +1014,12 @@ void handleDiskCacheSizeChanged(const LLSD& newValue)
 	const unsigned int disk_cache_mb = gSavedSettings.getU32("FSDiskCacheSize");
 	const U64 disk_cache_bytes = disk_cache_mb * 1024ULL * 1024ULL;
 	LLDiskCache::getInstance()->setMaxSizeBytes(disk_cache_bytes);
+	// <FS:Perf> Packed blob store
+	if (LLBlobStore::instanceExists())
+	{
+		LLBlobStore::instance().setMaxSizeBytes(disk_cache_bytes);
+	}
+	// </FS:Perf>
 }
 // </FS:Ansariel>
 
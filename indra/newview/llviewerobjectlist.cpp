@@ -337,6 +337,45 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
 
 static LLTrace::BlockTimerStatHandle FTM_PROCESS_OBJECTS("Process Objects");
 
+// <FS:Perf> Compiled field access for the per-object reads of the object
+// update messages, see compileMessageFields()
+namespace
+{
+	struct ObjectUpdateFields
+	{
+		// ObjectUpdate
+		LLMessageField mFullID;
+		LLMessageField mID;
+		LLMessageField mPCode;
+		// ObjectUpdateCompressed
+		LLMessageField mCompressedData;
+		LLMessageField mCompressedUpdateFlags;
+		// ImprovedTerseObjectUpdate
+		LLMessageField mTerseData;
+		// ObjectUpdateCached
+		LLMessageField mCachedID;
+		LLMessageField mCachedCRC;
+		LLMessageField mCachedUpdateFlags;
+	};
+	ObjectUpdateFields sObjectUpdateFields;
+}
+
+// static
+void LLViewerObjectList::compileMessageFields(LLMessageSystem *mesgsys)
+{
+	ObjectUpdateFields& fields = sObjectUpdateFields;
+	fields.mFullID = mesgsys->compileFieldFast(_PREHASH_ObjectUpdate, _PREHASH_ObjectData, _PREHASH_FullID);
+	fields.mID = mesgsys->compileFieldFast(_PREHASH_ObjectUpdate, _PREHASH_ObjectData, _PREHASH_ID);
+	fields.mPCode = mesgsys->compileFieldFast(_PREHASH_ObjectUpdate, _PREHASH_ObjectData, _PREHASH_PCode);
+	fields.mCompressedData = mesgsys->compileFieldFast(_PREHASH_ObjectUpdateCompressed, _PREHASH_ObjectData, _PREHASH_Data);
+	fields.mCompressedUpdateFlags = mesgsys->compileFieldFast(_PREHASH_ObjectUpdateCompressed, _PREHASH_ObjectData, _PREHASH_UpdateFlags);
+	fields.mTerseData = mesgsys->compileFieldFast(_PREHASH_ImprovedTerseObjectUpdate, _PREHASH_ObjectData, _PREHASH_Data);
+	fields.mCachedID = mesgsys->compileFieldFast(_PREHASH_ObjectUpdateCached, _PREHASH_ObjectData, _PREHASH_ID);
+	fields.mCachedCRC = mesgsys->compileFieldFast(_PREHASH_ObjectUpdateCached, _PREHASH_ObjectData, _PREHASH_CRC);
+	fields.mCachedUpdateFlags = mesgsys->compileFieldFast(_PREHASH_ObjectUpdateCached, _PREHASH_ObjectData, _PREHASH_UpdateFlags);
+}
+// </FS:Perf>
+
 LLViewerObject* LLViewerObjectList::processObjectUpdateFromCache(LLVOCacheEntry* entry, LLViewerRegion* regionp)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
@@ -517,6 +556,11 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 	LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, 2048);
 	LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
 
+	// <FS:Perf> Compiled field access
+	const ObjectUpdateFields& fields = sObjectUpdateFields;
+	const LLMessageField& data_field = (update_type == OUT_TERSE_IMPROVED) ? fields.mTerseData : fields.mCompressedData;
+	// </FS:Perf>
+
 	for (i = 0; i < num_objects; i++)
 	{
 		BOOL justCreated = FALSE;
@@ -526,15 +570,20 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		{
 			compressed_dp.reset();
 
-			S32 uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+			// <FS:Perf> Compiled field access
+			//S32 uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+			S32 uncompressed_length = mesgsys->getSizeFast(data_field, i);
+			// </FS:Perf>
             LL_DEBUGS("ObjectUpdate") << "got binary data from message to compressed_dpbuffer" << LL_ENDL;
-			mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compressed_dpbuffer, 0, i, 2048);
+			//mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compressed_dpbuffer, 0, i, 2048);
+			mesgsys->getBinaryDataFast(data_field, compressed_dpbuffer, 0, i, 2048); // <FS:Perf/> Compiled field access
 			compressed_dp.assignBuffer(compressed_dpbuffer, uncompressed_length);
 
 			if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
 			{
 				U32 flags = 0;
-				mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+				//mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+				mesgsys->getU32Fast(fields.mCompressedUpdateFlags, flags, i); // <FS:Perf/> Compiled field access
 
 				compressed_dp.unpackUUID(fullid, "ID");
 				compressed_dp.unpackU32(local_id, "LocalID");
@@ -594,8 +643,12 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		else // OUT_FULL only?
 		{
 			update_cache = true;
-			mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, fullid, i);
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+			// <FS:Perf> Compiled field access
+			//mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, fullid, i);
+			//mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+			mesgsys->getUUIDFast(fields.mFullID, fullid, i);
+			mesgsys->getU32Fast(fields.mID, local_id, i);
+			// </FS:Perf>
 			LL_DEBUGS("ObjectUpdate") << "Full Update, obj " << local_id << ", global ID " << fullid << " from " << mesgsys->getSender() << LL_ENDL;
 		}
 		objectp = findObject(fullid);
@@ -669,7 +722,8 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 					continue;
 				}
 
-				mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, pcode, i);
+				//mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, pcode, i);
+				mesgsys->getU8Fast(fields.mPCode, pcode, i); // <FS:Perf/> Compiled field access
 
 			}
 #ifdef IGNORE_DEAD
@@ -792,9 +846,15 @@ void LLViewerObjectList::processCachedObjectUpdate(LLMessageSystem *mesgsys,
 		U32 id;
 		U32 crc;
 		U32 flags;
-		mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, id, i);
-		mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
-		mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+		// <FS:Perf> Compiled field access
+		//mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, id, i);
+		//mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
+		//mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+		const ObjectUpdateFields& fields = sObjectUpdateFields;
+		mesgsys->getU32Fast(fields.mCachedID, id, i);
+		mesgsys->getU32Fast(fields.mCachedCRC, crc, i);
+		mesgsys->getU32Fast(fields.mCachedUpdateFlags, flags, i);
+		// </FS:Perf>
 
         LL_DEBUGS("ObjectUpdate") << "got probe for id " << id << " crc " << crc << LL_ENDL;
         dumpStack("ObjectUpdateStack");
@@ -1052,6 +1112,8 @@ void LLViewerObjectList::update(LLAgent &agent)
 	}
 	else
 	{
+		LLVOAvatar::updateAnimationLODBias(); // <FS:Perf/> Animation LOD
+		LLVOAvatar::beginMotionBatch(); // <FS:Perf/> Parallel motion evaluation
 		for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
 			idle_iter != idle_end; idle_iter++)
 		{
@@ -1059,6 +1121,7 @@ void LLViewerObjectList::update(LLAgent &agent)
 			llassert(objectp->isActive());
                 objectp->idleUpdate(agent, frame_time);
 		}
+		LLVOAvatar::evaluateMotionBatch(); // <FS:Perf/> Parallel motion evaluation
 
 		//update flexible objects
 		LLVolumeImplFlexible::updateClass();
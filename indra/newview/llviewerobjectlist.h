@@ -89,6 +89,10 @@ public:
 	void processObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type, bool compressed=false);
 	void processCompressedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
 	void processCachedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
+	// <FS:Perf> Resolve the per-object fields of the object update
+	// messages, done when their handlers are registered
+	static void compileMessageFields(LLMessageSystem *mesgsys);
+	// </FS:Perf>
 	void updateApparentAngles(LLAgent &agent);
 	void update(LLAgent &agent);
 
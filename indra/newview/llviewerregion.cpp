@@ -68,6 +68,7 @@
 #include "llvlcomposition.h"
 #include "llvoavatarself.h"
 #include "llvocache.h"
+#include "llvocacheregionfile.h" // <FS:Perf/> Asynchronous region object cache
 #include "llworld.h"
 #include "llspatialpartition.h"
 #include "stringize.h"
@@ -222,6 +223,7 @@ public:
 	LLVLComposition *mCompositionp;		// Composition layer for the surface
 
 	LLVOCacheEntry::vocache_entry_map_t	  mCacheMap; //all cached entries
+	LLVOCacheRegionFile::ptr_t            mCacheFile; // <FS:Perf/> cache file records not yet in mCacheMap
 	LLVOCacheEntry::vocache_entry_set_t   mActiveSet; //all active entries;
 	LLVOCacheEntry::vocache_entry_set_t   mWaitingSet; //entries waiting for LLDrawable to be generated.	
 	std::set< LLPointer<LLViewerOctreeGroup> >      mVisibleGroups; //visible groupa
@@ -654,6 +656,8 @@ LLViewerRegion::LLViewerRegion(const U64 &handle,
 	mViewerAssetUrl(""),
 	mCacheLoaded(FALSE),
 	mCacheDirty(FALSE),
+	mCacheLoading(FALSE), // <FS:Perf/> Asynchronous region object cache
+	mHandshakeReplyPending(FALSE), // <FS:Perf/> Asynchronous region object cache
 	mReleaseNotesRequested(FALSE),
 	mCapabilitiesState(CAPABILITIES_STATE_INIT),
 	mSimulatorFeaturesReceived(false),
@@ -845,16 +849,55 @@ void LLViewerRegion::loadObjectCache()
 	if(LLVOCache::instanceExists())
 	{
         LLVOCache & vocache = LLVOCache::instance();
-		vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap);
+		// <FS:Perf> Asynchronous region object cache: the file is opened on the
+		// object cache thread, and entries are made from it as they are asked
+		// for, see getCacheEntry()
+		//vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap);
         vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD);
 
-		if (mImpl->mCacheMap.empty())
+		//if (mImpl->mCacheMap.empty())
+		//{
+		//	mCacheDirty = TRUE;
+		//}
+		mCacheLoading = TRUE;
+		const U64 handle = mHandle;
+		const LLUUID cache_id = mImpl->mCacheID;
+		vocache.readFromCacheAsync(mHandle, mImpl->mCacheID, [handle, cache_id](LLVOCacheRegionFile::ptr_t file)
 		{
-			mCacheDirty = TRUE;
-		}
+			// The region may have gone while the file was being opened
+			LLViewerRegion* regionp = LLWorld::instanceExists() ? LLWorld::getInstance()->getRegionFromHandle(handle) : NULL;
+			if (regionp)
+			{
+				regionp->onObjectCacheLoaded(cache_id, file);
+			}
+		});
+		// </FS:Perf>
 	}
 }
 
+// <FS:Perf> Asynchronous region object cache
+void LLViewerRegion::onObjectCacheLoaded(const LLUUID& cache_id, LLVOCacheRegionFile::ptr_t file)
+{
+	if (!mCacheLoading || cache_id != mImpl->mCacheID)
+	{
+		return;
+	}
+	mCacheLoading = FALSE;
+
+	mImpl->mCacheFile = file;
+	if (!file || !file->getNumEntries())
+	{
+		mCacheDirty = TRUE;
+	}
+
+	if (mHandshakeReplyPending)
+	{
+		mHandshakeReplyPending = FALSE;
+		sendRegionHandshakeReply();
+	}
+}
+// </FS:Perf>
+
 
 void LLViewerRegion::saveObjectCache()
 {
@@ -863,6 +906,14 @@ void LLViewerRegion::saveObjectCache()
 		return;
 	}
 
+	// <FS:Perf> Asynchronous region object cache: nothing was read, don't
+	// replace the file with what little came in since
+	if (mCacheLoading)
+	{
+		return;
+	}
+	// </FS:Perf>
+
 	if (mImpl->mCacheMap.empty())
 	{
 		return;
@@ -875,7 +926,10 @@ void LLViewerRegion::saveObjectCache()
 
         LLVOCache & instance = LLVOCache::instance();
 
-        instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled);
+        // <FS:Perf> Asynchronous region object cache
+        //instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled);
+        instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, std::move(mImpl->mCacheFile), mCacheDirty, removal_enabled);
+        // </FS:Perf>
         instance.writeGenericExtrasToCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mCacheDirty, removal_enabled);
 		mCacheDirty = FALSE;
 	}
@@ -883,6 +937,7 @@ void LLViewerRegion::saveObjectCache()
 	// Map of LLVOCacheEntry takes time to release, store map for cleanup on idle
 	sRegionCacheCleanup.insert(mImpl->mCacheMap.begin(), mImpl->mCacheMap.end());
 	mImpl->mCacheMap.clear();
+	mImpl->mCacheFile.reset(); // <FS:Perf/> Asynchronous region object cache
 	// TODO - probably need to do the same for overrides cache
 }
 
@@ -2903,6 +2958,19 @@ LLVOCacheEntry* LLViewerRegion::getCacheEntry(U32 local_id, bool valid)
 			return iter->second;
 		}
 	}
+	// <FS:Perf> Asynchronous region object cache: make the entry from its
+	// record in the cache file the first time it is asked for. Entries
+	// read from the file start out invalid, as they always did.
+	else if (mImpl->mCacheFile && !valid)
+	{
+		LLPointer<LLVOCacheEntry> entry = mImpl->mCacheFile->createEntry(local_id);
+		if (entry.notNull())
+		{
+			mImpl->mCacheMap[local_id] = entry;
+			return entry;
+		}
+	}
+	// </FS:Perf>
 	return NULL;
 }
 
@@ -3280,10 +3348,29 @@ void LLViewerRegion::unpackRegionHandshake()
 	// off disk.
 	loadObjectCache();
 
+	// <FS:Perf> Asynchronous region object cache: the reply goes once the
+	// cache file is open, so the simulator knows whether to send probes
+	if (mCacheLoading)
+	{
+		mHandshakeReplyPending = TRUE;
+	}
+	else
+	{
+		sendRegionHandshakeReply();
+	}
+}
+
+void LLViewerRegion::sendRegionHandshakeReply()
+{
+	LLMessageSystem* msg = gMessageSystem;
+	// </FS:Perf>
 	// After loading cache, signal that simulator can start
 	// sending data.
 	// TODO: Send all upstream viewer->sim handshake info here.
-	LLHost host = msg->getSender();
+	// <FS:Perf> Asynchronous region object cache
+	//LLHost host = msg->getSender();
+	LLHost host = getHost();
+	// </FS:Perf>
 	msg->newMessage("RegionHandshakeReply");
 	msg->nextBlock("AgentData");
 	msg->addUUID("AgentID", gAgent.getID());
@@ -3297,7 +3384,10 @@ void LLViewerRegion::unpackRegionHandshake()
 	{
 		flags |= 0x00000001; //set the bit 0 to be 1 to ask sim to send all cacheable objects.		
 	}
-	if(mImpl->mCacheMap.empty())
+	// <FS:Perf> Asynchronous region object cache
+	//if(mImpl->mCacheMap.empty())
+	if(mImpl->mCacheMap.empty() && (!mImpl->mCacheFile || !mImpl->mCacheFile->getNumEntries()))
+	// </FS:Perf>
 	{
 		flags |= 0x00000002; //set the bit 1 to be 1 to tell sim the cache file is empty, no need to send cache probes.
 	}
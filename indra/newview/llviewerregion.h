@@ -61,6 +61,7 @@ class LLViewerParcelOverlay;
 class LLSurface;
 class LLVOCache;
 class LLVOCacheEntry;
+class LLVOCacheRegionFile; // <FS:Perf/> Asynchronous region object cache
 class LLSpatialPartition;
 class LLEventPump;
 class LLDataPacker;
@@ -112,6 +113,13 @@ public:
 	// Call this after you have the region name and handle.
 	void loadObjectCache();
 	void saveObjectCache();
+	// <FS:Perf> Asynchronous region object cache
+	// Called on the main thread once the cache file of the region is open,
+	// with NULL if it has none
+	void onObjectCacheLoaded(const LLUUID& cache_id, std::shared_ptr<LLVOCacheRegionFile> file);
+	// Tells the simulator it can start sending objects
+	void sendRegionHandshakeReply();
+	// </FS:Perf>
 
 	void sendMessage(); // Send the current message to this region's simulator
 	void sendReliableMessage(); // Send the current message to this region's simulator
@@ -595,6 +603,10 @@ public:
 	// a structure of size 2^14 = 16,000
 	BOOL									mCacheLoaded;
 	BOOL                                    mCacheDirty;
+	// <FS:Perf> Asynchronous region object cache
+	BOOL                                    mCacheLoading;  // cache file being opened on the object cache thread
+	BOOL                                    mHandshakeReplyPending; // RegionHandshakeReply waits for the cache file
+	// </FS:Perf>
 	BOOL	mAlive;					// can become false if circuit disconnects
 	BOOL	mSimulatorFeaturesReceived;
 	BOOL    mReleaseNotesRequested;
@@ -207,6 +207,10 @@ LLTrace::SampleStatHandle<>	FPS_SAMPLE("fpssample"),
 LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> > 
 							PACKETS_LOST_PERCENT("packetslostpercentstat");
 
+// <FS:Perf> Batched receive
+LLTrace::SampleStatHandle<> PACKETS_PER_RECEIVE_CALL("packetsperreceivecall", "Packets received per receive system call");
+// </FS:Perf>
+
 static LLTrace::SampleStatHandle<bool> 
 							CHAT_BUBBLES("chatbubbles", "Chat Bubbles Enabled");
 
@@ -197,6 +197,8 @@ extern LLTrace::SampleStatHandle<>		FPS_SAMPLE,
 
 extern LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> > PACKETS_LOST_PERCENT;
 
+extern LLTrace::SampleStatHandle<> PACKETS_PER_RECEIVE_CALL; // <FS:Perf/> Batched receive
+
 extern LLTrace::SampleStatHandle<F64Megabytes > FORMATTED_MEM;
 
 extern LLTrace::SampleStatHandle<F64Kilobytes >	DELTA_BANDWIDTH,
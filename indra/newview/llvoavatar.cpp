@@ -120,6 +120,7 @@
 #include "llskinningutil.h"
 
 #include "llperfstats.h"
+#include "parallelfor.h" // <FS:Perf/> Parallel motion evaluation
 
 #include <boost/lexical_cast.hpp>
 
@@ -633,6 +634,7 @@ BOOL LLVOAvatar::sShowAnimationDebug = FALSE;
 BOOL LLVOAvatar::sVisibleInFirstPerson = FALSE;
 F32 LLVOAvatar::sLODFactor = 1.f;
 F32 LLVOAvatar::sPhysicsLODFactor = 1.f;
+U32 LLVOAvatar::sAnimationLODBias = 0; // <FS:Perf/> Animation LOD
 BOOL LLVOAvatar::sJointDebug = FALSE;
 F32 LLVOAvatar::sUnbakedTime = 0.f;
 F32 LLVOAvatar::sUnbakedUpdateTime = 0.f;
@@ -642,6 +644,37 @@ LLPointer<LLViewerTexture> LLVOAvatar::sCloudTexture = NULL;
 std::vector<LLUUID> LLVOAvatar::sAVsIgnoringARTLimit;
 S32 LLVOAvatar::sAvatarsNearby = 0;
 
+// <FS:Perf> Parallel motion evaluation
+namespace
+{
+	// Below this many avatars per pool thread, posting costs more than it saves
+	constexpr size_t MOTION_BATCH_GRAIN = 4;
+
+	struct MotionBatchEntry
+	{
+		LLPointer<LLVOAvatar> mAvatar;
+		bool mWasSitGroundConstrained;
+		U64 mEvaluateTime; // CPU clock counts spent in evaluateMotions()
+	};
+
+	struct DeferredIdleUpdate
+	{
+		LLPointer<LLVOAvatar> mAvatar;
+		F64 mTime;
+	};
+
+	bool sMotionBatchOpen = false;
+	std::vector<MotionBatchEntry> sMotionBatch;
+	// Animesh attached to a batched avatar, updated once its pose is committed
+	std::vector<DeferredIdleUpdate> sDeferredAttachments;
+
+	// Animation LOD: level n evaluates motions once every 2^n frames
+	constexpr U32 ANIMATION_LOD_MAX_LEVEL = 3;
+	// Frames for a bias change to show up in the stats before the next one
+	constexpr U32 ANIMATION_LOD_BIAS_INTERVAL = 30;
+}
+// </FS:Perf>
+
 //-----------------------------------------------------------------------------
 // Helper functions
 //-----------------------------------------------------------------------------
@@ -2821,6 +2854,18 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
 	mLastRootPos = mRoot->getWorldPosition();
 	BOOL detailed_update = updateCharacter(agent);
 
+	// <FS:Perf> Parallel motion evaluation
+	if (mMotionUpdateDeferred)
+	{
+		// evaluateMotionBatch() finishes this update
+		return;
+	}
+	idleUpdateAfterCharacter(detailed_update);
+}
+
+void LLVOAvatar::idleUpdateAfterCharacter(BOOL detailed_update)
+{
+	// </FS:Perf>
 	static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
 	bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
 						 LLVoiceClient::getInstance()->getVoiceEnabled(mID);
@@ -5037,6 +5082,92 @@ void LLVOAvatar::updateTimeStep()
 	// </FS:Zi>
 }
 
+// <FS:Perf> Animation LOD
+//------------------------------------------------------------------------
+// updateAnimationLOD()
+// Avatars that are small on screen get their motions evaluated less
+// often, and are blended towards the last evaluated pose in between.
+// Each halving of the avatar's height on screen below
+// AvatarAnimationLODPixelArea halves the rate, and from level
+// AvatarAnimationLODBaseJoints on only the base skeleton is animated.
+// sAnimationLODBias moves everyone further down while animation is over
+// its budget. Impostors already update at their own, slower rate.
+//------------------------------------------------------------------------
+void LLVOAvatar::updateAnimationLOD()
+{
+	static LLCachedControl<bool> animation_lod(gSavedSettings, "AvatarAnimationLOD", false);
+	static LLCachedControl<F32> full_rate_area(gSavedSettings, "AvatarAnimationLODPixelArea", 40000.f);
+	static LLCachedControl<U32> base_joints_level(gSavedSettings, "AvatarAnimationLODBaseJoints", 2);
+
+	U32 level = 0;
+	if (animation_lod && full_rate_area > 0.f
+		&& !isSelf() && !isUIAvatar() && mSpecialRenderMode == 0 && mUpdatePeriod == 1)
+	{
+		// quartering the area halves the height
+		F32 steps = 0.5f * log2f(full_rate_area / llmax(mPixelArea, 1.f)) + (F32)sAnimationLODBias;
+		if (steps >= 0.f)
+		{
+			level = llmin((U32)steps + 1, ANIMATION_LOD_MAX_LEVEL);
+		}
+	}
+	mMotionController.setAnimationLOD(1 << level, base_joints_level > 0 && level >= base_joints_level);
+}
+
+//------------------------------------------------------------------------
+// updateAnimationLODBias()
+// Raises sAnimationLODBias while the animation time of the last frame
+// is over AvatarAnimationLODBudget, or autotune finds the frame rate
+// below its target, and lowers it again once well under budget.
+//------------------------------------------------------------------------
+// static
+void LLVOAvatar::updateAnimationLODBias()
+{
+	static LLCachedControl<bool> animation_lod(gSavedSettings, "AvatarAnimationLOD", false);
+	static LLCachedControl<F32> budget_ms(gSavedSettings, "AvatarAnimationLODBudget", 0.f);
+	static U32 last_change_frame = 0;
+
+	if (!animation_lod)
+	{
+		sAnimationLODBias = 0;
+		return;
+	}
+	if (gFrameCount - last_change_frame < ANIMATION_LOD_BIAS_INTERVAL)
+	{
+		return;
+	}
+
+	bool over_budget = LLPerfStats::tunables.userAutoTuneEnabled && LLPerfStats::belowTargetFPS;
+	bool under_budget = !over_budget;
+	if (budget_ms > 0.f && LLPerfStats::StatsRecorder::enabled())
+	{
+		LLPerfStats::bufferToggleLock.lock();
+		auto animation_time_raw = LLPerfStats::StatsRecorder::getSceneStat(LLPerfStats::StatType_t::RENDER_ANIMATION);
+		LLPerfStats::bufferToggleLock.unlock();
+
+		// each level roughly halves the time, so step back down only below half the budget
+		F64 animation_ms = LLPerfStats::raw_to_ms(animation_time_raw);
+		over_budget = over_budget || animation_ms > budget_ms;
+		under_budget = under_budget && animation_ms < budget_ms * 0.5f;
+	}
+
+	U32 bias = sAnimationLODBias;
+	if (over_budget && bias < ANIMATION_LOD_MAX_LEVEL)
+	{
+		bias++;
+	}
+	else if (under_budget && bias > 0)
+	{
+		bias--;
+	}
+	if (bias != sAnimationLODBias)
+	{
+		LL_DEBUGS("AnimationLOD") << "Animation LOD bias " << sAnimationLODBias << " -> " << bias << LL_ENDL;
+		sAnimationLODBias = bias;
+		last_change_frame = gFrameCount;
+	}
+}
+// </FS:Perf>
+
 void LLVOAvatar::updateRootPositionAndRotation(LLAgent& agent, F32 speed, bool was_sit_ground_constrained) 
 {
 	if (!(isSitting() && getParent()))
@@ -5296,6 +5427,7 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
 	//--------------------------------------------------------------------
     // SL-763 the time step quantization does not currently work.
     //updateTimeStep();
+	updateAnimationLOD(); // <FS:Perf/> Animation LOD
     
 	//--------------------------------------------------------------------
     // Update sitting state based on parent and active animation info.
@@ -5338,6 +5470,11 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
 	// store data relevant to motions
 	mSpeed = speed;
 
+	// <FS:Perf> Parallel motion evaluation: time the motions and the joint updates after them
+	LLPerfStats::RecordAvatarTime T(getID(), LLUUID::null, LLPerfStats::StatType_t::RENDER_ANIMATION);
+	LLPerfStats::RecordSceneTime T_scene(LLPerfStats::StatType_t::RENDER_ANIMATION);
+	// </FS:Perf>
+
 	// update animations
 	if (!visible)
 	{
@@ -5347,12 +5484,31 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
 	{
 		updateMotions(LLCharacter::FORCE_UPDATE);
 	}
+	// <FS:Perf> Parallel motion evaluation
+	else if (canBatchMotions())
+	{
+		if (prepareMotionUpdate(LLCharacter::NORMAL_UPDATE))
+		{
+			sMotionBatch.push_back({ this, was_sit_ground_constrained, 0 });
+			mMotionUpdateDeferred = true;
+			return visible;
+		}
+	}
+	// </FS:Perf>
 	else
 	{
 		// Might be better to do HIDDEN_UPDATE if cloud
 		updateMotions(LLCharacter::NORMAL_UPDATE);
 	}
 
+	// <FS:Perf> Parallel motion evaluation
+	finishCharacterUpdate(visible, was_sit_ground_constrained);
+	return visible;
+}
+
+void LLVOAvatar::finishCharacterUpdate(bool visible, bool was_sit_ground_constrained)
+{
+	// </FS:Perf>
 	// Special handling for sitting on ground.
 	if (!getParent() && (isSitting() || was_sit_ground_constrained))
 	{
@@ -5383,9 +5539,172 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
 		mNeedsSkin = TRUE;
     }
 
-	return visible;
+	//return visible; // <FS:Perf/> Parallel motion evaluation
 }
 
+// <FS:Perf> Parallel motion evaluation
+//-----------------------------------------------------------------------------
+// canBatchMotions()
+//-----------------------------------------------------------------------------
+bool LLVOAvatar::canBatchMotions()
+{
+	// Your own avatar sends stop requests to the simulator and drives the
+	// camera, so it keeps updating in place. Animesh attached to an avatar
+	// follows that avatar's attachment points: deferIdleUpdate() holds it
+	// back until the batch is done, and it updates in place then.
+	if (!sMotionBatchOpen || isSelf() || isUIAvatar())
+	{
+		return false;
+	}
+	if (isControlAvatar())
+	{
+		LLControlAvatar* cav = dynamic_cast<LLControlAvatar*>(this);
+		return cav && !(cav->mRootVolp && cav->mRootVolp->isAttachment());
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// deferIdleUpdate()
+//-----------------------------------------------------------------------------
+bool LLVOAvatar::deferIdleUpdate(const F64& time)
+{
+	if (!sMotionBatchOpen || !isControlAvatar())
+	{
+		return false;
+	}
+	// The avatar this is attached to may be batched before or after this
+	// point in the idle loop, and its pose is only committed at the end.
+	LLVOAvatar* attached_av = static_cast<LLControlAvatar*>(this)->getAttachedAvatar();
+	if (!attached_av || !attached_av->canBatchMotions())
+	{
+		return false;
+	}
+	sDeferredAttachments.push_back({ this, time });
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// beginMotionBatch()
+//-----------------------------------------------------------------------------
+// static
+void LLVOAvatar::beginMotionBatch()
+{
+	static LLCachedControl<bool> parallel_animation(gSavedSettings, "AvatarParallelAnimation", false);
+	sMotionBatchOpen = parallel_animation;
+}
+
+//-----------------------------------------------------------------------------
+// update_deferred_attachments()
+//-----------------------------------------------------------------------------
+static void update_deferred_attachments(std::vector<DeferredIdleUpdate>& attachments)
+{
+	// The batch is closed, so these follow the committed poses in place
+	for (DeferredIdleUpdate& deferred : attachments)
+	{
+		if (!deferred.mAvatar->isDead())
+		{
+			deferred.mAvatar->idleUpdate(gAgent, deferred.mTime);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotionBatch()
+//-----------------------------------------------------------------------------
+// static
+void LLVOAvatar::evaluateMotionBatch()
+{
+	LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+	sMotionBatchOpen = false;
+	std::vector<MotionBatchEntry> batch;
+	batch.swap(sMotionBatch);
+	std::vector<DeferredIdleUpdate> attachments;
+	attachments.swap(sDeferredAttachments);
+	if (batch.empty())
+	{
+		update_deferred_attachments(attachments);
+		return;
+	}
+
+	{
+		LLPerfStats::RecordSceneTime T(LLPerfStats::StatType_t::RENDER_ANIMATION);
+
+		// Each avatar's motions, joints and visual params belong to the one
+		// thread evaluating it. Anything with effects beyond the avatar is
+		// left for commitMotionUpdate() and updateVisualParams() below.
+		// The few process wide things motions touch while updating are
+		// made safe to share first: LLBodyNoiseMotion's noise tables are
+		// set up on first use, and LLSmoothInterpolation's cache grows on
+		// lookup. LLEyeMotion has its own random number generator.
+		if (gNoiseStart)
+		{
+			gNoiseStart = 0;
+			::init();
+		}
+		LLSmoothInterpolation::lockCache(true);
+		LL::parallelFor("General", batch.size(), MOTION_BATCH_GRAIN,
+						[&batch](size_t begin, size_t end)
+						{
+							for (size_t i = begin; i < end; ++i)
+							{
+								MotionBatchEntry& entry = batch[i];
+								LLVOAvatar* avatar = entry.mAvatar;
+								if (avatar->isDead())
+								{
+									continue;
+								}
+								const U64 start = LLTrace::BlockTimer::getCPUClockCount64();
+								avatar->mEvaluatingMotions = true;
+								avatar->mMotionController.evaluateMotions();
+								avatar->mEvaluatingMotions = false;
+								entry.mEvaluateTime = LLTrace::BlockTimer::getCPUClockCount64() - start;
+							}
+						});
+		LLSmoothInterpolation::lockCache(false);
+
+		// Commit every pose before any avatar goes on with its idle update
+		for (MotionBatchEntry& entry : batch)
+		{
+			LLVOAvatar* avatar = entry.mAvatar;
+			if (avatar->isDead())
+			{
+				continue;
+			}
+			LLPerfStats::RecordAvatarTime T_av(avatar->getID(), LLUUID::null, LLPerfStats::StatType_t::RENDER_ANIMATION);
+			avatar->mMotionController.commitMotionUpdate();
+			if (avatar->mVisualParamUpdateDeferred)
+			{
+				avatar->mVisualParamUpdateDeferred = false;
+				avatar->updateVisualParams();
+			}
+			avatar->finishCharacterUpdate(true, entry.mWasSitGroundConstrained);
+		}
+	}
+
+	for (MotionBatchEntry& entry : batch)
+	{
+		LLVOAvatar* avatar = entry.mAvatar;
+		avatar->mMotionUpdateDeferred = false;
+		if (avatar->isDead())
+		{
+			continue;
+		}
+		if (entry.mEvaluateTime && LLPerfStats::StatsRecorder::enabled())
+		{
+			LLPerfStats::StatsRecorder::send(LLPerfStats::StatsRecord{ LLPerfStats::StatType_t::RENDER_ANIMATION,
+																		LLPerfStats::ObjType_t::OT_AVATAR,
+																		avatar->getID(), LLUUID::null,
+																		entry.mEvaluateTime });
+		}
+		// Deferred avatars are always visible ones
+		avatar->idleUpdateAfterCharacter(TRUE);
+	}
+
+	update_deferred_attachments(attachments);
+}
+// </FS:Perf>
+
 //-----------------------------------------------------------------------------
 // updateHeadOffset()
 //-----------------------------------------------------------------------------
@@ -7829,6 +8148,15 @@ void LLVOAvatar::initAttachmentPoints(bool ignore_hud_joints)
 //-----------------------------------------------------------------------------
 void LLVOAvatar::updateVisualParams()
 {
+	// <FS:Perf> Parallel motion evaluation
+	if (mEvaluatingMotions)
+	{
+		// Asked for by a motion on a worker thread, done when its pose is committed
+		mVisualParamUpdateDeferred = true;
+		return;
+	}
+	// </FS:Perf>
+
 	ESex avatar_sex = (getVisualParamWeight("male") > 0.5f) ? SEX_MALE : SEX_FEMALE;
 	if (getSex() != avatar_sex)
 	{
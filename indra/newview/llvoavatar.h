@@ -280,6 +280,10 @@ public:
     void			computeUpdatePeriod();
     void			updateOrientation(LLAgent &agent, F32 speed, F32 delta_time);
     void			updateTimeStep();
+	// <FS:Perf> Animation LOD
+	void			updateAnimationLOD();
+	static void		updateAnimationLODBias(); // once per frame, before the avatars' idle updates
+	// </FS:Perf>
     void			updateRootPositionAndRotation(LLAgent &agent, F32 speed, bool was_sit_ground_constrained);
     
 	void 			idleUpdateVoiceVisualizer(bool voice_enabled);
@@ -359,6 +363,28 @@ public:
 
 	static void updateNearbyAvatarCount();
 
+	// <FS:Perf> Parallel motion evaluation
+	// LLViewerObjectList::update() opens a batch around its idleUpdate()
+	// loop when AvatarParallelAnimation is on. Avatars that need a full
+	// motion update while it is open only prepare it. evaluateMotionBatch()
+	// then evaluates all of their poses at once on the "General" thread
+	// pool, commits them, and finishes those avatars' idle updates.
+	// Animesh attached to a batched avatar holds its whole idle update back
+	// until then, so that it follows the pose committed this frame.
+	static void		beginMotionBatch();
+	static void		evaluateMotionBatch();
+	bool			deferIdleUpdate(const F64& time);
+private:
+	bool			canBatchMotions();
+	void			finishCharacterUpdate(bool visible, bool was_sit_ground_constrained);
+	void			idleUpdateAfterCharacter(BOOL detailed_update);
+
+	bool			mMotionUpdateDeferred = false; // waiting in the batch
+	bool			mEvaluatingMotions = false; // set on the thread evaluating this avatar
+	bool			mVisualParamUpdateDeferred = false; // asked for by a motion while evaluating
+public:
+	// </FS:Perf>
+
 	//--------------------------------------------------------------------
 	// Static preferences (controlled by user settings/menus)
 	//--------------------------------------------------------------------
@@ -379,6 +405,7 @@ public:
 	static BOOL		sShowAttachmentPoints;
 	static F32		sLODFactor; // user-settable LOD factor
 	static F32		sPhysicsLODFactor; // user-settable physics LOD factor
+	static U32		sAnimationLODBias; // <FS:Perf/> extra animation LOD levels while animation is over budget
 	static BOOL		sJointDebug; // output total number of joints being touched for each avatar
 	static LLPartSysData sCloud;
 
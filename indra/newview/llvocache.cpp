@@ -34,6 +34,12 @@
 #include "llagentcamera.h"
 #include "llsdserialize.h"
 #include "llagent.h" // <FS:Beq/> For gAgent
+// <FS:Perf> Asynchronous, memory mapped region object cache
+#include "llfile.h"
+#include "llvocacheregionfile.h"
+#include "threadpool.h"
+#include "workqueue.h"
+// </FS:Perf>
 
 //static variables
 U32 LLVOCacheEntry::sMinFrameRange = 0;
@@ -43,8 +49,10 @@ F32 LLVOCacheEntry::sFrontPixelThreshold = 1.0f;
 F32 LLVOCacheEntry::sRearPixelThreshold = 1.0f;
 BOOL LLVOCachePartition::sNeedsOcclusionCheck = FALSE;
 
-const S32 ENTRY_HEADER_SIZE = 6 * sizeof(S32);
-const S32 MAX_ENTRY_BODY_SIZE = 10000;
+// <FS:Perf> Moved to llvocache.h, LLVOCacheRegionFile uses them too
+//const S32 ENTRY_HEADER_SIZE = 6 * sizeof(S32);
+//const S32 MAX_ENTRY_BODY_SIZE = 10000;
+// </FS:Perf>
 
 BOOL check_read(LLAPRFile* apr_file, void* src, S32 n_bytes) 
 {
@@ -254,6 +262,56 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
 	}
 }
 
+// <FS:Perf> Asynchronous, memory mapped region object cache
+LLVOCacheEntry::LLVOCacheEntry(const U8* record, S32 record_size)
+:	LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY), 
+	mBuffer(NULL),
+	mUpdateFlags(-1),
+	mState(INACTIVE),
+	mSceneContrib(0.f),
+	mValid(FALSE),
+	mParentID(0),
+	mBSphereRadius(-1.0f)
+{
+	S32 size = -1;
+	BOOL success = record_size > ENTRY_HEADER_SIZE;
+
+	mDP.assignBuffer(mBuffer, 0);
+
+	if (success)
+	{
+		memcpy(&mLocalID, record, sizeof(U32));
+		memcpy(&mCRC, record + sizeof(U32), sizeof(U32));
+		memcpy(&mHitCount, record + (2 * sizeof(U32)), sizeof(S32));
+		memcpy(&mDupeCount, record + (3 * sizeof(U32)), sizeof(S32));
+		memcpy(&mCRCChangeCount, record + (4 * sizeof(U32)), sizeof(S32));
+		memcpy(&size, record + (5 * sizeof(U32)), sizeof(S32));
+
+		// Corruption in the cache entries
+		if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1) || (size != record_size - ENTRY_HEADER_SIZE))
+		{
+			LL_WARNS() << "Bogus cache entry, size " << size << ", record size " << record_size << LL_ENDL;
+			success = FALSE;
+		}
+	}
+	if (success)
+	{
+		mBuffer = new U8[size];
+		memcpy(mBuffer, record + ENTRY_HEADER_SIZE, size);
+		mDP.assignBuffer(mBuffer, size);
+	}
+	else
+	{
+		mLocalID = 0;
+		mCRC = 0;
+		mHitCount = 0;
+		mDupeCount = 0;
+		mCRCChangeCount = 0;
+		mEntry = NULL;
+	}
+}
+// </FS:Perf>
+
 LLVOCacheEntry::~LLVOCacheEntry()
 {
 	mDP.freeBuffer();
@@ -1136,6 +1194,7 @@ void LLVOCachePartition::removeOccluder(LLVOCacheGroup* group)
 	}
 	mOccludedGroups.erase(group);
 }
+
 //-------------------------------------------------------------------
 //LLVOCache
 //-------------------------------------------------------------------
@@ -1148,6 +1207,7 @@ const U32 MIN_ENTRIES_TO_PURGE = 16 ;
 const U32 INVALID_TIME = 0 ;
 const char* object_cache_dirname = "objectcache";
 const char* header_filename = "object.cache";
+static const char VOCACHE_THREAD_NAME[] = "VOCache"; // <FS:Perf/> Asynchronous region object cache
 
 
 LLVOCache::LLVOCache(bool read_only) :
@@ -1159,12 +1219,23 @@ LLVOCache::LLVOCache(bool read_only) :
 {
 #ifndef LL_TEST
 	mEnabled = gSavedSettings.getBOOL("ObjectCacheEnabled");
+	// <FS:Perf> Asynchronous region object cache
+	mThreadPool.reset(new LL::ThreadPool(VOCACHE_THREAD_NAME, 1));
+	mThreadPool->start();
+	// </FS:Perf>
 #endif
 	mLocalAPRFilePoolp = new LLVolatileAPRPool() ;
 }
 
 LLVOCache::~LLVOCache()
 {
+	// <FS:Perf> Asynchronous region object cache: finish the pending writes
+	if (mThreadPool)
+	{
+		mThreadPool->close();
+		mThreadPool.reset();
+	}
+	// </FS:Perf>
 	if(mEnabled)
 	{
 		writeCacheHeader();
@@ -1173,6 +1244,22 @@ LLVOCache::~LLVOCache()
 	delete mLocalAPRFilePoolp;
 }
 
+// <FS:Perf> Asynchronous region object cache
+template <typename WORK, typename DONE>
+bool LLVOCache::postToCacheThread(const WORK& work, const DONE& callback)
+{
+	if (!mThreadPool)
+	{
+		return false;
+	}
+
+	LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+	LL::WorkQueue::ptr_t cache_queue = LL::WorkQueue::getInstance(VOCACHE_THREAD_NAME);
+	// Copies, so that the caller can still run them itself if posting fails
+	return main_queue && cache_queue && main_queue->postTo(cache_queue, WORK(work), DONE(callback));
+}
+// </FS:Perf>
+
 void LLVOCache::setDirNames(ELLPath location)
 {
 	mHeaderFileName = gDirUtilp->getExpandedFilename(location, object_cache_dirname, header_filename);
@@ -1358,7 +1445,18 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
 
 	std::string filename;
 	getObjectCacheFilename(entry->mHandle, filename);
-	LLAPRFile::remove(filename, mLocalAPRFilePoolp);
+	// <FS:Perf> Asynchronous region object cache: in order with the reads
+	// and writes queued for the file
+	//LLAPRFile::remove(filename, mLocalAPRFilePoolp);
+	auto remove_file = [filename]()
+	{
+		return LLFile::remove(filename, ENOENT) == 0;
+	};
+	if (!postToCacheThread(remove_file, [](bool) {}))
+	{
+		remove_file();
+	}
+	// </FS:Perf>
 	entry->mTime = INVALID_TIME ;
 	updateEntry(entry) ; //update the head file.
 }
@@ -1524,56 +1622,115 @@ void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
 		return ;
 	}
 
-	bool success = true ;
+	// <FS:Perf> Memory mapped region object cache
+//	bool success = true ;
+//	{
+//		std::string filename;
+//		LLUUID cache_id;
+//		getObjectCacheFilename(handle, filename);
+//		LLAPRFile apr_file(filename, APR_READ|APR_BINARY, mLocalAPRFilePoolp);
+//
+//		success = check_read(&apr_file, cache_id.mData, UUID_BYTES);
+//
+//		if(success)
+//		{		
+//			if(cache_id != id)
+//			{
+//				LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
+//				success = false ;
+//			}
+//
+//			if(success)
+//			{
+//				S32 num_entries;  // if removal was enabled during write num_entries might be wrong
+//				success = check_read(&apr_file, &num_entries, sizeof(S32)) ;
+//
+//				if(success)
+//				{
+//					for (S32 i = 0; i < num_entries && apr_file.eof() != APR_EOF; i++)
+//					{
+//						LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(&apr_file);
+//						if (!entry->getLocalID())
+//						{
+//							LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
+//							success = false ;
+//							break ;
+//						}
+//						cache_entry_map[entry->getLocalID()] = entry;
+//					}
+//				}
+//			}
+//		}		
+//	}
+//
+//	if(!success)
+//	{
+//		if(cache_entry_map.empty())
+//		{
+//			removeEntry(iter->second) ;
+//		}
+//	}
+//
+//	return ;
+	std::string filename;
+	getObjectCacheFilename(handle, filename);
+	LLVOCacheRegionFile::ptr_t file = LLVOCacheRegionFile::open(filename, id);
+	if (file)
 	{
-		std::string filename;
-		LLUUID cache_id;
-		getObjectCacheFilename(handle, filename);
-		LLAPRFile apr_file(filename, APR_READ|APR_BINARY, mLocalAPRFilePoolp);
-	
-		success = check_read(&apr_file, cache_id.mData, UUID_BYTES);
-	
-		if(success)
-		{		
-			if(cache_id != id)
-			{
-				LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
-				success = false ;
-			}
+		file->createAllEntries(cache_entry_map);
+	}
+	else if (cache_entry_map.empty())
+	{
+		removeEntry(iter->second);
+	}
+	// </FS:Perf>
+}
 
-			if(success)
-			{
-				S32 num_entries;  // if removal was enabled during write num_entries might be wrong
-				success = check_read(&apr_file, &num_entries, sizeof(S32)) ;
-	
-				if(success)
-				{
-					for (S32 i = 0; i < num_entries && apr_file.eof() != APR_EOF; i++)
-					{
-						LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(&apr_file);
-						if (!entry->getLocalID())
-						{
-							LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
-							success = false ;
-							break ;
-						}
-						cache_entry_map[entry->getLocalID()] = entry;
-					}
-				}
-			}
-		}		
+// <FS:Perf> Asynchronous region object cache
+void LLVOCache::readFromCacheAsync(U64 handle, const LLUUID& id, read_callback_t callback)
+{
+	if(!mEnabled)
+	{
+		LL_WARNS() << "Not reading cache for handle " << handle << "): Cache is currently disabled." << LL_ENDL;
+		callback(LLVOCacheRegionFile::ptr_t());
+		return ;
 	}
-	
-	if(!success)
+	llassert_always(mInitialized);
+
+	if(mHandleEntryMap.find(handle) == mHandleEntryMap.end()) //no cache
+	{
+		LL_WARNS() << "No handle map entry for " << handle << LL_ENDL;
+		callback(LLVOCacheRegionFile::ptr_t());
+		return ;
+	}
+
+	std::string filename;
+	getObjectCacheFilename(handle, filename);
+
+	auto open_file = [filename, id]()
 	{
-		if(cache_entry_map.empty())
+		LLVOCacheRegionFile::ptr_t file = LLVOCacheRegionFile::open(filename, id);
+		if (file)
 		{
-			removeEntry(iter->second) ;
+			file->prefetch();
 		}
-	}
+		return file;
+	};
+	auto file_opened = [handle, callback](LLVOCacheRegionFile::ptr_t file)
+	{
+		if (!file && LLVOCache::instanceExists())
+		{
+			LLVOCache::instance().removeEntry(handle);
+		}
+		callback(file);
+	};
 
-	return ;
+	if (!postToCacheThread(open_file, file_opened))
+	{
+		file_opened(open_file());
+	}
 }
+// </FS:Perf>
 
 void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map)
 {
@@ -1666,7 +1823,10 @@ void LLVOCache::purgeEntries(U32 size)
 	mNumEntries = mHandleEntryMap.size() ;
 }
 
-void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled) 
+// <FS:Perf> Asynchronous, memory mapped region object cache
+//void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled) 
+void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheRegionFile::ptr_t file, BOOL dirty_cache, bool removal_enabled)
+// </FS:Perf>
 {
 	if(!mEnabled)
 	{
@@ -1722,71 +1882,99 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
 		return ; //nothing changed, no need to update.
 	}
 
-	//write to cache file
-	bool success = true ;
+	// <FS:Perf> Asynchronous, memory mapped region object cache: the image
+	// is made here, where the entries live, and written on the cache thread
+//	//write to cache file
+//	bool success = true ;
+//	{
+//		std::string filename;
+//		getObjectCacheFilename(handle, filename);
+//		LLAPRFile apr_file(filename, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, mLocalAPRFilePoolp);
+//
+//		success = check_write(&apr_file, (void*)id.mData, UUID_BYTES);
+//
+//		if(success)
+//		{
+//			S32 num_entries = cache_entry_map.size(); // if removal is enabled num_entries might be wrong
+//			success = check_write(&apr_file, &num_entries, sizeof(S32));
+//            if (success)
+//            {
+//                const S32 buffer_size = 32768; //should be large enough for couple MAX_ENTRY_BODY_SIZE
+//                U8 data_buffer[buffer_size]; // generaly entries are fairly small, so collect them and drop onto disk in one go
+//                S32 size_in_buffer = 0;
+//
+//                // This can have a lot of entries, so might be better to dump them into buffer first and write in one go.
+//                for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
+//                {
+//                    if (!removal_enabled || iter->second->isValid())
+//                    {
+//                        S32 size = iter->second->writeToBuffer(data_buffer + size_in_buffer);
+//
+//                        if (size > ENTRY_HEADER_SIZE) // body is minimum of 1
+//                        {
+//                            size_in_buffer += size;
+//                        }
+//                        else
+//                        {
+//                            success = false;
+//                            break;
+//                        }
+//
+//                        // Make sure we have space in buffer for next element
+//                        if (buffer_size - size_in_buffer < MAX_ENTRY_BODY_SIZE + ENTRY_HEADER_SIZE)
+//                        {
+//                            success = check_write(&apr_file, (void*)data_buffer, size_in_buffer);
+//                            size_in_buffer = 0;
+//                            if (!success)
+//                            {
+//                                break;
+//                            }
+//                        }
+//                    }
+//                }
+//
+//                if (success && size_in_buffer > 0)
+//                {
+//                    // final write
+//                    success = check_write(&apr_file, (void*)data_buffer, size_in_buffer);
+//                    size_in_buffer = 0;
+//                }
+//            }
+//		}
+//	}
+//
+//	if(!success)
+//	{
+//		removeEntry(entry) ;
+//	}
+//
+//	return ;
+	std::shared_ptr<LLVOCacheRegionFile::Image> image = std::make_shared<LLVOCacheRegionFile::Image>();
+	LLVOCacheRegionFile::buildImage(*image, id, cache_entry_map, file.get(), removal_enabled);
+
+	std::string filename;
+	getObjectCacheFilename(handle, filename);
+
+	// Unmap the old file before it gets replaced
+	file.reset();
+
+	auto write_file = [filename, image]()
 	{
-		std::string filename;
-		getObjectCacheFilename(handle, filename);
-		LLAPRFile apr_file(filename, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, mLocalAPRFilePoolp);
-	
-		success = check_write(&apr_file, (void*)id.mData, UUID_BYTES);
-	
-		if(success)
+		return LLVOCacheRegionFile::writeImage(filename, *image);
+	};
+	auto file_written = [handle](bool success)
+	{
+		if (!success && LLVOCache::instanceExists())
 		{
-			S32 num_entries = cache_entry_map.size(); // if removal is enabled num_entries might be wrong
-			success = check_write(&apr_file, &num_entries, sizeof(S32));
-            if (success)
-            {
-                const S32 buffer_size = 32768; //should be large enough for couple MAX_ENTRY_BODY_SIZE
-                U8 data_buffer[buffer_size]; // generaly entries are fairly small, so collect them and drop onto disk in one go
-                S32 size_in_buffer = 0;
-
-                // This can have a lot of entries, so might be better to dump them into buffer first and write in one go.
-                for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
-                {
-                    if (!removal_enabled || iter->second->isValid())
-                    {
-                        S32 size = iter->second->writeToBuffer(data_buffer + size_in_buffer);
-
-                        if (size > ENTRY_HEADER_SIZE) // body is minimum of 1
-                        {
-                            size_in_buffer += size;
-                        }
-                        else
-                        {
-                            success = false;
-                            break;
-                        }
-
-                        // Make sure we have space in buffer for next element
-                        if (buffer_size - size_in_buffer < MAX_ENTRY_BODY_SIZE + ENTRY_HEADER_SIZE)
-                        {
-                            success = check_write(&apr_file, (void*)data_buffer, size_in_buffer);
-                            size_in_buffer = 0;
-                            if (!success)
-                            {
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                if (success && size_in_buffer > 0)
-                {
-                    // final write
-                    success = check_write(&apr_file, (void*)data_buffer, size_in_buffer);
-                    size_in_buffer = 0;
-                }
-            }
+			LLVOCache::instance().removeEntry(handle);
 		}
-	}
+	};
 
-	if(!success)
+	if (!postToCacheThread(write_file, file_written))
 	{
-		removeEntry(entry) ;
+		file_written(write_file());
 	}
-
-	return ;
+	// </FS:Perf>
 }
 
 void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, BOOL dirty_cache, bool removal_enabled)
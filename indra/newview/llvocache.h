@@ -33,7 +33,12 @@
 #include "llvieweroctree.h"
 #include "llapr.h"
 #include "llgltfmaterial.h"
+// <FS:Perf> Asynchronous, memory mapped region object cache
+#include "threadpool_fwd.h"
 
+#include <functional>
+#include <memory>
+// </FS:Perf>
 #include <unordered_map>
 
 //---------------------------------------------------------------------------
@@ -53,6 +58,12 @@ public:
     U64 mRegionHandle = 0;
 };
 
+// <FS:Perf> Asynchronous, memory mapped region object cache
+// Layout of an entry record, shared with LLVOCacheRegionFile
+const S32 ENTRY_HEADER_SIZE = 6 * sizeof(S32);
+const S32 MAX_ENTRY_BODY_SIZE = 10000;
+// </FS:Perf>
+
 class LLVOCacheEntry 
 :	public LLViewerOctreeEntryData
 {
@@ -107,6 +118,7 @@ protected:
 public:
 	LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
 	LLVOCacheEntry(LLAPRFile* apr_file);
+	LLVOCacheEntry(const U8* record, S32 record_size); // <FS:Perf/> Entry from a memory mapped cache file
 	LLVOCacheEntry();	
 
 	void updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp);
@@ -244,6 +256,9 @@ private:
 	U32   mIdleHash;
 };
 
+// <FS:Perf/> Asynchronous, memory mapped region object cache, see llvocacheregionfile.h
+class LLVOCacheRegionFile;
+
 //
 //Note: LLVOCache is not thread-safe
 //
@@ -290,9 +305,20 @@ public:
 	void removeCache(ELLPath location, bool started = false) ;
 
 	void readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
+	// <FS:Perf> Asynchronous, memory mapped region object cache
+	// Opens the region cache file on the object cache thread, then calls
+	// callback on the main thread with the file, or NULL if there is none.
+	typedef std::function<void(std::shared_ptr<LLVOCacheRegionFile>)> read_callback_t;
+	void readFromCacheAsync(U64 handle, const LLUUID& id, read_callback_t callback);
+	// </FS:Perf>
     void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map);
 
-	void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled);
+	// <FS:Perf> Asynchronous, memory mapped region object cache
+	// The records of file that are not in cache_entry_map are written back
+	// as they are. The file is written on the object cache thread.
+	//void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled);
+	void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, std::shared_ptr<LLVOCacheRegionFile> file, BOOL dirty_cache, bool removal_enabled);
+	// </FS:Perf>
     void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, BOOL dirty_cache, bool removal_enabled);
 	void removeEntry(U64 handle) ;
 
@@ -312,6 +338,11 @@ private:
 	void removeEntry(HeaderEntryInfo* entry) ;
 	void purgeEntries(U32 size);
 	BOOL updateEntry(const HeaderEntryInfo* entry);
+	// <FS:Perf> Runs work on the object cache thread, then callback with its
+	// result on the main thread. Returns false if there is no thread to run it.
+	template <typename WORK, typename DONE>
+	bool postToCacheThread(const WORK& work, const DONE& callback);
+	// </FS:Perf>
 	
 private:
 	bool                 mEnabled;
@@ -325,6 +356,10 @@ private:
 	LLVolatileAPRPool*   mLocalAPRFilePoolp ; 	
 	header_entry_queue_t mHeaderEntryQueue;
 	handle_entry_map_t   mHandleEntryMap;	
+	// <FS:Perf> Object cache thread. Only one, so that region files are
+	// read, written and removed in the order they were asked for.
+	std::unique_ptr<LL::ThreadPool> mThreadPool;
+	// </FS:Perf>
 };
 
 #endif
@@ -0,0 +1,297 @@
+/**
+ * @file llvocacheregionfile.cpp
+ * @brief Memory mapped object cache file of one region
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+#include "llvocacheregionfile.h"
+
+#include "llfile.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#endif
+
+#include <algorithm>
+
+namespace
+{
+	// Moves from over to in one step, so a crash leaves either the old or
+	// the new file behind. LLFile::rename() can't replace an existing file
+	// on Windows.
+	bool replace_file(const std::string& from, const std::string& to)
+	{
+#if LL_WINDOWS
+		return MoveFileExW(utf8str_to_utf16str(from).c_str(), utf8str_to_utf16str(to).c_str(),
+						   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return LLFile::rename(from, to) == 0;
+#endif
+	}
+
+	struct index_less
+	{
+		bool operator()(const LLVOCacheRegionFile::IndexEntry& lhs, U32 local_id) const
+		{
+			return lhs.mLocalID < local_id;
+		}
+	};
+}
+
+LLVOCacheRegionFile::LLVOCacheRegionFile()
+:	mIndex(NULL),
+	mNumEntries(0)
+{
+}
+
+//static
+LLVOCacheRegionFile::ptr_t LLVOCacheRegionFile::open(const std::string& filename, const LLUUID& id)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	if (!LLFile::isfile(filename))
+	{
+		return ptr_t();
+	}
+
+	ptr_t file(new LLVOCacheRegionFile());
+	if (!file->mFile.open(filename, LLMappedFile::READ_ONLY))
+	{
+		return ptr_t();
+	}
+
+	const U8* data = file->mFile.data();
+	const size_t size = file->mFile.size();
+
+	FileHeader header;
+	if (size < sizeof(FileHeader))
+	{
+		LL_WARNS() << "Object cache file " << filename << " is truncated, discarding" << LL_ENDL;
+		return ptr_t();
+	}
+	memcpy(&header, data, sizeof(FileHeader));
+
+	if (header.mMagic != MAGIC || header.mVersion != VERSION)
+	{
+		LL_INFOS() << "Object cache file " << filename << " has an unknown format, discarding" << LL_ENDL;
+		return ptr_t();
+	}
+	if (memcmp(header.mCacheID, id.mData, UUID_BYTES))
+	{
+		LL_INFOS() << "Cache ID doesn't match for this region, discarding" << LL_ENDL;
+		return ptr_t();
+	}
+
+	// The header is a multiple of 4 bytes long and the mapping starts on a
+	// page, so the index can be used where it lies.
+	const size_t index_end = sizeof(FileHeader) + (size_t)header.mNumEntries * sizeof(IndexEntry);
+	if (index_end > size)
+	{
+		LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
+		return ptr_t();
+	}
+
+	const IndexEntry* index = (const IndexEntry*)(data + sizeof(FileHeader));
+	for (U32 i = 0; i < header.mNumEntries; ++i)
+	{
+		const IndexEntry& entry = index[i];
+		if (!entry.mLocalID
+			|| (i > 0 && entry.mLocalID <= index[i - 1].mLocalID)
+			|| entry.mOffset < index_end
+			|| entry.mSize <= (U32)ENTRY_HEADER_SIZE
+			|| entry.mSize > (U32)(ENTRY_HEADER_SIZE + MAX_ENTRY_BODY_SIZE)
+			|| (size_t)entry.mOffset + entry.mSize > size)
+		{
+			LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
+			return ptr_t();
+		}
+	}
+
+	file->mIndex = index;
+	file->mNumEntries = header.mNumEntries;
+	return file;
+}
+
+const LLVOCacheRegionFile::IndexEntry* LLVOCacheRegionFile::findIndex(U32 local_id) const
+{
+	const IndexEntry* end = mIndex + mNumEntries;
+	const IndexEntry* found = std::lower_bound(mIndex, end, local_id, index_less());
+	return (found != end && found->mLocalID == local_id) ? found : NULL;
+}
+
+LLPointer<LLVOCacheEntry> LLVOCacheRegionFile::createEntry(U32 local_id) const
+{
+	const IndexEntry* index = findIndex(local_id);
+	return index ? createEntry(*index) : LLPointer<LLVOCacheEntry>();
+}
+
+LLPointer<LLVOCacheEntry> LLVOCacheRegionFile::createEntry(const IndexEntry& index) const
+{
+	LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(mFile.data() + index.mOffset, (S32)index.mSize);
+	if (entry->getLocalID() != index.mLocalID)
+	{
+		LL_WARNS() << "Bad record for object " << index.mLocalID << " in " << mFile.getFilename() << LL_ENDL;
+		return LLPointer<LLVOCacheEntry>();
+	}
+	return entry;
+}
+
+void LLVOCacheRegionFile::createAllEntries(LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) const
+{
+	for (U32 i = 0; i < mNumEntries; ++i)
+	{
+		if (cache_entry_map.find(mIndex[i].mLocalID) == cache_entry_map.end())
+		{
+			LLPointer<LLVOCacheEntry> entry = createEntry(mIndex[i]);
+			if (entry.notNull())
+			{
+				cache_entry_map[entry->getLocalID()] = entry;
+			}
+		}
+	}
+}
+
+void LLVOCacheRegionFile::prefetch() const
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	const size_t PAGE_SIZE = 4096;
+	const U8* data = mFile.data();
+	U8 sum = 0;
+	for (size_t offset = 0; offset < mFile.size(); offset += PAGE_SIZE)
+	{
+		sum += ((const volatile U8*)data)[offset];
+	}
+	(void)sum;
+}
+
+//static
+void LLVOCacheRegionFile::buildImage(Image& image, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map,
+									 const LLVOCacheRegionFile* previous, bool removal_enabled)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	image.mCacheID = id;
+	image.mIndex.clear();
+	image.mRecords.clear();
+
+	const U32 num_records = previous ? previous->mNumEntries : 0;
+	image.mIndex.reserve(cache_entry_map.size() + num_records);
+
+	// Offsets are from the start of mRecords until writeImage() lays out the file
+	auto add_record = [&image](U32 local_id, const U8* record, U32 size)
+	{
+		IndexEntry index = { local_id, (U32)image.mRecords.size(), size };
+		image.mIndex.push_back(index);
+		image.mRecords.insert(image.mRecords.end(), record, record + size);
+	};
+
+	// The map and the previous index are both sorted by local id, merge
+	// them. An entry in memory replaces its record.
+	U8 buffer[ENTRY_HEADER_SIZE + MAX_ENTRY_BODY_SIZE];
+	LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin();
+	U32 record = 0;
+	while (iter != cache_entry_map.end() || record < num_records)
+	{
+		if (record < num_records && (iter == cache_entry_map.end() || previous->mIndex[record].mLocalID < iter->first))
+		{
+			// Never asked for this session, so never found valid either
+			if (!removal_enabled)
+			{
+				const IndexEntry& index = previous->mIndex[record];
+				add_record(index.mLocalID, previous->mFile.data() + index.mOffset, index.mSize);
+			}
+			++record;
+			continue;
+		}
+
+		if (record < num_records && previous->mIndex[record].mLocalID == iter->first)
+		{
+			++record;
+		}
+
+		if (iter->first && (!removal_enabled || iter->second->isValid()))
+		{
+			S32 size = iter->second->writeToBuffer(buffer);
+			if (size > ENTRY_HEADER_SIZE) // body is minimum of 1
+			{
+				add_record(iter->first, buffer, (U32)size);
+			}
+		}
+		++iter;
+	}
+}
+
+//static
+bool LLVOCacheRegionFile::writeImage(const std::string& filename, const Image& image)
+{
+	LL_PROFILE_ZONE_SCOPED;
+
+	FileHeader header;
+	header.mMagic = MAGIC;
+	header.mVersion = VERSION;
+	memcpy(header.mCacheID, image.mCacheID.mData, UUID_BYTES);
+	header.mNumEntries = (U32)image.mIndex.size();
+
+	const U32 records_start = (U32)(sizeof(FileHeader) + image.mIndex.size() * sizeof(IndexEntry));
+	std::vector<IndexEntry> index(image.mIndex);
+	for (IndexEntry& entry : index)
+	{
+		entry.mOffset += records_start;
+	}
+
+	// Write next to the old file and move the result over it, so that a
+	// crash never leaves half a cache file behind.
+	const std::string temp_filename = filename + ".tmp";
+	bool success = false;
+	{
+		llofstream out(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (out.is_open())
+		{
+			out.write((const char*)&header, sizeof(FileHeader));
+			if (!index.empty())
+			{
+				out.write((const char*)index.data(), index.size() * sizeof(IndexEntry));
+			}
+			if (!image.mRecords.empty())
+			{
+				out.write((const char*)image.mRecords.data(), image.mRecords.size());
+			}
+			out.close();
+			success = !out.fail();
+		}
+	}
+
+	if (success)
+	{
+		success = replace_file(temp_filename, filename);
+	}
+	if (!success)
+	{
+		LL_WARNS() << "Failed to write object cache file " << filename << LL_ENDL;
+		LLFile::remove(temp_filename, ENOENT);
+	}
+	return success;
+}
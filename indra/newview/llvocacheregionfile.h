@@ -0,0 +1,118 @@
+/**
+ * @file llvocacheregionfile.h
+ * @brief Memory mapped object cache file of one region
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOCACHEREGIONFILE_H
+#define LL_LLVOCACHEREGIONFILE_H
+
+#include "llmappedfile.h"
+#include "llvocache.h"
+
+#include <memory>
+#include <vector>
+
+//
+// The object cache file of one region, mapped into memory. The file starts
+// with a FileHeader and one IndexEntry per object, sorted by local id,
+// followed by the entry records as written by LLVOCacheEntry::writeToBuffer().
+// Entries are only made from their record when the region first asks for
+// them, so opening a region cache no longer costs one allocation per object.
+//
+// The mapping is read only and can be used from any thread; open() and
+// writeImage() are meant to run on the object cache thread.
+//
+class LLVOCacheRegionFile
+{
+public:
+	typedef std::shared_ptr<LLVOCacheRegionFile> ptr_t;
+
+	enum
+	{
+		MAGIC = 0x434f4c53, // "SLOC"
+		VERSION = 1
+	};
+
+	struct FileHeader
+	{
+		U32 mMagic;
+		U32 mVersion;
+		U8  mCacheID[UUID_BYTES];
+		U32 mNumEntries;
+	};
+
+	struct IndexEntry
+	{
+		U32 mLocalID;
+		U32 mOffset; // from the start of the file
+		U32 mSize;   // of the whole record, entry header included
+	};
+
+	// Everything needed to write a region cache file, built on the main
+	// thread and written out on the cache thread
+	struct Image
+	{
+		LLUUID mCacheID;
+		std::vector<IndexEntry> mIndex;
+		std::vector<U8> mRecords;
+	};
+
+	// Maps filename and checks it is a cache file for region cache id id.
+	// Returns NULL if the file is missing, belongs to another region or is corrupt.
+	static ptr_t open(const std::string& filename, const LLUUID& id);
+
+	// Makes the image of a region cache file from the entries in memory, plus
+	// the records of previous that were never made into entries.
+	static void buildImage(Image& image, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map,
+						   const LLVOCacheRegionFile* previous, bool removal_enabled);
+	// Writes image to a temporary file, then moves it over filename in one
+	// step. Any LLVOCacheRegionFile mapping filename must be released first,
+	// Windows won't replace a mapped file.
+	static bool writeImage(const std::string& filename, const Image& image);
+
+	U32 getNumEntries() const { return mNumEntries; }
+	bool hasEntry(U32 local_id) const { return findIndex(local_id) != NULL; }
+
+	// New entry made from the record of local_id, NULL if there is none
+	LLPointer<LLVOCacheEntry> createEntry(U32 local_id) const;
+	// Makes entries for every record not already in cache_entry_map
+	void createAllEntries(LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) const;
+
+	// Touches every page of the mapping, so that later createEntry() calls
+	// on the main thread don't wait on the disk.
+	void prefetch() const;
+
+private:
+	LLVOCacheRegionFile();
+
+	const IndexEntry* findIndex(U32 local_id) const;
+	LLPointer<LLVOCacheEntry> createEntry(const IndexEntry& index) const;
+
+	LLMappedFile		mFile;
+	const IndexEntry*	mIndex;
+	U32					mNumEntries;
+};
+
+#endif // LL_LLVOCACHEREGIONFILE_H
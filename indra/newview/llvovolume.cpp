@@ -94,6 +94,8 @@
 #include "rlvlocks.h"
 // [/RLVa:KB]
 #include "llviewernetwork.h"
+#include "parallelfor.h" // <FS:Perf/> Rigged volume skinning on the general thread pool
+#include "workqueue.h" // <FS:Perf/> Sculpts built on the general thread pool
 
 const F32 FORCE_SIMPLE_RENDER_AREA = 512.f;
 const F32 FORCE_CULL_AREA = 8.f;
@@ -343,6 +345,7 @@ void LLVOVolume::cleanupClass()
 {
     sObjectMediaClient = NULL;
     sObjectMediaNavigateClient = NULL;
+    clearPendingSculpts(); // <FS:Perf/> Asynchronous sculpt builds
 }
 
 U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
@@ -1480,6 +1483,12 @@ void LLVOVolume::sculpt()
 				mSculptTexture->updateBindStatsForTester() ;
 			}
 		}
+		// <FS:Perf> Sculpt on the general thread pool, the result is taken by the idle loop
+		if (postSculpt(sculpt_width, sculpt_height, sculpt_components, sculpt_data, discard_level))
+		{
+			return;
+		}
+		// </FS:Perf>
 		getVolume()->sculpt(sculpt_width, sculpt_height, sculpt_components, sculpt_data, discard_level, mSculptTexture->isMissingAsset());
 
 		//notify rebuild any other VOVolumes that reference this sculpty volume
@@ -1494,6 +1503,116 @@ void LLVOVolume::sculpt()
 	}
 }
 
+// <FS:Perf>
+namespace
+{
+	// Sculpts being built on the general thread pool, by target volume.
+	// Only touched on the main thread.
+	struct PendingSculpt
+	{
+		LLPointer<LLVolume> mVolume;
+		LLPointer<LLViewerFetchedTexture> mTexture;
+		S32 mDiscard;
+		U64 mSequence;
+	};
+	std::map<LLVolume*, PendingSculpt> sPendingSculpts;
+	U64 sNextSculptSequence = 0;
+}
+
+// static
+void LLVOVolume::clearPendingSculpts()
+{
+	// Builds still in flight find nothing to apply to and are dropped
+	sPendingSculpts.clear();
+}
+
+bool LLVOVolume::postSculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, S32 discard_level)
+{
+	LLVolume* target = getVolume();
+	std::map<LLVolume*, PendingSculpt>::iterator it = sPendingSculpts.find(target);
+	if (it != sPendingSculpts.end() && it->second.mDiscard == discard_level)
+	{
+		// Already on its way
+		return true;
+	}
+
+	LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+	LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+	if (!main_queue || !general_queue)
+	{
+		return false;
+	}
+
+	// The raw image may be replaced while the sculpt is built
+	std::vector<U8> data;
+	if (sculpt_data)
+	{
+		data.assign(sculpt_data, sculpt_data + (size_t)sculpt_width * sculpt_height * sculpt_components);
+	}
+
+	const U64 sequence = sNextSculptSequence++;
+	const LLVolumeParams params = target->getParams();
+	const F32 detail = target->getDetail();
+	const bool missing_asset = mSculptTexture->isMissingAsset();
+
+	bool posted = main_queue->postTo(
+		general_queue,
+		[params, detail, sculpt_width, sculpt_height, sculpt_components, data, discard_level, missing_asset]()
+		{
+			LL_PROFILE_ZONE_NAMED("sculpt build");
+			// Owned by the pointer, so it isn't leaked if the reply is never delivered
+			LLPointer<LLVolume> built = new LLVolume(params, detail, FALSE, TRUE);
+			built->sculpt(sculpt_width, sculpt_height, sculpt_components, data.empty() ? NULL : data.data(), discard_level, missing_asset);
+			return built;
+		},
+		[target, sequence](LLPointer<LLVolume> built)
+		{
+			onSculptBuilt(target, sequence, built);
+		});
+	if (!posted)
+	{
+		return false;
+	}
+
+	PendingSculpt& pending = sPendingSculpts[target];
+	pending.mVolume = target;
+	pending.mTexture = mSculptTexture;
+	pending.mDiscard = discard_level;
+	pending.mSequence = sequence;
+	return true;
+}
+
+// static
+void LLVOVolume::onSculptBuilt(LLVolume* target, U64 sequence, const LLPointer<LLVolume>& built)
+{
+	std::map<LLVolume*, PendingSculpt>::iterator it = sPendingSculpts.find(target);
+	if (it == sPendingSculpts.end() || it->second.mSequence != sequence)
+	{
+		// Superseded by a better discard level
+		return;
+	}
+	PendingSculpt pending = it->second;
+	sPendingSculpts.erase(it);
+
+	if (pending.mVolume->getNumRefs() <= 1)
+	{
+		// Nothing uses the volume anymore
+		return;
+	}
+	pending.mVolume->takeSculpt(built);
+
+	for (S32 i = 0; i < pending.mTexture->getNumVolumes(LLRender::SCULPT_TEX); ++i)
+	{
+		LLVOVolume* volume = (*(pending.mTexture->getVolumeList(LLRender::SCULPT_TEX)))[i];
+		if (volume->getVolume() == target)
+		{
+			volume->mSculptChanged = TRUE;
+			gPipeline.markRebuild(volume->mDrawable, LLDrawable::REBUILD_GEOMETRY);
+		}
+	}
+}
+// </FS:Perf>
+
 S32	LLVOVolume::computeLODDetail(F32 distance, F32 radius, F32 lod_factor)
 {
 	S32	cur_detail;
@@ -5136,113 +5255,276 @@ void LLRiggedVolume::update(
         face_begin = face_index;
         face_end = face_begin + 1;
     }
-    for (S32 i = face_begin; i < face_end; ++i)
-	{
-		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+    // <FS:Perf> Skin in jobs of a few vertices each on the general thread
+    // pool and merge their bounds here afterwards. Face octrees are only
+    // dropped: the raycasts that need one build it again on demand.
+//    for (S32 i = face_begin; i < face_end; ++i)
+//	{
+//		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
 		
-		LLVolumeFace& dst_face = mVolumeFaces[i];
+//		LLVolumeFace& dst_face = mVolumeFaces[i];
 		
-		LLVector4a* weight = vol_face.mWeights;
+//		LLVector4a* weight = vol_face.mWeights;
 
-		if ( weight )
-		{
-            LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
+//		if ( weight )
+//		{
+//            LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
+
+//			LLVector4a* pos = dst_face.mPositions;
+
+//			if (pos && dst_face.mExtents)
+//			{
+//                U32 max_joints = LLSkinningUtil::getMaxJointCount();
+//                rigged_vert_count += dst_face.mNumVertices;
+//                rigged_face_count++;
+
+//            #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
+//                if (vol_face.mJointIndices) // fast path with preconditioned joint indices
+//                {
+//                    LLMatrix4a src[4];
+//                    U8* joint_indices_cursor = vol_face.mJointIndices;
+//                    LLVector4a* just_weights = vol_face.mJustWeights;
+//                    for (U32 j = 0; j < dst_face.mNumVertices; ++j)
+//				    {
+//					    LLMatrix4a final_mat;
+//                        F32* w = just_weights[j].getF32ptr();
+//                        LLSkinningUtil::getPerVertexSkinMatrixWithIndices(w, joint_indices_cursor, mat, final_mat, src);
+//                        joint_indices_cursor += 4;
+
+//					    LLVector4a& v = vol_face.mPositions[j];
+//					    LLVector4a t;
+//					    LLVector4a dst;
+//					    bind_shape_matrix.affineTransform(v, t);
+//					    final_mat.affineTransform(t, dst);
+//					    pos[j] = dst;
+//				    }
+//                }
+//                else
+//            #endif
+//                {
+//				    for (U32 j = 0; j < dst_face.mNumVertices; ++j)
+//				    {
+//					    LLMatrix4a final_mat;
+//                        // <FS:ND> Use the SSE2 version
+//                        // LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
+//                        FSSkinningUtil::getPerVertexSkinMatrixSSE(weight[j], mat, false, final_mat, max_joints);
+//                        // </FS:ND>
+
+//					    LLVector4a& v = vol_face.mPositions[j];
+//					    LLVector4a t;
+//					    LLVector4a dst;
+//					    bind_shape_matrix.affineTransform(v, t);
+//					    final_mat.affineTransform(t, dst);
+//					    pos[j] = dst;
+//				    }
+//                }
+
+//				//update bounding box
+//				// VFExtents change
+//				LLVector4a& min = dst_face.mExtents[0];
+//				LLVector4a& max = dst_face.mExtents[1];
+
+//				min = pos[0];
+//				max = pos[1];
+//                if (i==0)
+//                {
+//                    box_min = min;
+//                    box_max = max;
+//                }
+
+//				for (U32 j = 1; j < dst_face.mNumVertices; ++j)
+//				{
+//					min.setMin(min, pos[j]);
+//					max.setMax(max, pos[j]);
+//				}
+
+//                box_min.setMin(min,box_min);
+//                box_max.setMax(max,box_max);
+
+//				dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
+//				dst_face.mCenter->mul(0.5f);
+
+//			}
+
+//            if (rebuild_face_octrees)
+//			{
+//                dst_face.destroyOctree();
+//				// <FS:ND> Create a debug log for octree insertions if requested.
+//				static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
+//				bool _debugOT( debugOctree );
+//				if( _debugOT )
+//					nd::octree::debug::gOctreeDebug += 1;
+//				// </FS:ND>
+
+//                dst_face.createOctree();
+
+//				// <FS:ND> Reset octree log
+//				if( _debugOT )
+//					nd::octree::debug::gOctreeDebug -= 1;
+//				// </FS:ND>
+//			}
+//		}
+//	}
+    struct SkinJob
+    {
+        S32 mFace;
+        U32 mBegin;
+        U32 mEnd;
+        LLVector4a mMin;
+        LLVector4a mMax;
+    };
+    static const U32 SKIN_JOB_VERTICES = 1024;
+    // Jobs per slice, so that small meshes are skinned on this thread alone
+    static const size_t SKIN_JOB_GRAIN = 4;
+
+    std::vector<SkinJob> jobs;
+    for (S32 i = face_begin; i < face_end; ++i)
+    {
+        const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+        LLVolumeFace& dst_face = mVolumeFaces[i];
 
-			LLVector4a* pos = dst_face.mPositions;
+        LLVector4a* weight = vol_face.mWeights;
+        if (weight)
+        {
+            LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
 
-			if (pos && dst_face.mExtents)
-			{
-                U32 max_joints = LLSkinningUtil::getMaxJointCount();
+            if (dst_face.mPositions && dst_face.mExtents)
+            {
                 rigged_vert_count += dst_face.mNumVertices;
                 rigged_face_count++;
 
-            #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
-                if (vol_face.mJointIndices) // fast path with preconditioned joint indices
+                const U32 num_vertices = (U32)dst_face.mNumVertices;
+                for (U32 begin = 0; begin < num_vertices; begin += SKIN_JOB_VERTICES)
                 {
-                    LLMatrix4a src[4];
-                    U8* joint_indices_cursor = vol_face.mJointIndices;
-                    LLVector4a* just_weights = vol_face.mJustWeights;
-                    for (U32 j = 0; j < dst_face.mNumVertices; ++j)
-				    {
-					    LLMatrix4a final_mat;
-                        F32* w = just_weights[j].getF32ptr();
-                        LLSkinningUtil::getPerVertexSkinMatrixWithIndices(w, joint_indices_cursor, mat, final_mat, src);
-                        joint_indices_cursor += 4;
-
-					    LLVector4a& v = vol_face.mPositions[j];
-					    LLVector4a t;
-					    LLVector4a dst;
-					    bind_shape_matrix.affineTransform(v, t);
-					    final_mat.affineTransform(t, dst);
-					    pos[j] = dst;
-				    }
-                }
-                else
-            #endif
-                {
-				    for (U32 j = 0; j < dst_face.mNumVertices; ++j)
-				    {
-					    LLMatrix4a final_mat;
-                        // <FS:ND> Use the SSE2 version
-                        // LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
-                        FSSkinningUtil::getPerVertexSkinMatrixSSE(weight[j], mat, false, final_mat, max_joints);
-                        // </FS:ND>
-
-					    LLVector4a& v = vol_face.mPositions[j];
-					    LLVector4a t;
-					    LLVector4a dst;
-					    bind_shape_matrix.affineTransform(v, t);
-					    final_mat.affineTransform(t, dst);
-					    pos[j] = dst;
-				    }
+                    SkinJob job;
+                    job.mFace = i;
+                    job.mBegin = begin;
+                    job.mEnd = llmin(begin + SKIN_JOB_VERTICES, num_vertices);
+                    jobs.push_back(job);
                 }
+            }
+        }
+    }
 
-				//update bounding box
-				// VFExtents change
-				LLVector4a& min = dst_face.mExtents[0];
-				LLVector4a& max = dst_face.mExtents[1];
+    const U32 max_joints = LLSkinningUtil::getMaxJointCount();
+    auto skin_job = [&](SkinJob& job)
+    {
+        const LLVolumeFace& vol_face = volume->getVolumeFace(job.mFace);
+        LLVector4a* pos = mVolumeFaces[job.mFace].mPositions;
 
-				min = pos[0];
-				max = pos[1];
-                if (i==0)
-                {
-                    box_min = min;
-                    box_max = max;
-                }
+    #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
+        if (vol_face.mJointIndices) // fast path with preconditioned joint indices
+        {
+            LLMatrix4a src[4];
+            U8* joint_indices_cursor = vol_face.mJointIndices + job.mBegin * 4;
+            LLVector4a* just_weights = vol_face.mJustWeights;
+            for (U32 j = job.mBegin; j < job.mEnd; ++j)
+            {
+                LLMatrix4a final_mat;
+                F32* w = just_weights[j].getF32ptr();
+                LLSkinningUtil::getPerVertexSkinMatrixWithIndices(w, joint_indices_cursor, mat, final_mat, src);
+                joint_indices_cursor += 4;
+
+                LLVector4a& v = vol_face.mPositions[j];
+                LLVector4a t;
+                LLVector4a dst;
+                bind_shape_matrix.affineTransform(v, t);
+                final_mat.affineTransform(t, dst);
+                pos[j] = dst;
+            }
+        }
+        else
+    #endif
+        {
+            LLVector4a* weight = vol_face.mWeights;
+            for (U32 j = job.mBegin; j < job.mEnd; ++j)
+            {
+                LLMatrix4a final_mat;
+                FSSkinningUtil::getPerVertexSkinMatrixSSE(weight[j], mat, false, final_mat, max_joints);
+
+                LLVector4a& v = vol_face.mPositions[j];
+                LLVector4a t;
+                LLVector4a dst;
+                bind_shape_matrix.affineTransform(v, t);
+                final_mat.affineTransform(t, dst);
+                pos[j] = dst;
+            }
+        }
 
-				for (U32 j = 1; j < dst_face.mNumVertices; ++j)
-				{
-					min.setMin(min, pos[j]);
-					max.setMax(max, pos[j]);
-				}
+        job.mMin = pos[job.mBegin];
+        job.mMax = pos[job.mBegin];
+        for (U32 j = job.mBegin + 1; j < job.mEnd; ++j)
+        {
+            job.mMin.setMin(job.mMin, pos[j]);
+            job.mMax.setMax(job.mMax, pos[j]);
+        }
+    };
 
-                box_min.setMin(min,box_min);
-                box_max.setMax(max,box_max);
+    LL::parallelFor("General", jobs.size(), SKIN_JOB_GRAIN,
+                    [&](size_t begin, size_t end)
+                    {
+                        for (size_t k = begin; k < end; ++k)
+                        {
+                            skin_job(jobs[k]);
+                        }
+                    });
 
-				dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
-				dst_face.mCenter->mul(0.5f);
+    // Jobs of a face are next to each other
+    for (size_t k = 0; k < jobs.size(); )
+    {
+        const S32 i = jobs[k].mFace;
+        LLVolumeFace& dst_face = mVolumeFaces[i];
 
-			}
+        //update bounding box
+        // VFExtents change
+        LLVector4a& min = dst_face.mExtents[0];
+        LLVector4a& max = dst_face.mExtents[1];
 
-            if (rebuild_face_octrees)
-			{
-                dst_face.destroyOctree();
-				// <FS:ND> Create a debug log for octree insertions if requested.
-				static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
-				bool _debugOT( debugOctree );
-				if( _debugOT )
-					nd::octree::debug::gOctreeDebug += 1;
-				// </FS:ND>
+        min = jobs[k].mMin;
+        max = jobs[k].mMax;
+        for (++k; k < jobs.size() && jobs[k].mFace == i; ++k)
+        {
+            min.setMin(min, jobs[k].mMin);
+            max.setMax(max, jobs[k].mMax);
+        }
 
-                dst_face.createOctree();
+        if (i==0)
+        {
+            box_min = min;
+            box_max = max;
+        }
+        box_min.setMin(min,box_min);
+        box_max.setMax(max,box_max);
 
-				// <FS:ND> Reset octree log
-				if( _debugOT )
-					nd::octree::debug::gOctreeDebug -= 1;
-				// </FS:ND>
-			}
-		}
-	}
+        dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
+        dst_face.mCenter->mul(0.5f);
+    }
+
+    if (rebuild_face_octrees)
+    {
+        // <FS:ND> Create a debug log for octree insertions if requested.
+        static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
+        bool _debugOT( debugOctree );
+        // </FS:ND>
+        for (S32 i = face_begin; i < face_end; ++i)
+        {
+            if (!volume->getVolumeFace(i).mWeights)
+            {
+                continue;
+            }
+
+            LLVolumeFace& dst_face = mVolumeFaces[i];
+            dst_face.destroyOctree();
+            // The log is of the octree being built, so that still happens here
+            if( _debugOT )
+            {
+                nd::octree::debug::gOctreeDebug += 1;
+                dst_face.createOctree();
+                nd::octree::debug::gOctreeDebug -= 1;
+            }
+        }
+    }
+    // </FS:Perf>
     mExtraDebugText = llformat("rigged %d/%d - box (%f %f %f) (%f %f %f)",
                                rigged_face_count, rigged_vert_count,
                                box_min[0], box_min[1], box_min[2],
@@ -236,6 +236,12 @@ public:
 				void	updateSculptTexture();
 				void    setIndexInTex(U32 ch, S32 index) { mIndexInTex[ch] = index ;}
 				void	sculpt();
+				// <FS:Perf>
+				// Builds the sculpt on the general thread pool, false if that is not possible
+				bool	postSculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, S32 discard_level);
+	 static     void    onSculptBuilt(LLVolume* target, U64 sequence, const LLPointer<LLVolume>& built);
+	 static     void    clearPendingSculpts();
+				// </FS:Perf>
 	 static     void    rebuildMeshAssetCallback(const LLUUID& asset_uuid,
 												 LLAssetType::EType type,
 												 void* user_data, S32 status, LLExtStat ext_status);
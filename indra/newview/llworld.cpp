@@ -1244,6 +1244,14 @@ void LLWorld::updateNetStats()
 	add(LLStatViewer::PACKETS_OUT, packets_out);
 	add(LLStatViewer::PACKETS_LOST, packets_lost);
 
+	// <FS:Perf> Batched receive
+	F32 packets_per_receive_call = gMessageSystem->mPacketRing.getAndResetPacketsPerReceiveCall();
+	if (packets_per_receive_call > 0.f)
+	{
+		sample(LLStatViewer::PACKETS_PER_RECEIVE_CALL, packets_per_receive_call);
+	}
+	// </FS:Perf>
+
 	F32 total_packets_in = LLViewerStats::instance().getRecording().getSum(LLStatViewer::PACKETS_IN);
 	if (total_packets_in > 0)
 	{
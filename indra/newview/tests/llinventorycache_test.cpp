@@ -0,0 +1,380 @@
+/**
+ * @file llinventorycache_test.cpp
+ * @brief Tests of the binary inventory cache files
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Dependencies
+#include "linden_common.h"
+#include "llfile.h"
+#include "../llviewerinventory.h"
+// Class to test
+#include "../llinventorycache.h"
+// Tut header
+#include "../test/lltut.h"
+
+#include <algorithm>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// Notes:
+// * Add here stubbed implementation of the few classes and methods used in the class to be tested
+// * Add as little as possible (let the link errors guide you)
+// * Do not make any assumption as to how those classes or methods work (i.e. don't copy/paste code)
+// * A simulator for a class can be implemented here. Please comment and document thoroughly.
+
+// Simulator of the viewer inventory objects: no links, no agent and no
+// server, so every getter answers what LLInventoryItem/Category hold.
+LLViewerInventoryItem::LLViewerInventoryItem(const LLUUID& uuid, const LLUUID& parent_uuid, const LLPermissions& permissions,
+											 const LLUUID& asset_uuid, LLAssetType::EType type, LLInventoryType::EType inv_type,
+											 const std::string& name, const std::string& desc, const LLSaleInfo& sale_info,
+											 U32 flags, time_t creation_date_utc)
+:	LLInventoryItem(uuid, parent_uuid, permissions, asset_uuid, type, inv_type, name, desc, sale_info, flags, (S32)creation_date_utc),
+	mIsComplete(true)
+{
+}
+LLViewerInventoryItem::~LLViewerInventoryItem() { }
+LLAssetType::EType LLViewerInventoryItem::getType() const { return LLInventoryItem::getType(); }
+const LLUUID& LLViewerInventoryItem::getAssetUUID() const { return LLInventoryItem::getAssetUUID(); }
+const LLUUID& LLViewerInventoryItem::getProtectedAssetUUID() const { return LLInventoryItem::getAssetUUID(); }
+const std::string& LLViewerInventoryItem::getName() const { return LLInventoryItem::getName(); }
+S32 LLViewerInventoryItem::getSortField() const { return 0; }
+void LLViewerInventoryItem::getSLURL() { }
+const LLPermissions& LLViewerInventoryItem::getPermissions() const { return LLInventoryItem::getPermissions(); }
+const bool LLViewerInventoryItem::getIsFullPerm() const { return false; }
+const LLUUID& LLViewerInventoryItem::getCreatorUUID() const { return LLInventoryItem::getCreatorUUID(); }
+const std::string& LLViewerInventoryItem::getDescription() const { return LLInventoryItem::getDescription(); }
+const LLSaleInfo& LLViewerInventoryItem::getSaleInfo() const { return LLInventoryItem::getSaleInfo(); }
+const LLUUID& LLViewerInventoryItem::getThumbnailUUID() const { return LLInventoryItem::getThumbnailUUID(); }
+LLInventoryType::EType LLViewerInventoryItem::getInventoryType() const { return LLInventoryItem::getInventoryType(); }
+bool LLViewerInventoryItem::isWearableType() const { return false; }
+LLWearableType::EType LLViewerInventoryItem::getWearableType() const { return LLWearableType::WT_INVALID; }
+bool LLViewerInventoryItem::isSettingsType() const { return false; }
+LLSettingsType::type_e LLViewerInventoryItem::getSettingsType() const { return LLSettingsType::ST_NONE; }
+U32 LLViewerInventoryItem::getFlags() const { return LLInventoryItem::getFlags(); }
+time_t LLViewerInventoryItem::getCreationDate() const { return LLInventoryItem::getCreationDate(); }
+U32 LLViewerInventoryItem::getCRC32() const { return LLInventoryItem::getCRC32(); }
+void LLViewerInventoryItem::copyItem(const LLInventoryItem* other) { LLInventoryItem::copyItem(other); }
+void LLViewerInventoryItem::updateParentOnServer(BOOL restamp) const { }
+void LLViewerInventoryItem::updateServer(BOOL is_new) const { }
+void LLViewerInventoryItem::packMessage(LLMessageSystem* msg) const { }
+BOOL LLViewerInventoryItem::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num) { return FALSE; }
+BOOL LLViewerInventoryItem::unpackMessage(const LLSD& item) { return FALSE; }
+BOOL LLViewerInventoryItem::importLegacyStream(std::istream& input_stream) { return FALSE; }
+void LLViewerInventoryItem::setTransactionID(const LLTransactionID& transaction_id) { mTransactionID = transaction_id; }
+
+LLViewerInventoryCategory::LLViewerInventoryCategory(const LLUUID& uuid, const LLUUID& parent_uuid, LLFolderType::EType preferred_type,
+													 const std::string& name, const LLUUID& owner_id)
+:	LLInventoryCategory(uuid, parent_uuid, preferred_type, name),
+	mOwnerID(owner_id),
+	mVersion(VERSION_UNKNOWN),
+	mDescendentCount(DESCENDENT_COUNT_UNKNOWN),
+	mFetching(FETCH_NONE)
+{
+}
+LLViewerInventoryCategory::~LLViewerInventoryCategory() { }
+void LLViewerInventoryCategory::updateParentOnServer(BOOL restamp_children) const { }
+void LLViewerInventoryCategory::updateServer(BOOL is_new) const { }
+void LLViewerInventoryCategory::packMessage(LLMessageSystem* msg) const { }
+void LLViewerInventoryCategory::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num) { }
+BOOL LLViewerInventoryCategory::unpackMessage(const LLSD& category) { return FALSE; }
+S32 LLViewerInventoryCategory::getVersion() const { return mVersion; }
+void LLViewerInventoryCategory::setVersion(S32 version) { mVersion = version; }
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+namespace
+{
+	const S32 INV_CACHE_VERSION = 7;
+
+	std::string snapshot_file_name()
+	{
+		return std::string(LLFile::tmpdir()) + "llinventorycache_test.inv";
+	}
+
+	LLPointer<LLViewerInventoryCategory> make_test_category(const LLUUID& parent_id, const std::string& name)
+	{
+		LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(LLUUID::generateNewID(), parent_id,
+																				 LLFolderType::FT_NONE, name, LLUUID::generateNewID());
+		cat->setVersion(3);
+		return cat;
+	}
+
+	LLPointer<LLViewerInventoryItem> make_test_item(const LLUUID& parent_id, const std::string& name)
+	{
+		LLPermissions perm;
+		perm.init(LLUUID::generateNewID(), LLUUID::generateNewID(), LLUUID::null, LLUUID::null);
+		return new LLViewerInventoryItem(LLUUID::generateNewID(), parent_id, perm, LLUUID::generateNewID(),
+										 LLAssetType::AT_NOTECARD, LLInventoryType::IT_NOTECARD, name, name + " description",
+										 LLSaleInfo(LLSaleInfo::FS_COPY, 10), 0, 1700000000);
+	}
+
+	const LLViewerInventoryItem* find_item(const LLInventoryModel::item_array_t& items, const LLUUID& id)
+	{
+		for (const LLPointer<LLViewerInventoryItem>& item : items)
+		{
+			if (item->getUUID() == id)
+			{
+				return item;
+			}
+		}
+		return NULL;
+	}
+
+	std::vector<char> read_file(const std::string& filename)
+	{
+		llifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	void write_file(const std::string& filename, const std::vector<char>& bytes)
+	{
+		llofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), bytes.size());
+	}
+}
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+namespace tut
+{
+	// Test wrapper declaration
+	struct inventorycache_test
+	{
+		// A small inventory: two folders, three items in the second one
+		inventorycache_test()
+		{
+			mCategories.push_back(make_test_category(LLUUID::null, "My Inventory"));
+			mCategories.push_back(make_test_category(mCategories[0]->getUUID(), "Notecards"));
+			for (S32 i = 0; i < 3; ++i)
+			{
+				mItems.push_back(make_test_item(mCategories[1]->getUUID(), llformat("Note %d", i)));
+			}
+			LLInventoryBinaryCache::removeFiles(snapshot_file_name());
+		}
+		~inventorycache_test()
+		{
+			LLInventoryBinaryCache::removeFiles(snapshot_file_name());
+		}
+
+		// What a fresh cache loads from the files
+		bool loadFresh(LLInventoryModel::cat_array_t& categories, LLInventoryModel::item_array_t& items)
+		{
+			LLInventoryBinaryCache cache(snapshot_file_name());
+			LLInventoryModel::changed_items_t cats_to_update;
+			return cache.load(INV_CACHE_VERSION, categories, items, cats_to_update);
+		}
+
+		std::string logFileName() const
+		{
+			return LLInventoryBinaryCache(snapshot_file_name()).getLogFilename();
+		}
+
+		LLInventoryModel::cat_array_t mCategories;
+		LLInventoryModel::item_array_t mItems;
+	};
+
+	// Tut templating thingamagic: test group, object and test instance
+	typedef test_group<inventorycache_test> inventorycache_t;
+	typedef inventorycache_t::object inventorycache_object_t;
+	tut::inventorycache_t tut_inventorycache("LLInventoryBinaryCache");
+
+	// ---------------------------------------------------------------------------------------
+	// Test functions
+	// ---------------------------------------------------------------------------------------
+	// Test 1 : what is saved loads back, through the snapshot and through the log
+	template<> template<>
+	void inventorycache_object_t::test<1>()
+	{
+		set_test_name("inventory cache round trip");
+
+		LLInventoryBinaryCache cache(snapshot_file_name());
+		ensure("snapshot saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+
+		LLInventoryModel::cat_array_t categories;
+		LLInventoryModel::item_array_t items;
+		ensure("snapshot loads", loadFresh(categories, items));
+		ensure_equals("categories", categories.size(), 2);
+		ensure_equals("items", items.size(), 3);
+		ensure_equals("category name", categories[1]->getName(), std::string("Notecards"));
+		ensure_equals("category version", categories[1]->getVersion(), 3);
+		ensure_equals("category parent", categories[1]->getParentUUID(), mCategories[0]->getUUID());
+
+		const LLViewerInventoryItem* item = find_item(items, mItems[2]->getUUID());
+		ensure("item found", item != NULL);
+		ensure_equals("item name", item->getName(), std::string("Note 2"));
+		ensure_equals("item description", item->getDescription(), std::string("Note 2 description"));
+		ensure_equals("item asset", item->getAssetUUID(), mItems[2]->getAssetUUID());
+		ensure_equals("item creator", item->getCreatorUUID(), mItems[2]->getCreatorUUID());
+		ensure_equals("item type", item->getType(), LLAssetType::AT_NOTECARD);
+		ensure_equals("item price", item->getSaleInfo().getSalePrice(), 10);
+		ensure_equals("item date", (S32)item->getCreationDate(), 1700000000);
+
+		// A change and a removal go to the log
+		const LLUUID removed_id = mItems.back()->getUUID();
+		mItems[0]->rename("Renamed");
+		mItems.pop_back();
+		ensure("changes saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("log written", LLFile::isfile(logFileName()));
+
+		categories.clear();
+		items.clear();
+		ensure("snapshot and log load", loadFresh(categories, items));
+		ensure_equals("items after removal", items.size(), 2);
+		ensure("removed item gone", !find_item(items, removed_id));
+		ensure_equals("renamed item", find_item(items, mItems[0]->getUUID())->getName(), std::string("Renamed"));
+	}
+
+	// Test 2 : a log cut short by a crash keeps its whole entries, and is rewritten
+	template<> template<>
+	void inventorycache_object_t::test<2>()
+	{
+		set_test_name("torn last log record");
+
+		LLInventoryBinaryCache cache(snapshot_file_name());
+		ensure("snapshot saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		mItems[0]->rename("First change");
+		ensure("first change logged", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		mItems[1]->rename("Second change");
+		ensure("second change logged", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+
+		std::vector<char> log = read_file(logFileName());
+		ensure("log has entries", log.size() > 8);
+		log.resize(log.size() - 8);
+		write_file(logFileName(), log);
+
+		LLInventoryBinaryCache reloaded(snapshot_file_name());
+		LLInventoryModel::cat_array_t categories;
+		LLInventoryModel::item_array_t items;
+		LLInventoryModel::changed_items_t cats_to_update;
+		ensure("loads despite the torn entry", reloaded.load(INV_CACHE_VERSION, categories, items, cats_to_update));
+		ensure_equals("whole entry replayed", find_item(items, mItems[0]->getUUID())->getName(), std::string("First change"));
+		ensure_equals("torn entry dropped", find_item(items, mItems[1]->getUUID())->getName(), std::string("Note 1"));
+
+		// Appending behind a partial entry would hide everything after it
+		ensure("saved again", reloaded.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("torn log replaced by a snapshot", !LLFile::isfile(logFileName()));
+		categories.clear();
+		items.clear();
+		ensure("rewritten cache loads", loadFresh(categories, items));
+		ensure_equals("second change kept", find_item(items, mItems[1]->getUUID())->getName(), std::string("Second change"));
+	}
+
+	// Test 3 : a log written against another snapshot is ignored
+	template<> template<>
+	void inventorycache_object_t::test<3>()
+	{
+		set_test_name("snapshot and log generation mismatch");
+
+		LLInventoryBinaryCache cache(snapshot_file_name());
+		ensure("snapshot saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		mItems[0]->rename("Logged change");
+		ensure("change logged", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		const std::vector<char> stale_log = read_file(logFileName());
+
+		// Another instance writes a new snapshot, then the old log comes back
+		mItems[0]->rename("Note 0");
+		LLInventoryBinaryCache other(snapshot_file_name());
+		ensure("new snapshot saved", other.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("old log removed with the old snapshot", !LLFile::isfile(logFileName()));
+		write_file(logFileName(), stale_log);
+
+		LLInventoryBinaryCache reloaded(snapshot_file_name());
+		LLInventoryModel::cat_array_t categories;
+		LLInventoryModel::item_array_t items;
+		LLInventoryModel::changed_items_t cats_to_update;
+		ensure("snapshot loads", reloaded.load(INV_CACHE_VERSION, categories, items, cats_to_update));
+		ensure_equals("stale log not replayed", find_item(items, mItems[0]->getUUID())->getName(), std::string("Note 0"));
+
+		ensure("saved again", reloaded.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("stale log not appended to", !LLFile::isfile(logFileName()));
+
+		// The first instance finds the files changed under it
+		mItems[1]->rename("Late change");
+		ensure("late save", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("late save writes a snapshot", !LLFile::isfile(logFileName()));
+	}
+
+	// Test 4 : once the log gets large it is folded into a new snapshot
+	template<> template<>
+	void inventorycache_object_t::test<4>()
+	{
+		set_test_name("log compaction");
+
+		LLInventoryBinaryCache cache(snapshot_file_name());
+		ensure("snapshot saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		mItems[0]->rename("Small change");
+		ensure("small change saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("small change logged", LLFile::isfile(logFileName()));
+
+		for (S32 i = 0; i < 1100; ++i)
+		{
+			mItems.push_back(make_test_item(mCategories[1]->getUUID(), llformat("Bulk %d", i)));
+		}
+		ensure("large change saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("large change compacted", !LLFile::isfile(logFileName()));
+
+		LLInventoryModel::cat_array_t categories;
+		LLInventoryModel::item_array_t items;
+		ensure("compacted cache loads", loadFresh(categories, items));
+		ensure_equals("all items", items.size(), mItems.size());
+		ensure_equals("logged change kept", find_item(items, mItems[0]->getUUID())->getName(), std::string("Small change"));
+
+		// and the new snapshot takes log entries again
+		mItems[1]->rename("After compaction");
+		ensure("change after compaction saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+		ensure("change after compaction logged", LLFile::isfile(logFileName()));
+	}
+
+	// Test 5 : files of another format or cache version are not used
+	template<> template<>
+	void inventorycache_object_t::test<5>()
+	{
+		set_test_name("older formats are refused");
+
+		LLInventoryBinaryCache cache(snapshot_file_name());
+		ensure("snapshot saved", cache.save(INV_CACHE_VERSION, mCategories, mItems));
+
+		// Asset ids are not stored in the clear
+		std::vector<char> snapshot = read_file(snapshot_file_name());
+		const char* asset_id = (const char*)mItems[0]->getAssetUUID().mData;
+		ensure("asset id ciphered", std::search(snapshot.begin(), snapshot.end(), asset_id, asset_id + UUID_BYTES) == snapshot.end());
+
+		LLInventoryBinaryCache reloaded(snapshot_file_name());
+		LLInventoryModel::cat_array_t categories;
+		LLInventoryModel::item_array_t items;
+		LLInventoryModel::changed_items_t cats_to_update;
+		ensure("other inventory cache version", !reloaded.load(INV_CACHE_VERSION + 1, categories, items, cats_to_update));
+
+		// Format version 1 stored asset ids in the clear
+		const U32 format_version = 1;
+		memcpy(snapshot.data() + sizeof(U32), &format_version, sizeof(format_version));
+		write_file(snapshot_file_name(), snapshot);
+		ensure("version 1 snapshot", !reloaded.load(INV_CACHE_VERSION, categories, items, cats_to_update));
+		ensure("nothing loaded", categories.empty() && items.empty());
+	}
+}
@@ -0,0 +1,267 @@
+/**
+ * @file llvocacheregionfile_test.cpp
+ * @brief Tests of the memory mapped region object cache file
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Dependencies
+#include "linden_common.h"
+#include "llfile.h"
+// Class to test
+#include "../llvocacheregionfile.h"
+// Tut header
+#include "../test/lltut.h"
+
+#include <vector>
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// Notes:
+// * Add here stubbed implementation of the few classes and methods used in the class to be tested
+// * Add as little as possible (let the link errors guide you)
+// * Do not make any assumption as to how those classes or methods work (i.e. don't copy/paste code)
+// * A simulator for a class can be implemented here. Please comment and document thoroughly.
+
+LLViewerOctreeEntryData::LLViewerOctreeEntryData(LLViewerOctreeEntry::eEntryDataType_t data_type) : mDataType(data_type), mEntry(NULL) { }
+LLViewerOctreeEntryData::~LLViewerOctreeEntryData() { }
+void LLViewerOctreeEntryData::setOctreeEntry(LLViewerOctreeEntry* entry) { }
+void LLViewerOctreeEntryData::setGroup(LLViewerOctreeGroup* group) { }
+bool LLViewerOctreeEntryData::isVisible() const { return false; }
+bool LLViewerOctreeEntryData::isRecentlyVisible() const { return false; }
+
+// Simulator of LLVOCacheEntry: only the record layout matters to the region file.
+// A record is ENTRY_HEADER_SIZE bytes of local id, crc, hit count, dupe count,
+// crc change count and body size, followed by the body.
+LLVOCacheEntry::LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer& dp)
+:	LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY),
+	mLocalID(local_id),
+	mCRC(crc),
+	mHitCount(0),
+	mDupeCount(0),
+	mCRCChangeCount(0),
+	mValid(TRUE)
+{
+	S32 size = dp.getBufferSize();
+	mBuffer = new U8[size];
+	memcpy(mBuffer, dp.getBuffer(), size);
+	mDP.assignBuffer(mBuffer, size);
+}
+
+// Entries read back from a file start invalid, until the region sees the object again
+LLVOCacheEntry::LLVOCacheEntry(const U8* record, S32 record_size)
+:	LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY),
+	mBuffer(NULL),
+	mValid(FALSE)
+{
+	S32 size = 0;
+	memcpy(&mLocalID, record, sizeof(U32));
+	memcpy(&mCRC, record + sizeof(U32), sizeof(U32));
+	memcpy(&mHitCount, record + (2 * sizeof(U32)), sizeof(S32));
+	memcpy(&mDupeCount, record + (3 * sizeof(U32)), sizeof(S32));
+	memcpy(&mCRCChangeCount, record + (4 * sizeof(U32)), sizeof(S32));
+	memcpy(&size, record + (5 * sizeof(U32)), sizeof(S32));
+	if (size == record_size - ENTRY_HEADER_SIZE)
+	{
+		mBuffer = new U8[size];
+		memcpy(mBuffer, record + ENTRY_HEADER_SIZE, size);
+		mDP.assignBuffer(mBuffer, size);
+	}
+}
+
+LLVOCacheEntry::~LLVOCacheEntry()
+{
+	delete[] mBuffer;
+}
+
+S32 LLVOCacheEntry::writeToBuffer(U8* data_buffer) const
+{
+	S32 size = mDP.getBufferSize();
+	memcpy(data_buffer, &mLocalID, sizeof(U32));
+	memcpy(data_buffer + sizeof(U32), &mCRC, sizeof(U32));
+	memcpy(data_buffer + (2 * sizeof(U32)), &mHitCount, sizeof(S32));
+	memcpy(data_buffer + (3 * sizeof(U32)), &mDupeCount, sizeof(S32));
+	memcpy(data_buffer + (4 * sizeof(U32)), &mCRCChangeCount, sizeof(S32));
+	memcpy(data_buffer + (5 * sizeof(U32)), &size, sizeof(S32));
+	memcpy(data_buffer + ENTRY_HEADER_SIZE, mBuffer, size);
+	return ENTRY_HEADER_SIZE + size;
+}
+
+LLDataPackerBinaryBuffer* LLVOCacheEntry::getDP() { return mBuffer ? &mDP : NULL; }
+void LLVOCacheEntry::setOctreeEntry(LLViewerOctreeEntry* entry) { }
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+namespace
+{
+	// Cache entry for local_id with a body of size bytes of value
+	LLPointer<LLVOCacheEntry> make_entry(U32 local_id, U32 crc, S32 size, U8 value)
+	{
+		std::vector<U8> body(size, value);
+		LLDataPackerBinaryBuffer dp(body.data(), size);
+		return new LLVOCacheEntry(local_id, crc, dp);
+	}
+
+	std::string region_file_name()
+	{
+		return std::string(LLFile::tmpdir()) + "llvocacheregionfile_test.slc";
+	}
+}
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+namespace tut
+{
+	// Test wrapper declaration
+	struct vocacheregionfile_test
+	{
+		~vocacheregionfile_test()
+		{
+			LLFile::remove(region_file_name());
+		}
+	};
+
+	// Tut templating thingamagic: test group, object and test instance
+	typedef test_group<vocacheregionfile_test> vocacheregionfile_t;
+	typedef vocacheregionfile_t::object vocacheregionfile_object_t;
+	tut::vocacheregionfile_t tut_vocacheregionfile("LLVOCacheRegionFile");
+
+	// ---------------------------------------------------------------------------------------
+	// Test functions
+	// ---------------------------------------------------------------------------------------
+	// Test 1 : a written image reads back, one entry at a time or all at once
+	template<> template<>
+	void vocacheregionfile_object_t::test<1>()
+	{
+		set_test_name("region cache file round trip");
+
+		LLUUID region_id = LLUUID::generateNewID();
+		LLVOCacheEntry::vocache_entry_map_t entries;
+		entries[42] = make_entry(42, 4200, 300, 0x42);
+		entries[5] = make_entry(5, 500, 1, 0x05);
+		entries[9] = make_entry(9, 900, 60, 0x09);
+
+		LLVOCacheRegionFile::Image image;
+		LLVOCacheRegionFile::buildImage(image, region_id, entries, NULL, false);
+		ensure("image written", LLVOCacheRegionFile::writeImage(region_file_name(), image));
+
+		ensure("other region", !LLVOCacheRegionFile::open(region_file_name(), LLUUID::generateNewID()));
+
+		LLVOCacheRegionFile::ptr_t file = LLVOCacheRegionFile::open(region_file_name(), region_id);
+		ensure("file opens", (bool)file);
+		ensure_equals("entries", file->getNumEntries(), 3);
+		ensure("has 9", file->hasEntry(9));
+		ensure("no 10", !file->hasEntry(10));
+		ensure("no 10 entry", file->createEntry(10).isNull());
+
+		LLPointer<LLVOCacheEntry> entry = file->createEntry(42);
+		ensure("42 made", entry.notNull());
+		ensure_equals("42 crc", entry->getCRC(), 4200);
+		ensure("42 starts invalid", !entry->isValid());
+		LLDataPackerBinaryBuffer* dp = entry->getDP();
+		ensure("42 body", dp && dp->getBufferSize() == 300);
+		ensure_equals("42 body bytes", (S32)dp->getBuffer()[299], 0x42);
+
+		LLVOCacheEntry::vocache_entry_map_t all;
+		all[9] = entry;
+		file->createAllEntries(all);
+		ensure_equals("all made", all.size(), 3);
+		ensure("made entries are kept", all[9] == entry);
+		ensure_equals("5 crc", all[5]->getCRC(), 500);
+	}
+
+	// Test 2 : records never made into entries survive a rewrite of the file
+	template<> template<>
+	void vocacheregionfile_object_t::test<2>()
+	{
+		set_test_name("records never asked for are written back");
+
+		LLUUID region_id = LLUUID::generateNewID();
+		LLVOCacheEntry::vocache_entry_map_t entries;
+		for (U32 local_id = 1; local_id <= 100; ++local_id)
+		{
+			entries[local_id] = make_entry(local_id, local_id, 20 + local_id, (U8)local_id);
+		}
+		LLVOCacheRegionFile::Image image;
+		LLVOCacheRegionFile::buildImage(image, region_id, entries, NULL, false);
+		ensure("first write", LLVOCacheRegionFile::writeImage(region_file_name(), image));
+
+		LLVOCacheRegionFile::ptr_t file = LLVOCacheRegionFile::open(region_file_name(), region_id);
+		ensure("first open", (bool)file);
+
+		// a session that saw one object change, and one new object it never validated
+		LLVOCacheEntry::vocache_entry_map_t session;
+		session[50] = make_entry(50, 5000, 10, 0x50);
+		session[200] = make_entry(200, 200, 10, 0x20);
+		session[200]->setValid(FALSE);
+
+		LLVOCacheRegionFile::buildImage(image, region_id, session, file.get(), false);
+		// the mapping has to go before the file under it is replaced
+		file.reset();
+		ensure("second write replaces the file", LLVOCacheRegionFile::writeImage(region_file_name(), image));
+
+		file = LLVOCacheRegionFile::open(region_file_name(), region_id);
+		ensure("second open", (bool)file);
+		ensure_equals("merged entries", file->getNumEntries(), 101);
+		ensure_equals("changed entry", file->createEntry(50)->getCRC(), 5000);
+		ensure_equals("unchanged entry", file->createEntry(51)->getCRC(), 51);
+		ensure("new entry", file->hasEntry(200));
+
+		// with removal, only what was found valid is kept
+		LLVOCacheRegionFile::buildImage(image, region_id, session, file.get(), true);
+		ensure_equals("valid entries", image.mIndex.size(), 1);
+		ensure_equals("valid entry", image.mIndex[0].mLocalID, 50);
+	}
+
+	// Test 3 : missing, truncated and old format files are not opened
+	template<> template<>
+	void vocacheregionfile_object_t::test<3>()
+	{
+		set_test_name("corrupt region cache files are refused");
+
+		LLUUID region_id = LLUUID::generateNewID();
+		LLVOCacheEntry::vocache_entry_map_t entries;
+		entries[7] = make_entry(7, 7, 40, 0x07);
+		LLVOCacheRegionFile::Image image;
+		LLVOCacheRegionFile::buildImage(image, region_id, entries, NULL, false);
+
+		LLFile::remove(region_file_name());
+		ensure("missing file", !LLVOCacheRegionFile::open(region_file_name(), region_id));
+
+		// record running past the end of the file
+		image.mIndex[0].mSize += 8;
+		ensure("bad size written", LLVOCacheRegionFile::writeImage(region_file_name(), image));
+		ensure("bad size", !LLVOCacheRegionFile::open(region_file_name(), region_id));
+
+		// file in the old format: region id then entry count
+		{
+			llofstream out(region_file_name().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			S32 num_entries = 1;
+			out.write((const char*)region_id.mData, UUID_BYTES);
+			out.write((const char*)&num_entries, sizeof(S32));
+		}
+		ensure("old format", !LLVOCacheRegionFile::open(region_file_name(), region_id));
+	}
+}
@@ -0,0 +1,336 @@
+/**
+ * @file lltemplatemessagereader_tut.cpp
+ * @brief Tests for reading template messages through compiled fields.
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+#include "linden_common.h"
+#include "lltut.h"
+
+#include "llapr.h"
+#include "llmessagefield.h"
+#include "llmessagetemplate.h"
+#include "lltemplatemessagebuilder.h"
+#include "lltemplatemessagereader.h"
+#include "message_prehash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace tut
+{
+	static LLTemplateMessageBuilder::message_template_name_map_t readerNameMap;
+	static LLTemplateMessageReader::message_template_number_map_t readerNumberMap;
+
+	struct LLTemplateMessageReaderTestData
+	{
+		// Shaped like ObjectUpdate: a single header block followed by a
+		// variable block of fixed and variable size variables
+		LLMessageTemplate mTemplate;
+		U8 mBuffer[MAX_BUFFER_SIZE];
+		S32 mBuiltSize;
+
+		LLTemplateMessageReaderTestData()
+		:	mTemplate(initMessaging(), 1, MFT_HIGH),
+			mBuiltSize(0)
+		{
+			LLMessageBlock* header = new LLMessageBlock(const_cast<char*>(_PREHASH_TestBlock1), MBT_SINGLE);
+			header->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U32, 4);
+			mTemplate.addBlock(header);
+
+			LLMessageBlock* objects = new LLMessageBlock(const_cast<char*>(_PREHASH_Test0), MBT_VARIABLE);
+			objects->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U32, 4);
+			objects->addVariable(const_cast<char*>(_PREHASH_Test1), MVT_LLUUID, 16);
+			objects->addVariable(const_cast<char*>(_PREHASH_Test2), MVT_VARIABLE, 2);
+			mTemplate.addBlock(objects);
+
+			readerNameMap[_PREHASH_TestMessage] = &mTemplate;
+			readerNumberMap[1] = &mTemplate;
+		}
+
+		static const char* initMessaging()
+		{
+			static bool init = false;
+			if (!init)
+			{
+				ll_init_apr();
+				const F32 circuit_heartbeat_interval = 5;
+				const F32 circuit_timeout = 100;
+
+				start_messaging_system("notafile", 13036,
+									   1,
+									   0,
+									   0,
+									   FALSE,
+									   "notasharedsecret",
+									   NULL,
+									   false,
+									   circuit_heartbeat_interval,
+									   circuit_timeout);
+				init = true;
+			}
+			return _PREHASH_TestMessage;
+		}
+
+		static LLUUID objectID(S32 i)
+		{
+			LLUUID id;
+			id.mData[0] = (U8)i;
+			id.mData[15] = (U8)(255 - i);
+			return id;
+		}
+
+		static std::string objectData(S32 i)
+		{
+			return std::string(i % 40 + 1, (char)('a' + i % 26));
+		}
+
+		void build(S32 count)
+		{
+			LLTemplateMessageBuilder builder(readerNameMap);
+			builder.newMessage(_PREHASH_TestMessage);
+			builder.nextBlock(_PREHASH_TestBlock1);
+			builder.addU32(_PREHASH_Test0, 0xdeadbeef);
+			for (S32 i = 0; i < count; ++i)
+			{
+				builder.nextBlock(_PREHASH_Test0);
+				builder.addU32(_PREHASH_Test0, 1000 + i);
+				builder.addUUID(_PREHASH_Test1, objectID(i));
+				std::string data = objectData(i);
+				builder.addBinaryData(_PREHASH_Test2, data.data(), (S32)data.size());
+			}
+			memset(mBuffer, 0, LL_PACKET_ID_SIZE);
+			mBuiltSize = builder.buildMessage(mBuffer, MAX_BUFFER_SIZE, 0);
+		}
+
+		void read(LLTemplateMessageReader& reader)
+		{
+			ensure("valid", reader.validateMessage(mBuffer, mBuiltSize, LLHost()));
+			ensure("read", reader.readMessage(mBuffer, LLHost()));
+		}
+	};
+
+	typedef test_group<LLTemplateMessageReaderTestData>	LLTemplateMessageReaderTestGroup;
+	typedef LLTemplateMessageReaderTestGroup::object		LLTemplateMessageReaderTestObject;
+	LLTemplateMessageReaderTestGroup templateMessageReaderTestGroup("LLTemplateMessageReader");
+
+	template<> template<>
+	void LLTemplateMessageReaderTestObject::test<1>()
+		// compiling
+	{
+		LLMessageField field(_PREHASH_Test0, _PREHASH_Test2);
+		ensure("not compiled", !field.isCompiled());
+		ensure("compiles", field.compile(&mTemplate));
+		ensure("compiled", field.isCompiled());
+		ensure_equals("block index", field.getBlockIndex(), 1);
+		ensure_equals("var index", field.getVarIndex(), 2);
+
+		LLMessageField missing_var(_PREHASH_Test0, _PREHASH_TestMessage);
+		ensure("missing var", !missing_var.compile(&mTemplate));
+		ensure("missing var not compiled", !missing_var.isCompiled());
+		LLMessageField missing_block(_PREHASH_TestMessage, _PREHASH_Test0);
+		ensure("missing block", !missing_block.compile(&mTemplate));
+	}
+
+	template<> template<>
+	void LLTemplateMessageReaderTestObject::test<2>()
+		// compiled fields read what the names read
+	{
+		LLMessageField header(_PREHASH_TestBlock1, _PREHASH_Test0);
+		LLMessageField local_id(_PREHASH_Test0, _PREHASH_Test0);
+		LLMessageField full_id(_PREHASH_Test0, _PREHASH_Test1);
+		LLMessageField data(_PREHASH_Test0, _PREHASH_Test2);
+		header.compile(&mTemplate);
+		local_id.compile(&mTemplate);
+		full_id.compile(&mTemplate);
+		data.compile(&mTemplate);
+
+		const S32 count = 20;
+		build(count);
+		LLTemplateMessageReader reader(readerNumberMap);
+		read(reader);
+		ensure("current message", reader.isCurrentMessage(data));
+
+		U32 header_value = 0;
+		reader.getFieldData(header, &header_value, sizeof(header_value));
+		ensure_equals("header", header_value, (U32)0xdeadbeef);
+
+		ensure_equals("block count", reader.getFieldNumberOfBlocks(local_id), count);
+		ensure_equals("block count by name", reader.getFieldNumberOfBlocks(local_id),
+					  reader.getNumberOfBlocks(_PREHASH_Test0));
+		ensure_equals("header block count", reader.getFieldNumberOfBlocks(header), 1);
+
+		for (S32 i = 0; i < count; ++i)
+		{
+			U32 value = 0;
+			reader.getFieldData(local_id, &value, sizeof(value), i);
+			U32 by_name = 0;
+			reader.getU32(_PREHASH_Test0, _PREHASH_Test0, by_name, i);
+			ensure_equals("local id", value, (U32)(1000 + i));
+			ensure_equals("local id by name", value, by_name);
+
+			LLUUID id;
+			reader.getFieldData(full_id, &id, sizeof(id), i);
+			ensure_equals("full id", id, objectID(i));
+
+			std::string expected = objectData(i);
+			S32 size = reader.getFieldSize(data, i);
+			ensure_equals("data size", size, (S32)expected.size());
+			ensure_equals("data size by name", size, reader.getSize(_PREHASH_Test0, i, _PREHASH_Test2));
+			char buffer[64];
+			reader.getFieldData(data, buffer, 0, i, sizeof(buffer));
+			ensure_equals("data", std::string(buffer, size), expected);
+		}
+
+		ensure_equals("block past the end", reader.getFieldSize(data, count), (S32)LL_BLOCK_NOT_IN_MESSAGE);
+	}
+
+	template<> template<>
+	void LLTemplateMessageReaderTestObject::test<3>()
+		// fields of another template don't apply
+	{
+		LLMessageTemplate other(_PREHASH_TestMessage, 2, MFT_HIGH);
+		LLMessageBlock* block = new LLMessageBlock(const_cast<char*>(_PREHASH_Test0), MBT_VARIABLE);
+		block->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U32, 4);
+		other.addBlock(block);
+
+		LLMessageField field(_PREHASH_Test0, _PREHASH_Test0);
+		ensure("compiles", field.compile(&other));
+
+		build(1);
+		LLTemplateMessageReader reader(readerNumberMap);
+		read(reader);
+		ensure("other message", !reader.isCurrentMessage(field));
+		ensure("uncompiled field", !reader.isCurrentMessage(LLMessageField(_PREHASH_Test0, _PREHASH_Test0)));
+	}
+
+	// Not a regression test: times reading every object of a full
+	// ObjectUpdate sized message by name and through compiled fields.
+	template<> template<>
+	void LLTemplateMessageReaderTestObject::test<4>()
+		// field read speed
+	{
+		LLMessageField local_id(_PREHASH_Test0, _PREHASH_Test0);
+		LLMessageField full_id(_PREHASH_Test0, _PREHASH_Test1);
+		LLMessageField data(_PREHASH_Test0, _PREHASH_Test2);
+		local_id.compile(&mTemplate);
+		full_id.compile(&mTemplate);
+		data.compile(&mTemplate);
+
+		const S32 count = 40;
+		const S32 repeat = 20000;
+		build(count);
+		LLTemplateMessageReader reader(readerNumberMap);
+		read(reader);
+
+		U32 value = 0;
+		LLUUID id;
+		char buffer[64];
+		U32 checksum[2] = { 0, 0 };
+		F64 usec[2];
+		for (S32 compiled = 0; compiled < 2; ++compiled)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (S32 r = 0; r < repeat; ++r)
+			{
+				for (S32 i = 0; i < count; ++i)
+				{
+					if (compiled)
+					{
+						reader.getFieldData(local_id, &value, sizeof(value), i);
+						reader.getFieldData(full_id, &id, sizeof(id), i);
+						S32 size = reader.getFieldSize(data, i);
+						reader.getFieldData(data, buffer, 0, i, sizeof(buffer));
+						checksum[compiled] += value + id.mData[0] + size + buffer[0];
+					}
+					else
+					{
+						reader.getU32(_PREHASH_Test0, _PREHASH_Test0, value, i);
+						reader.getUUID(_PREHASH_Test0, _PREHASH_Test1, id, i);
+						S32 size = reader.getSize(_PREHASH_Test0, i, _PREHASH_Test2);
+						reader.getBinaryData(_PREHASH_Test0, _PREHASH_Test2, buffer, 0, i, sizeof(buffer));
+						checksum[compiled] += value + id.mData[0] + size + buffer[0];
+					}
+				}
+			}
+			usec[compiled] = std::chrono::duration<F64, std::micro>(std::chrono::steady_clock::now() - start).count();
+		}
+		ensure_equals("same reads", checksum[1], checksum[0]);
+
+		const F64 reads = (F64)repeat * count * 4;
+		std::cout << "\nLLTemplateMessageReader, " << count << " blocks of 3 variables, ns per read: by name "
+				  << usec[0] * 1000.0 / reads << ", compiled " << usec[1] * 1000.0 / reads << std::endl;
+	}
+
+	template<> template<>
+	void LLTemplateMessageReaderTestObject::test<5>()
+		// in place decode reads the same as copying decode
+	{
+		const S32 count = 30;
+		build(count);
+
+		LLTemplateMessageReader copying(readerNumberMap);
+		read(copying);
+		LLTemplateMessageReader in_place(readerNumberMap);
+		in_place.setDecodeInPlace(true);
+		ensure("in place", in_place.getDecodeInPlace());
+		read(in_place);
+
+		U32 header = 0;
+		in_place.getU32(_PREHASH_TestBlock1, _PREHASH_Test0, header);
+		ensure_equals("header", header, (U32)0xdeadbeef);
+		ensure_equals("block count", in_place.getNumberOfBlocks(_PREHASH_Test0), count);
+		for (S32 i = 0; i < count; ++i)
+		{
+			U32 expected_id = 0, id = 0;
+			copying.getU32(_PREHASH_Test0, _PREHASH_Test0, expected_id, i);
+			in_place.getU32(_PREHASH_Test0, _PREHASH_Test0, id, i);
+			ensure_equals("local id", id, expected_id);
+
+			LLUUID expected_uuid, uuid;
+			copying.getUUID(_PREHASH_Test0, _PREHASH_Test1, expected_uuid, i);
+			in_place.getUUID(_PREHASH_Test0, _PREHASH_Test1, uuid, i);
+			ensure_equals("full id", uuid, expected_uuid);
+
+			S32 size = in_place.getSize(_PREHASH_Test0, i, _PREHASH_Test2);
+			ensure_equals("data size", size, copying.getSize(_PREHASH_Test0, i, _PREHASH_Test2));
+			char expected_data[64], data[64];
+			copying.getBinaryData(_PREHASH_Test0, _PREHASH_Test2, expected_data, 0, i, sizeof(expected_data));
+			in_place.getBinaryData(_PREHASH_Test0, _PREHASH_Test2, data, 0, i, sizeof(data));
+			ensure_equals("data", std::string(data, size), std::string(expected_data, size));
+		}
+
+		// the variables are the packet bytes, not a copy of them
+		U32 packed = 0xdeadbeef;
+		U8* header_bytes = std::search(mBuffer, mBuffer + mBuiltSize, (U8*)&packed, (U8*)&packed + 4);
+		ensure("header in packet", header_bytes != mBuffer + mBuiltSize);
+		header_bytes[0] ^= 0xff;
+		in_place.getU32(_PREHASH_TestBlock1, _PREHASH_Test0, header);
+		ensure_equals("in place header", header, (U32)0xdeadbeef ^ 0xff);
+		copying.getU32(_PREHASH_TestBlock1, _PREHASH_Test0, header);
+		ensure_equals("copied header", header, (U32)0xdeadbeef);
+	}
+}